@@ -0,0 +1,104 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <array>
+#include <iomanip>
+#include <iostream>
+#include <tiledarray.h>
+
+int main(int argc, char** argv) {
+  int rc = 0;
+
+  try {
+    // Initialize runtime
+    TiledArray::World& world = TiledArray::initialize(argc, argv);
+
+    // Get command line arguments
+    if(argc < 2) {
+      std::cout << "Permutes a rank-4 tile with extent^4 elements with every "
+                   "rank-4 permutation.\n"
+                << "Usage: ta_permute extent [repetitions]\n";
+      return 0;
+    }
+    const long extent = atol(argv[1]);
+    if (extent <= 0) {
+      std::cerr << "Error: extent must be greater than zero.\n";
+      return 1;
+    }
+    const long repeat = (argc >= 3 ? atol(argv[2]) : 5);
+    if (repeat <= 0) {
+      std::cerr << "Error: number of repetitions must be greater than zero.\n";
+      return 1;
+    }
+
+    // Only the first process runs the benchmark
+    if(world.rank() == 0) {
+      const std::array<std::size_t, 4> upper = {{std::size_t(extent),
+          std::size_t(extent), std::size_t(extent), std::size_t(extent)}};
+      TiledArray::Tensor<double> tile(TiledArray::Range(upper));
+      for(std::size_t i = 0ul; i < tile.size(); ++i)
+        tile[i] = double(i);
+
+      const double gbytes = 2.0 * double(tile.size()) * sizeof(double) / 1.0e9;
+      std::cout << "TiledArray: tile permutation benchmark..."
+                << "\nTile extent         = " << extent << "^4"
+                << "\nMemory per tile     = " << gbytes * 0.5 << " GB"
+                << "\nRepetitions         = " << repeat << "\n\n";
+
+      // Benchmark every rank-4 permutation, including the identity
+      std::array<unsigned int, 4> p = {{0u, 1u, 2u, 3u}};
+      do {
+        const TiledArray::Permutation perm(p.begin(), p.end());
+
+        // Warm up
+        TiledArray::Tensor<double> result = tile.permute(perm);
+
+        const double start = madness::wall_time();
+        for(long r = 0l; r < repeat; ++r)
+          result = tile.permute(perm);
+        const double time = (madness::wall_time() - start) / double(repeat);
+
+        std::cout << "Permutation " << perm << ": " << std::setw(10) << time
+                  << " s, " << std::setw(10) << gbytes / time << " GB/s\n";
+      } while(std::next_permutation(p.begin(), p.end()));
+    }
+
+    world.gop.fence();
+    TiledArray::finalize();
+
+  } catch(TiledArray::Exception& e) {
+    std::cerr << "!! TiledArray exception: " << e.what() << "\n";
+    rc = 1;
+  } catch(madness::MadnessException& e) {
+    std::cerr << "!! MADNESS exception: " << e.what() << "\n";
+    rc = 1;
+  } catch(SafeMPI::Exception& e) {
+    std::cerr << "!! SafeMPI exception: " << e.what() << "\n";
+    rc = 1;
+  } catch(std::exception& e) {
+    std::cerr << "!! std exception: " << e.what() << "\n";
+    rc = 1;
+  } catch(...) {
+    std::cerr << "!! exception: unknown exception\n";
+    rc = 1;
+  }
+
+  return rc;
+}
@@ -0,0 +1,167 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// Throughput of expression reductions with the default and the reproducible
+// reduction order (see TiledArray::math::reproducible_reduce()), and the
+// spread of the results over repeated runs.
+//
+// Usage: ta_reduce matrix_size block_size [repetitions]
+
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+#include <tiledarray.h>
+
+namespace {
+
+  /// Time repeated dot products and norms of an array
+
+  /// \param a The array
+  /// \param repeat The number of repetitions
+  /// \param reproducible The reproducible reduction flag
+  /// \return The time per reduction in seconds
+  double reduce_test(const TiledArray::TArrayD& a, const long repeat,
+      const bool reproducible)
+  {
+    TiledArray::World& world = a.world();
+    TiledArray::math::set_reproducible_reduce(reproducible);
+
+    double min_dot = std::numeric_limits<double>::max();
+    double max_dot = std::numeric_limits<double>::lowest();
+    double norm = 0.0;
+
+    world.gop.fence();
+    const double start = madness::wall_time();
+    for(long i = 0l; i < repeat; ++i) {
+      const double dot = a("i,j").dot(a("i,j")).get();
+      min_dot = std::min(min_dot, dot);
+      max_dot = std::max(max_dot, dot);
+      norm += a("i,j").norm().get();
+    }
+    const double time = (madness::wall_time() - start) / double(2l * repeat);
+
+    if(world.rank() == 0)
+      std::cout << std::left << std::setw(14)
+          << (reproducible ? "reproducible" : "default") << std::right
+          << std::scientific << std::setprecision(3)
+          << std::setw(12) << time << " s"
+          << std::setw(12) << (max_dot - min_dot) << " dot spread"
+          << std::setprecision(17) << std::setw(26) << min_dot << "\n";
+    (void)norm;
+
+    return time;
+  }
+
+} // namespace
+
+int main(int argc, char** argv) {
+  int rc = 0;
+
+  try {
+
+    // Initialize runtime
+    TiledArray::World& world = TiledArray::initialize(argc, argv);
+
+    // Get command line arguments
+    if(argc < 3) {
+      std::cout << "Usage: ta_reduce matrix_size block_size [repetitions]\n";
+      return 0;
+    }
+    const long matrix_size = atol(argv[1]);
+    const long block_size = atol(argv[2]);
+    if (matrix_size <= 0) {
+      std::cerr << "Error: matrix size must be greater than zero.\n";
+      return 1;
+    }
+    if (block_size <= 0) {
+      std::cerr << "Error: block size must be greater than zero.\n";
+      return 1;
+    }
+    if((matrix_size % block_size) != 0ul) {
+      std::cerr << "Error: matrix size must be evenly divisible by block size.\n";
+      return 1;
+    }
+    const long repeat = (argc >= 4 ? atol(argv[3]) : 20);
+    if (repeat <= 0) {
+      std::cerr << "Error: number of repetitions must be greater than zero.\n";
+      return 1;
+    }
+
+    const std::size_t num_blocks = matrix_size / block_size;
+    if(world.rank() == 0)
+      std::cout << "TiledArray: reduction order test..."
+                << "\nNumber of nodes     = " << world.size()
+                << "\nMatrix size         = " << matrix_size << "x" << matrix_size
+                << "\nBlock size          = " << block_size << "x" << block_size
+                << "\nNumber of blocks    = " << num_blocks * num_blocks
+                << "\n\n";
+
+    // Construct TiledRange
+    std::vector<unsigned int> blocking;
+    blocking.reserve(num_blocks + 1);
+    for(long i = 0l; i <= matrix_size; i += block_size)
+      blocking.push_back(i);
+
+    std::vector<TiledArray::TiledRange1> blocking2(2,
+        TiledArray::TiledRange1(blocking.begin(), blocking.end()));
+
+    TiledArray::TiledRange
+      trange(blocking2.begin(), blocking2.end());
+
+    {
+      // Elements with a wide range of magnitudes make the result depend on
+      // the order of the reduction
+      TiledArray::TArrayD a(world, trange);
+      a.init_elements([] (const auto& i) {
+        return (i[0] % 7 == 0 ? 1.0e4 : 1.0e-4) * double(1 + (i[1] % 13));
+      });
+
+      const bool reproducible = TiledArray::math::reproducible_reduce();
+      const double default_time = reduce_test(a, repeat, false);
+      const double reproducible_time = reduce_test(a, repeat, true);
+      TiledArray::math::set_reproducible_reduce(reproducible);
+
+      if(world.rank() == 0)
+        std::cout << "\nRelative cost of the reproducible order: "
+                  << std::fixed << std::setprecision(2)
+                  << reproducible_time / default_time << "\n";
+    }
+
+    TiledArray::finalize();
+
+  } catch(TiledArray::Exception& e) {
+    std::cerr << "!! TiledArray exception: " << e.what() << "\n";
+    rc = 1;
+  } catch(madness::MadnessException& e) {
+    std::cerr << "!! MADNESS exception: " << e.what() << "\n";
+    rc = 1;
+  } catch(SafeMPI::Exception& e) {
+    std::cerr << "!! SafeMPI exception: " << e.what() << "\n";
+    rc = 1;
+  } catch(std::exception& e) {
+    std::cerr << "!! std exception: " << e.what() << "\n";
+    rc = 1;
+  } catch(...) {
+    std::cerr << "!! exception: unknown exception\n";
+    rc = 1;
+  }
+
+  return rc;
+}
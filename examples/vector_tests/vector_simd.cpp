@@ -0,0 +1,160 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// Memory bandwidth of the vector kernels in math/simd.h, compared to the
+// STREAM copy and triad loops and to the generic vector operations.
+//
+// Usage: vector_simd [size] [repeat]
+//
+// Set TA_SIMD=portable|avx2|avx512 to select the instruction set.
+
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <string>
+#include <madness/world/timers.h>
+#include "TiledArray/math/simd.h"
+
+namespace {
+
+  const char* isa_name(const TiledArray::math::simd::Isa isa) {
+    switch(isa) {
+      case TiledArray::math::simd::Isa::avx512: return "avx512";
+      case TiledArray::math::simd::Isa::avx2: return "avx2";
+      default: return "portable";
+    }
+  }
+
+  /// Time an operation and print its bandwidth
+
+  /// \param name The name of the operation
+  /// \param bytes The number of bytes moved by one call of \c op
+  /// \param repeat The number of calls
+  /// \param op The operation
+  /// \param peak The reference bandwidth in GB/s, or 0 for none
+  /// \return The bandwidth of \c op in GB/s
+  template <typename Op>
+  double report(const std::string& name, const double bytes,
+      const std::size_t repeat, Op&& op, const double peak = 0.0)
+  {
+    op(); // warm up
+    const double start = madness::wall_time();
+    for(std::size_t r = 0ul; r < repeat; ++r)
+      op();
+    const double time = madness::wall_time() - start;
+    const double bandwidth = bytes * double(repeat) / time * 1.0e-9;
+
+    std::cout << std::left << std::setw(22) << name << std::right
+        << std::fixed << std::setprecision(2) << std::setw(10) << bandwidth
+        << " GB/s";
+    if(peak > 0.0)
+      std::cout << std::setw(8) << std::setprecision(1)
+          << (100.0 * bandwidth / peak) << " % of STREAM";
+    std::cout << "\n";
+
+    return bandwidth;
+  }
+
+} // namespace
+
+int main(int argc, char** argv) {
+  using namespace TiledArray::math;
+
+  const std::size_t n = (argc > 1 ? std::atol(argv[1]) : 20000000l);
+  const std::size_t repeat = (argc > 2 ? std::atol(argv[2]) : 20l);
+  if(n == 0ul || repeat == 0ul) {
+    std::cerr << "Usage: vector_simd [size] [repeat]\n";
+    return 1;
+  }
+
+  double* a = NULL;
+  double* b = NULL;
+  double* c = NULL;
+  if(posix_memalign(reinterpret_cast<void**>(&a), 128, sizeof(double) * n) != 0)
+    return 1;
+  if(posix_memalign(reinterpret_cast<void**>(&b), 128, sizeof(double) * n) != 0)
+    return 1;
+  if(posix_memalign(reinterpret_cast<void**>(&c), 128, sizeof(double) * n) != 0)
+    return 1;
+  std::fill_n(a, n, 1.0);
+  std::fill_n(b, n, 2.0);
+  std::fill_n(c, n, 0.0);
+
+  const double word = sizeof(double) * double(n);
+  double result = 0.0;
+
+  std::cout << "Vector size: " << n << ", repeat: " << repeat
+      << ", instruction set: " << isa_name(simd::isa()) << "\n\n";
+
+  // STREAM reference loops
+  const double copy = report("STREAM copy", 2.0 * word, repeat, [=] () {
+    for(std::size_t i = 0ul; i < n; ++i)
+      c[i] = a[i];
+  });
+  const double triad = report("STREAM triad", 3.0 * word, repeat, [=] () {
+    for(std::size_t i = 0ul; i < n; ++i)
+      a[i] = b[i] + 3.0 * c[i];
+  });
+  std::cout << "\n";
+
+  // Vector kernels, which are compared to the STREAM loop that moves the
+  // same amount of data
+  report("simd add_to", 3.0 * word, repeat,
+      [=] () { simd::add_to(n, b, c); }, triad);
+  report("simd axpy", 3.0 * word, repeat,
+      [=] () { simd::axpy(n, 0.5, b, c); }, triad);
+  report("simd scale_to", 2.0 * word, repeat,
+      [=] () { simd::scale_to(n, 0.5, c); }, copy);
+  report("simd sum", word, repeat,
+      [=, &result] () { result += simd::sum(n, a); }, copy);
+  report("simd dot", 2.0 * word, repeat,
+      [=, &result] () { result += simd::dot(n, a, b); }, copy);
+  report("simd squared_norm", word, repeat,
+      [=, &result] () { result += simd::squared_norm(n, a); }, copy);
+  report("simd abs_max", word, repeat,
+      [=, &result] () { result += simd::abs_max(n, a); }, copy);
+  std::cout << "\n";
+
+  // Generic vector operations for the same kernels
+  report("vector_op add_to", 3.0 * word, repeat, [=] () {
+    inplace_vector_op([] (double& MADNESS_RESTRICT y, const double x) { y += x; },
+        n, c, b);
+  }, triad);
+  report("vector_op scale_to", 2.0 * word, repeat, [=] () {
+    inplace_vector_op([] (double& MADNESS_RESTRICT y) { y *= 0.5; }, n, c);
+  }, copy);
+  report("reduce_op dot", 2.0 * word, repeat, [=, &result] () {
+    double dot = 0.0;
+    auto mult_add = [] (double& MADNESS_RESTRICT r, const double x, const double y)
+        { r += x * y; };
+    auto add = [] (double& MADNESS_RESTRICT r, const double x) { r += x; };
+    reduce_op(mult_add, add, 0.0, n, dot, a, b);
+    result += dot;
+  }, copy);
+
+  // Print the reductions so they are not optimized away
+  std::cout << "\n(checksum " << result << ")\n";
+
+  free(a);
+  free(b);
+  free(c);
+
+  return 0;
+}
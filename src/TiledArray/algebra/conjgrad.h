@@ -26,10 +26,12 @@
 #ifndef TILEDARRAY_ALGEBRA_CONJGRAD_H__INCLUDED
 #define TILEDARRAY_ALGEBRA_CONJGRAD_H__INCLUDED
 
+#include <array>
 #include <sstream>
 #include <TiledArray/algebra/diis.h>
 #include <TiledArray/algebra/utils.h>
 #include "../dist_array.h"
+#include "../reduce_task.h"
 
 namespace TiledArray {
 
@@ -177,6 +179,312 @@ namespace TiledArray {
     }
   };
 
+  /// The dot products of an iteration of the pipelined conjugate gradient solver
+
+  /// \tparam T The value type
+  template <typename T>
+  struct PipelinedCGDots {
+    T ru; ///< <tt> r . u </tt>, the residual times the preconditioned residual
+    T wu; ///< <tt> w . u </tt>, \c w is <tt> a(u) </tt>
+    T rr; ///< <tt> r . r </tt>, the squared norm of the residual
+
+    template <typename Archive>
+    void serialize(Archive& ar) { ar & ru & wu & rr; }
+  }; // struct PipelinedCGDots
+
+  /// Solves real linear system <tt> a(x) = b </tt> using pipelined conjugate
+  /// gradient solver where \c a is a linear function of \c x .
+
+  /// This is the preconditioned pipelined conjugate gradient method of
+  /// Ghysels and Vanroose [Parallel Computing 40, 224 (2014)]. It is
+  /// mathematically equivalent to \c ConjugateGradientSolver , but the
+  /// three dot products of an iteration are computed together with the vector
+  /// updates, in a single pass over the vectors, and are reduced with a single
+  /// non-blocking all-reduce, which overlaps the evaluation of \c a . All
+  /// vectors are updated in place. The price is four more work vectors and
+  /// slightly different rounding.
+  /// \tparam D type of \c x and \c b, as well as the preconditioner;
+  /// \tparam F type that evaluates the LHS, will call \c F::operator()(x,result) ,
+  /// \c D must implement <tt> operator()(const D&, D&) const </tt>
+  /// \c D::element_type must be defined and \c D must provide the following
+  /// stand-alone functions:
+  ///   \li <tt> std::size_t size(const D&) </tt>
+  ///   \li <tt> D clone(const D&) </tt>
+  ///   \li <tt> D copy(const D&) </tt>
+  ///   \li <tt> void zero(D&) </tt>
+  ///   \li <tt> value_type minabs_value(const D&) </tt>
+  ///   \li <tt> value_type maxabs_value(const D&) </tt>
+  ///   \li <tt> void vec_multiply(D& a, const D& b) </tt> (element-wise multiply of \c a by \c b )
+  ///   \li <tt> void scale(D&, value_type) </tt>
+  ///   \li <tt> void axpy(D& y, value_type a, const D& x) </tt>
+  ///   \li <tt> void assign(D&, const D&) </tt>
+  ///   \li <tt> Future<PipelinedCGDots<value_type> > pipelined_cg_update(...) </tt>
+  /// (see the \c DistArray implementation)
+  template <typename D, typename F>
+  struct PipelinedConjugateGradientSolver {
+    typedef typename D::element_type value_type;
+
+    /// \param a object of type F
+    /// \param b RHS
+    /// \param x unknown
+    /// \param preconditioner
+    /// \param convergence_target The convergence target [default = -1.0]
+    /// \return The 2-norm of the residual, a(x) - b, divided by the number of
+    /// elements in the residual.
+    value_type operator()(F& a, const D& b, D& x, const D& preconditioner,
+        value_type convergence_target = -1.0)
+    {
+
+      std::size_t n = size(x);
+      assert(n == size(preconditioner));
+
+      // approximate the condition number as the ratio of the min and max elements of the preconditioner
+      // assuming that preconditioner is the approximate inverse of A in Ax - b =0
+      const value_type precond_min = minabs_value(preconditioner);
+      const value_type precond_max = maxabs_value(preconditioner);
+      const value_type cond_number = precond_max / precond_min;
+      // if convergence target is given, estimate of how tightly the system can be converged
+      if (convergence_target < 0.0) {
+        convergence_target = 1e-15 * cond_number;
+      }
+      else { // else warn if the given system is not sufficiently well conditioned
+        if (convergence_target < 1e-15 * cond_number)
+          std::cout << "WARNING: ConjugateGradient convergence target (" << convergence_target
+                    << ") may be too low for 64-bit precision" << std::endl;
+      }
+
+      const unsigned int max_niter = n;
+      const std::size_t rhs_size = size(b);
+
+      // The vectors are updated in place, so they are computed from clones of
+      // b, which gives them the same distribution
+
+      // starting guess: x_0 = D^-1 . b
+      D XX_i = copy(b);
+      vec_multiply(XX_i, preconditioner);
+
+      // r_0 = b - a(x)
+      D AXX_i = clone(b);
+      a(XX_i, AXX_i);  // AXX_i = a(XX_i)
+      D RR_i = clone(b);
+      axpy(RR_i, -1.0, AXX_i); // RR_i = b - a(XX_i)
+
+      // u_0 = D^-1 . r_0
+      D UU_i = copy(RR_i);
+      vec_multiply(UU_i, preconditioner);
+
+      // w_0 = a(u_0)
+      D AUU_i = clone(b);
+      a(UU_i, AUU_i);
+      D WW_i = clone(b);
+      zero(WW_i);
+      axpy(WW_i, 1.0, AUU_i);
+
+      // The remaining work vectors are zero initially, so the first update
+      // only computes the dot products and m_0 = D^-1 . w_0
+      D PP_i = clone(b); // p_i = u_i + beta_i p_i-1
+      zero(PP_i);
+      D SS_i = clone(PP_i); // s_i = a(p_i)
+      D QQ_i = clone(PP_i); // q_i = D^-1 . s_i
+      D ZZ_i = clone(PP_i); // z_i = a(q_i)
+      D MM_i = clone(PP_i); // m_i = D^-1 . w_i
+      D NN_i = clone(PP_i); // n_i = a(m_i)
+
+      Future<PipelinedCGDots<value_type> > dots =
+          pipelined_cg_update(value_type(0), value_type(0), XX_i, RR_i, UU_i,
+          WW_i, PP_i, SS_i, QQ_i, ZZ_i, MM_i, NN_i, preconditioner);
+
+      value_type alpha_im1 = 0.0;
+      value_type ru_im1 = 0.0;
+      value_type rnorm2 = 0.0;
+      unsigned int iter = 0;
+      while (true) {
+
+        // n_i = a(m_i), which overlaps the reduction of the dot products
+        a(MM_i, NN_i);
+
+        const PipelinedCGDots<value_type> dots_i = dots.get();
+        rnorm2 = std::sqrt(dots_i.rr) / rhs_size;
+        if (rnorm2 < convergence_target)
+          break;
+
+        if (iter >= max_niter) {
+          assign(x, XX_i);
+          throw std::domain_error("ConjugateGradient: max # of iterations exceeded");
+        }
+
+        // beta_i = (r_i . u_i) / (r_i-1 . u_i-1)
+        // alpha_i = (r_i . u_i) / (w_i . u_i - beta_i (r_i . u_i) / alpha_i-1)
+        const value_type beta_i = (iter == 0 ? value_type(0) : dots_i.ru / ru_im1);
+        const value_type alpha_i = (iter == 0 ? dots_i.ru / dots_i.wu :
+            dots_i.ru / (dots_i.wu - beta_i * dots_i.ru / alpha_im1));
+
+        // Update the vectors, and start the reduction of the next dot products
+        dots = pipelined_cg_update(alpha_i, beta_i, XX_i, RR_i, UU_i, WW_i,
+            PP_i, SS_i, QQ_i, ZZ_i, MM_i, NN_i, preconditioner);
+
+        alpha_im1 = alpha_i;
+        ru_im1 = dots_i.ru;
+        ++iter;
+      } // solver loop
+
+      assign(x, XX_i);
+
+      return rnorm2;
+    }
+  };
+
+  namespace detail {
+
+    /// Dot product reduction of the pipelined conjugate gradient solver
+    template <typename T>
+    struct PipelinedCGDotsReduction {
+      typedef PipelinedCGDots<T> result_type;
+      typedef PipelinedCGDots<T> argument_type;
+
+      result_type operator()() const { return result_type{T(0), T(0), T(0)}; }
+
+      const result_type& operator()(const result_type& result) const { return result; }
+
+      void operator()(result_type& result, const argument_type& arg) const {
+        result.ru += arg.ru;
+        result.wu += arg.wu;
+        result.rr += arg.rr;
+      }
+    }; // struct PipelinedCGDotsReduction
+
+    /// Fused vector updates of one tile of the pipelined conjugate gradient solver
+
+    /// \param alpha The step length
+    /// \param beta The direction update factor
+    /// \param tiles The tiles of \c x, \c r, \c u, \c w, \c p, \c s,
+    /// \c q, and \c z , which are updated in place
+    /// \param m The tile of \c m
+    /// \param n The tile of \c n
+    /// \return The local contributions to the dot products of the updated
+    /// vectors
+    template <typename Tile>
+    PipelinedCGDots<typename Tile::value_type>
+    pipelined_cg_tile_update(const typename Tile::value_type alpha,
+        const typename Tile::value_type beta, std::array<Tile, 8> tiles,
+        const Tile& m, const Tile& n)
+    {
+      typedef typename Tile::value_type value_type;
+      auto* MADNESS_RESTRICT const x = tiles[0].data();
+      auto* MADNESS_RESTRICT const r = tiles[1].data();
+      auto* MADNESS_RESTRICT const u = tiles[2].data();
+      auto* MADNESS_RESTRICT const w = tiles[3].data();
+      auto* MADNESS_RESTRICT const p = tiles[4].data();
+      auto* MADNESS_RESTRICT const s = tiles[5].data();
+      auto* MADNESS_RESTRICT const q = tiles[6].data();
+      auto* MADNESS_RESTRICT const z = tiles[7].data();
+      const value_type* MADNESS_RESTRICT const m_data = m.data();
+      const value_type* MADNESS_RESTRICT const n_data = n.data();
+
+      value_type ru = 0, wu = 0, rr = 0;
+      const std::size_t size = tiles[0].size();
+      for(std::size_t i = 0ul; i < size; ++i) {
+        z[i] = n_data[i] + beta * z[i];
+        q[i] = m_data[i] + beta * q[i];
+        s[i] = w[i] + beta * s[i];
+        p[i] = u[i] + beta * p[i];
+        x[i] += alpha * p[i];
+        r[i] -= alpha * s[i];
+        u[i] -= alpha * q[i];
+        w[i] -= alpha * z[i];
+        ru += r[i] * u[i];
+        wu += w[i] * u[i];
+        rr += r[i] * r[i];
+      }
+
+      return PipelinedCGDots<value_type>{ru, wu, rr};
+    }
+
+    /// Preconditioned tile of the pipelined conjugate gradient solver
+
+    /// \param preconditioner The preconditioner tile
+    /// \param w The updated tile of \c w
+    /// \return The tile of <tt> m = D^-1 . w </tt>
+    template <typename Tile>
+    Tile pipelined_cg_tile_precondition(const Tile& preconditioner, const Tile& w,
+        const PipelinedCGDots<typename Tile::value_type>&)
+    {
+      Tile m(w.range());
+      const std::size_t size = w.size();
+      for(std::size_t i = 0ul; i < size; ++i)
+        m[i] = preconditioner[i] * w[i];
+      return m;
+    }
+
+  } // namespace detail
+
+  /// Vector updates of an iteration of the pipelined conjugate gradient solver
+
+  /// This function applies
+  /// \code
+  /// z = n + beta z;  q = m + beta q;  s = w + beta s;  p = u + beta p;
+  /// x += alpha p;  r -= alpha s;  u -= alpha q;  w -= alpha z;
+  /// \endcode
+  /// in place, in a single pass over the local tiles, which also computes the
+  /// local contributions to <tt> r . u </tt>, <tt> w . u </tt>, and
+  /// <tt> r . r </tt>. The contributions are combined with a single
+  /// non-blocking all-reduce. \c m is replaced with the preconditioned
+  /// residual update <tt> preconditioner * w </tt>, whose tiles become ready
+  /// as the local updates are done. The updated vectors must not share tiles
+  /// with other arrays, and must be dense and have the same process map;
+  /// \c m, \c n and \c preconditioner only need the same tiling.
+  /// \return The dot products of the updated vectors
+  template <typename Tile, typename Policy>
+  Future<PipelinedCGDots<typename DistArray<Tile, Policy>::element_type> >
+  pipelined_cg_update(const typename DistArray<Tile, Policy>::element_type alpha,
+      const typename DistArray<Tile, Policy>::element_type beta,
+      DistArray<Tile, Policy>& x, DistArray<Tile, Policy>& r,
+      DistArray<Tile, Policy>& u, DistArray<Tile, Policy>& w,
+      DistArray<Tile, Policy>& p, DistArray<Tile, Policy>& s,
+      DistArray<Tile, Policy>& q, DistArray<Tile, Policy>& z,
+      DistArray<Tile, Policy>& m, const DistArray<Tile, Policy>& n,
+      const DistArray<Tile, Policy>& preconditioner)
+  {
+    typedef typename DistArray<Tile, Policy>::element_type element_type;
+    typedef typename DistArray<Tile, Policy>::value_type value_type;
+    typedef detail::PipelinedCGDotsReduction<element_type> reduction_type;
+    typedef madness::TaggedKey<madness::uniqueidT, reduction_type> key_type;
+
+    World& world = x.world();
+    DistArray<Tile, Policy> m_next(world, x.trange(), x.shape(), x.pmap());
+
+    Future<PipelinedCGDots<element_type> > result =
+        detail::all_reduce_args(world, key_type(world.unique_obj_id()),
+        reduction_type(), [&] (auto& reduce_task) {
+      for(auto index : * x.pmap()) {
+        TA_ASSERT(! x.is_zero(index));
+        TA_ASSERT(r.is_local(index) && u.is_local(index) && w.is_local(index));
+        TA_ASSERT(p.is_local(index) && s.is_local(index) && q.is_local(index));
+        TA_ASSERT(z.is_local(index));
+
+        // The tiles of the in-place vectors are not modified after the
+        // previous update, so they are shared with the update task
+        const std::array<value_type, 8> tiles = {{ x.find(index).get(),
+            r.find(index).get(), u.find(index).get(), w.find(index).get(),
+            p.find(index).get(), s.find(index).get(), q.find(index).get(),
+            z.find(index).get() }};
+        Future<PipelinedCGDots<element_type> > dots = world.taskq.add(
+            & detail::pipelined_cg_tile_update<value_type>, alpha, beta, tiles,
+            m.find(index), n.find(index));
+
+        // The new tile of m depends on the updated tile of w
+        m_next.set(index, world.taskq.add(
+            & detail::pipelined_cg_tile_precondition<value_type>,
+            preconditioner.find(index), tiles[3], dots));
+
+        reduce_task.add(dots);
+      }
+    });
+
+    m = m_next;
+    return result;
+  }
+
 };
 
 #endif // TILEDARRAY_ALGEBRA_CONJGRAD_H__INCLUDED
@@ -27,6 +27,7 @@
 #define TILEDARRAY_ALGEBRA_DIIS_H__INCLUDED
 
 #include <deque>
+#include <vector>
 #include <TiledArray/math/eigen.h>
 #include <TiledArray/algebra/utils.h>
 #include "../dist_array.h"
@@ -153,9 +154,13 @@ namespace TiledArray {
 
         // extrapolate the error if needed
         if (extrapolate_error && (mixing_fraction == 0.0 || x_extrap_.empty())) {
+          std::vector<value_type> a;
+          std::vector<const D*> e;
           for (unsigned int k=nskip_, kk=1; k < nvec; ++k, ++kk) {
-            axpy(error, C_[kk], errors_[k]);
+            a.push_back(C_[kk]);
+            e.push_back(&errors_[k]);
           }
+          axpy(error, a, e);
         }
       }
 
@@ -189,8 +194,8 @@ namespace TiledArray {
         if (iter == 1) { // the first iteration
           if (not x_extrap_.empty() && do_mixing) {
             zero(x);
-            axpy(x, (1.0-mixing_fraction), x_[0]);
-            axpy(x, mixing_fraction, x_extrap_[0]);
+            axpy(x, std::vector<value_type>{1.0-mixing_fraction, mixing_fraction},
+                 std::vector<const D*>{&x_[0], &x_extrap_[0]});
           }
         }
         else if (iter > start && (((iter - start) % ngroup) < ngroupdiis)) { // not the first iteration and need to extrapolate?
@@ -200,16 +205,23 @@ namespace TiledArray {
 
           TA_USER_ASSERT(c.size() == rank,
                          "DIIS: numbers of coefficients and x's do not match");
-          zero(x);
+          // x = sum_k c_k x_k, as a single linear combination
+          std::vector<value_type> a;
+          std::vector<const D*> xs;
           for (unsigned int k=nskip, kk=1; k < nvec; ++k, ++kk) {
             if (not do_mixing || x_extrap_.empty()) {
               //std::cout << "contrib " << k << " c=" << c[kk] << ":" << std::endl << x_[k] << std::endl;
-              axpy(x, c[kk], x_[k]);
+              a.push_back(c[kk]);
+              xs.push_back(&x_[k]);
             } else {
-              axpy(x, c[kk] * (1.0 - mixing_fraction), x_[k]);
-              axpy(x, c[kk] * mixing_fraction, x_extrap_[k]);
+              a.push_back(c[kk] * (1.0 - mixing_fraction));
+              xs.push_back(&x_[k]);
+              a.push_back(c[kk] * mixing_fraction);
+              xs.push_back(&x_extrap_[k]);
             }
           }
+          zero(x);
+          axpy(x, a, xs);
 
         } // do DIIS
 
@@ -244,10 +256,16 @@ namespace TiledArray {
         errors_.push_back(error);
         const unsigned int nvec = errors_.size();
 
-        // and compute the most recent elements of B, B(i,j) = <ei|ej>
+        // and compute the most recent elements of B, B(i,j) = <ei|ej>, with
+        // a single pass over the most recent error
+        std::vector<const D*> errors;
+        errors.reserve(nvec);
+        for (const D& e : errors_)
+          errors.push_back(&e);
+        const std::vector<value_type> B_row = dot_products(errors, errors_.back());
         for (unsigned int i=0; i < nvec-1; i++)
-          B_(i,nvec-1) = B_(nvec-1,i) = dot_product(errors_[i], errors_[nvec-1]);
-        B_(nvec-1,nvec-1) = dot_product(errors_[nvec-1], errors_[nvec-1]);
+          B_(i,nvec-1) = B_(nvec-1,i) = B_row[i];
+        B_(nvec-1,nvec-1) = B_row[nvec-1];
 
         // compute extrapolation coefficients C_ and number of skipped vectors nskip_
         if (iter > start && (((iter - start) % ngroup) < ngroupdiis)) { // not the first iteration and need to extrapolate?
@@ -27,9 +27,12 @@
 #define TILEDARRAY_ALGEBRA_UTILS_H__INCLUDED
 
 #include <sstream>
+#include <vector>
 
 #include "../dist_array.h"
+#include "../tensor/type_traits.h"
 #include "../expressions/expr.h"
+#include "../reduce_task.h"
 
 namespace TiledArray {
 
@@ -43,6 +46,83 @@ namespace TiledArray {
       return oss.str();
     }
 
+    /// Element-wise sum of vectors, where an empty vector is zero
+    template <typename T>
+    struct VectorSumReduction {
+      typedef std::vector<T> result_type;
+      typedef std::vector<T> argument_type;
+
+      result_type operator()() const { return result_type(); }
+
+      const result_type& operator()(const result_type& result) const { return result; }
+
+      void operator()(result_type& result, const argument_type& arg) const {
+        if(result.empty()) {
+          result = arg;
+        } else {
+          TA_ASSERT(arg.empty() || (arg.size() == result.size()));
+          for(std::size_t i = 0ul; i < arg.size(); ++i)
+            result[i] += arg[i];
+        }
+      }
+    }; // struct VectorSumReduction
+
+    /// Dot products of one tile of several arrays with a tile of another array
+
+    /// \param n The number of arrays
+    /// \param ordinals The ordinals of the arrays in \c x
+    /// \param x The tiles of the arrays with non-zero tiles
+    /// \param y The other tile
+    /// \return The dot products of the tiles, which are zero for arrays that
+    /// are not in \c ordinals
+    template <typename T, typename Tile>
+    std::vector<T> tile_dot_products(const std::size_t n,
+        const std::vector<std::size_t>& ordinals,
+        const std::vector<Future<Tile> >& x, const Tile& y)
+    {
+      using TiledArray::dot;
+      std::vector<T> result(n, T(0));
+      for(std::size_t i = 0ul; i < ordinals.size(); ++i)
+        result[ordinals[i]] = dot(x[i].get(), y);
+      return result;
+    }
+
+    /// Tiles that are linearly combined element by element by \c tile_axpy()
+
+    /// \c tile_axpy() accesses the elements of the tiles directly, so it is
+    /// only used for tensors of numbers with contiguous data; other tiles,
+    /// including lazy tiles and tensors of tensors, are combined with
+    /// expressions.
+    template <typename Tile>
+    struct is_axpy_tile : public std::integral_constant<bool,
+        is_tensor<Tile>::value && is_contiguous_tensor<Tile>::value> { };
+
+    /// Linear combination of tiles
+
+    /// \tparam Tile A tile type for which \c is_axpy_tile is \c true
+    /// \param y The tile that is added to
+    /// \param a The factors
+    /// \param x The tiles that are added to \c y
+    /// \return <tt> y + sum_k a[k] x[k] </tt>
+    template <typename T, typename Tile>
+    Tile tile_axpy(const Tile& y, const std::vector<T>& a,
+        const std::vector<Future<Tile> >& x)
+    {
+      static_assert(is_axpy_tile<Tile>::value,
+          "tile_axpy() requires a tensor with contiguous data");
+      using TiledArray::clone;
+      Tile result = clone(y);
+      auto* MADNESS_RESTRICT const result_data = result.data();
+      const std::size_t size = result.size();
+      for(std::size_t k = 0ul; k < x.size(); ++k) {
+        const auto* MADNESS_RESTRICT const x_data = x[k].get().data();
+        const T a_k = a[k];
+        for(std::size_t i = 0ul; i < size; ++i)
+          result_data[i] += a_k * x_data[i];
+      }
+      return result;
+    }
+
   } // namespace detail
 
   template <typename Tile, typename Policy>
@@ -119,6 +199,144 @@ namespace TiledArray {
     y(vars) = y(vars) + a * x(vars);
   }
 
+  /// Dot products of several vectors with one vector
+
+  /// This generic version calls \c dot_product for each vector.
+  /// \param x The vectors
+  /// \param y The other vector
+  /// \return <tt> {dot_product(*x[0], y), dot_product(*x[1], y), ...} </tt>
+  template <typename D>
+  inline std::vector<typename D::element_type>
+  dot_products(const std::vector<const D*>& x, const D& y) {
+    std::vector<typename D::element_type> result;
+    result.reserve(x.size());
+    for(const D* x_k : x)
+      result.push_back(dot_product(*x_k, y));
+    return result;
+  }
+
+  /// Dot products of several arrays with one array
+
+  /// The dot products are computed in a single pass over the local tiles of
+  /// \c y and combined with a single all-reduce.
+  /// \param x The arrays, which must have the same tiling as \c y
+  /// \param y The other array
+  /// \return <tt> {dot_product(*x[0], y), dot_product(*x[1], y), ...} </tt>
+  template <typename Tile, typename Policy>
+  inline std::vector<typename DistArray<Tile,Policy>::element_type>
+  dot_products(const std::vector<const DistArray<Tile,Policy>*>& x,
+               const DistArray<Tile,Policy>& y) {
+    typedef typename DistArray<Tile,Policy>::element_type element_type;
+    typedef detail::VectorSumReduction<element_type> reduction_type;
+    typedef madness::TaggedKey<madness::uniqueidT, reduction_type> key_type;
+
+    World& world = y.world();
+    std::vector<element_type> result = detail::all_reduce_args(world,
+        key_type(world.unique_obj_id()), reduction_type(),
+        [&] (auto& reduce_task) {
+      for(auto index : * y.pmap()) {
+        if(y.is_zero(index))
+          continue;
+
+        std::vector<std::size_t> ordinals;
+        std::vector<Future<Tile> > x_tiles;
+        for(std::size_t k = 0ul; k < x.size(); ++k) {
+          if(! x[k]->is_zero(index)) {
+            ordinals.push_back(k);
+            x_tiles.push_back(x[k]->find(index));
+          }
+        }
+        if(ordinals.empty())
+          continue;
+
+        reduce_task.add(world.taskq.add(
+            & detail::tile_dot_products<element_type, Tile>, x.size(), ordinals,
+            x_tiles, y.find(index)));
+      }
+    }).get();
+
+    // The result is empty if all tiles are zero
+    result.resize(x.size(), element_type(0));
+    return result;
+  }
+
+  /// Add a linear combination of vectors to a vector
+
+  /// This generic version calls \c axpy for each vector.
+  /// \param y The vector that is added to
+  /// \param a The factors
+  /// \param x The vectors
+  template <typename D>
+  inline void axpy(D& y, const std::vector<typename D::element_type>& a,
+                   const std::vector<const D*>& x) {
+    TA_ASSERT(a.size() == x.size());
+    for(std::size_t k = 0ul; k < x.size(); ++k)
+      axpy(y, a[k], *x[k]);
+  }
+
+  namespace detail {
+
+    /// Add a linear combination of arrays to an array, one array at a time
+    template <typename Tile, typename Policy>
+    inline void axpy(DistArray<Tile,Policy>& y,
+                     const std::vector<typename DistArray<Tile,Policy>::element_type>& a,
+                     const std::vector<const DistArray<Tile,Policy>*>& x,
+                     std::false_type)
+    {
+      for(std::size_t k = 0ul; k < x.size(); ++k)
+        TiledArray::axpy(y, a[k], *x[k]);
+    }
+
+    /// Add a linear combination of arrays to an array in a single pass
+
+    /// \c y and the arrays in \c x must be dense.
+    template <typename Tile, typename Policy>
+    inline void axpy(DistArray<Tile,Policy>& y,
+                     const std::vector<typename DistArray<Tile,Policy>::element_type>& a,
+                     const std::vector<const DistArray<Tile,Policy>*>& x,
+                     std::true_type)
+    {
+      World& world = y.world();
+      DistArray<Tile,Policy> result(world, y.trange(), y.shape(), y.pmap());
+      for(auto index : * y.pmap()) {
+        std::vector<Future<Tile> > x_tiles;
+        x_tiles.reserve(x.size());
+        for(const DistArray<Tile,Policy>* x_k : x)
+          x_tiles.push_back(x_k->find(index));
+
+        result.set(index, world.taskq.add(
+            & tile_axpy<typename DistArray<Tile,Policy>::element_type, Tile>,
+            y.find(index), a, x_tiles));
+      }
+
+      y = result;
+    }
+
+  } // namespace detail
+
+  /// Add a linear combination of arrays to an array
+
+  /// When all arrays are dense and their tiles are tensors with contiguous
+  /// data (see \c detail::is_axpy_tile ), <tt> y + sum_k a[k] x[k] </tt> is
+  /// computed in a single pass over the tiles of \c y ; otherwise, this calls
+  /// \c axpy for each array.
+  /// \param y The array that is added to
+  /// \param a The factors
+  /// \param x The arrays, which must have the same tiling as \c y
+  template <typename Tile, typename Policy>
+  inline void axpy(DistArray<Tile,Policy>& y,
+                   const std::vector<typename DistArray<Tile,Policy>::element_type>& a,
+                   const std::vector<const DistArray<Tile,Policy>*>& x) {
+    TA_ASSERT(a.size() == x.size());
+    bool dense = y.is_dense();
+    for(const DistArray<Tile,Policy>* x_k : x)
+      dense = dense && x_k->is_dense();
+    if(dense)
+      detail::axpy(y, a, x, detail::is_axpy_tile<Tile>());
+    else
+      detail::axpy(y, a, x, std::false_type());
+  }
+
   template <typename Tile, typename Policy>
   inline void assign(DistArray<Tile,Policy>& m1,
                      const DistArray<Tile,Policy>& m2) {
@@ -34,6 +34,8 @@ namespace TiledArray {
     template class ArrayImpl<Tensor<long, Eigen::aligned_allocator<long> >, DensePolicy>;
 //    template class ArrayImpl<Tensor<std::complex<double>, Eigen::aligned_allocator<std::complex<double> > >, DensePolicy>;
 //    template class ArrayImpl<Tensor<std::complex<float>, Eigen::aligned_allocator<std::complex<float> > >, DensePolicy>
+    template class ArrayImpl<Tensor<double, PoolAllocator<double> >, DensePolicy>;
+    template class ArrayImpl<Tensor<float, PoolAllocator<float> >, DensePolicy>;
 
     template class ArrayImpl<Tensor<double, Eigen::aligned_allocator<double> >, SparsePolicy>;
     template class ArrayImpl<Tensor<float, Eigen::aligned_allocator<float> >, SparsePolicy>;
@@ -41,6 +43,8 @@ namespace TiledArray {
     template class ArrayImpl<Tensor<long, Eigen::aligned_allocator<long> >, SparsePolicy>;
 //    template class ArrayImpl<Tensor<std::complex<double>, Eigen::aligned_allocator<std::complex<double> > >, SparsePolicy>;
 //    template class ArrayImpl<Tensor<std::complex<float>, Eigen::aligned_allocator<std::complex<float> > >, SparsePolicy>;
+    template class ArrayImpl<Tensor<double, PoolAllocator<double> >, SparsePolicy>;
+    template class ArrayImpl<Tensor<float, PoolAllocator<float> >, SparsePolicy>;
 
   }  // namespace detail
 } // namespace TiledArray
@@ -30,6 +30,7 @@
 #include <TiledArray/distributed_storage.h>
 #include <TiledArray/transform_iterator.h>
 #include <TiledArray/type_traits.h>
+#include <TiledArray/pool_allocator.h>
 
 namespace TiledArray {
   namespace detail {
@@ -569,6 +570,10 @@ namespace TiledArray {
 //    class ArrayImpl<Tensor<std::complex<double>, Eigen::aligned_allocator<std::complex<double> > >, DensePolicy>;
 //    extern template
 //    class ArrayImpl<Tensor<std::complex<float>, Eigen::aligned_allocator<std::complex<float> > >, DensePolicy>;
+    extern template
+    class ArrayImpl<Tensor<double, PoolAllocator<double> >, DensePolicy>;
+    extern template
+    class ArrayImpl<Tensor<float, PoolAllocator<float> >, DensePolicy>;
 
     extern template
     class ArrayImpl<Tensor<double, Eigen::aligned_allocator<double> >, SparsePolicy>;
@@ -582,6 +587,10 @@ namespace TiledArray {
 //    class ArrayImpl<Tensor<std::complex<double>, Eigen::aligned_allocator<std::complex<double> > >, SparsePolicy>;
 //    extern template
 //    class ArrayImpl<Tensor<std::complex<float>, Eigen::aligned_allocator<std::complex<float> > >, SparsePolicy>;
+    extern template
+    class ArrayImpl<Tensor<double, PoolAllocator<double> >, SparsePolicy>;
+    extern template
+    class ArrayImpl<Tensor<float, PoolAllocator<float> >, SparsePolicy>;
 
 #endif // TILEDARRAY_HEADER_ONLY
 
@@ -53,10 +53,9 @@ namespace TiledArray {
           [](const size_type l, const size_type r) { return l <= r; }));
 
       // Initialize the block range data members
-      data_ = new size_type[range.rank() << 2];
+      Range::alloc(range.rank());
       offset_ = range.offset();
       volume_ = 1ul;
-      rank_ = range.rank();
       block_offset_ = 0ul;
 
       // Construct temp pointers
@@ -183,6 +183,16 @@ namespace TiledArray {
     static DenseShape gemm(const DenseShape&, const Scalar, const math::GemmHelper&, const Permutation&)
     { return DenseShape(); }
 
+    template <typename Scalar>
+    static DenseShape hadamard_gemm(const DenseShape&, const Scalar,
+        const math::GemmHelper&, const unsigned int)
+    { return DenseShape(); }
+
+    template <typename Scalar>
+    static DenseShape hadamard_gemm(const DenseShape&, const Scalar,
+        const math::GemmHelper&, const unsigned int, const Permutation&)
+    { return DenseShape(); }
+
   }; // class DenseShape
 
   constexpr inline bool operator==(const DenseShape& a, const DenseShape& b) { return true; }
@@ -37,6 +37,8 @@ namespace TiledArray {
   template class DistArray<Tensor<long, Eigen::aligned_allocator<long> >, DensePolicy>;
 //  template class DistArray<Tensor<std::complex<double>, Eigen::aligned_allocator<std::complex<double> > >, DensePolicy>;
 //  template class DistArray<Tensor<std::complex<float>, Eigen::aligned_allocator<std::complex<float> > >, DensePolicy>;
+  template class DistArray<Tensor<double, PoolAllocator<double> >, DensePolicy>;
+  template class DistArray<Tensor<float, PoolAllocator<float> >, DensePolicy>;
 
   template class DistArray<Tensor<double, Eigen::aligned_allocator<double> >, SparsePolicy>;
   template class DistArray<Tensor<float, Eigen::aligned_allocator<float> >, SparsePolicy>;
@@ -44,6 +46,8 @@ namespace TiledArray {
   template class DistArray<Tensor<long, Eigen::aligned_allocator<long> >, SparsePolicy>;
 //  template class DistArray<Tensor<std::complex<double>, Eigen::aligned_allocator<std::complex<double> > >, SparsePolicy>;
 //  template class DistArray<Tensor<std::complex<float>, Eigen::aligned_allocator<std::complex<float> > >, SparsePolicy>;
+  template class DistArray<Tensor<double, PoolAllocator<double> >, SparsePolicy>;
+  template class DistArray<Tensor<float, PoolAllocator<float> >, SparsePolicy>;
 
 
 } // namespace TiledArray
@@ -747,8 +747,8 @@ namespace TiledArray {
         auto pmap = std::make_shared<detail::ReplicatedPmap>(world(), size());
         DistArray_ result = DistArray_(world(), trange(), shape(), pmap);
 
-        // Create the replicator object that will do an all-to-all broadcast of
-        // the local tile data.
+        // Create the replicator object that will broadcast each tile from its
+        // owner with a tree. The replicated tiles can be used as they arrive.
         auto replicator =
             std::make_shared<detail::Replicator<DistArray_>>(*this, result);
 
@@ -823,6 +823,10 @@ namespace TiledArray {
 //  class DistArray<Tensor<std::complex<double>, Eigen::aligned_allocator<std::complex<double> > >, DensePolicy>;
 //  extern template
 //  class DistArray<Tensor<std::complex<float>, Eigen::aligned_allocator<std::complex<float> > >, DensePolicy>
+  extern template
+  class DistArray<Tensor<double, PoolAllocator<double> >, DensePolicy>;
+  extern template
+  class DistArray<Tensor<float, PoolAllocator<float> >, DensePolicy>;
 
   extern template
   class DistArray<Tensor<double, Eigen::aligned_allocator<double> >, SparsePolicy>;
@@ -836,6 +840,10 @@ namespace TiledArray {
 //  class DistArray<Tensor<std::complex<double>, Eigen::aligned_allocator<std::complex<double> > >, SparsePolicy>;
 //  extern template
 //  class DistArray<Tensor<std::complex<float>, Eigen::aligned_allocator<std::complex<float> > >, SparsePolicy>;
+  extern template
+  class DistArray<Tensor<double, PoolAllocator<double> >, SparsePolicy>;
+  extern template
+  class DistArray<Tensor<float, PoolAllocator<float> >, SparsePolicy>;
 
 #endif // TILEDARRAY_HEADER_ONLY
 
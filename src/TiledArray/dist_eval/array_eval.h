@@ -27,7 +27,9 @@
 #define TILEDARRAY_DIST_EVAL_ARRAY_EVAL_H__INCLUDED
 
 #include <TiledArray/dist_eval/dist_eval.h>
+#include <TiledArray/dist_eval/bulk_fetch.h>
 #include <TiledArray/block_range.h>
+#include <unordered_map>
 
 namespace TiledArray {
   namespace detail {
@@ -133,7 +135,11 @@ namespace TiledArray {
     /// \c TiledArray::Array objects and internal evaluation of expressions. The
     /// main purpose of this evaluator is to do a lazy evaluation of input tiles
     /// so that the resulting data is only evaluated when the tile is needed by
-    /// subsequent operations.
+    /// subsequent operations. When the tiles are distributed with a process
+    /// map other than the array's own, the remote tiles are fetched in bulk
+    /// with a \c BulkFetch object (see \c bulk_fetch() ). When a fetch
+    /// window is given with \c set_tile_order() , at most that many remote
+    /// tiles are requested ahead of the tiles that have been taken.
     /// \tparam Policy The evaluator policy type
     template <typename Array, typename Op, typename Policy>
     class ArrayEvalImpl :
@@ -152,6 +158,7 @@ namespace TiledArray {
       typedef typename DistEvalImpl_::trange_type trange_type; ///< tiled range type
       typedef typename DistEvalImpl_::value_type value_type; ///< value type = LazyArrayTile
       typedef Op op_type; ///< Tile evaluation operator type
+      typedef BulkFetch<array_type> fetch_type; ///< Bulk tile fetch type
 
       using std::enable_shared_from_this<ArrayEvalImpl<Array, Op, Policy> >::shared_from_this;
 
@@ -159,6 +166,29 @@ namespace TiledArray {
       array_type array_; ///< The array that will be evaluated
       std::shared_ptr<op_type> op_; ///< The tile operation
       BlockRange block_range_; ///< Sub-block range
+      bool consume_; ///< If \c true , local array tiles may be consumed
+      std::shared_ptr<fetch_type> fetch_; ///< Bulk fetch of remote tiles
+      std::vector<size_type> tile_order_; ///< The order in which local tiles are needed
+      size_type fetch_window_; ///< The maximum number of outstanding fetches, or 0 for no limit
+      std::vector<size_type> fetch_queue_; ///< Remote tiles, in the order they are needed
+      mutable std::unordered_map<size_type, size_type> fetch_position_;
+          ///< The position of each remote tile that has not been taken in \c fetch_queue_
+      mutable size_type fetch_next_; ///< The next tile of \c fetch_queue_ that will be requested
+      mutable size_type fetch_pending_; ///< The number of requested tiles that have not been taken
+      mutable madness::Spinlock fetch_lock_; ///< Lock for the fetch queue
+
+      /// Bulk fetch factory function
+
+      /// \param array The array that will be evaluated
+      /// \param pmap The process map for the result tensor tiles
+      /// \return A bulk fetch object for \c array , or a null pointer if
+      /// the tiles of \c array are not redistributed
+      static std::shared_ptr<fetch_type>
+      make_fetch(const array_type& array, const std::shared_ptr<pmap_interface>& pmap) {
+        if(bulk_fetch() && (array.world().size() > 1) && (pmap != array.pmap()))
+          return std::make_shared<fetch_type>(array);
+        return std::shared_ptr<fetch_type>();
+      }
 
     public:
 
@@ -171,11 +201,18 @@ namespace TiledArray {
       /// \param pmap The process map for the result tensor tiles
       /// \param perm The permutation that is applied to the tile coordinate index
       /// \param op The operation that will be used to evaluate the tiles of array
+      /// \param consume If \c true , the local tiles of \c array are not used
+      /// elsewhere and may be consumed by \c op ; it is ignored when the
+      /// tiles are replicated by \c pmap
       ArrayEvalImpl(const array_type& array, World& world, const trange_type& trange,
           const shape_type& shape, const std::shared_ptr<pmap_interface>& pmap,
-          const Permutation& perm, const op_type& op) :
+          const Permutation& perm, const op_type& op, const bool consume = false) :
         DistEvalImpl_(world, trange, shape, pmap, perm),
-        array_(array), op_(std::make_shared<op_type>(op)), block_range_()
+        array_(array), op_(std::make_shared<op_type>(op)), block_range_(),
+        consume_(consume && ! pmap->is_replicated()),
+        fetch_(make_fetch(array, pmap)), tile_order_(), fetch_window_(0ul),
+        fetch_queue_(), fetch_position_(), fetch_next_(0ul), fetch_pending_(0ul),
+        fetch_lock_()
       { }
 
       /// Constructor with sub-block range
@@ -196,11 +233,19 @@ namespace TiledArray {
           const std::vector<std::size_t>& upper_bound) :
         DistEvalImpl_(world, trange, shape, pmap, perm),
         array_(array), op_(std::make_shared<op_type>(op)),
-        block_range_(array.trange().tiles_range(), lower_bound, upper_bound)
+        block_range_(array.trange().tiles_range(), lower_bound, upper_bound),
+        consume_(false), fetch_(make_fetch(array, pmap)), tile_order_(),
+        fetch_window_(0ul), fetch_queue_(), fetch_position_(), fetch_next_(0ul),
+        fetch_pending_(0ul), fetch_lock_()
       { }
 
       /// Virtual destructor
-      virtual ~ArrayEvalImpl() { }
+      virtual ~ArrayEvalImpl() {
+        // Other processes may still request tiles from the bulk fetch object,
+        // so it is deleted at the end of the next fence.
+        if(fetch_)
+          madness::detail::deferred_cleanup(TensorImpl_::world(), fetch_);
+      }
 
       virtual Future<value_type> get_tile(size_type i) const {
 
@@ -213,10 +258,16 @@ namespace TiledArray {
           array_index = block_range_.ordinal(array_index);
 
         // Get the tile from array_, which may be located on a remote node.
-        Future<typename array_type::value_type> tile =
-            array_.find(array_index);
+        const bool remote_tile = ! array_.is_local(array_index);
+        const bool consumable_tile = consume_ || remote_tile;
+        Future<typename array_type::value_type> tile;
+        if(fetch_ && remote_tile) {
+          take_fetched_tile(array_index);
+          tile = fetch_->get(array_index);
+        } else {
+          tile = array_.find(array_index);
+        }
 
-        const bool consumable_tile = ! array_.is_local(array_index);
         // Insert the tile into this evaluator for subsequent processing
         if(tile.probe()) {
           // Skip the task since the tile is ready
@@ -240,10 +291,35 @@ namespace TiledArray {
 
       /// This function handles the cleanup for tiles that are not needed in
       /// subsequent computation.
-      virtual void discard_tile(size_type) const {
+      virtual void discard_tile(size_type i) const {
+        // Release the fetched tile
+        if(fetch_) {
+          size_type array_index = DistEvalImpl_::perm_index_to_source(i);
+          if(block_range_.rank())
+            array_index = block_range_.ordinal(array_index);
+          if(! array_.is_local(array_index)) {
+            take_fetched_tile(array_index);
+            fetch_->discard(array_index);
+          }
+        }
+
         const_cast<ArrayEvalImpl_*>(this)->notify();
       }
 
+      /// Set the order in which local tiles will be requested
+
+      /// Remote tiles are fetched in this order, followed by any local tiles
+      /// that are not listed.
+      /// \param order The local tile indices in the order they are needed
+      /// \param window The maximum number of remote tiles that are fetched
+      /// ahead of the tiles that have been taken, or 0 for no limit
+      virtual void set_tile_order(const std::vector<size_type>& order,
+          const size_type window)
+      {
+        tile_order_ = order;
+        fetch_window_ = window;
+      }
+
     private:
 
       value_type make_tile(const typename array_type::value_type& tile, const bool consume) const {
@@ -258,6 +334,86 @@ namespace TiledArray {
         DistEvalImpl_::set_tile(i, value_type(tile, op_, consume));
       }
 
+      /// Request the next tiles of the fetch queue
+
+      /// When the fetch window is full, no tiles are requested until half of
+      /// the window has been taken, so that the tiles are still requested in
+      /// batches. The caller must hold \c fetch_lock_ .
+      void fetch_next_tiles() const {
+        if(fetch_window_ && ((fetch_pending_ << 1) > fetch_window_))
+          return;
+
+        std::vector<size_type> indices;
+        while((fetch_next_ < fetch_queue_.size()) &&
+            ((! fetch_window_) || (fetch_pending_ < fetch_window_)))
+        {
+          // Skip tiles that were taken before they were requested
+          const size_type index = fetch_queue_[fetch_next_++];
+          if(fetch_position_.count(index)) {
+            indices.push_back(index);
+            ++fetch_pending_;
+          }
+        }
+
+        if(! indices.empty())
+          fetch_->fetch(indices);
+      }
+
+      /// Remove a remote tile from the fetch queue
+
+      /// Tiles that have not been requested yet are fetched separately by
+      /// \c fetch_ , so they are skipped by \c fetch_next_tiles() .
+      /// \param index The array index of a remote tile
+      void take_fetched_tile(const size_type index) const {
+        madness::ScopedMutex<madness::Spinlock> locker(&fetch_lock_);
+        const auto it = fetch_position_.find(index);
+        if(it == fetch_position_.end())
+          return;
+
+        if(it->second < fetch_next_)
+          --fetch_pending_;
+        fetch_position_.erase(it);
+        fetch_next_tiles();
+      }
+
+      /// Request the remote, non-zero local tiles with \c fetch_
+
+      /// The tiles are queued in the order given by \c tile_order_ ,
+      /// followed by the remaining local tiles in process map order, and the
+      /// first window of the queue is requested.
+      void fetch_remote_tiles() {
+        const std::shared_ptr<pmap_interface>& pmap = TensorImpl_::pmap();
+        std::vector<bool> listed(TensorImpl_::size(), false);
+        std::vector<size_type> indices;
+        indices.reserve(pmap->local_size());
+
+        auto add_tile = [&] (const size_type i) {
+          if(listed[i] || (! pmap->is_local(i)) || TensorImpl_::is_zero(i))
+            return;
+          listed[i] = true;
+
+          size_type array_index = DistEvalImpl_::perm_index_to_source(i);
+          if(block_range_.rank())
+            array_index = block_range_.ordinal(array_index);
+          if(! array_.is_local(array_index))
+            indices.push_back(array_index);
+        };
+
+        for(const size_type i : tile_order_)
+          add_tile(i);
+        for(const size_type i : *pmap)
+          add_tile(i);
+
+        tile_order_ = std::vector<size_type>();
+
+        madness::ScopedMutex<madness::Spinlock> locker(&fetch_lock_);
+        fetch_position_.reserve(indices.size());
+        for(size_type p = 0ul; p < indices.size(); ++p)
+          fetch_position_.emplace(indices[p], p);
+        fetch_queue_ = std::move(indices);
+        fetch_next_tiles();
+      }
+
       /// Evaluate the tiles of this tensor
 
       /// This function will evaluate the children of this distributed evaluator
@@ -283,6 +439,9 @@ namespace TiledArray {
           }
         }
 
+        if(fetch_)
+          fetch_remote_tiles();
+
         return task_count;
       }
 
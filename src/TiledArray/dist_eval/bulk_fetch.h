@@ -0,0 +1,304 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TILEDARRAY_DIST_EVAL_BULK_FETCH_H__INCLUDED
+#define TILEDARRAY_DIST_EVAL_BULK_FETCH_H__INCLUDED
+
+#include <TiledArray/madness.h>
+#include <TiledArray/type_traits.h>
+#include <TiledArray/utility.h>
+#include <atomic>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace TiledArray {
+  namespace detail {
+
+    inline std::atomic<bool>& bulk_fetch_flag() {
+      static std::atomic<bool> flag(env_flag("TA_BULK_FETCH", true));
+      return flag;
+    }
+
+    /// Fetch remote argument tiles in bulk (\c TA_BULK_FETCH , default on)
+    inline bool bulk_fetch() {
+      return bulk_fetch_flag().load(std::memory_order_relaxed);
+    }
+
+    /// Enable or disable bulk tile fetches
+
+    /// \param enable The new value of the bulk fetch flag
+    /// \return The previous value of the flag
+    /// \sa bulk_fetch()
+    inline bool set_bulk_fetch(const bool enable) {
+      return bulk_fetch_flag().exchange(enable);
+    }
+
+    /// Aggregated fetch of remote array tiles
+
+    /// This object fetches a set of remote tiles of an array with one
+    /// request message per owner, rather than one message per tile. Each
+    /// owner splits the requested tiles, in the order they were requested,
+    /// into batches of at most \c batch_bytes() bytes and sends each batch
+    /// in a single reply message as soon as all of its tiles are ready. The
+    /// tiles that are needed first should therefore be requested first, so
+    /// that they can be used before the remaining tiles arrive.
+    /// \note This object is derived from \c WorldObject , so it must be
+    /// constructed in the same order on all processes, and it must not be
+    /// destroyed before the owners have sent all requested tiles (e.g. use
+    /// \c madness::detail::deferred_cleanup ).
+    /// \tparam Array The array type
+    template <typename Array>
+    class BulkFetch : public madness::WorldObject<BulkFetch<Array> > {
+    public:
+      typedef BulkFetch<Array> BulkFetch_; ///< This object type
+      typedef madness::WorldObject<BulkFetch_> WorldObject_; ///< Base object type
+      typedef Array array_type; ///< The array type
+      typedef typename array_type::size_type size_type; ///< Tile index type
+      typedef typename array_type::value_type value_type; ///< Tile type
+      typedef Future<value_type> future; ///< Tile future type
+
+    private:
+
+      /// Requested tiles; the flag is set when the tile future has been
+      /// taken by \c get() before the tile arrived
+      typedef madness::ConcurrentHashMap<size_type, std::pair<future, bool> >
+          container_type;
+      typedef typename container_type::accessor accessor; ///< Element accessor type
+
+      array_type array_; ///< The array that owns the tiles
+      const size_type batch_bytes_; ///< The maximum size of a reply batch
+      container_type tiles_; ///< Tiles requested by this process
+
+      // not allowed
+      BulkFetch(const BulkFetch_&);
+      BulkFetch_& operator=(const BulkFetch_&);
+
+      /// A batch of tiles that is sent when all of its tiles are ready
+      class Batch : public madness::CallbackInterface {
+        BulkFetch_* owner_; ///< The object that sends the batch
+        const ProcessID requester_; ///< The process that requested the tiles
+        std::vector<size_type> indices_; ///< The tile indices
+        std::vector<future> tiles_; ///< The tiles
+        madness::AtomicInt count_; ///< The number of tiles that are not ready, plus one
+
+      public:
+
+        Batch(BulkFetch_* owner, const ProcessID requester,
+            std::vector<size_type>&& indices) :
+          owner_(owner), requester_(requester), indices_(std::move(indices)),
+          tiles_(), count_()
+        {
+          count_ = indices_.size() + 1ul;
+          tiles_.reserve(indices_.size());
+          for(const size_type index : indices_)
+            tiles_.push_back(owner_->array_.find(index));
+        }
+
+        virtual ~Batch() { }
+
+        /// Wait for the tiles, and send the batch when they are all ready
+        void start() {
+          for(future& tile : tiles_)
+            tile.register_callback(this);
+          notify();
+        }
+
+        virtual void notify() {
+          if(count_.dec_and_test()) {
+            owner_->send(requester_, indices_, tiles_);
+            delete this;
+          }
+        }
+      }; // class Batch
+
+      /// Send a batch of ready tiles to \c requester
+
+      /// \param requester The process that requested the tiles
+      /// \param indices The tile indices
+      /// \param tiles The tiles
+      void send(const ProcessID requester, const std::vector<size_type>& indices,
+          const std::vector<future>& tiles)
+      {
+        std::vector<value_type> values;
+        values.reserve(tiles.size());
+        for(const future& tile : tiles)
+          values.push_back(tile.get());
+
+        WorldObject_::task(requester, & BulkFetch_::reply_handler, indices,
+            values, madness::TaskAttributes::hipri());
+      }
+
+      /// Split the tiles requested by \c requester into batches
+
+      /// \param requester The process that requested the tiles
+      /// \param indices The requested tiles, in the order they are needed
+      void request_handler(const ProcessID requester,
+          const std::vector<size_type>& indices)
+      {
+        std::vector<size_type> batch;
+        size_type bytes = 0ul;
+        for(const size_type index : indices) {
+          TA_ASSERT(array_.is_local(index));
+          batch.push_back(index);
+          bytes += array_.trange().make_tile_range(index).volume() *
+              sizeof(typename numeric_type<value_type>::type);
+
+          if(bytes >= batch_bytes_) {
+            (new Batch(this, requester, std::move(batch)))->start();
+            batch = std::vector<size_type>();
+            bytes = 0ul;
+          }
+        }
+
+        if(! batch.empty())
+          (new Batch(this, requester, std::move(batch)))->start();
+      }
+
+      /// Take a requested tile
+
+      /// \param index The tile index
+      /// \param[out] tile The future to tile \c index
+      /// \return \c true if tile \c index was requested with \c fetch()
+      bool take(const size_type index, future& tile) {
+        accessor acc;
+        if(! tiles_.find(acc, index))
+          return false;
+
+        TA_ASSERT(! acc->second.second);
+        tile = acc->second.first;
+        if(tile.probe())
+          tiles_.erase(acc);
+        else
+          acc->second.second = true;
+        return true;
+      }
+
+      /// Receive a batch of requested tiles
+
+      /// \param indices The tile indices
+      /// \param values The tiles
+      void reply_handler(const std::vector<size_type>& indices,
+          const std::vector<value_type>& values)
+      {
+        TA_ASSERT(indices.size() == values.size());
+        for(size_type i = 0ul; i < indices.size(); ++i) {
+          // Remove the tile from the container if it has been taken already,
+          // otherwise it is removed when it is taken.
+          future tile;
+          {
+            accessor acc;
+            const bool found = tiles_.find(acc, indices[i]);
+            TA_ASSERT(found);
+            tile = acc->second.first;
+            if(acc->second.second)
+              tiles_.erase(acc);
+          }
+
+          tile.set(values[i]);
+        }
+      }
+
+    public:
+
+      /// Default maximum size of a reply batch, in bytes
+      static constexpr size_type default_batch_bytes = 4194304ul;
+
+      /// Constructor
+
+      /// \param array The array that owns the tiles
+      /// \param batch_bytes The maximum size, in bytes, of the tiles that are
+      /// sent in a single reply; a batch always holds at least one tile
+      BulkFetch(const array_type& array,
+          const size_type batch_bytes = default_batch_bytes) :
+        WorldObject_(array.world()), array_(array), batch_bytes_(batch_bytes),
+        tiles_()
+      {
+        WorldObject_::process_pending();
+      }
+
+      virtual ~BulkFetch() { }
+
+      /// Maximum reply batch size accessor
+
+      /// \return The maximum size, in bytes, of a reply batch
+      size_type batch_bytes() const { return batch_bytes_; }
+
+      /// Request remote tiles
+
+      /// Sends one request to each process that owns some of the tiles. This
+      /// function may be called more than once, but each tile may be
+      /// requested only once.
+      /// \param indices The indices of the tiles, in the order they are
+      /// needed; the tiles must be non-zero and owned by other processes
+      void fetch(const std::vector<size_type>& indices) {
+        World& world = WorldObject_::get_world();
+        std::vector<std::vector<size_type> > requests(world.size());
+
+        // Insert the tile futures before any request is sent, so the replies
+        // always find them
+        for(const size_type index : indices) {
+          TA_ASSERT(! array_.is_local(index));
+          TA_ASSERT(! array_.is_zero(index));
+          const bool inserted =
+              tiles_.insert(std::make_pair(index, std::make_pair(future(), false))).second;
+          TA_ASSERT(inserted);
+          requests[array_.owner(index)].push_back(index);
+        }
+
+        // Send the requests, starting with the next process so that the
+        // requests of all processes are spread over the owners
+        for(ProcessID p = 1; p < world.size(); ++p) {
+          const ProcessID owner = (world.rank() + p) % world.size();
+          if(! requests[owner].empty())
+            WorldObject_::task(owner, & BulkFetch_::request_handler,
+                world.rank(), requests[owner], madness::TaskAttributes::hipri());
+        }
+      }
+
+      /// Get a tile
+
+      /// Tiles that were requested with \c fetch() are removed from this
+      /// object, so each of them may be taken only once; other tiles are
+      /// fetched from \c array .
+      /// \param index The tile index
+      /// \return A future to tile \c index
+      future get(const size_type index) {
+        future tile;
+        if(take(index, tile))
+          return tile;
+        return array_.find(index);
+      }
+
+      /// Discard a tile
+
+      /// Releases a tile that was requested with \c fetch() , but that will
+      /// not be used; other tiles are ignored.
+      /// \param index The tile index
+      void discard(const size_type index) {
+        future tile;
+        take(index, tile);
+      }
+
+    }; // class BulkFetch
+
+  }  // namespace detail
+} // namespace TiledArray
+
+#endif // TILEDARRAY_DIST_EVAL_BULK_FETCH_H__INCLUDED
@@ -24,6 +24,7 @@
 
 #include <TiledArray/config.h>
 #include <TiledArray/dist_eval/dist_eval.h>
+#include <TiledArray/dist_eval/summa_depth_controller.h>
 #include <TiledArray/proc_grid.h>
 #include <TiledArray/reduce_task.h>
 #include <TiledArray/type_traits.h>
@@ -49,6 +50,16 @@ namespace TiledArray {
     /// argument and the column phase of the right-hand argument are equal to
     /// the number of rows and columns, respectively, in the \c ProcGrid object
     /// passed to the constructor.
+    /// \note When the \c ProcGrid object has more than one layer, the
+    /// evaluation uses the 2.5D SUMMA algorithm: the inner dimension is split
+    /// into contiguous slabs, one per layer, and the arguments must be
+    /// distributed with the process maps given by
+    /// \c ProcGrid::make_row_phase_pmap() and
+    /// \c ProcGrid::make_col_phase_pmap() . Each layer evaluates the
+    /// contractions of its slab with SUMMA on its own 2D process grid, which
+    /// reduces the communication volume of the broadcasts by a factor of
+    /// \f$ \sqrt{L} \f$ for \f$ L \f$ layers. The partial result tiles are
+    /// summed on the first layer.
     template <typename Left, typename Right, typename Op, typename Policy>
     class Summa :
         public DistEvalImpl<typename Op::result_type, Policy>,
@@ -70,8 +81,8 @@ namespace TiledArray {
       typedef Op op_type; ///< Tile evaluation operator type
 
     private:
-      static size_type max_memory_; ///< Maximum memory used per node
-      static size_type max_depth_; ///< Maximum number of concurrent SUMMA iterations
+      const size_type max_memory_; ///< Maximum memory used by broadcast tiles per process
+      const size_type max_depth_; ///< Maximum number of concurrent SUMMA iterations
 
       // Arguments and operation
       left_type left_; ///< The left-hand argument
@@ -85,10 +96,15 @@ namespace TiledArray {
       // Dimension information
       const size_type k_; ///< Number of tiles in the inner dimension
       const ProcGrid proc_grid_; ///< Process grid for this contraction
+      const size_type k_begin_; ///< First inner dimension tile of this layer
+      const size_type k_end_; ///< End of the inner dimension tiles of this layer
 
       // Contraction results
       ReducePairTask<op_type>* reduce_tasks_; ///< A pointer to the reduction tasks
 
+      // Pipeline control
+      SummaDepthController depth_controller_; ///< Controls the number of concurrent SUMMA iterations
+
       // Constants used to iterate over columns and rows of left_ and right_, respectively.
       const size_type left_start_local_; ///< The starting point of left column iterator ranges (just add k for specific columns)
       const size_type left_end_; ///< The end of the left column iterator ranges
@@ -118,10 +134,13 @@ namespace TiledArray {
 
     private:
 
-      // Static variable initialization ----------------------------------------
+      // Default parameters ----------------------------------------------------
+
 
+      /// Read the default SUMMA memory limit from the environment
 
-      /// Initialize max_memory_ limit for SUMMA
+      /// \return The memory limit in bytes given by \c TA_SUMMA_MAX_MEMORY, or
+      /// 0 if it is not set.
       static size_type init_max_memory() {
         const char* max_memory = getenv("TA_SUMMA_MAX_MEMORY");
         if(max_memory) {
@@ -157,6 +176,10 @@ namespace TiledArray {
       }
 
 
+      /// Read the default SUMMA depth limit from the environment
+
+      /// \return The depth limit given by \c TA_SUMMA_MAX_DEPTH, or 0 if it is
+      /// not set.
       static size_type init_max_depth() {
         const char* max_depth = getenv("TA_SUMMA_MAX_DEPTH");
         if(max_depth)
@@ -164,6 +187,18 @@ namespace TiledArray {
         return 0ul;
       }
 
+      /// \return The default memory limit for SUMMA broadcast tiles
+      static size_type default_max_memory() {
+        static const size_type max_memory = init_max_memory();
+        return max_memory;
+      }
+
+      /// \return The default maximum number of concurrent SUMMA iterations
+      static size_type default_max_depth() {
+        static const size_type max_depth = init_max_depth();
+        return max_depth;
+      }
+
 
       // Process groups --------------------------------------------------------
 
@@ -584,10 +619,16 @@ namespace TiledArray {
       // Broadcast specialization for left and right arguments -----------------
 
 
+      // The group ranks follow the world rank order, so the root is
+      // translated through the group when the group is sparse or when the
+      // grid is not in rank order (see ProcGrid::has_rank_table()).
+
       ProcessID get_row_group_root(const size_type k, const madness::Group& row_group) const {
         ProcessID group_root = k % proc_grid_.proc_cols();
-        if(! right_.shape().is_dense() && row_group.size() < static_cast<ProcessID>(proc_grid_.proc_cols())) {
-          const ProcessID world_root = proc_grid_.rank_row() * proc_grid_.proc_cols() + group_root;
+        if(proc_grid_.has_rank_table() || (! right_.shape().is_dense() &&
+            row_group.size() < static_cast<ProcessID>(proc_grid_.proc_cols())))
+        {
+          const ProcessID world_root = proc_grid_.map_col(group_root);
           group_root = row_group.rank(world_root);
         }
         return group_root;
@@ -595,8 +636,10 @@ namespace TiledArray {
 
       ProcessID get_col_group_root(const size_type k, const madness::Group& col_group) const {
         ProcessID group_root = k % proc_grid_.proc_rows();
-        if(! left_.shape().is_dense() && col_group.size() < static_cast<ProcessID>(proc_grid_.proc_rows())) {
-          const ProcessID world_root = group_root * proc_grid_.proc_cols() + proc_grid_.rank_col();
+        if(proc_grid_.has_rank_table() || (! left_.shape().is_dense() &&
+            col_group.size() < static_cast<ProcessID>(proc_grid_.proc_rows())))
+        {
+          const ProcessID world_root = proc_grid_.map_row(group_root);
           group_root = col_group.rank(world_root);
         }
         return group_root;
@@ -729,12 +772,12 @@ namespace TiledArray {
       /// non-zero tiles in this processes column.
       /// \param k The first row to search
       /// \return The first row, greater than or equal to \c k with non-zero
-      /// tiles, or \c k_ if none is found.
+      /// tiles, or \c k_end_ if none is found.
       size_type iterate_row(size_type k) const {
         // Iterate over k's until a non-zero tile is found or the end of the
         // matrix is reached.
         size_type end = k * proc_grid_.cols();
-        for(; k < k_; ++k) {
+        for(; k < k_end_; ++k) {
           // Search for non-zero tiles in row k of right
           size_type i = end + proc_grid_.rank_col();
           end += proc_grid_.cols();
@@ -753,11 +796,11 @@ namespace TiledArray {
       /// checks for non-zero tiles in this process's row.
       /// \param k The first column to test for non-zero tiles
       /// \return The first column, greater than or equal to \c k, that contains
-      /// a non-zero tile. If no non-zero tile is not found, return \c k_.
+      /// a non-zero tile. If no non-zero tile is not found, return \c k_end_.
       size_type iterate_col(size_type k) const {
         // Iterate over k's until a non-zero tile is found or the end of the
         // matrix is reached.
-        for(; k < k_; ++k)
+        for(; k < k_end_; ++k)
           // Search row k for non-zero tiles
           for(size_type i = left_start_local_ + k; i < left_end_; i += left_stride_local_)
             if(! left_.shape().is_zero(i))
@@ -935,6 +978,75 @@ namespace TiledArray {
 
       // Finalize functions ----------------------------------------------------
 
+      /// Key of a partial result tile that is sent to the first layer
+
+      /// \param layer The layer that computed the partial result tile
+      /// \param index The permuted index of the result tile
+      /// \return The key used to send the partial result tile
+      madness::DistributedID partial_key(const size_type layer,
+          const size_type index) const
+      {
+        TA_ASSERT(layer > 0ul);
+        return madness::DistributedID(DistEvalImpl_::id(), left_.size() +
+            right_.size() + (layer - 1ul) * TensorImpl_::size() + index);
+      }
+
+      /// Sum two partial result tiles
+
+      /// \param left The partial result of the first layer
+      /// \param right The partial result of another layer
+      /// \return The sum of \c left and \c right
+      value_type reduce_partials(value_type left, const value_type& right) const {
+        using TiledArray::empty;
+        if(empty(right))
+          return left;
+        if(empty(left))
+          return right;
+        op_(left, right);
+        return left;
+      }
+
+      /// Set a result tile
+
+      /// The result of \c reduce_task is stored in the result tile. When the
+      /// process grid has more than one layer, the partial results of all
+      /// layers are summed by the process that holds the tile in the first
+      /// layer. A layer that has no contributions to the tile sends an empty
+      /// tile.
+      /// \param perm_index The permuted index of the result tile
+      /// \param reduce_task The reduction task of the result tile
+      void set_result_tile(const size_type perm_index,
+          ReducePairTask<op_type>& reduce_task)
+      {
+        if(proc_grid_.layers() == 1u) {
+          DistEvalImpl_::set_tile(perm_index, reduce_task.submit());
+          return;
+        }
+
+        Future<value_type> tile = (reduce_task.count() ? reduce_task.submit() :
+            Future<value_type>(value_type()));
+        World& world = TensorImpl_::world();
+
+        if(proc_grid_.layer() == 0u) {
+          // Sum the partial results of the other layers
+          for(size_type layer = 1ul; layer < proc_grid_.layers(); ++layer) {
+            Future<value_type> partial = world.gop.template recv<value_type>(
+                proc_grid_.map_layer(layer), partial_key(layer, perm_index));
+            tile = world.taskq.add(shared_from_this(), & Summa_::reduce_partials,
+                tile, partial, madness::TaskAttributes::hipri());
+          }
+
+          DistEvalImpl_::set_tile(perm_index, tile);
+        } else {
+          // Send the partial result to the first layer
+          world.gop.send(proc_grid_.map_layer(0ul),
+              partial_key(proc_grid_.layer(), perm_index), tile);
+
+          // Record the assignment of a tile
+          tile.register_callback(this);
+        }
+      }
+
       /// Set the result tiles, destroy reduce tasks, and destroy broadcast groups
       void finalize(const DenseShape&) {
         // Initialize iteration variables
@@ -954,8 +1066,8 @@ namespace TiledArray {
 
 
             // Set the result tile
-            DistEvalImpl_::set_tile(DistEvalImpl_::perm_index_to_target(index),
-                reduce_task->submit());
+            set_result_tile(DistEvalImpl_::perm_index_to_target(index),
+                *reduce_task);
 
             // Destroy the reduce task
             reduce_task->~ReducePairTask<op_type>();
@@ -1001,7 +1113,7 @@ namespace TiledArray {
 #endif // TILEDARRAY_ENABLE_SUMMA_TRACE_FINALIZE
 
               // Set the result tile
-              DistEvalImpl_::set_tile(perm_index, reduce_task->submit());
+              set_result_tile(perm_index, *reduce_task);
             }
 
             // Destroy the reduce task
@@ -1026,6 +1138,9 @@ namespace TiledArray {
 
         finalize(TensorImpl_::shape());
 
+        // Export the pipeline depth statistics
+        SummaDepthLog::instance().record(depth_controller_.statistics());
+
 #ifdef TILEDARRAY_ENABLE_SUMMA_TRACE_FINALIZE
         printf("finalize: finish rank=%i\n", TensorImpl_::world().rank());
 #endif // TILEDARRAY_ENABLE_SUMMA_TRACE_FINALIZE
@@ -1051,19 +1166,180 @@ namespace TiledArray {
       }; // class FinalizeTask
 
 
+      /// Set the tile order of the arguments
+
+      /// The local tiles of \c left_ and \c right_ are needed by column and
+      /// row, respectively, in the order of the SUMMA iterations of this
+      /// layer. When the iteration depth or memory is limited, the arguments
+      /// may prefetch only the tiles of as many iterations as can be in
+      /// flight at once (see \c max_depth() ).
+      void set_arg_tile_order() const {
+        const size_type steps = k_end_ - k_begin_;
+        const size_type window_steps = ((max_depth_ || max_memory_) ?
+            max_depth(max_step_bytes()) : 0ul);
+
+        std::vector<size_type> left_order;
+        std::vector<size_type> right_order;
+        for(size_type k = k_begin_; k < k_end_; ++k) {
+          for(size_type index = left_start_local_ + k; index < left_end_;
+              index += left_stride_local_)
+            left_order.push_back(index);
+
+          const size_type right_end = (k + 1ul) * proc_grid_.cols();
+          for(size_type index = k * proc_grid_.cols() + proc_grid_.rank_col();
+              index < right_end; index += right_stride_local_)
+            right_order.push_back(index);
+        }
+
+        left_.set_tile_order(left_order,
+            window_steps * ((left_order.size() + steps - 1ul) / steps));
+        right_.set_tile_order(right_order,
+            window_steps * ((right_order.size() + steps - 1ul) / steps));
+      }
+
+      // Pipeline monitoring ---------------------------------------------------
+
+      /// Compute the memory footprint of the tiles used by a SUMMA step
+
+      /// The footprint is computed from the exact sizes of the non-zero tiles
+      /// in the local part of column \c k of \c left_ and row \c k of
+      /// \c right_, which are held by this process during step \c k.
+      /// \param k The SUMMA iteration (i.e. contraction tile) index
+      /// \return The size, in bytes, of the tiles used by step \c k
+      size_type step_bytes(const size_type k) const {
+        size_type left_volume = 0ul;
+        for(size_type index = left_start_local_ + k; index < left_end_;
+            index += left_stride_local_)
+          if(! left_.shape().is_zero(index))
+            left_volume += left_.trange().make_tile_range(index).volume();
+
+        size_type right_volume = 0ul;
+        const size_type right_end = (k + 1ul) * proc_grid_.cols();
+        for(size_type index = k * proc_grid_.cols() + proc_grid_.rank_col();
+            index < right_end; index += right_stride_local_)
+          if(! right_.shape().is_zero(index))
+            right_volume += right_.trange().make_tile_range(index).volume();
+
+        return left_volume *
+            sizeof(typename numeric_type<typename left_type::eval_type>::type) +
+            right_volume *
+            sizeof(typename numeric_type<typename right_type::eval_type>::type);
+      }
+
+      /// SUMMA step monitor
+
+      /// This object measures the broadcast latency and the tile contraction
+      /// time of a single SUMMA step, and reports them to the depth
+      /// controller. It holds one dependency of the step task that is gated by
+      /// this step, which is released when all contractions of the step are
+      /// complete. The object deletes itself when it is done.
+      class StepMonitor : public madness::CallbackInterface {
+      private:
+
+        /// Callback for the arrival of the broadcast tiles
+        class BcastCallback : public madness::CallbackInterface {
+        private:
+          StepMonitor* const parent_; ///< The owner of this callback
+          madness::AtomicInt count_; ///< Dependency counter
+
+        public:
+          BcastCallback(StepMonitor* const parent) : parent_(parent) {
+            count_ = 1;
+          }
+
+          virtual ~BcastCallback() { }
+
+          /// Register this callback with the tile futures in \c vec
+          template <typename Datum>
+          void register_callbacks(std::vector<Datum>& vec) {
+            for(Datum& datum : vec) {
+              if(! datum.second.probe()) {
+                count_++;
+                datum.second.register_callback(this);
+              }
+            }
+          }
+
+          virtual void notify() {
+            if((--count_) == 0) {
+              parent_->bcast_time_ = madness::wall_time();
+              parent_->notify();
+            }
+          }
+        }; // class BcastCallback
+
+        std::shared_ptr<Summa_> owner_; ///< The owner of this step
+        madness::TaskInterface* const task_; ///< The task gated by this step
+        const size_type bytes_; ///< The size of the step tiles
+        const double start_time_; ///< Start time of the broadcast
+        double bcast_time_; ///< Arrival time of the last broadcast tile
+        madness::AtomicInt count_; ///< Dependency counter
+        BcastCallback bcast_callback_; ///< Broadcast arrival callback
+
+      public:
+
+        /// Constructor
+
+        /// \param owner The owner of the SUMMA step
+        /// \param task The step task that depends on the contractions of this
+        /// step
+        /// \param bytes The size of the step tiles
+        StepMonitor(const std::shared_ptr<Summa_>& owner,
+            madness::TaskInterface* const task, const size_type bytes) :
+          owner_(owner), task_(task), bytes_(bytes),
+          start_time_(madness::wall_time()), bcast_time_(start_time_),
+          bcast_callback_(this)
+        {
+          TA_ASSERT(task_);
+          // One dependency is released by start(), the other by bcast_callback_
+          count_ = 2;
+          if (trace_tasks)
+            task_->inc_debug("StepMonitor");
+          else
+            task_->inc();
+          owner_->depth_controller_.step_started(bytes_);
+        }
+
+        virtual ~StepMonitor() { }
+
+        /// Monitor the arrival of the tiles in \c col and \c row
+        void monitor_bcast(std::vector<col_datum>& col, std::vector<row_datum>& row) {
+          bcast_callback_.register_callbacks(col);
+          bcast_callback_.register_callbacks(row);
+          bcast_callback_.notify();
+        }
+
+        /// Add a tile contraction dependency
+        void inc() { count_++; }
+
+        virtual void notify() {
+          if((--count_) == 0) {
+            const double finish_time = madness::wall_time();
+            owner_->depth_controller_.step_finished(bytes_,
+                bcast_time_ - start_time_, finish_time - bcast_time_);
+            if (trace_tasks)
+              task_->notify_debug("StepMonitor");
+            else
+              task_->notify();
+            delete this;
+          }
+        }
+      }; // class StepMonitor
+
+
       // Contraction functions -------------------------------------------------
 
       /// Schedule local contraction tasks for \c col and \c row tile pairs
 
       /// Schedule tile contractions for each tile pair of \c row and \c col. A
-      /// callback to \c task will be registered with each tile contraction
+      /// callback to \c monitor will be registered with each tile contraction
       /// task.
       /// \param col A column of tiles from the left-hand argument
       /// \param row A row of tiles from the right-hand argument
-      /// \param task The task that depends on tile contraction tasks
+      /// \param monitor The step monitor that depends on tile contraction tasks
       void contract(const DenseShape&, const size_type,
           const std::vector<col_datum>& col, const std::vector<row_datum>& row,
-          madness::TaskInterface* const task)
+          StepMonitor* const monitor)
       {
         // Iterate over the row
         for(size_type i = 0ul; i < col.size(); ++i) {
@@ -1075,11 +1351,11 @@ namespace TiledArray {
             const size_type reduce_task_index = reduce_task_offset + row[j].first;
 
             // Schedule task for contraction pairs
-            if(task)
-              task->inc();
+            if(monitor)
+              monitor->inc();
             const left_future left = col[i].second;
             const right_future right = row[j].second;
-            reduce_tasks_[reduce_task_index].add(left, right, task);
+            reduce_tasks_[reduce_task_index].add(left, right, monitor);
           }
         }
       }
@@ -1087,15 +1363,15 @@ namespace TiledArray {
       /// Schedule local contraction tasks for \c col and \c row tile pairs
 
       /// Schedule tile contractions for each tile pair of \c row and \c col. A
-      /// callback to \c task will be registered with each tile contraction
+      /// callback to \c monitor will be registered with each tile contraction
       /// task.
       /// \param col A column of tiles from the left-hand argument
       /// \param row A row of tiles from the right-hand argument
-      /// \param task The task that depends on tile contraction tasks
+      /// \param monitor The step monitor that depends on tile contraction tasks
       template <typename Shape>
       void contract(const Shape&, const size_type,
           const std::vector<col_datum>& col, const std::vector<row_datum>& row,
-          madness::TaskInterface* const task)
+          StepMonitor* const monitor)
       {
         // Iterate over the row
         for(size_type i = 0ul; i < col.size(); ++i) {
@@ -1111,15 +1387,11 @@ namespace TiledArray {
               continue;
 
             // Schedule task for contraction pairs
-            if(task) {
-              if (trace_tasks)
-                task->inc_debug("destroy(*ReduceObject)");
-              else
-                task->inc();
-            }
+            if(monitor)
+              monitor->inc();
             const left_future left = col[i].second;
             const right_future right = row[j].second;
-            reduce_tasks_[reduce_task_index].add(left, right, task);
+            reduce_tasks_[reduce_task_index].add(left, right, monitor);
           }
         }
       }
@@ -1129,7 +1401,7 @@ namespace TiledArray {
       /// Schedule local contraction tasks for \c col and \c row tile pairs
 
       /// Schedule tile contractions for each tile pair of \c row and \c col. A
-      /// callback to \c task will be registered with each tile contraction
+      /// callback to \c monitor will be registered with each tile contraction
       /// task. This version of contract is used when shape_type is
       /// \c SparseShape. It skips tile contractions that have a negligible
       /// contribution to the result tile.
@@ -1137,12 +1409,13 @@ namespace TiledArray {
       /// \param k The k step for this contraction set
       /// \param col A column of tiles from the left-hand argument
       /// \param row A row of tiles from the right-hand argument
-      /// \param task The task that depends on the tile contraction tasks
+      /// \param monitor The step monitor that depends on the tile contraction
+      /// tasks
       template <typename T>
       typename std::enable_if<std::is_floating_point<T>::value>::type
       contract(const SparseShape<T>&, const size_type k,
           const std::vector<col_datum>& col, const std::vector<row_datum>& row,
-          madness::TaskInterface* const task)
+          StepMonitor* const monitor)
       {
         // Cache row shape data.
         std::vector<typename SparseShape<T>::value_type> row_shape_values;
@@ -1173,17 +1446,17 @@ namespace TiledArray {
             if(! reduce_tasks_[reduce_task_index])
               continue;
 
-            if(task)
-              task->inc();
-            reduce_tasks_[reduce_task_index].add(col[i].second, row[j].second, task);
+            if(monitor)
+              monitor->inc();
+            reduce_tasks_[reduce_task_index].add(col[i].second, row[j].second, monitor);
           }
         }
       }
 #endif // TILEDARRAY_DISABLE_TILE_CONTRACTION_FILTER
 
       void contract(const size_type k, const std::vector<col_datum>& col,
-          const std::vector<row_datum>& row, madness::TaskInterface* const task)
-      { contract(TensorImpl_::shape(), k, col, row, task); }
+          const std::vector<row_datum>& row, StepMonitor* const monitor)
+      { contract(TensorImpl_::shape(), k, col, row, monitor); }
 
 
       // SUMMA step task -------------------------------------------------------
@@ -1274,8 +1547,8 @@ namespace TiledArray {
         void make_next_step_tasks(Derived* task, size_type depth) {
           TA_ASSERT(depth > 0);
           // Set the depth to be no greater than the maximum number steps
-          if(depth > owner_->k_)
-            depth = owner_->k_;
+          if(depth > (owner_->k_end_ - owner_->k_begin_))
+            depth = owner_->k_end_ - owner_->k_begin_;
 
           // Spawn n=depth step tasks
           for(; depth > 0ul; --depth) {
@@ -1294,11 +1567,31 @@ namespace TiledArray {
           printf("step:  start rank=%i k=%lu\n", owner_->world().rank(), k);
 #endif // TILEDARRAY_ENABLE_SUMMA_TRACE_STEP
 
-          if(k < owner_->k_) {
+          if(k < owner_->k_end_) {
             // Initialize next tail task and submit next task
             TA_ASSERT(next_step_task_);
-            next_step_task_->tail_step_task_ =
-                new Derived(static_cast<Derived*>(tail_step_task_), 1);  // <- ndep=1, will control its scheduling by this task
+            Derived* tail_step_task = static_cast<Derived*>(tail_step_task_);
+            // The pipeline is not extended past the end of the inner
+            // dimension; a new step would have nothing to do.
+            const int depth_change =
+                owner_->depth_controller_.adjust(tail_step_task->can_grow());
+            if(depth_change < 0) {
+              // Shrink the pipeline: the next step is gated by the same task
+              // as this step, and it will release the extra dependency.
+              TA_ASSERT(tail_step_task_ != next_step_task_);
+              if (trace_tasks)
+                tail_step_task_->inc_debug("StepTask nth ctor");
+              else
+                tail_step_task_->inc();
+              next_step_task_->tail_step_task_ = tail_step_task_;
+            } else {
+              // Grow the pipeline: insert a step that is not gated by any
+              // previous step.
+              if(depth_change > 0)
+                tail_step_task = new Derived(tail_step_task, 0);
+              next_step_task_->tail_step_task_ =
+                  new Derived(tail_step_task, 1);  // <- ndep=1, will control its scheduling by this task
+            }
             // submit next step task ... even if it's same as tail_step_task_ it is safe to submit
             // because its ndep > 0 (see StepTask::make_next_step_tasks)
             TA_ASSERT(tail_step_task_->ndep() > 0);
@@ -1312,7 +1605,11 @@ namespace TiledArray {
                              madness::TaskAttributes::hipri());
 
             // Submit tasks for the contraction of col and row tiles.
-            owner_->contract(k, col_, row_, tail_step_task_);
+            StepMonitor* const monitor = new StepMonitor(owner_, tail_step_task_,
+                owner_->step_bytes(k));
+            monitor->monitor_bcast(col_, row_);
+            owner_->contract(k, col_, row_, monitor);
+            monitor->notify();
 
             // Notify task dependencies
             TA_ASSERT(tail_step_task_);
@@ -1357,7 +1654,8 @@ namespace TiledArray {
 
       public:
         DenseStepTask(const std::shared_ptr<Summa_>& owner, const size_type depth) :
-          StepTask(owner, owner->k_ + 1ul), k_(0)
+          StepTask(owner, owner->k_end_ - owner->k_begin_ + 1ul),
+          k_(owner->k_begin_)
         {
           StepTask::make_next_step_tasks(this, depth);
           StepTask::spawn_get_row_col_tasks(k_);
@@ -1367,12 +1665,16 @@ namespace TiledArray {
           StepTask(parent, ndep), k_(parent->k_ + 1ul)
         {
           // Spawn tasks to get k-th row and column tiles
-          if(k_ < owner_->k_)
+          if(k_ < owner_->k_end_)
             StepTask::spawn_get_row_col_tasks(k_);
         }
 
         virtual ~DenseStepTask() { }
 
+        /// \return \c true if a step that is not gated by this task may be
+        /// appended to it
+        bool can_grow() const { return (k_ + 1ul) < owner_->k_end_; }
+
         virtual void run(const madness::TaskThreadEnv&) {
           StepTask::template run<DenseStepTask>(k_, owner_->row_group_, owner_->col_group_);
         }
@@ -1396,7 +1698,7 @@ namespace TiledArray {
           k = owner_->iterate_sparse(k + offset);
           k_.set(k);
 
-          if(k < owner_->k_) {
+          if(k < owner_->k_end_) {
             // NOTE: The order of task submissions is dependent on the order in
             // which we want the tasks to complete.
 
@@ -1434,13 +1736,13 @@ namespace TiledArray {
           else
             madness::DependencyInterface::inc();
           world_.taskq.add(this, & SparseStepTask::iterate_task,
-              0ul, 0ul, madness::TaskAttributes::hipri());
+              owner_->k_begin_, 0ul, madness::TaskAttributes::hipri());
         }
 
         SparseStepTask(SparseStepTask* const parent, const int ndep) :
           StepTask(parent, ndep)
         {
-          if(parent->k_.probe() && (parent->k_.get() >= owner_->k_)) {
+          if(parent->k_.probe() && (parent->k_.get() >= owner_->k_end_)) {
             // Avoid running extra tasks if not needed.
             k_.set(parent->k_.get());
             TA_ASSERT(ndep == 1);  // ensure that this does not get executed immediately
@@ -1457,6 +1759,15 @@ namespace TiledArray {
 
         virtual ~SparseStepTask() { }
 
+        /// \return \c true if a step that is not gated by this task may be
+        /// appended to it
+        bool can_grow() const {
+          // Only grow once the iteration of this task is known: if it were
+          // resolved past the end between this check and the construction
+          // of the new step, that step would be submitted without a gate.
+          return k_.probe() && (k_.get() < owner_->k_end_);
+        }
+
         virtual void run(const madness::TaskThreadEnv&) {
           StepTask::template run<SparseStepTask>(k_, row_group_, col_group_);
         }
@@ -1477,18 +1788,27 @@ namespace TiledArray {
       /// \param k The number of tiles in the inner dimension
       /// \param proc_grid The process grid that defines the layout of the tiles
       ///                  during the contraction evaluation
+      /// \param max_memory The maximum memory, in bytes, used by broadcast
+      ///                  tiles on each process; if 0, the limit given by
+      ///                  \c TA_SUMMA_MAX_MEMORY is used
       /// \note The trange, shape, and pmap refer to the final,
       ///       permuted, state for the result, NOT to the result during
       ///       the SUMMA evaluation.
       Summa(const left_type& left, const right_type& right,
           World& world, const trange_type trange, const shape_type& shape,
           const std::shared_ptr<pmap_interface>& pmap, const Permutation& perm,
-          const op_type& op, const size_type k, const ProcGrid& proc_grid) :
+          const op_type& op, const size_type k, const ProcGrid& proc_grid,
+          const size_type max_memory = 0ul) :
         DistEvalImpl_(world, trange, shape, pmap, perm),
+        max_memory_(max_memory ? max_memory : default_max_memory()),
+        max_depth_(default_max_depth()),
         left_(left), right_(right), op_(op),
         row_group_(), col_group_(),
         k_(k), proc_grid_(proc_grid),
+        k_begin_(proc_grid.local_size() ? proc_grid.layer_range(k).first : 0ul),
+        k_end_(proc_grid.local_size() ? proc_grid.layer_range(k).second : 0ul),
         reduce_tasks_(NULL),
+        depth_controller_(),
         left_start_local_(proc_grid_.rank_row() * k),
         left_end_(left.size()),
         left_stride_(k),
@@ -1534,34 +1854,51 @@ namespace TiledArray {
 
     private:
 
+      /// Compute the memory footprint of the largest SUMMA step
+
+      /// \return The maximum of \c step_bytes(k) over all k, or 0 when no
+      /// memory limit is set
+      size_type max_step_bytes() const {
+        size_type result = 0ul;
+        if(max_memory_)
+          for(size_type k = k_begin_; k < k_end_; ++k)
+            result = std::max(result, step_bytes(k));
+        return result;
+      }
+
+      /// Upper bound for the iteration depth
+
+      /// \param max_step_bytes The memory footprint of the largest SUMMA step
+      /// \return The number of inner dimension tiles of this layer, bounded by
+      /// the user defined depth limit and by the number of steps that fit in
+      /// the memory limit
+      size_type max_depth(const size_type max_step_bytes) const {
+        const size_type steps = k_end_ - k_begin_;
+        size_type result = (max_depth_ ? std::min(max_depth_, steps) : steps);
+        if(max_memory_ && max_step_bytes)
+          result = std::min(result, max_memory_ / max_step_bytes);
+        return std::max(result, size_type(1));
+      }
+
       /// Adjust iteration depth based on memory constraints
 
+      /// The memory bounded depth is the number of SUMMA iterations whose
+      /// broadcast tiles fit in \c max_memory_, assuming that every iteration
+      /// needs as much memory as the largest one.
       /// \param depth The unbounded iteration depth
-      /// \param left_sparsity The fraction of zero tiles in the left-hand matrix
-      /// \param right_sparsity The fraction of zero tiles in the right-hand matrix
+      /// \param max_step_bytes The memory footprint of the largest SUMMA step
       /// \return The memory bounded iteration depth
-      /// \thorw TiledArray::Exception When the memory bounded iteration depth
+      /// \throw TiledArray::Exception When the memory bounded iteration depth
       /// is less than 1.
-      size_type mem_bound_depth(size_type depth, const float left_sparsity, const float right_sparsity) {
+      size_type mem_bound_depth(size_type depth, const size_type max_step_bytes) const {
 
         // Check if a memory bound has been set
         const size_type available_memory = max_memory_;
         if(available_memory) {
 
-          // Compute the average memory requirement per iteration of this process
-          const std::size_t local_memory_per_iter_left =
-              (left_.trange().elements_range().volume() / left_.trange().tiles_range().volume()) *
-              sizeof(typename numeric_type<typename left_type::eval_type>::type) *
-              proc_grid_.local_rows() * (1.0f - left_sparsity);
-          const std::size_t local_memory_per_iter_right =
-              (right_.trange().elements_range().volume() / right_.trange().tiles_range().volume()) *
-              sizeof(typename numeric_type<typename right_type::eval_type>::type) *
-              proc_grid_.local_cols() * (1.0f - right_sparsity);
-
           // Compute the maximum number of iterations based on available memory
-          const size_type mem_bound_depth =
-              ((local_memory_per_iter_left + local_memory_per_iter_right) /
-              available_memory);
+          const size_type mem_bound_depth = (max_step_bytes ?
+              available_memory / max_step_bytes : depth);
 
           // Check if the memory bounded depth is less than the optimal depth
           if(depth > mem_bound_depth) {
@@ -1597,6 +1934,11 @@ namespace TiledArray {
         printf("eval: start eval children rank=%i\n", TensorImpl_::world().rank());
 #endif // TILEDARRAY_ENABLE_SUMMA_TRACE_EVAL
 
+        // Tell the child tensors the order in which their tiles are needed,
+        // so that redistributed arguments can fetch them in SUMMA order
+        if(proc_grid_.local_size() > 0ul)
+          set_arg_tile_order();
+
         // Start evaluate child tensors
         left_.eval();
         right_.eval();
@@ -1607,6 +1949,7 @@ namespace TiledArray {
 
         size_type tile_count = 0ul;
         if(proc_grid_.local_size() > 0ul) {
+          TA_ASSERT(k_begin_ < k_end_);
           tile_count = initialize();
 
           // depth controls the number of simultaneous SUMMA iterations
@@ -1617,19 +1960,24 @@ namespace TiledArray {
           size_type depth =
               std::max(ProcGrid::size_type(2), std::min(proc_grid_.proc_rows(), proc_grid_.proc_cols()));
 
+          // The exact memory footprint of the largest iteration, which is used
+          // to enforce the memory limit
+          const size_type max_bytes = max_step_bytes();
+
           // Construct the first SUMMA iteration task
           if(TensorImpl_::shape().is_dense()) {
             // We cannot have more iterations than there are blocks in the k
-            // dimension
-            if(depth > k_) depth = k_;
+            // dimension of this layer
+            if(depth > (k_end_ - k_begin_)) depth = k_end_ - k_begin_;
 
             // Modify the number of concurrent iterations based on the available
             // memory.
-            depth = mem_bound_depth(depth, 0.0f, 0.0f);
+            depth = mem_bound_depth(depth, max_bytes);
 
             // Enforce user defined depth bound
-            if(max_depth_) std::min(depth, max_depth_);
+            if(max_depth_) depth = std::min(depth, max_depth_);
 
+            depth_controller_.initialize(depth, max_depth(max_bytes), max_memory_);
             TensorImpl_::world().taskq.add(new DenseStepTask(shared_from_this(),
                                                              depth));
           } else {
@@ -1647,16 +1995,17 @@ namespace TiledArray {
             depth = float(depth) * (1.0f - 1.35638f * std::log2(frac_non_zero)) + 0.5f;
 
             // We cannot have more iterations than there are blocks in the k
-            // dimension
-            if(depth > k_) depth = k_;
+            // dimension of this layer
+            if(depth > (k_end_ - k_begin_)) depth = k_end_ - k_begin_;
 
             // Modify the number of concurrent iterations based on the available
             // memory and sparsity of the argument tensors.
-            depth = mem_bound_depth(depth, left_sparsity, right_sparsity);
+            depth = mem_bound_depth(depth, max_bytes);
 
             // Enforce user defined depth bound
-            if(max_depth_) std::min(depth, max_depth_);
+            if(max_depth_) depth = std::min(depth, max_depth_);
 
+            depth_controller_.initialize(depth, max_depth(max_bytes), max_memory_);
             TensorImpl_::world().taskq.add(new SparseStepTask(shared_from_this(),
                                                               depth));
           }
@@ -1679,18 +2028,6 @@ namespace TiledArray {
 
     }; // class Summa
 
-
-    // Initialize static member variables for Summa
-
-    template <typename Left, typename Right, typename Op, typename Policy>
-    typename Summa<Left, Right, Op, Policy>::size_type
-    Summa<Left, Right, Op, Policy>::max_depth_ =
-        Summa<Left, Right, Op, Policy>::init_max_depth();
-
-    template <typename Left, typename Right, typename Op, typename Policy>
-    typename Summa<Left, Right, Op, Policy>::size_type
-    Summa<Left, Right, Op, Policy>::max_memory_ =
-        Summa<Left, Right, Op, Policy>::init_max_memory();
   } // namespace detail
 }  // namespace TiledArray
 
@@ -137,6 +137,16 @@ namespace TiledArray {
       /// \param i The index of the tile
       virtual void discard_tile(size_type i) const = 0;
 
+      /// Set the order in which local tiles will be requested
+
+      /// This is a hint, given before \c eval() , that evaluators may use to
+      /// schedule the evaluation or communication of tiles. The default
+      /// implementation ignores it.
+      /// \param order The local tile indices in the order they are needed
+      /// \param window The maximum number of tiles that should be prefetched
+      /// ahead of the tiles that have been requested, or 0 for no limit
+      virtual void set_tile_order(const std::vector<size_type>&, const size_type) { }
+
       /// Set tensor value
 
       /// This will store \c value at ordinal index \c i . Typically, this
@@ -352,6 +362,18 @@ namespace TiledArray {
       /// \param i The index of the tile
       virtual void discard(size_type i) const { pimpl_->discard_tile(i); }
 
+      /// Set the order in which local tiles will be requested
+
+      /// \param order The local tile indices in the order they are needed
+      /// \param window The maximum number of tiles that should be prefetched
+      /// ahead of the tiles that have been requested, or 0 for no limit
+      /// \sa DistEvalImpl::set_tile_order()
+      void set_tile_order(const std::vector<size_type>& order,
+          const size_type window = 0ul) const
+      {
+        pimpl_->set_tile_order(order, window);
+      }
+
       /// World object accessor
 
       /// \return A reference to the world object
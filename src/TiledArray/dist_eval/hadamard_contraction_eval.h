@@ -0,0 +1,349 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TILEDARRAY_DIST_EVAL_HADAMARD_CONTRACTION_EVAL_H__INCLUDED
+#define TILEDARRAY_DIST_EVAL_HADAMARD_CONTRACTION_EVAL_H__INCLUDED
+
+#include <TiledArray/dist_eval/dist_eval.h>
+#include <TiledArray/pmap/hadamard_pmap.h>
+#include <TiledArray/reduce_task.h>
+#include <TiledArray/type_traits.h>
+#include <vector>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// Distributed evaluator of a contraction with Hadamard dimensions
+
+    /// This evaluates contractions whose leading (Hadamard) dimensions are
+    /// shared by the arguments and the result, e.g.
+    /// \f$ C_{hij} = \sum_k A_{hik} B_{hkj} \f$. The tiles of the Hadamard
+    /// dimensions are distributed cyclically (see \c HadamardPmap ): the
+    /// tiles of the arguments and of the result that belong to Hadamard tile
+    /// \f$ h \f$ are held by process \f$ h \bmod P_h \f$, where \f$ P_h \f$
+    /// is the smaller of the number of processes and Hadamard tiles. When
+    /// there are fewer Hadamard tiles than processes, the rows \f$ i \f$ of
+    /// the left-hand argument and of the result of each Hadamard tile are
+    /// also distributed over \f$ S \f$ processes, and the right-hand tiles
+    /// of the Hadamard tile are broadcast to them. Every result tile is the
+    /// sum of the tile contractions over the inner dimension, which are
+    /// evaluated as tasks.
+    /// \tparam Left The left-hand argument evaluator type
+    /// \tparam Right The right-hand argument evaluator type
+    /// \tparam Op The contraction/reduction operation type
+    /// \tparam Policy The tensor policy class
+    /// \note The arguments must be ordered as \f$ (h, i, k) \f$ and
+    /// \f$ (h, k, j) \f$, and distributed with \c make_left_pmap() and
+    /// \c make_right_pmap() .
+    template <typename Left, typename Right, typename Op, typename Policy>
+    class HadamardContraction :
+        public DistEvalImpl<typename Op::result_type, Policy>,
+        public std::enable_shared_from_this<HadamardContraction<Left, Right, Op, Policy> >
+    {
+    public:
+      typedef HadamardContraction<Left, Right, Op, Policy>
+          HadamardContraction_; ///< This object type
+      typedef DistEvalImpl<typename Op::result_type, Policy> DistEvalImpl_; ///< The base class type
+      typedef typename DistEvalImpl_::TensorImpl_ TensorImpl_; ///< The base, base class type
+      typedef Left left_type; ///< The left-hand argument type
+      typedef Right right_type; ///< The right-hand argument type
+      typedef typename DistEvalImpl_::size_type size_type; ///< Size type
+      typedef typename DistEvalImpl_::range_type range_type; ///< Range type
+      typedef typename DistEvalImpl_::shape_type shape_type; ///< Shape type
+      typedef typename DistEvalImpl_::pmap_interface pmap_interface; ///< Process map interface type
+      typedef typename DistEvalImpl_::trange_type trange_type; ///< Tiled range type
+      typedef typename DistEvalImpl_::value_type value_type; ///< Tile type
+      typedef typename DistEvalImpl_::eval_type eval_type; ///< Tile evaluation type
+      typedef Op op_type; ///< Tile evaluation operator type
+
+    private:
+
+      left_type left_; ///< The left-hand argument
+      right_type right_; /// < The right-hand argument
+      op_type op_; /// < The operation used to evaluate tile-tile contractions
+
+      // Dimension information
+      const size_type h_; ///< Number of tiles in the Hadamard dimensions
+      const size_type m_; ///< Number of tiles in the left-hand outer dimensions
+      const size_type n_; ///< Number of tiles in the right-hand outer dimensions
+      const size_type k_; ///< Number of tiles in the inner dimensions
+      const size_type procs_; ///< Number of processes that hold Hadamard tiles
+      const size_type split_; ///< Number of processes per Hadamard tile
+
+      typedef Future<typename left_type::eval_type> left_future; ///< Future to a left-hand argument tile
+      typedef Future<typename right_type::eval_type> right_future; ///< Future to a right-hand argument tile
+
+      /// Tile conversion task function
+
+      /// \tparam Tile The input tile type
+      /// \param tile The input tile
+      /// \return The evaluated version of the lazy tile
+      template <typename Tile>
+      static auto convert_tile(const Tile& tile) {
+        TiledArray::Cast<typename eval_trait<Tile>::type, Tile> cast;
+        return cast(tile);
+      }
+
+      /// Conversion function
+
+      /// This function does nothing since tile is not a lazy tile.
+      /// \tparam Arg The type of the argument that holds the input tiles
+      /// \param arg The argument that holds the tiles
+      /// \param index The tile index of arg
+      /// \return \c tile
+      template <typename Arg>
+      static typename std::enable_if<
+          ! is_lazy_tile<typename Arg::value_type>::value,
+          Future<typename Arg::eval_type> >::type
+      get_tile(Arg& arg, const typename Arg::size_type index) { return arg.get(index); }
+
+      /// Conversion function
+
+      /// This function spawns a task that will convert a lazy tile from the
+      /// tile type to the evaluated tile type.
+      /// \tparam Arg The type of the argument that holds the input tiles
+      /// \param arg The argument that holds the tiles
+      /// \param index The tile index of arg
+      /// \return A future to the evaluated tile
+      template <typename Arg>
+      static typename std::enable_if<
+          is_lazy_tile<typename Arg::value_type>::value,
+          Future<typename Arg::eval_type> >::type
+      get_tile(Arg& arg, const typename Arg::size_type index) {
+        auto convert_tile_fn =
+            &HadamardContraction_::template convert_tile<typename Arg::value_type>;
+        return arg.world().taskq.add(convert_tile_fn, arg.get(index),
+                                     madness::TaskAttributes::hipri());
+      }
+
+      /// Get the right-hand tiles of a Hadamard tile
+
+      /// When a Hadamard tile is split among several processes, the
+      /// right-hand tiles are broadcast from the process that holds them to
+      /// the other processes of the Hadamard tile.
+      /// \param h The Hadamard tile index
+      /// \param[out] right_tiles The non-zero right-hand tiles of \c h
+      void get_right_tiles(const size_type h, std::vector<right_future>& right_tiles) {
+        const size_type right_first = h * k_ * n_;
+        if(split_ == 1ul) {
+          for(size_type i = 0ul; i < right_tiles.size(); ++i)
+            if(! right_.is_zero(right_first + i))
+              right_tiles[i] = get_tile(right_, right_first + i);
+          return;
+        }
+
+        // Construct the group of the processes of Hadamard tile h; the
+        // right-hand tiles are held by the first of them
+        std::vector<ProcessID> proc_list(split_);
+        for(size_type s = 0ul; s < split_; ++s)
+          proc_list[s] = h + s * procs_;
+        const madness::Group group(TensorImpl_::world(), proc_list,
+            madness::DistributedID(DistEvalImpl_::id(), h));
+        const ProcessID group_root = group.rank(proc_list.front());
+
+        // The broadcast keys are offset by the number of result tiles, which
+        // are sent with their own indices as keys
+        const size_type key_offset = TensorImpl_::size();
+        const bool root = (ProcessID(h) == TensorImpl_::world().rank());
+        for(size_type i = 0ul; i < right_tiles.size(); ++i) {
+          if(right_.is_zero(right_first + i))
+            continue;
+
+          if(root)
+            right_tiles[i] = get_tile(right_, right_first + i);
+          const madness::DistributedID key(DistEvalImpl_::id(),
+              key_offset + right_first + i);
+          TensorImpl_::world().gop.bcast(key, right_tiles[i], group_root, group);
+        }
+      }
+
+      /// Contract the tiles of a Hadamard tile
+
+      /// Every non-zero argument tile of Hadamard tile \c h that is needed by
+      /// this process is requested once, and the contraction of each non-zero
+      /// result tile is reduced by a \c ReducePairTask .
+      /// \param h The Hadamard tile index
+      /// \param first_m The first row of \c h that is contracted by this
+      /// process; the rows are contracted with a stride of \c split_
+      /// \return The number of result tiles that are set by this function
+      size_type contract(const size_type h, const size_type first_m) {
+        World& world = TensorImpl_::world();
+
+        // Get the non-zero argument tiles of the Hadamard tile
+        const size_type left_first = h * m_ * k_;
+        std::vector<left_future> left_tiles(m_ * k_);
+        for(size_type m = first_m; m < m_; m += split_)
+          for(size_type i = m * k_; i < ((m + 1ul) * k_); ++i)
+            if(! left_.is_zero(left_first + i))
+              left_tiles[i] = get_tile(left_, left_first + i);
+
+        const size_type right_first = h * k_ * n_;
+        std::vector<right_future> right_tiles(k_ * n_);
+        get_right_tiles(h, right_tiles);
+
+        // Reduce the tile contractions of each non-zero result tile
+        size_type count = 0ul;
+        for(size_type m = first_m; m < m_; m += split_) {
+          for(size_type n = 0ul, index = (h * m_ + m) * n_; n < n_; ++n, ++index) {
+            const size_type perm_index = DistEvalImpl_::perm_index_to_target(index);
+            if(TensorImpl_::is_zero(perm_index))
+              continue;
+
+            ReducePairTask<op_type> reduce_task(world, op_);
+            for(size_type k = 0ul; k < k_; ++k) {
+              const size_type left_index = m * k_ + k;
+              const size_type right_index = k * n_ + n;
+              if(left_.is_zero(left_first + left_index) ||
+                  right_.is_zero(right_first + right_index))
+                continue;
+
+              reduce_task.add(left_tiles[left_index], right_tiles[right_index]);
+            }
+
+            TA_ASSERT(reduce_task.count() > 0ul);
+            DistEvalImpl_::set_tile(perm_index, reduce_task.submit());
+            ++count;
+          }
+        }
+
+        return count;
+      }
+
+    public:
+
+      /// Constructor
+
+      /// \param left The left-hand argument
+      /// \param right The right-hand argument
+      /// \param world The world where the tensor lives
+      /// \param trange The tiled range object
+      /// \param shape The tensor shape object
+      /// \param pmap The tile-process map
+      /// \param perm The permutation that is applied to tile indices
+      /// \param op The tile transform operation
+      /// \param h The number of tiles in the Hadamard dimensions
+      /// \param k The number of tiles in the inner dimensions
+      /// \note The trange, shape, and pmap refer to the final, permuted,
+      /// state for the result.
+      HadamardContraction(const left_type& left, const right_type& right,
+          World& world, const trange_type trange, const shape_type& shape,
+          const std::shared_ptr<pmap_interface>& pmap, const Permutation& perm,
+          const op_type& op, const size_type h, const size_type k) :
+        DistEvalImpl_(world, trange, shape, pmap, perm),
+        left_(left), right_(right), op_(op),
+        h_(h), m_(left.size() / (h * k)), n_(right.size() / (h * k)), k_(k),
+        procs_(std::min<size_type>(h, world.size())),
+        split_(HadamardPmap::split(world.size(), h, m_))
+      {
+        TA_ASSERT(left.size() == (h_ * m_ * k_));
+        TA_ASSERT(right.size() == (h_ * k_ * n_));
+        TA_ASSERT(TensorImpl_::size() == (h_ * m_ * n_));
+      }
+
+      virtual ~HadamardContraction() { }
+
+      /// Left-hand argument and result process map factory
+
+      /// \param world The world where the tensor is distributed
+      /// \param h The number of tiles in the Hadamard dimensions
+      /// \param m The number of tiles in the left-hand outer dimensions
+      /// \param size The number of tiles in the tensor
+      /// \return A process map that assigns the rows of Hadamard tile \c h
+      /// to the processes that contract them (see \c HadamardPmap )
+      static std::shared_ptr<pmap_interface>
+      make_left_pmap(World& world, const size_type h, const size_type m,
+          const size_type size)
+      {
+        TA_ASSERT((size % (h * m)) == 0ul);
+        return std::make_shared<HadamardPmap>(world, h, m, size / (h * m));
+      }
+
+      /// Right-hand argument process map factory
+
+      /// \param world The world where the argument is distributed
+      /// \param h The number of tiles in the Hadamard dimensions
+      /// \param size The number of tiles in the argument
+      /// \return A process map that assigns the argument tiles of Hadamard
+      /// tile \c h to process \f$ h \bmod P_h \f$
+      static std::shared_ptr<pmap_interface>
+      make_right_pmap(World& world, const size_type h, const size_type size) {
+        TA_ASSERT((size % h) == 0ul);
+        return std::make_shared<HadamardPmap>(world, h, 1ul, size / h);
+      }
+
+      /// Get tile at index \c i
+
+      /// \param i The index of the tile
+      /// \return A \c Future to the tile at index i
+      /// \throw TiledArray::Exception When tile \c i is owned by a remote node.
+      /// \throw TiledArray::Exception When tile \c i a zero tile.
+      virtual Future<value_type> get_tile(size_type i) const {
+        TA_ASSERT(TensorImpl_::is_local(i));
+        TA_ASSERT(! TensorImpl_::is_zero(i));
+
+        // Compute the process that contracts the row of tile i
+        const size_type source_row = DistEvalImpl_::perm_index_to_source(i) / n_;
+        const ProcessID source = ((source_row / m_) % procs_) +
+            procs_ * ((source_row % m_) % split_);
+
+        const madness::DistributedID key(DistEvalImpl_::id(), i);
+        return TensorImpl_::world().gop.template recv<value_type>(source, key);
+      }
+
+      /// Discard a tile that is not needed
+
+      /// This function handles the cleanup for tiles that are not needed in
+      /// subsequent computation.
+      /// \param i The index of the tile
+      virtual void discard_tile(size_type i) const { get_tile(i); }
+
+    private:
+
+      /// Evaluate the tiles of this tensor
+
+      /// This function will evaluate the children of this distributed evaluator
+      /// and evaluate the tiles for this distributed evaluator. It will block
+      /// until the tasks for the children are evaluated (not for the tasks of
+      /// this object).
+      /// \return The number of tiles that will be set by this process
+      virtual int internal_eval() {
+        // Start evaluate child tensors
+        left_.eval();
+        right_.eval();
+
+        // Contract the local rows of the local Hadamard tiles
+        size_type tile_count = 0ul;
+        const size_type rank = TensorImpl_::world().rank();
+        if(rank < (procs_ * split_))
+          for(size_type h = rank % procs_; h < h_; h += procs_)
+            tile_count += contract(h, rank / procs_);
+
+        // Wait for child tensors to be evaluated, and process tasks while waiting.
+        left_.wait();
+        right_.wait();
+
+        return tile_count;
+      }
+
+    }; // class HadamardContraction
+
+  } // namespace detail
+} // namespace TiledArray
+
+#endif // TILEDARRAY_DIST_EVAL_HADAMARD_CONTRACTION_EVAL_H__INCLUDED
@@ -0,0 +1,359 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TILEDARRAY_DIST_EVAL_SUMMA_DEPTH_CONTROLLER_H__INCLUDED
+#define TILEDARRAY_DIST_EVAL_SUMMA_DEPTH_CONTROLLER_H__INCLUDED
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <TiledArray/madness.h>
+#include <TiledArray/utility.h>
+
+namespace TiledArray {
+
+  /// SUMMA pipeline depth statistics
+
+  /// When logging is enabled, one instance of this object is recorded, on
+  /// each process, for every SUMMA contraction that is evaluated. See
+  /// \c summa_depth_statistics() and \c set_summa_depth_logging() .
+  struct SummaDepthStatistics {
+    std::size_t initial_depth = 0ul; ///< The depth used for the first step
+    std::size_t min_depth = 0ul; ///< The smallest depth used
+    std::size_t max_depth = 0ul; ///< The largest depth used
+    std::size_t final_depth = 0ul; ///< The depth used for the last step
+    std::size_t steps = 0ul; ///< The number of measured SUMMA steps
+    std::size_t grow_count = 0ul; ///< The number of times the depth was increased
+    std::size_t shrink_count = 0ul; ///< The number of times the depth was decreased
+    double mean_bcast_latency = 0.0; ///< Average broadcast latency per step (s)
+    double mean_gemm_time = 0.0; ///< Average tile contraction time per step (s)
+    std::size_t peak_resident_bytes = 0ul; ///< Peak broadcast memory (bytes)
+  }; // struct SummaDepthStatistics
+
+  namespace detail {
+
+    inline std::atomic<std::size_t>& summa_min_depth_value() {
+      static std::atomic<std::size_t> value([] () {
+        const char* min_depth = getenv("TA_SUMMA_MIN_DEPTH");
+        return std::size_t(min_depth ? std::strtoul(min_depth, nullptr, 10) : 1ul);
+      }());
+      return value;
+    }
+
+  } // namespace detail
+
+  /// Lower bound of the adaptive SUMMA depth
+
+  /// The adaptive depth controller grows the SUMMA pipeline toward this depth,
+  /// even when the measured broadcast latency does not require it. The SUMMA
+  /// memory limit has priority: the depth is reduced below this bound when
+  /// the broadcast data does not fit in the limit. The initial value is given by the environment variable
+  /// \c TA_SUMMA_MIN_DEPTH; the default is 1.
+  /// \return The lower bound of the adaptive SUMMA depth
+  inline std::size_t summa_min_depth() {
+    return detail::summa_min_depth_value().load(std::memory_order_relaxed);
+  }
+
+  /// Set the lower bound of the adaptive SUMMA depth
+
+  /// \param min_depth The new lower bound of the adaptive depth
+  /// \return The previous lower bound
+  /// \sa summa_min_depth()
+  inline std::size_t set_summa_min_depth(const std::size_t min_depth) {
+    return detail::summa_min_depth_value().exchange(min_depth);
+  }
+
+  namespace detail {
+
+    inline std::atomic<bool>& summa_depth_log_flag() {
+      static std::atomic<bool> flag(env_flag("TA_SUMMA_DEPTH_LOG", false));
+      return flag;
+    }
+
+    /// Process-local log of SUMMA depth statistics
+
+    /// The log holds at most \c capacity entries; when it is full, the oldest
+    /// entry is dropped.
+    class SummaDepthLog {
+    public:
+      static constexpr std::size_t capacity = 1024ul; ///< Maximum number of entries
+
+    private:
+      std::deque<SummaDepthStatistics> log_;
+      madness::Spinlock lock_;
+
+      SummaDepthLog() = default;
+
+    public:
+
+      /// Singleton accessor
+      static SummaDepthLog& instance() {
+        static SummaDepthLog log;
+        return log;
+      }
+
+      /// Append \c stats to the log, if logging is enabled
+      void record(const SummaDepthStatistics& stats) {
+        if(! summa_depth_log_flag().load(std::memory_order_relaxed))
+          return;
+        madness::ScopedMutex<madness::Spinlock> locker(&lock_);
+        if(log_.size() == capacity)
+          log_.pop_front();
+        log_.push_back(stats);
+      }
+
+      /// Remove all entries from the log
+
+      /// \return The removed entries, oldest first
+      std::vector<SummaDepthStatistics> take() {
+        madness::ScopedMutex<madness::Spinlock> locker(&lock_);
+        std::vector<SummaDepthStatistics> result(log_.begin(), log_.end());
+        log_.clear();
+        return result;
+      }
+
+      /// Remove all entries from the log
+      void clear() {
+        madness::ScopedMutex<madness::Spinlock> locker(&lock_);
+        log_.clear();
+      }
+    }; // class SummaDepthLog
+
+
+    /// Feedback controller for the number of concurrent SUMMA iterations
+
+    /// The SUMMA step tasks report, for each k-step, the time between the
+    /// start of the broadcast and the arrival of all tiles (broadcast latency),
+    /// the time between the arrival of the tiles and the completion of all
+    /// tile contractions (GEMM time), and the number of bytes that the step
+    /// holds. The controller estimates the number of steps that must be in
+    /// flight to hide the broadcast latency behind the contractions of the
+    /// preceding steps, and moves the depth toward that estimate by at most
+    /// one step at a time. The estimate is kept in the range
+    /// <tt>[min_depth, max_depth]</tt>, where \c min_depth is given by
+    /// \c summa_min_depth() , and, when a memory limit is given, it is bounded
+    /// by the number of steps that fit in the limit. The depth is reduced,
+    /// down to 1, whenever the resident broadcast data exceeds the limit.
+    class SummaDepthController {
+    public:
+      typedef std::size_t size_type; ///< Size type
+
+    private:
+      /// Weight of the newest sample in the running averages
+      static constexpr double sample_weight_ = 0.25;
+
+      bool adaptive_ = false; ///< Adjust the depth at runtime
+      size_type depth_ = 1ul; ///< Current depth
+      size_type min_depth_ = 1ul; ///< Smallest allowed depth
+      size_type max_depth_ = 1ul; ///< Largest allowed depth
+      size_type max_memory_ = 0ul; ///< Broadcast memory limit (0 = no limit)
+      size_type resident_bytes_ = 0ul; ///< Bytes held by in-flight steps
+      size_type pending_ = 0ul; ///< Samples since the last depth change
+      double latency_ = 0.0; ///< Running average of the broadcast latency
+      double gemm_time_ = 0.0; ///< Running average of the GEMM time per step
+      double step_bytes_ = 0.0; ///< Running average of the bytes per step
+      SummaDepthStatistics stats_;
+      madness::Spinlock lock_;
+
+      void update(double& avg, const double sample) const {
+        avg = (stats_.steps == 0ul ? sample :
+            (1.0 - sample_weight_) * avg + sample_weight_ * sample);
+      }
+
+      void set_depth(const size_type depth) {
+        if(depth > depth_)
+          ++stats_.grow_count;
+        else if(depth < depth_)
+          ++stats_.shrink_count;
+        depth_ = depth;
+        pending_ = 0ul;
+        stats_.min_depth = std::min(stats_.min_depth, depth_);
+        stats_.max_depth = std::max(stats_.max_depth, depth_);
+      }
+
+    public:
+
+      SummaDepthController() = default;
+
+      SummaDepthController(const SummaDepthController&) = delete;
+      SummaDepthController& operator=(const SummaDepthController&) = delete;
+
+      /// Set the initial state of the controller
+
+      /// \param depth The initial depth
+      /// \param max_depth The largest allowed depth
+      /// \param max_memory The broadcast memory limit in bytes, or 0 for no
+      /// limit
+      /// \param adaptive Adjust the depth at runtime when \c true
+      void initialize(const size_type depth, const size_type max_depth,
+          const size_type max_memory, const bool adaptive = enabled())
+      {
+        madness::ScopedMutex<madness::Spinlock> locker(&lock_);
+        adaptive_ = adaptive;
+        depth_ = std::max(depth, size_type(1));
+        max_depth_ = std::max(max_depth, depth_);
+        min_depth_ = std::min(std::max(summa_min_depth(), size_type(1)),
+            max_depth_);
+        max_memory_ = max_memory;
+        resident_bytes_ = 0ul;
+        pending_ = 0ul;
+        stats_ = SummaDepthStatistics();
+        stats_.initial_depth = stats_.min_depth = stats_.max_depth =
+            stats_.final_depth = depth_;
+      }
+
+      /// Adaptive depth control flag
+
+      /// The control can be disabled by setting the environment variable
+      /// \c TA_SUMMA_ADAPTIVE_DEPTH to 0.
+      /// \return \c true if the depth controller is enabled by default
+      static bool enabled() {
+        static const bool result = env_flag("TA_SUMMA_ADAPTIVE_DEPTH", true);
+        return result;
+      }
+
+      /// \return The current depth
+      size_type depth() {
+        madness::ScopedMutex<madness::Spinlock> locker(&lock_);
+        return depth_;
+      }
+
+      /// Register the start of a SUMMA step
+
+      /// \param bytes The number of bytes of broadcast tiles held by the step
+      void step_started(const size_type bytes) {
+        madness::ScopedMutex<madness::Spinlock> locker(&lock_);
+        resident_bytes_ += bytes;
+        stats_.peak_resident_bytes =
+            std::max(stats_.peak_resident_bytes, resident_bytes_);
+      }
+
+      /// Register the completion of a SUMMA step
+
+      /// \param bytes The number of bytes of broadcast tiles held by the step
+      /// \param latency The broadcast latency of the step, in seconds
+      /// \param gemm_time The contraction time of the step, in seconds
+      void step_finished(const size_type bytes, const double latency,
+          const double gemm_time)
+      {
+        madness::ScopedMutex<madness::Spinlock> locker(&lock_);
+        TA_ASSERT(resident_bytes_ >= bytes);
+        resident_bytes_ -= bytes;
+        update(latency_, latency);
+        // The contraction time of a step includes the time it waits for the
+        // other steps in flight, so normalize it by the depth.
+        update(gemm_time_, gemm_time / double(depth_));
+        update(step_bytes_, double(bytes));
+        stats_.mean_bcast_latency += (latency - stats_.mean_bcast_latency)
+            / double(stats_.steps + 1ul);
+        stats_.mean_gemm_time += (gemm_time - stats_.mean_gemm_time)
+            / double(stats_.steps + 1ul);
+        ++stats_.steps;
+        ++pending_;
+      }
+
+      /// Compute the depth change for the next step
+
+      /// \param can_grow \c false when the pipeline cannot be extended, i.e.
+      /// when its last step is at the end of the inner dimension
+      /// \return The change in depth that must be applied to the pipeline:
+      /// +1, 0, or -1.
+      int adjust(const bool can_grow = true) {
+        madness::ScopedMutex<madness::Spinlock> locker(&lock_);
+        stats_.final_depth = depth_;
+        if(! adaptive_) return 0;
+
+        // Memory bound has priority over performance
+        if(max_memory_ && (resident_bytes_ > max_memory_) && (depth_ > 1ul)) {
+          set_depth(depth_ - 1ul);
+          return -1;
+        }
+
+        // Wait for fresh samples since the last depth change
+        if(pending_ < 2ul)
+          return 0;
+
+        // Number of steps that must be in flight to hide the latency
+        size_type target = (gemm_time_ > 0.0 ?
+            std::min(std::ceil(latency_ / gemm_time_) + 1.0, double(max_depth_)) :
+            depth_);
+        target = std::max(min_depth_, target);
+        if(max_memory_ && step_bytes_ > 0.0)
+          target = std::max(size_type(1), std::min(target,
+              size_type(double(max_memory_) / step_bytes_)));
+
+        if(target > depth_) {
+          if(! can_grow) return 0;
+          set_depth(depth_ + 1ul);
+          return 1;
+        } else if(target < depth_) {
+          set_depth(depth_ - 1ul);
+          return -1;
+        }
+
+        return 0;
+      }
+
+      /// \return The statistics collected by this controller
+      SummaDepthStatistics statistics() {
+        madness::ScopedMutex<madness::Spinlock> locker(&lock_);
+        return stats_;
+      }
+
+    }; // class SummaDepthController
+
+  } // namespace detail
+
+  /// Log the SUMMA depth statistics (\c TA_SUMMA_DEPTH_LOG , default off)
+  inline bool summa_depth_logging() {
+    return detail::summa_depth_log_flag().load(std::memory_order_relaxed);
+  }
+
+  /// Enable or disable logging of the SUMMA depth statistics
+
+  /// \param enable The new value of the logging flag
+  /// \return The previous value of the flag
+  /// \sa summa_depth_logging()
+  inline bool set_summa_depth_logging(const bool enable) {
+    return detail::summa_depth_log_flag().exchange(enable);
+  }
+
+  /// Export the SUMMA depth statistics
+
+  /// The exported statistics are removed from the log of this process.
+  /// \return The depth statistics of the SUMMA contractions evaluated by this
+  /// process since the last export, in the order of completion; at most
+  /// \c detail::SummaDepthLog::capacity of the most recent ones are kept
+  inline std::vector<SummaDepthStatistics> summa_depth_statistics() {
+    return detail::SummaDepthLog::instance().take();
+  }
+
+  /// Clear the SUMMA depth statistics of this process
+  inline void reset_summa_depth_statistics() {
+    detail::SummaDepthLog::instance().clear();
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_DIST_EVAL_SUMMA_DEPTH_CONTROLLER_H__INCLUDED
@@ -72,7 +72,10 @@ namespace TiledArray {
       typedef typename policy::pmap_interface
           pmap_interface; ///< Process map interface type
 
-      static constexpr bool consumable = true;
+      // Note: aliased block tiles may share the data of the array tiles (see
+      // BlkTsrEngine::init()), so they must not be consumed.
+      static constexpr bool consumable = (! Alias) ||
+          TiledArray::eval_trait<typename array_type::value_type>::is_consumable;
       static constexpr unsigned int leaves = 1;
     };
 
@@ -348,13 +351,33 @@ namespace TiledArray {
       using BlkTsrEngineBase_::lower_bound_;
       using BlkTsrEngineBase_::upper_bound_;
 
+      bool view_; ///< If \c true , tiles share the data of the array tiles
+
     public:
 
       template <typename A>
       BlkTsrEngine(const BlkTsrExpr<A, Alias>& expr) :
-        BlkTsrEngineBase_(expr)
+        BlkTsrEngineBase_(expr), view_(true)
       { }
 
+      /// Expression initialization
+
+      /// This engine is the root of the expression, so its tiles are stored
+      /// in the result. They are copied from the array tiles instead of
+      /// sharing their data, which aliased block tiles do when this engine is
+      /// the argument of another engine. Those tiles are not consumable, so
+      /// the parent engine never modifies them in place.
+      /// \param world The world where the expression will be evaluated
+      /// \param pmap The process map for the result tensor (may be NULL)
+      /// \param target_vars The target variable list of the result tensor
+      /// \param balance If \c true , distribute the result tiles by their cost
+      void init(World& world, std::shared_ptr<pmap_interface> pmap,
+          const VariableList& target_vars, const bool balance = false)
+      {
+        view_ = false;
+        ExprEngine_::init(world, pmap, target_vars, balance);
+      }
+
       /// Non-permuting shape factory function
 
       /// \return The result shape
@@ -391,7 +414,8 @@ namespace TiledArray {
           range_shift.emplace_back(-base_d);
         }
 
-        return op_type(op_base_type(range_shift));
+        return op_type(op_base_type(range_shift,
+            view_ && ! EngineTrait<BlkTsrEngine_>::consumable));
       }
 
       /// Permuting tile operation factory function
@@ -26,12 +26,49 @@
 #ifndef TILEDARRAY_EXPRESSIONS_CONT_ENGINE_H__INCLUDED
 #define TILEDARRAY_EXPRESSIONS_CONT_ENGINE_H__INCLUDED
 
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+
 #include <TiledArray/expressions/binary_engine.h>
 #include <TiledArray/dist_eval/contraction_eval.h>
+#include <TiledArray/dist_eval/hadamard_contraction_eval.h>
 #include <TiledArray/tile_op/contract_reduce.h>
 #include <TiledArray/proc_grid.h>
 
 namespace TiledArray {
+  namespace detail {
+
+    /// Number of SUMMA process grid layers given by \c TA_SUMMA_LAYERS
+
+    /// The environment variable is read once; a value that is not a positive
+    /// integer is reported and ignored.
+    /// \return The number of layers, or 0 if it is not given
+    inline std::size_t summa_layers() {
+      static const std::size_t layers = [] () -> std::size_t {
+        const char* env_layers = getenv("TA_SUMMA_LAYERS");
+        if(! env_layers)
+          return 0ul;
+
+        char* end = nullptr;
+        const unsigned long value = std::strtoul(env_layers, &end, 10);
+        if(! std::isdigit(static_cast<unsigned char>(env_layers[0])) ||
+            (*end != '\0') || (value == 0ul))
+        {
+          if(TiledArray::get_default_world().rank() == 0) {
+            TA_USER_ERROR_MESSAGE("TA_SUMMA_LAYERS=" << env_layers
+                << " is not a positive integer and is ignored.")
+          }
+          return 0ul;
+        }
+        return value;
+      }();
+      return layers;
+    }
+
+  } // namespace detail
+
   namespace expressions {
 
     // Forward declarations
@@ -65,6 +102,11 @@ namespace TiledArray {
           typename eval_trait<typename left_type::value_type>::type,
           typename eval_trait<typename right_type::value_type>::type,
           scalar_type> op_type; ///< The tile operation type
+      typedef TiledArray::detail::HadamardContractReduce<value_type,
+          typename eval_trait<typename left_type::value_type>::type,
+          typename eval_trait<typename right_type::value_type>::type,
+          scalar_type> hadamard_op_type; ///< The tile operation type of
+              ///< contractions with Hadamard dimensions
       typedef typename EngineTrait<Derived>::policy
           policy; ///< The result policy type
       typedef typename EngineTrait<Derived>::dist_eval_type
@@ -114,6 +156,9 @@ namespace TiledArray {
       op_type op_; ///< Tile operation
       TiledArray::detail::ProcGrid proc_grid_; ///< Process grid for the contraction
       size_type K_; ///< Inner dimension size
+      unsigned int hadamard_rank_; ///< The number of Hadamard dimensions
+      hadamard_op_type hadamard_op_; ///< Tile operation with Hadamard dimensions
+      size_type H_; ///< Hadamard dimension size
 
 
       static unsigned int
@@ -137,7 +182,7 @@ namespace TiledArray {
       ContEngine(const MultExpr<L, R>& expr) :
         BinaryEngine_(expr), factor_(1), left_vars_(), right_vars_(),
         left_op_(permute_to_no_trans), right_op_(permute_to_no_trans), op_(),
-        proc_grid_(), K_(1u)
+        proc_grid_(), K_(1u), hadamard_rank_(0u), hadamard_op_(), H_(1u)
       { }
 
       /// Constructor
@@ -150,7 +195,7 @@ namespace TiledArray {
       ContEngine(const ScalMultExpr<L, R, S>& expr) :
         BinaryEngine_(expr), factor_(expr.factor()), left_vars_(), right_vars_(),
         left_op_(permute_to_no_trans), right_op_(permute_to_no_trans), op_(),
-        proc_grid_(), K_(1u)
+        proc_grid_(), K_(1u), hadamard_rank_(0u), hadamard_op_(), H_(1u)
       { }
 
       // Pull base class functions into this class.
@@ -352,6 +397,92 @@ namespace TiledArray {
 
       }
 
+      /// Initialize the variable list of a contraction with Hadamard dimensions
+
+      /// The variables that appear in both arguments and in \c target_vars
+      /// are Hadamard variables, e.g. \c l in
+      /// \code c("i,j,l") = a("i,l,k") * b("j,l,k") \endcode . When there are
+      /// any, the arguments are permuted to \f$ (h, i, k) \f$ and
+      /// \f$ (h, k, j) \f$, and the result variables are \f$ (h, i, j) \f$,
+      /// where \f$ h \f$, \f$ i \f$, and \f$ j \f$ are ordered as in
+      /// \c target_vars , and the inner variables \f$ k \f$ are ordered as in
+      /// the left-hand argument.
+      /// \note Like \c init_vars() , this function does not initialize the
+      /// child data.
+      /// \param target_vars The target variable list for this expression
+      /// \return \c true if the contraction has Hadamard dimensions
+      /// \throw TiledArray::Exception When the contraction has Hadamard
+      /// dimensions, but they are not supported by the tile type
+      bool init_hadamard_vars(const VariableList& target_vars) {
+        const unsigned int left_rank = left_.vars().dim();
+        const unsigned int right_rank = right_.vars().dim();
+        const unsigned int target_rank = target_vars.dim();
+
+        // Partition the target variables
+        std::vector<std::string> hadamard_vars, left_outer_vars, right_outer_vars;
+        for(unsigned int i = 0u; i < target_rank; ++i) {
+          const std::string& var = target_vars[i];
+          const bool left_var = find(left_.vars(), var, 0u, left_rank) < left_rank;
+          const bool right_var = find(right_.vars(), var, 0u, right_rank) < right_rank;
+          if(left_var && right_var)
+            hadamard_vars.push_back(var);
+          else if(left_var)
+            left_outer_vars.push_back(var);
+          else if(right_var)
+            right_outer_vars.push_back(var);
+        }
+
+        if(hadamard_vars.empty())
+          return false;
+
+        if(! hadamard_op_type::supported)
+          TA_EXCEPTION("Contractions with Hadamard dimensions are not supported "
+              "for this tile type");
+
+        // The remaining shared variables are contracted
+        std::vector<std::string> inner_vars;
+        for(unsigned int i = 0u; i < left_rank; ++i) {
+          const std::string& var = left_.vars()[i];
+          if((find(right_.vars(), var, 0u, right_rank) < right_rank) &&
+              (find(target_vars, var, 0u, target_rank) == target_rank))
+            inner_vars.push_back(var);
+        }
+
+        TA_USER_ASSERT((hadamard_vars.size() + left_outer_vars.size() +
+            inner_vars.size()) == left_rank,
+            "The target variables do not include all outer variables of the "
+            "left-hand argument");
+        TA_USER_ASSERT((hadamard_vars.size() + right_outer_vars.size() +
+            inner_vars.size()) == right_rank,
+            "The target variables do not include all outer variables of the "
+            "right-hand argument");
+
+        hadamard_rank_ = hadamard_vars.size();
+
+        std::vector<std::string> vars(hadamard_vars);
+        vars.insert(vars.end(), left_outer_vars.begin(), left_outer_vars.end());
+        vars.insert(vars.end(), inner_vars.begin(), inner_vars.end());
+        left_vars_ = VariableList(vars.begin(), vars.end());
+
+        vars = hadamard_vars;
+        vars.insert(vars.end(), inner_vars.begin(), inner_vars.end());
+        vars.insert(vars.end(), right_outer_vars.begin(), right_outer_vars.end());
+        right_vars_ = VariableList(vars.begin(), vars.end());
+
+        vars = hadamard_vars;
+        vars.insert(vars.end(), left_outer_vars.begin(), left_outer_vars.end());
+        vars.insert(vars.end(), right_outer_vars.begin(), right_outer_vars.end());
+        vars_ = VariableList(vars.begin(), vars.end());
+
+        // The arguments are always permuted to the Hadamard layout, so the
+        // argument permutation flags are not used.
+        left_op_ = right_op_ = no_trans;
+        left_.perm_vars(left_vars_);
+        right_.perm_vars(right_vars_);
+
+        return true;
+      }
+
       /// Initialize result tensor structure
 
       /// This function will initialize the permutation, tiled range, and shape
@@ -362,6 +493,32 @@ namespace TiledArray {
         left_.init_struct(left_vars_);
         right_.init_struct(right_vars_);
 
+        if(hadamard_rank_) {
+          // The tile operation of one element of the Hadamard dimensions is
+          // used to evaluate the tiled range and shape.
+          op_ = op_type(madness::cblas::NoTrans, madness::cblas::NoTrans,
+              factor_, vars_.dim() - hadamard_rank_,
+              left_vars_.dim() - hadamard_rank_, right_vars_.dim() - hadamard_rank_);
+
+          if(target_vars != vars_) {
+            perm_ = ExprEngine_::make_perm(target_vars);
+            hadamard_op_ = hadamard_op_type(factor_, hadamard_rank_, vars_.dim(),
+                left_vars_.dim(), right_vars_.dim(),
+                (permute_tiles_ ? perm_ : Permutation()));
+            trange_ = ContEngine_::make_trange(perm_);
+            shape_ = ContEngine_::make_shape(perm_);
+          } else {
+            hadamard_op_ = hadamard_op_type(factor_, hadamard_rank_, vars_.dim(),
+                left_vars_.dim(), right_vars_.dim());
+            trange_ = ContEngine_::make_trange();
+            shape_ = ContEngine_::make_shape();
+          }
+
+          if(ExprEngine_::override_ptr_ && ExprEngine_::override_ptr_->shape)
+            shape_ = shape_.mask(*ExprEngine_::override_ptr_->shape);
+          return;
+        }
+
         // Initialize the tile operation in this function because it is used to
         // evaluate the tiled range and shape.
 
@@ -391,6 +548,71 @@ namespace TiledArray {
         } 
       }
 
+      /// Number of process grid layers used by the contraction
+
+      /// When memory allows, the inner dimension of the contraction is split
+      /// among several layers of the process grid (2.5D SUMMA). Every layer
+      /// holds a partial copy of the result, so the memory used for the result
+      /// grows linearly with the number of layers \f$ L \f$, while the
+      /// broadcast volume shrinks by \f$ \sqrt{L} \f$. The number of layers is
+      /// the largest \f$ L \le \min(P^{1/3}, K) \f$, for \f$ P \f$ processes
+      /// and \f$ K \f$ inner tiles, such that the partial results held by a
+      /// process do not exceed its share of the argument data, nor the memory
+      /// limit given by \c Expr::set_max_memory() . Layers are only used for
+      /// dense results. For dense results, the choice may be overridden with
+      /// the environment variable \c TA_SUMMA_LAYERS, which is clamped to
+      /// \f$ [1, \min(P^{1/3}, K)] \f$; set it to 1 to always use a 2D process
+      /// grid.
+      /// \param world The world where the contraction is evaluated
+      /// \param m The number of element rows of the result
+      /// \param n The number of element columns of the result
+      /// \param k The number of elements in the inner dimension
+      /// \return The number of process grid layers
+      size_type layers(const World& world, const size_type m, const size_type n,
+          const size_type k) const
+      {
+        if(! shape_.is_dense())
+          return 1ul;
+
+        const size_type nprocs = world.size();
+        const size_type max_layers = std::max<size_type>(1ul,
+            std::min(size_type(std::cbrt(double(nprocs)) + 1.0e-6), K_));
+
+        const size_type env_layers = TiledArray::detail::summa_layers();
+        if(env_layers) {
+          if(env_layers > max_layers) {
+            static std::atomic<bool> warned(false);
+            if((world.rank() == 0) && ! warned.exchange(true)) {
+              TA_USER_ERROR_MESSAGE("TA_SUMMA_LAYERS=" << env_layers
+                  << " exceeds the maximum number of layers and is reduced to "
+                  << max_layers << ".")
+            }
+          }
+          return std::min(env_layers, max_layers);
+        }
+
+        const std::size_t max_memory = (ExprEngine_::override_ptr_ ?
+            ExprEngine_::override_ptr_->max_memory : 0ul);
+        const double element_size =
+            sizeof(typename TiledArray::detail::numeric_type<value_type>::type);
+        const double result_size = double(m) * double(n);
+        const double arg_size = (double(m) + double(n)) * double(k);
+
+        size_type result = max_layers;
+        for(; result > 1ul; --result) {
+          // Total size of the partial results of all layers
+          const double partial_size = double(result) * result_size;
+          if(partial_size > arg_size)
+            continue;
+          if(max_memory && ((partial_size * element_size / double(nprocs))
+              > double(max_memory)))
+            continue;
+          break;
+        }
+
+        return result;
+      }
+
       /// Initialize result tensor distribution
 
       /// This function will initialize the world and process map for the result
@@ -398,6 +620,11 @@ namespace TiledArray {
       /// \param world The world were the result will be distributed
       /// \param pmap The process map for the result tensor tiles
       void init_distribution(World* world, std::shared_ptr<pmap_interface> pmap) {
+        if(hadamard_rank_) {
+          init_hadamard_distribution(world, pmap);
+          return;
+        }
+
         const unsigned int inner_rank = op_.gemm_helper().num_contract_ranks();
         const unsigned int left_rank = op_.gemm_helper().left_rank();
         const unsigned int right_rank = op_.gemm_helper().right_rank();
@@ -414,21 +641,32 @@ namespace TiledArray {
             right_.trange().elements_range().extent_data();
 
         // Compute the fused sizes of the contraction
-        size_type M = 1ul, m = 1ul, N = 1ul, n = 1ul;
+        size_type M = 1ul, m = 1ul, N = 1ul, n = 1ul, k = 1ul;
         unsigned int i = 0u;
         for(; i < left_outer_rank; ++i) {
           M *= left_tiles_size[i];
           m *= left_element_size[i];
         }
-        for(; i < left_rank; ++i)
+        for(; i < left_rank; ++i) {
           K_ *= left_tiles_size[i];
+          k *= left_element_size[i];
+        }
         for(i = inner_rank; i < right_rank; ++i) {
           N *= right_tiles_size[i];
           n *= right_element_size[i];
         }
 
-        // Construct the process grid.
-        proc_grid_ = TiledArray::detail::ProcGrid(*world, M, N, m, n);
+        // Construct the process grid. In node-aware mode, the processes of
+        // each node are kept together in the rows or columns of the grid.
+        const size_type nlayers = ContEngine_::layers(*world, m, n, k);
+        std::shared_ptr<const TiledArray::detail::NodeTopology> topology;
+        if(TiledArray::detail::node_aware_proc_grid()) {
+          topology = TiledArray::detail::NodeTopology::get(*world);
+          if(topology->nodes() == 1ul)
+            topology.reset();
+        }
+        proc_grid_ = TiledArray::detail::ProcGrid(*world, M, N, m, n, nlayers,
+            topology.get());
 
         // Initialize children
         left_.init_distribution(world, proc_grid_.make_row_phase_pmap(K_));
@@ -440,6 +678,47 @@ namespace TiledArray {
         ExprEngine_::init_distribution(world, pmap);
       }
 
+      /// Initialize the distribution of a contraction with Hadamard dimensions
+
+      /// The argument tiles of each Hadamard tile are held by the processes
+      /// that contract it (see \c TiledArray::detail::HadamardContraction ),
+      /// and so are the result tiles, unless the result is permuted or
+      /// \c pmap is given.
+      /// \param world The world were the result will be distributed
+      /// \param pmap The process map for the result tensor tiles
+      void init_hadamard_distribution(World* world,
+          std::shared_ptr<pmap_interface> pmap)
+      {
+        typedef TiledArray::detail::HadamardContraction<
+            typename left_type::dist_eval_type, typename right_type::dist_eval_type,
+            hadamard_op_type, typename Derived::policy> impl_type;
+
+        // Compute the number of Hadamard and inner tiles
+        const unsigned int left_rank = left_vars_.dim();
+        const unsigned int inner_rank = op_.gemm_helper().num_contract_ranks();
+        const size_type* MADNESS_RESTRICT const left_tiles_size =
+            left_.trange().tiles_range().extent_data();
+        for(unsigned int i = 0u; i < hadamard_rank_; ++i)
+          H_ *= left_tiles_size[i];
+        for(unsigned int i = left_rank - inner_rank; i < left_rank; ++i)
+          K_ *= left_tiles_size[i];
+
+        // Compute the number of left-hand outer tiles
+        const size_type M = left_.trange().tiles_range().volume() / (H_ * K_);
+
+        // Initialize children
+        left_.init_distribution(world, impl_type::make_left_pmap(*world, H_, M,
+            left_.trange().tiles_range().volume()));
+        right_.init_distribution(world, impl_type::make_right_pmap(*world, H_,
+            right_.trange().tiles_range().volume()));
+
+        // Initialize the process map in not already defined
+        if(! pmap)
+          pmap = (perm_ ? policy::default_pmap(*world, trange_.tiles_range().volume()) :
+              impl_type::make_left_pmap(*world, H_, M, trange_.tiles_range().volume()));
+        ExprEngine_::init_distribution(world, pmap);
+      }
+
       /// Tiled range factory function
 
       /// \param perm The permutation to be applied to the array
@@ -451,14 +730,16 @@ namespace TiledArray {
         const unsigned int inner_rank = op_.gemm_helper().num_contract_ranks();
         const unsigned int left_outer_rank = left_rank - inner_rank;
 
-        // Construct the trange input and compute the gemm sizes
-        typename trange_type::Ranges ranges(op_.gemm_helper().result_rank());
+        // Construct the trange input and compute the gemm sizes. The leading
+        // Hadamard dimensions, if any, are taken from the left-hand argument.
+        const unsigned int h = hadamard_rank_;
+        typename trange_type::Ranges ranges(h + op_.gemm_helper().result_rank());
         unsigned int i = 0ul;
-        for(unsigned int x = 0ul; x < left_outer_rank; ++x, ++i) {
+        for(unsigned int x = 0ul; x < (h + left_outer_rank); ++x, ++i) {
           const unsigned int pi = (perm ? perm[i] : i);
           ranges[pi] = left_.trange().data()[x];
         }
-        for(unsigned int x = inner_rank; x < right_rank; ++x, ++i) {
+        for(unsigned int x = h + inner_rank; x < (h + right_rank); ++x, ++i) {
           const unsigned int pi = (perm ? perm[i] : i);
           ranges[pi] = right_.trange().data()[x];
         }
@@ -471,8 +752,14 @@ namespace TiledArray {
         const auto* MADNESS_RESTRICT const right_extent =
             right_.trange().tiles_range().extent_data();
 
+        // Check that the Hadamard dimensions have equal tilings
+        for(unsigned int x = 0u; x < h; ++x)
+          if(left_.trange().data()[x] != right_.trange().data()[x])
+            TA_EXCEPTION("The tilings of the Hadamard dimensions of the left- "
+                "and right-hand arguments are not equal.");
+
         // Check that the contracted dimensions are have congruent tilings
-        for(unsigned int l = left_outer_rank, r = 0ul; l < left_rank; ++l, ++r) {
+        for(unsigned int l = h + left_outer_rank, r = h; l < (h + left_rank); ++l, ++r) {
           if(left_.trange().data()[l] != right_.trange().data()[r]) {
             if(TiledArray::get_default_world().rank() == 0) {
 
@@ -508,6 +795,9 @@ namespace TiledArray {
         shape_gemm_helper(madness::cblas::NoTrans, madness::cblas::NoTrans,
             op_.gemm_helper().result_rank(), op_.gemm_helper().left_rank(),
             op_.gemm_helper().right_rank());
+        if(hadamard_rank_)
+          return left_.shape().hadamard_gemm(right_.shape(), factor_,
+              shape_gemm_helper, hadamard_rank_);
         return left_.shape().gemm(right_.shape(), factor_, shape_gemm_helper);
       }
 
@@ -520,11 +810,17 @@ namespace TiledArray {
         shape_gemm_helper(madness::cblas::NoTrans, madness::cblas::NoTrans,
             op_.gemm_helper().result_rank(), op_.gemm_helper().left_rank(),
             op_.gemm_helper().right_rank());
+        if(hadamard_rank_)
+          return left_.shape().hadamard_gemm(right_.shape(), factor_,
+              shape_gemm_helper, hadamard_rank_, perm);
         return left_.shape().gemm(right_.shape(), factor_, shape_gemm_helper,
                                   perm);
       }
 
       dist_eval_type make_dist_eval() const {
+        if(hadamard_rank_)
+          return make_hadamard_dist_eval();
+
         // Define the impl type
         typedef TiledArray::detail::Summa<typename left_type::dist_eval_type,
             typename right_type::dist_eval_type, op_type, typename Derived::policy> impl_type;
@@ -532,9 +828,30 @@ namespace TiledArray {
         typename left_type::dist_eval_type left = left_.make_dist_eval();
         typename right_type::dist_eval_type right = right_.make_dist_eval();
 
+        // Use the memory budget of this expression, if one was set
+        const size_type max_memory = (ExprEngine_::override_ptr_ ?
+            ExprEngine_::override_ptr_->max_memory : 0ul);
+
         std::shared_ptr<impl_type> pimpl =
             std::make_shared<impl_type>(left, right, *world_, trange_, shape_,
-                                        pmap_, perm_, op_, K_, proc_grid_);
+                                        pmap_, perm_, op_, K_, proc_grid_,
+                                        max_memory);
+
+        return dist_eval_type(pimpl);
+      }
+
+      /// Construct the distributed evaluator of a contraction with Hadamard dimensions
+
+      /// \return The distributed evaluator that will evaluate this expression
+      dist_eval_type make_hadamard_dist_eval() const {
+        typedef TiledArray::detail::HadamardContraction<
+            typename left_type::dist_eval_type, typename right_type::dist_eval_type,
+            hadamard_op_type, typename Derived::policy> impl_type;
+
+        std::shared_ptr<impl_type> pimpl =
+            std::make_shared<impl_type>(left_.make_dist_eval(),
+                right_.make_dist_eval(), *world_, trange_, shape_, pmap_, perm_,
+                hadamard_op_, H_, K_);
 
         return dist_eval_type(pimpl);
       }
@@ -0,0 +1,326 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TILEDARRAY_EXPRESSIONS_CONTRACTION_ORDER_H__INCLUDED
+#define TILEDARRAY_EXPRESSIONS_CONTRACTION_ORDER_H__INCLUDED
+
+#include <TiledArray/expressions/variable_list.h>
+#include <TiledArray/math/gemm_helper.h>
+#include <TiledArray/utility.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace TiledArray {
+  namespace detail {
+
+    inline std::atomic<bool>& reorder_contractions_flag() {
+      static std::atomic<bool> flag(env_flag("TA_REORDER_CONTRACTIONS", true));
+      return flag;
+    }
+
+    /// Reorder contraction chains (\c TA_REORDER_CONTRACTIONS , default on)
+    inline bool reorder_contractions() {
+      return reorder_contractions_flag().load(std::memory_order_relaxed);
+    }
+
+    /// Enable or disable contraction chain reordering
+
+    /// \param enable The new value of the contraction reordering flag
+    /// \return The previous value of the flag
+    /// \sa reorder_contractions()
+    inline bool set_reorder_contractions(const bool enable) {
+      return reorder_contractions_flag().exchange(enable);
+    }
+
+  } // namespace detail
+
+  namespace expressions {
+
+    // Forward declarations
+    template <typename, typename> class MultExpr;
+    template <typename, bool> class TsrExpr;
+
+    /// Estimated cost of a contraction
+    struct ContractionCost {
+      double flops; ///< The number of floating point operations
+      double memory; ///< The number of elements in the non-zero result tiles
+    };
+
+    /// Contraction cost comparison
+
+    /// Costs are ordered by their flop count, and then by their memory.
+    /// \param left The left-hand cost
+    /// \param right The right-hand cost
+    /// \return \c true if \c left is cheaper than \c right
+    inline bool operator<(const ContractionCost& left,
+        const ContractionCost& right)
+    {
+      return (left.flops < right.flops) ||
+          ((left.flops == right.flops) && (left.memory < right.memory));
+    }
+
+    /// Operand of a contraction cost estimate
+
+    /// \tparam Shape The shape type of the operand
+    template <typename Shape>
+    struct ContractionOperand {
+      std::vector<std::string> vars; ///< The variables of the operand
+      std::vector<double> extents; ///< The element extent of each variable
+      Shape shape; ///< The shape of the operand
+    };
+
+    /// Estimate the cost of a contraction
+
+    /// The variables that are shared by \c left and \c right are contracted,
+    /// and the others are the result variables, in the order of \c left and
+    /// then \c right . The flop count is that of the dense contraction,
+    /// scaled by the fraction of non-zero tiles of both operands. The result
+    /// shape is computed with \c Shape::gemm , and the memory is the number of
+    /// elements in its non-zero tiles.
+    /// \tparam Shape The shape type
+    /// \param left The left-hand operand
+    /// \param right The right-hand operand
+    /// \param keep The variables that are used after this contraction
+    /// \param[out] result The result operand
+    /// \param[out] cost The cost of the contraction
+    /// \return \c false if this is not a contraction, i.e. a variable of
+    /// \c keep is shared by the operands, or there are no inner or outer
+    /// variables; otherwise \c true
+    template <typename Shape>
+    inline bool estimate_contraction(const ContractionOperand<Shape>& left,
+        const ContractionOperand<Shape>& right,
+        const std::vector<std::string>& keep,
+        ContractionOperand<Shape>& result, ContractionCost& cost)
+    {
+      auto contains = [] (const std::vector<std::string>& vars,
+          const std::string& var)
+      { return std::find(vars.begin(), vars.end(), var) != vars.end(); };
+
+      // Sort the variables of the operands into outer and inner variables
+      std::vector<std::string> inner_vars;
+      result.vars.clear();
+      result.extents.clear();
+      double m = 1.0, n = 1.0, k = 1.0;
+      for(std::size_t d = 0ul; d < left.vars.size(); ++d) {
+        const std::string& var = left.vars[d];
+        if(contains(right.vars, var)) {
+          if(contains(keep, var))
+            return false;
+          inner_vars.push_back(var);
+          k *= left.extents[d];
+        } else {
+          result.vars.push_back(var);
+          result.extents.push_back(left.extents[d]);
+          m *= left.extents[d];
+        }
+      }
+      const std::size_t left_outer = result.vars.size();
+      for(std::size_t d = 0ul; d < right.vars.size(); ++d) {
+        const std::string& var = right.vars[d];
+        if(! contains(left.vars, var)) {
+          result.vars.push_back(var);
+          result.extents.push_back(right.extents[d]);
+          n *= right.extents[d];
+        }
+      }
+      if(inner_vars.empty() || (left_outer == 0ul) ||
+          (left_outer == result.vars.size()))
+        return false;
+
+      // Permute the operand shapes to (outer, inner) and (inner, outer)
+      std::vector<std::string> left_vars(result.vars.begin(),
+          result.vars.begin() + left_outer);
+      left_vars.insert(left_vars.end(), inner_vars.begin(), inner_vars.end());
+      std::vector<std::string> right_vars(inner_vars);
+      right_vars.insert(right_vars.end(), result.vars.begin() + left_outer,
+          result.vars.end());
+
+      const Shape left_shape = left.shape.perm(
+          VariableList(left_vars.begin(), left_vars.end()).permutation(left.vars));
+      const Shape right_shape = right.shape.perm(
+          VariableList(right_vars.begin(), right_vars.end()).permutation(right.vars));
+
+      // Estimate the result shape and the cost
+      const math::GemmHelper gemm_helper(madness::cblas::NoTrans,
+          madness::cblas::NoTrans, result.vars.size(), left.vars.size(),
+          right.vars.size());
+      result.shape = left_shape.gemm(right_shape, 1, gemm_helper);
+
+      cost.flops = 2.0 * m * n * k * (1.0 - left.shape.sparsity()) *
+          (1.0 - right.shape.sparsity());
+      cost.memory = m * n * (1.0 - result.shape.sparsity());
+
+      return true;
+    }
+
+    /// Contraction chain reordering
+
+    /// The primary template does not reorder expressions.
+    /// \tparam E The expression type
+    template <typename E, typename Enabler = void>
+    struct ContractionOrder {
+
+      /// Evaluate an expression in a different order
+
+      /// \return \c false
+      template <typename Target>
+      static bool eval_to(const E&, Target&) { return false; }
+
+    }; // struct ContractionOrder
+
+    /// Contraction chain reordering
+
+    /// A chain of two contractions of three arrays, e.g.
+    /// <tt>a("i,k") * b("k,l") * c("l,j")</tt>, is evaluated from left to
+    /// right as <tt>(a * b) * c</tt>. This estimates the cost of the orders
+    /// <tt>(a * b) * c</tt>, <tt>a * (b * c)</tt>, and <tt>(a * c) * b</tt>
+    /// with \c estimate_contraction() , and evaluates the chain in the
+    /// cheapest order, i.e. the order with the lowest flop count and then the
+    /// smallest intermediate. The chain is reordered only when each variable
+    /// is contracted by exactly one of the contractions; chains with Hadamard
+    /// variables are evaluated as written. The shapes are replicated, so all
+    /// processes choose the same order.
+    /// \tparam A1 The array type of the first operand
+    /// \tparam A2 The array type of the second operand
+    /// \tparam A3 The array type of the third operand
+    template <typename A1, typename A2, typename A3>
+    struct ContractionOrder<
+        MultExpr<MultExpr<TsrExpr<A1, true>, TsrExpr<A2, true> >, TsrExpr<A3, true> >,
+        typename std::enable_if<
+            std::is_same<typename std::remove_const<A1>::type,
+                typename std::remove_const<A2>::type>::value &&
+            std::is_same<typename std::remove_const<A1>::type,
+                typename std::remove_const<A3>::type>::value
+        >::type>
+    {
+      typedef MultExpr<MultExpr<TsrExpr<A1, true>, TsrExpr<A2, true> >,
+          TsrExpr<A3, true> > expr_type; ///< The contraction chain type
+      typedef typename std::remove_const<A1>::type array_type; ///< The array type
+      typedef typename array_type::shape_type shape_type; ///< The shape type
+      typedef ContractionOperand<shape_type> operand_type; ///< The operand type
+
+    private:
+
+      /// Contraction operand factory
+
+      /// \tparam A The array type
+      /// \param expr The tensor expression
+      /// \return The contraction operand of \c expr
+      template <typename A>
+      static operand_type make_operand(const TsrExpr<A, true>& expr) {
+        operand_type result;
+        result.vars = VariableList(expr.vars()).data();
+        const auto& elements_range = expr.array().trange().elements_range();
+        for(unsigned int d = 0u; d < elements_range.rank(); ++d)
+          result.extents.push_back(elements_range.extent(d));
+        result.shape = expr.array().shape();
+        return result;
+      }
+
+      /// Estimate the cost of a contraction order
+
+      /// \param first The first operand of the first contraction
+      /// \param second The second operand of the first contraction
+      /// \param third The operand that is contracted with the intermediate
+      /// \param target The result variables
+      /// \param[out] cost The cost of both contractions; the memory is that
+      /// of the intermediate
+      /// \return \c true if both contractions are valid
+      static bool estimate(const operand_type& first,
+          const operand_type& second, const operand_type& third,
+          const std::vector<std::string>& target, ContractionCost& cost)
+      {
+        std::vector<std::string> keep(third.vars);
+        keep.insert(keep.end(), target.begin(), target.end());
+
+        operand_type intermediate, result;
+        ContractionCost first_cost, second_cost;
+        if(! estimate_contraction(first, second, keep, intermediate, first_cost))
+          return false;
+        if(! estimate_contraction(intermediate, third, target, result, second_cost))
+          return false;
+        if(! VariableList(result.vars.begin(), result.vars.end()).is_permutation(
+            VariableList(target.begin(), target.end())))
+          return false;
+
+        cost.flops = first_cost.flops + second_cost.flops;
+        cost.memory = first_cost.memory;
+        return true;
+      }
+
+    public:
+
+      /// Evaluate the chain in its cheapest order
+
+      /// \tparam A The result array type
+      /// \tparam Alias Tile alias flag
+      /// \param expr The contraction chain
+      /// \param tsr The tensor to be assigned
+      /// \return \c true if \c expr was evaluated in a different order,
+      /// otherwise \c false and \c expr should be evaluated as written
+      template <typename A, bool Alias>
+      static bool eval_to(const expr_type& expr, TsrExpr<A, Alias>& tsr) {
+        if(! TiledArray::detail::reorder_contractions())
+          return false;
+
+        const auto& a = expr.left().left();
+        const auto& b = expr.left().right();
+        const auto& c = expr.right();
+
+        const std::vector<std::string> target = VariableList(tsr.vars()).data();
+        const operand_type a_operand = make_operand(a);
+        const operand_type b_operand = make_operand(b);
+        const operand_type c_operand = make_operand(c);
+
+        // Estimate the cost of the order as written, (a * b) * c, and of the
+        // alternatives
+        ContractionCost ab_c, a_bc, ac_b;
+        if(! estimate(a_operand, b_operand, c_operand, target, ab_c))
+          return false;
+        const bool use_a_bc =
+            estimate(b_operand, c_operand, a_operand, target, a_bc) &&
+            (a_bc < ab_c);
+        const bool use_ac_b =
+            estimate(a_operand, c_operand, b_operand, target, ac_b) &&
+            (ac_b < (use_a_bc ? a_bc : ab_c));
+
+        // The intermediate is the right-hand argument, so the reordered
+        // expressions are not contraction chains themselves.
+        if(use_ac_b) {
+          (b * (a * c)).eval_to(tsr);
+          return true;
+        }
+        if(use_a_bc) {
+          (a * (b * c)).eval_to(tsr);
+          return true;
+        }
+
+        return false;
+      }
+
+    }; // struct ContractionOrder
+
+  } // namespace expressions
+} // namespace TiledArray
+
+#endif // TILEDARRAY_EXPRESSIONS_CONTRACTION_ORDER_H__INCLUDED
@@ -0,0 +1,273 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TILEDARRAY_EXPRESSIONS_EVAL_BLOCK_H__INCLUDED
+#define TILEDARRAY_EXPRESSIONS_EVAL_BLOCK_H__INCLUDED
+
+#include <TiledArray/error.h>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace TiledArray {
+  namespace expressions {
+
+    /// Deferred evaluation of a block of expression assignments
+
+    /// While an \c EvalBlock object is in scope, expression assignments to
+    /// arrays and array blocks are recorded instead of evaluated. The
+    /// recorded assignments are evaluated in order by \c wait() , or by the
+    /// destructor, as one dataflow graph: each assignment is started as soon
+    /// as the previous one has been started, the tiles of its arguments are
+    /// consumed as soon as they are computed, and the block waits once for
+    /// all of them at the end. For example,
+    /// \code
+    /// {
+    ///   TiledArray::expressions::EvalBlock block;
+    ///   t("i,j") = a("i,k") * b("k,j");
+    ///   r("i,j") = t("i,j") + c("i,j");
+    ///   block.temporary(t);
+    /// } // t and r are evaluated here, then t is released
+    /// \endcode
+    /// Arrays that are declared with \c temporary() are intermediates: they
+    /// are released at the end of the block, and if one is read by exactly
+    /// one argument after it is assigned, that argument consumes its tiles
+    /// (e.g. the element-wise operation that reads it works in place).
+    /// \note Assigned arrays must not be used outside of assignments (e.g.
+    /// with \c find() or in reductions) before the block is evaluated, and
+    /// the arrays and shapes referenced by the recorded expressions must
+    /// outlive the block. Blocks must be constructed in the same order on
+    /// all processes, and they may not be nested.
+    class EvalBlock {
+    private:
+
+      enum class Phase { collect, count, run };
+
+      /// The state of an array that is used by the block
+      struct ArrayInfo {
+        std::size_t reads = 0ul; ///< The number of arguments that read the array
+        std::size_t first_write = std::numeric_limits<std::size_t>::max();
+            ///< The first assignment to the array
+        bool temporary = false; ///< The array is an intermediate
+      }; // struct ArrayInfo
+
+      /// Recorded assignment; it is evaluated when called with \c true ,
+      /// otherwise only its expression engine is constructed
+      typedef std::function<void(bool)> statement_type;
+
+      Phase phase_; ///< The current evaluation phase
+      std::size_t current_; ///< The assignment that is being processed
+      std::vector<statement_type> statements_; ///< The recorded assignments
+      std::unordered_map<const void*, ArrayInfo> arrays_; ///< Used arrays
+      std::vector<std::function<void()> > waits_; ///< Evaluations to wait for
+      std::vector<std::function<void()> > releases_; ///< Temporary release functions
+
+      static EvalBlock*& current_block() {
+        static EvalBlock* block = nullptr;
+        return block;
+      }
+
+      /// Discard the recorded assignments and resume recording
+      void reset() {
+        phase_ = Phase::collect;
+        current_ = 0ul;
+        statements_.clear();
+        arrays_.clear();
+        waits_.clear();
+        releases_.clear();
+      }
+
+      /// \return \c true if the stack is being unwound by an exception
+      static bool unwinding() {
+#if __cplusplus >= 201703L
+        return std::uncaught_exceptions() > 0;
+#else
+        return std::uncaught_exception();
+#endif
+      }
+
+      // not allowed
+      EvalBlock(const EvalBlock&);
+      EvalBlock& operator=(const EvalBlock&);
+
+    public:
+
+      /// Start recording expression assignments
+      EvalBlock() :
+        phase_(Phase::collect), current_(0ul), statements_(), arrays_(),
+        waits_(), releases_()
+      {
+        TA_ASSERT(current_block() == nullptr);
+        current_block() = this;
+      }
+
+      /// Evaluate the recorded assignments and stop recording
+
+      /// When the block is left by an exception, the recorded assignments are
+      /// discarded instead of evaluated.
+      /// \throw anything Any exception thrown by \c wait()
+      ~EvalBlock() noexcept(false) {
+        if(! unwinding()) {
+          try {
+            wait();
+          } catch(...) {
+            current_block() = nullptr;
+            throw;
+          }
+        }
+        current_block() = nullptr;
+      }
+
+      /// The active evaluation block
+
+      /// \return A pointer to the evaluation block in scope, or \c nullptr
+      static EvalBlock* current() { return current_block(); }
+
+      /// Query the recording state
+
+      /// \return \c true if assignments are recorded
+      bool collecting() const { return phase_ == Phase::collect; }
+
+      /// Query the evaluation state
+
+      /// \return \c true if the recorded assignments are being evaluated
+      bool running() const { return phase_ == Phase::run; }
+
+      /// Number of recorded assignments
+
+      /// \return The number of assignments that will be evaluated by
+      /// \c wait()
+      std::size_t size() const { return statements_.size(); }
+
+      /// Declare an intermediate array
+
+      /// \tparam A The array type
+      /// \param array An array that is only used inside this block; it is
+      /// released at the end of \c wait()
+      template <typename A>
+      void temporary(A& array) {
+        arrays_[& array].temporary = true;
+        releases_.emplace_back([&array] () { array = A(); });
+      }
+
+      /// Record an assignment
+
+      /// \tparam E The expression type
+      /// \tparam T The assignment target type
+      /// \param expr The expression
+      /// \param target The target array or array block expression
+      template <typename E, typename T>
+      void defer(const E& expr, const T& target) {
+        TA_ASSERT(collecting());
+        ArrayInfo& info = arrays_[& target.array()];
+        if(info.first_write > statements_.size())
+          info.first_write = statements_.size();
+
+        statements_.emplace_back([expr, target = T(target)] (const bool run) mutable {
+          if(run) {
+            expr.eval_to(target);
+          } else {
+            typename E::engine_type engine(expr);
+          }
+        });
+      }
+
+      /// Register an argument array
+
+      /// This function is called for each array argument of an expression.
+      /// \param array The argument array
+      /// \return \c true if the tiles of \c array may be consumed by the
+      /// argument
+      static bool read(const void* array) {
+        EvalBlock* const block = current_block();
+        if(! block)
+          return false;
+
+        if(block->phase_ == Phase::count) {
+          ++block->arrays_[array].reads;
+        } else if(block->phase_ == Phase::run) {
+          const auto it = block->arrays_.find(array);
+          return (it != block->arrays_.end()) && it->second.temporary &&
+              (it->second.reads == 1ul) &&
+              (it->second.first_write < block->current_);
+        }
+
+        return false;
+      }
+
+      /// Defer the wait for a distributed evaluator to the end of the block
+
+      /// \tparam D The distributed evaluator type
+      /// \param dist_eval The distributed evaluator of an assignment
+      template <typename D>
+      void wait_later(const D& dist_eval) {
+        TA_ASSERT(running());
+        waits_.emplace_back([dist_eval] () { dist_eval.wait(); });
+      }
+
+      /// Evaluate the recorded assignments
+
+      /// Assignments that are made after this call are recorded again. If an
+      /// assignment throws, the remaining assignments are discarded, the
+      /// assignments that have been started are waited for, the temporaries
+      /// are not released, and the first exception is rethrown.
+      /// \throw anything Any exception thrown by an assignment
+      void wait() {
+        TA_ASSERT(collecting());
+
+        try {
+          // Count the arguments that read each array
+          phase_ = Phase::count;
+          for(current_ = 0ul; current_ < statements_.size(); ++current_)
+            statements_[current_](false);
+
+          // Start the evaluation of all assignments, then wait for them
+          phase_ = Phase::run;
+          for(current_ = 0ul; current_ < statements_.size(); ++current_)
+            statements_[current_](true);
+          for(auto& wait : waits_)
+            wait();
+
+          for(auto& release : releases_)
+            release();
+        } catch(...) {
+          // Join the evaluations that have been started, so that their tasks
+          // do not write to the arrays after the block is reset; the first
+          // exception is rethrown.
+          const std::exception_ptr error = std::current_exception();
+          for(auto& wait : waits_) {
+            try {
+              wait();
+            } catch(...) { }
+          }
+          reset();
+          std::rethrow_exception(error);
+        }
+
+        reset();
+      }
+
+    }; // class EvalBlock
+
+  }  // namespace expressions
+} // namespace TiledArray
+
+#endif // TILEDARRAY_EXPRESSIONS_EVAL_BLOCK_H__INCLUDED
@@ -27,6 +27,8 @@
 #define TILEDARRAY_EXPRESSIONS_EXPR_H__INCLUDED
 
 #include "expr_engine.h"
+#include "eval_block.h"
+#include "contraction_order.h"
 #include "../reduce_task.h"
 #include "../tile_interface/cast.h"
 #include "../tile_interface/scale.h"
@@ -48,7 +50,7 @@ namespace TiledArray {
     template <typename Engine>
     struct EngineParamOverride {
 
-      EngineParamOverride() : world(nullptr), pmap(), shape(nullptr) {}
+      EngineParamOverride() : world(nullptr), pmap(), shape(nullptr), max_memory(0ul) {}
 
       typedef typename EngineTrait<Engine>::policy policy; ///< The result policy type
       typedef typename EngineTrait<Engine>::shape_type shape_type; ///< Tensor shape type
@@ -57,6 +59,7 @@ namespace TiledArray {
        World* world;
        std::shared_ptr<pmap_interface> pmap;
        const shape_type* shape;
+       std::size_t max_memory; ///< Memory budget in bytes (0 = default)
     };
 
     /// \brief type trait checks if T has array() member
@@ -135,6 +138,24 @@ namespace TiledArray {
         }
         return derived();
       }
+      /// \param max_memory the maximum memory, in bytes, that the contraction
+      /// evaluated by this expression may use on each process for broadcast
+      /// argument tiles
+      /// \note This only affects contraction expressions, e.g.
+      /// \code
+      /// c("i,j") = (a("i,k") * b("k,j")).set_max_memory(1ul << 30);
+      /// \endcode
+      /// The budget overrides the limit given by \c TA_SUMMA_MAX_MEMORY and
+      /// it is not applied to contractions nested inside this expression.
+      Expr<Derived>& set_max_memory(const std::size_t max_memory) {
+        if (override_ptr_) {
+          override_ptr_->max_memory = max_memory;
+        } else {
+          override_ptr_ = std::make_shared<override_type>();
+          override_ptr_->max_memory = max_memory;
+        }
+        return derived();
+      }
 
     private:
 
@@ -279,7 +300,10 @@ namespace TiledArray {
 
       /// This expression is evaluated in parallel in distributed environments,
       /// where the content of \c tsr will be replaced by the results of the
-      /// evaluated tensor expression.
+      /// evaluated tensor expression. Inside an \c EvalBlock , the assignment
+      /// is recorded and evaluated with the rest of the block. Chains of
+      /// contractions are evaluated in their cheapest order (see
+      /// \c ContractionOrder ).
       /// \tparam A The array type
       /// \tparam Alias Tile alias flag
       /// \param tsr The tensor to be assigned
@@ -288,6 +312,17 @@ namespace TiledArray {
         static_assert(! is_lazy_tile<typename A::value_type>::value,
             "Assignment to an array of lazy tiles is not supported.");
 
+        EvalBlock* const block = EvalBlock::current();
+        if(block && block->collecting()) {
+          block->defer(derived(), tsr);
+          return;
+        }
+
+        // Evaluate a chain of contractions in a cheaper order
+        if(! override_ptr_ &&
+            ContractionOrder<derived_type>::eval_to(derived(), tsr))
+          return;
+
         // Get the target world
         // 1. result's world is assigned, use it
         // 2. if this expression's world was assigned by set_world(), use it
@@ -299,7 +334,8 @@ namespace TiledArray {
 
         // Get the output process map.
         // If result's pmap is assigned use it as the initial guess
-        // it will be assigned in engine.init
+        // it will be assigned in engine.init, otherwise the engine may
+        // balance the cost of the result tiles
         std::shared_ptr<typename TsrExpr<A, Alias>::array_type::pmap_interface> pmap;
         if(tsr.array().is_initialized())
           pmap = tsr.array().pmap();
@@ -309,7 +345,8 @@ namespace TiledArray {
 
         // Construct the expression engine
         engine_type engine(derived());
-        engine.init(world, pmap, target_vars);
+        engine.init(world, pmap, target_vars,
+            TiledArray::detail::balanced_pmap());
 
         // Create the distributed evaluator from this expression
         typename engine_type::dist_eval_type dist_eval = engine.make_dist_eval();
@@ -326,8 +363,12 @@ namespace TiledArray {
             set_tile(result, index, dist_eval.get(index));
         }
 
-        // Wait for child expressions of dist_eval
-        dist_eval.wait();
+        // Wait for child expressions of dist_eval, or let the evaluation block
+        // wait for them with the rest of the block
+        if(block && block->running())
+          block->wait_later(dist_eval);
+        else
+          dist_eval.wait();
 
         // Swap the new array with the result array object.
         result.swap(tsr.array());
@@ -351,6 +392,12 @@ namespace TiledArray {
         static_assert(! is_lazy_tile<typename A::value_type>::value,
             "Assignment to an array of lazy tiles is not supported.");
 
+        EvalBlock* const block = EvalBlock::current();
+        if(block && block->collecting()) {
+          block->defer(derived(), tsr);
+          return;
+        }
+
 #ifndef NDEBUG
         // Check that the array has been initialized.
         if(! tsr.array().is_initialized()) {
@@ -422,7 +469,10 @@ namespace TiledArray {
         }
 
         // Wait for child expressions of dist_eval
-        dist_eval.wait();
+        if(block && block->running())
+          block->wait_later(dist_eval);
+        else
+          dist_eval.wait();
 
         // Swap the new array with the result array object.
         result.swap(tsr.array());
@@ -479,21 +529,31 @@ namespace TiledArray {
         typename engine_type::dist_eval_type dist_eval = engine.make_dist_eval();
         dist_eval.eval();
 
-        // Create a local reduction task
+        // Move the data from dist_eval into a local reduction task
+        auto reduce_tiles = [&dist_eval] (auto& reduce_task) {
+          typename engine_type::dist_eval_type::pmap_interface::const_iterator it =
+              dist_eval.pmap()->begin();
+          const typename engine_type::dist_eval_type::pmap_interface::const_iterator end =
+              dist_eval.pmap()->end();
+          for(; it != end; ++it)
+            if(! dist_eval.is_zero(*it))
+              reduce_task.add(dist_eval.get(*it));
+          return reduce_task.submit();
+        };
+
+        // Reduce the local tiles and all reduce the result of the expression
         reduction_op_type wrapped_op(op);
-        TiledArray::detail::ReduceTask<reduction_op_type> reduce_task(world, wrapped_op);
-
-        // Move the data from dist_eval into the local reduction task
-        typename engine_type::dist_eval_type::pmap_interface::const_iterator it =
-            dist_eval.pmap()->begin();
-        const typename engine_type::dist_eval_type::pmap_interface::const_iterator end =
-            dist_eval.pmap()->end();
-        for(; it != end; ++it)
-          if(! dist_eval.is_zero(*it))
-            reduce_task.add(dist_eval.get(*it));
-
-        // All reduce the result of the expression
-        auto result = world.gop.all_reduce(key_type(dist_eval.id()), reduce_task.submit(), op);
+        Future<typename Op::result_type> result;
+        if(math::reproducible_reduce()) {
+          TiledArray::detail::OrderedReduceTask<reduction_op_type>
+              reduce_task(world, wrapped_op);
+          result = TiledArray::detail::reproducible_all_reduce(world,
+              key_type(dist_eval.id()), reduce_tiles(reduce_task), op);
+        } else {
+          TiledArray::detail::ReduceTask<reduction_op_type> reduce_task(world, wrapped_op);
+          result = world.gop.all_reduce(key_type(dist_eval.id()),
+              reduce_tiles(reduce_task), op);
+        }
         dist_eval.wait();
         return result;
       }
@@ -550,31 +610,41 @@ namespace TiledArray {
         }
 #endif // NDEBUG
 
-        // Create a local reduction task
-        reduction_op_type wrapped_op(op);
-        TiledArray::detail::ReducePairTask<reduction_op_type>
-            local_reduce_task(world, wrapped_op);
-
-        // Move the data from dist_eval into the local reduction task
-        typename engine_type::dist_eval_type::pmap_interface::const_iterator it =
-            left_dist_eval.pmap()->begin();
-        const typename engine_type::dist_eval_type::pmap_interface::const_iterator end =
-            left_dist_eval.pmap()->end();
-        for(; it != end; ++it) {
-          const typename engine_type::size_type index = *it;
-          const bool left_not_zero = !left_dist_eval.is_zero(index);
-          const bool right_not_zero = !right_dist_eval.is_zero(index);
-
-          if(left_not_zero && right_not_zero) {
-            local_reduce_task.add(left_dist_eval.get(index), right_dist_eval.get(index));
-          } else {
-            if(left_not_zero) left_dist_eval.get(index);
-            if(right_not_zero) right_dist_eval.get(index);
+        // Move the data from dist_eval into a local reduction task
+        auto reduce_tiles = [&left_dist_eval, &right_dist_eval] (auto& local_reduce_task) {
+          typename engine_type::dist_eval_type::pmap_interface::const_iterator it =
+              left_dist_eval.pmap()->begin();
+          const typename engine_type::dist_eval_type::pmap_interface::const_iterator end =
+              left_dist_eval.pmap()->end();
+          for(; it != end; ++it) {
+            const typename engine_type::size_type index = *it;
+            const bool left_not_zero = !left_dist_eval.is_zero(index);
+            const bool right_not_zero = !right_dist_eval.is_zero(index);
+
+            if(left_not_zero && right_not_zero) {
+              local_reduce_task.add(left_dist_eval.get(index), right_dist_eval.get(index));
+            } else {
+              if(left_not_zero) left_dist_eval.get(index);
+              if(right_not_zero) right_dist_eval.get(index);
+            }
           }
-        }
+          return local_reduce_task.submit();
+        };
 
-        auto result = world.gop.all_reduce(key_type(left_dist_eval.id()),
-            local_reduce_task.submit(), op);
+        // Reduce the local tiles and all reduce the result of the expression
+        reduction_op_type wrapped_op(op);
+        Future<typename Op::result_type> result;
+        if(math::reproducible_reduce()) {
+          TiledArray::detail::OrderedReducePairTask<reduction_op_type>
+              local_reduce_task(world, wrapped_op);
+          result = TiledArray::detail::reproducible_all_reduce(world,
+              key_type(left_dist_eval.id()), reduce_tiles(local_reduce_task), op);
+        } else {
+          TiledArray::detail::ReducePairTask<reduction_op_type>
+              local_reduce_task(world, wrapped_op);
+          result = world.gop.all_reduce(key_type(left_dist_eval.id()),
+              reduce_tiles(local_reduce_task), op);
+        }
         left_dist_eval.wait();
         right_dist_eval.wait();
         return result;
@@ -28,6 +28,7 @@
 
 #include <TiledArray/madness.h>
 #include <TiledArray/expressions/expr_trace.h>
+#include <TiledArray/pmap/cost_pmap.h>
 
 namespace TiledArray {
   namespace expressions {
@@ -89,8 +90,11 @@ namespace TiledArray {
       /// \param world The world where the expression will be evaluated
       /// \param pmap The process map for the result tensor (may be NULL)
       /// \param target_vars The target variable list of the result tensor
+      /// \param balance If \c true and no valid process map is given, the
+      /// result tiles are distributed with a \c CostPmap built from the result
+      /// shape, and the arguments are redistributed to match
       void init(World& world, std::shared_ptr<pmap_interface> pmap,
-          const VariableList& target_vars)
+          const VariableList& target_vars, const bool balance = false)
       {
         if(target_vars.dim()) {
           derived().init_vars(target_vars);
@@ -114,6 +118,10 @@ namespace TiledArray {
             pmap_.reset();
         }
 
+        // Balance the cost of the result tiles
+        if(! pmap_ && balance)
+          pmap_ = TiledArray::detail::make_cost_pmap(*world_, trange_, shape_);
+
         derived().init_distribution(world_, pmap_);
       }
 
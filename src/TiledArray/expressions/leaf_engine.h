@@ -27,6 +27,7 @@
 #define TILEDARRAY_EXPRESSIONS_LEAF_ENGINE_H__INCLUDED
 
 #include <TiledArray/expressions/expr_engine.h>
+#include <TiledArray/expressions/eval_block.h>
 #include <TiledArray/dist_eval/array_eval.h>
 
 namespace TiledArray {
@@ -72,6 +73,7 @@ namespace TiledArray {
       using ExprEngine_::permute_tiles_;
 
       array_type array_; ///< The array object
+      bool consume_; ///< If \c true , the local tiles of \c array_ may be consumed
 
     public:
 
@@ -81,7 +83,8 @@ namespace TiledArray {
       template <typename D>
       LeafEngine(const Expr<D>& expr) :
         ExprEngine_(expr),
-        array_(expr.derived().array())
+        array_(expr.derived().array()),
+        consume_(EvalBlock::read(& expr.derived().array()))
       {
         vars_ = VariableList(expr.derived().vars());
       }
@@ -160,7 +163,7 @@ namespace TiledArray {
         /// Create the pimpl for the distributed evaluator
         std::shared_ptr<impl_type> pimpl =
             std::make_shared<impl_type>(array_, *world_, trange_, shape_, pmap_,
-                                        perm_, ExprEngine_::make_op());
+                                        perm_, ExprEngine_::make_op(), consume_);
 
         return dist_eval_type(pimpl);
       }
@@ -123,10 +123,14 @@ namespace TiledArray {
     /// Multiplication expression engine
 
     /// This implements any expression encoded with the multiplication operator. This
-    /// includes Hadamard product, e.g. \code (c("i,j")=)a("i,j")*b("i,j") \endcode , and
-    /// pure contractions, e.g. \code (c("i,j")=)a("i,k")*b("k,j") \endcode .
-    /// \internal mixed Hadamard-contraction case, e.g. \code c("i,j,l")=a("i,l,k")*b("j,l,k") \endcode , is not supported since
-    ///   this requires that the result labels are assigned by user (currently they are computed by this engine)
+    /// includes Hadamard product, e.g. \code (c("i,j")=)a("i,j")*b("i,j") \endcode ,
+    /// pure contractions, e.g. \code (c("i,j")=)a("i,k")*b("k,j") \endcode , and
+    /// the mixed Hadamard-contraction case, e.g.
+    /// \code c("i,j,l")=a("i,l,k")*b("j,l,k") \endcode .
+    /// \internal The mixed case is only recognized when the result labels are
+    ///   assigned by the user, i.e. when the target variable list is known
+    ///   (see \c ContEngine::init_hadamard_vars() ); otherwise the shared
+    ///   variables are contracted.
     /// \tparam Left The left-hand engine type
     /// \tparam Right The right-hand engine type
     /// \tparam Result The result tile type
@@ -214,8 +218,10 @@ namespace TiledArray {
           BinaryEngine_::perm_vars(target_vars);
         } else {
           contract_ = true;
-          ContEngine_::init_vars();
-          ContEngine_::perm_vars(target_vars);
+          if(! ContEngine_::init_hadamard_vars(target_vars)) {
+            ContEngine_::init_vars();
+            ContEngine_::perm_vars(target_vars);
+          }
         }
       }
 
@@ -430,8 +436,10 @@ namespace TiledArray {
           BinaryEngine_::perm_vars(target_vars);
         } else {
           contract_ = true;
-          ContEngine_::init_vars();
-          ContEngine_::perm_vars(target_vars);
+          if(! ContEngine_::init_hadamard_vars(target_vars)) {
+            ContEngine_::init_vars();
+            ContEngine_::perm_vars(target_vars);
+          }
         }
       }
 
@@ -0,0 +1,416 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TILEDARRAY_MATH_FIXED_KERNELS_H__INCLUDED
+#define TILEDARRAY_MATH_FIXED_KERNELS_H__INCLUDED
+
+#include <TiledArray/error.h>
+#include <TiledArray/math/eigen.h>
+#include <TiledArray/math/vector_op.h>
+
+namespace TiledArray {
+  namespace math {
+
+    /// A list of extents for which specialized kernels are compiled
+
+    /// \tparam Ns The extents
+    template <std::size_t... Ns>
+    struct FixedExtents {
+      static constexpr std::size_t size = sizeof...(Ns); ///< The number of extents
+    }; // struct FixedExtents
+
+    /// The extents of the fixed-extent kernel registry
+
+    /// The registry is empty unless \c TILEDARRAY_FIXED_TILE_EXTENTS is
+    /// defined as a comma-separated list of extents (set with the CMake
+    /// variable \c TA_FIXED_TILE_EXTENTS , e.g. <tt>8,16,32</tt>). Every
+    /// kernel below is instantiated for each extent, and the GEMM kernel for
+    /// each combination of three extents, so the list should be short.
+#ifdef TILEDARRAY_FIXED_TILE_EXTENTS
+    typedef FixedExtents<TILEDARRAY_FIXED_TILE_EXTENTS> fixed_extents;
+#else
+    typedef FixedExtents<> fixed_extents;
+#endif // TILEDARRAY_FIXED_TILE_EXTENTS
+
+    template <typename> struct FixedExtentDispatch;
+
+    /// Fixed extent dispatch helper class
+
+    /// This object terminates the search of the extent list.
+    template <>
+    struct FixedExtentDispatch<FixedExtents<> > {
+
+      static constexpr bool contains(const std::size_t) { return false; }
+
+      template <typename Op, typename... Args>
+      static bool call(const std::size_t, Op&&, Args&&...) { return false; }
+
+    }; // struct FixedExtentDispatch
+
+    /// Fixed extent dispatch helper class
+
+    /// This object searches the extent list for a runtime extent, and calls
+    /// the kernel that is specialized for that extent.
+    /// \tparam N The first extent of the list
+    /// \tparam Ns The remaining extents of the list
+    template <std::size_t N, std::size_t... Ns>
+    struct FixedExtentDispatch<FixedExtents<N, Ns...> > {
+
+      typedef FixedExtentDispatch<FixedExtents<Ns...> > FixedExtentDispatchN1;
+
+      /// Check that an extent is in the list
+
+      /// \param n The extent
+      /// \return \c true if \c n is in the list
+      static constexpr bool contains(const std::size_t n) {
+        return (n == N) || FixedExtentDispatchN1::contains(n);
+      }
+
+      /// Call a kernel specialized for an extent
+
+      /// \tparam Op The kernel type
+      /// \tparam Args The kernel argument types
+      /// \param n The runtime extent
+      /// \param op The kernel, which is called as
+      /// <tt>op(std::integral_constant<std::size_t, n>(), args...)</tt>
+      /// \param args The kernel arguments
+      /// \return \c false if \c n is not in the list, otherwise the value
+      /// returned by \c op
+      template <typename Op, typename... Args>
+      static bool call(const std::size_t n, Op&& op, Args&&... args) {
+        if(n == N)
+          return op(std::integral_constant<std::size_t, N>(),
+              std::forward<Args>(args)...);
+        return FixedExtentDispatchN1::call(n, std::forward<Op>(op),
+            std::forward<Args>(args)...);
+      }
+
+    }; // struct FixedExtentDispatch
+
+    typedef FixedExtentDispatch<fixed_extents> FixedDispatch;
+
+    /// Stride-one extent of a range with specialized kernels
+
+    /// \tparam Range The range type
+    /// \param range The range
+    /// \return The extent of the last dimension of \c range if every extent
+    /// of \c range is in \c fixed_extents , otherwise zero
+    template <typename Range>
+    inline std::size_t fixed_inner_extent(const Range& range) {
+      const unsigned int rank = range.rank();
+      if((fixed_extents::size == 0ul) || (rank == 0u))
+        return 0ul;
+      const auto* MADNESS_RESTRICT const extent = range.extent_data();
+      for(unsigned int i = 0u; i < rank; ++i)
+        if(! FixedDispatch::contains(extent[i]))
+          return 0ul;
+      return extent[rank - 1u];
+    }
+
+    // Element-wise kernels --------------------------------------------------
+    //
+    // The data is processed as rows of N elements, where N is the stride-one
+    // extent of the tensor. The inner loop has a compile time trip count, so
+    // it is fully vectorized, and there is no tail loop.
+
+    /// Fixed extent in-place vector operation kernel
+    struct FixedInplaceVectorOp {
+      template <std::size_t N, typename Op, typename Result, typename... Args>
+      bool operator()(std::integral_constant<std::size_t, N>, Op& op,
+          const std::size_t n, Result* const result, const Args* const... args) const
+      {
+        TA_ASSERT((n % N) == 0ul);
+        for(std::size_t offset = 0ul; offset < n; offset += N) {
+          Result* MADNESS_RESTRICT const result_row = result + offset;
+          for(std::size_t i = 0ul; i < N; ++i)
+            op(result_row[i], args[offset + i]...);
+        }
+        return true;
+      }
+    }; // struct FixedInplaceVectorOp
+
+    /// Fixed extent vector pointer operation kernel
+    struct FixedVectorPtrOp {
+      template <std::size_t N, typename Op, typename Result, typename... Args>
+      bool operator()(std::integral_constant<std::size_t, N>, Op& op,
+          const std::size_t n, Result* const result, const Args* const... args) const
+      {
+        TA_ASSERT((n % N) == 0ul);
+        for(std::size_t offset = 0ul; offset < n; offset += N) {
+          Result* MADNESS_RESTRICT const result_row = result + offset;
+          for(std::size_t i = 0ul; i < N; ++i)
+            op(result_row + i, args[offset + i]...);
+        }
+        return true;
+      }
+    }; // struct FixedVectorPtrOp
+
+    /// Fixed extent reduction kernel
+    struct FixedReduceOp {
+      template <std::size_t N, typename Op, typename Result, typename... Args>
+      bool operator()(std::integral_constant<std::size_t, N>, Op& op,
+          const std::size_t n, Result& result, const Args* const... args) const
+      {
+        TA_ASSERT((n % N) == 0ul);
+        for(std::size_t offset = 0ul; offset < n; offset += N) {
+          Result temp = result;
+          for(std::size_t i = 0ul; i < N; ++i)
+            op(temp, args[offset + i]...);
+          result = temp;
+        }
+        return true;
+      }
+    }; // struct FixedReduceOp
+
+    /// Fixed extent in-place vector operation
+
+    /// \param op The element-wise operation, <tt>op(result[i], args[i]...)</tt>
+    /// \param inner The stride-one extent
+    /// \param n The number of elements, a multiple of \c inner
+    /// \param result The result data
+    /// \param args The argument data
+    /// \return \c false if there is no kernel for \c inner , in which case
+    /// nothing is done
+    template <typename Op, typename Result, typename... Args>
+    inline bool fixed_inplace_vector_op(Op&& op, const std::size_t inner,
+        const std::size_t n, Result* const result, const Args* const... args)
+    {
+      return FixedDispatch::call(inner, FixedInplaceVectorOp(), op, n, result, args...);
+    }
+
+    /// Fixed extent vector pointer operation
+
+    /// \param op The element-wise operation, <tt>op(result + i, args[i]...)</tt>
+    /// \param inner The stride-one extent
+    /// \param n The number of elements, a multiple of \c inner
+    /// \param result The result data
+    /// \param args The argument data
+    /// \return \c false if there is no kernel for \c inner , in which case
+    /// nothing is done
+    template <typename Op, typename Result, typename... Args>
+    inline bool fixed_vector_ptr_op(Op&& op, const std::size_t inner,
+        const std::size_t n, Result* const result, const Args* const... args)
+    {
+      return FixedDispatch::call(inner, FixedVectorPtrOp(), op, n, result, args...);
+    }
+
+    /// Fixed extent reduction
+
+    /// \param op The element-wise reduction, <tt>op(result, args[i]...)</tt>
+    /// \param inner The stride-one extent
+    /// \param n The number of elements, a multiple of \c inner
+    /// \param[in,out] result The reduction target
+    /// \param args The argument data
+    /// \return \c false if there is no kernel for \c inner , in which case
+    /// nothing is done
+    template <typename Op, typename Result, typename... Args>
+    inline bool fixed_reduce_op(Op&& op, const std::size_t inner,
+        const std::size_t n, Result& result, const Args* const... args)
+    {
+      return FixedDispatch::call(inner, FixedReduceOp(), op, n, result, args...);
+    }
+
+    // Transpose kernel ------------------------------------------------------
+
+    /// Fixed extent matrix transpose kernel
+
+    /// The \c M x \c N argument matrix is transposed into a buffer with
+    /// compile time strides, and the buffer is copied into the result.
+    struct FixedTranspose {
+
+      /// Dispatch the column extent
+      template <std::size_t M, typename InputOp, typename OutputOp,
+          typename Result, typename... Args>
+      bool operator()(std::integral_constant<std::size_t, M> m, InputOp& input_op,
+          OutputOp& output_op, const std::size_t n, const std::size_t result_stride,
+          Result* const result, const std::size_t arg_stride,
+          const Args* const... args) const
+      {
+        return FixedDispatch::call(n, *this, m, input_op, output_op,
+            result_stride, result, arg_stride, args...);
+      }
+
+      /// Transpose an \c M x \c N matrix
+      template <std::size_t N, std::size_t M, typename InputOp, typename OutputOp,
+          typename Result, typename... Args>
+      bool operator()(std::integral_constant<std::size_t, N>,
+          std::integral_constant<std::size_t, M>, InputOp& input_op,
+          OutputOp& output_op, const std::size_t result_stride,
+          Result* const result, const std::size_t arg_stride,
+          const Args* const... args) const
+      {
+        TILEDARRAY_ALIGNED_STORAGE Result temp[M * N];
+
+        for(std::size_t i = 0ul; i < M; ++i) {
+          const std::size_t offset = i * arg_stride;
+          for(std::size_t j = 0ul; j < N; ++j)
+            temp[j * M + i] = input_op(args[offset + j]...);
+        }
+
+        for(std::size_t j = 0ul; j < N; ++j) {
+          Result* MADNESS_RESTRICT const result_j = result + (j * result_stride);
+          const Result* MADNESS_RESTRICT const temp_j = temp + (j * M);
+          for(std::size_t i = 0ul; i < M; ++i)
+            output_op(result_j + i, temp_j[i]);
+        }
+
+        return true;
+      }
+
+    }; // struct FixedTranspose
+
+    /// Fixed extent matrix transpose
+
+    /// The arguments are the same as for \c math::transpose .
+    /// \return \c false if there is no kernel for \c m or \c n , in which
+    /// case nothing is done
+    template <typename InputOp, typename OutputOp, typename Result, typename... Args>
+    inline bool fixed_transpose(InputOp&& input_op, OutputOp&& output_op,
+        const std::size_t m, const std::size_t n,
+        const std::size_t result_stride, Result* const result,
+        const std::size_t arg_stride, const Args* const... args)
+    {
+      return FixedDispatch::call(m, FixedTranspose(), input_op, output_op, n,
+          result_stride, result, arg_stride, args...);
+    }
+
+    // GEMM kernel -----------------------------------------------------------
+
+    /// Fixed extent matrix multiplication kernel
+
+    /// The matrices are mapped to fixed size Eigen matrices, for which Eigen
+    /// generates fully unrolled and vectorized products.
+    struct FixedGemm {
+
+      /// Eigen storage order of an \c R x \c C row-major matrix
+      template <std::size_t R, std::size_t C>
+      using matrix_type_order = std::integral_constant<int,
+          ((C == 1ul) && (R != 1ul) ? Eigen::ColMajor : Eigen::RowMajor)>;
+
+      /// Fixed size row-major matrix type
+      template <typename T, std::size_t R, std::size_t C>
+      using matrix_type = Eigen::Matrix<T, int(R), int(C),
+          matrix_type_order<R, C>::value>;
+
+      /// Dispatch the column extent of the result
+      template <std::size_t M, typename... Args>
+      bool operator()(std::integral_constant<std::size_t, M> m,
+          const integer n, const integer k, Args&&... args) const
+      {
+        return FixedDispatch::call(n, *this, m, k, std::forward<Args>(args)...);
+      }
+
+      /// Dispatch the inner extent
+      template <std::size_t N, std::size_t M, typename... Args>
+      bool operator()(std::integral_constant<std::size_t, N> n,
+          std::integral_constant<std::size_t, M> m, const integer k,
+          Args&&... args) const
+      {
+        return FixedDispatch::call(k, *this, n, m, std::forward<Args>(args)...);
+      }
+
+      /// Compute <tt>c = alpha * op(a) * op(b) + beta * c</tt>
+      template <std::size_t K, std::size_t N, std::size_t M,
+          typename S1, typename T, typename S2>
+      bool operator()(std::integral_constant<std::size_t, K>,
+          std::integral_constant<std::size_t, N>,
+          std::integral_constant<std::size_t, M>,
+          const madness::cblas::CBLAS_TRANSPOSE op_a,
+          const madness::cblas::CBLAS_TRANSPOSE op_b, const S1 alpha,
+          const T* const a, const T* const b, const S2 beta, T* const c) const
+      {
+        const bool trans_a = (op_a == madness::cblas::Trans);
+        const bool trans_b = (op_b == madness::cblas::Trans);
+
+        Eigen::Map<matrix_type<T, M, N> > C(c);
+        if(beta == static_cast<S2>(0))
+          C.setZero();
+        else if(beta != static_cast<S2>(1))
+          C *= static_cast<T>(beta);
+
+        if(trans_a) {
+          Eigen::Map<const matrix_type<T, K, M> > A(a);
+          if(trans_b) {
+            Eigen::Map<const matrix_type<T, N, K> > B(b);
+            C.noalias() += alpha * A.transpose() * B.transpose();
+          } else {
+            Eigen::Map<const matrix_type<T, K, N> > B(b);
+            C.noalias() += alpha * A.transpose() * B;
+          }
+        } else {
+          Eigen::Map<const matrix_type<T, M, K> > A(a);
+          if(trans_b) {
+            Eigen::Map<const matrix_type<T, N, K> > B(b);
+            C.noalias() += alpha * A * B.transpose();
+          } else {
+            Eigen::Map<const matrix_type<T, K, N> > B(b);
+            C.noalias() += alpha * A * B;
+          }
+        }
+
+        return true;
+      }
+
+    }; // struct FixedGemm
+
+    template <typename S1, typename T1, typename T2, typename S2, typename T3>
+    inline bool fixed_gemm(const madness::cblas::CBLAS_TRANSPOSE,
+        const madness::cblas::CBLAS_TRANSPOSE, const integer, const integer,
+        const integer, const S1, const T1* const, const T2* const, const S2,
+        T3* const, std::false_type)
+    {
+      return false;
+    }
+
+    template <typename S1, typename T, typename S2>
+    inline bool fixed_gemm(const madness::cblas::CBLAS_TRANSPOSE op_a,
+        const madness::cblas::CBLAS_TRANSPOSE op_b, const integer m,
+        const integer n, const integer k, const S1 alpha, const T* const a,
+        const T* const b, const S2 beta, T* const c, std::true_type)
+    {
+      if((op_a == madness::cblas::ConjTrans) || (op_b == madness::cblas::ConjTrans))
+        return false;
+      return FixedDispatch::call(m, FixedGemm(), n, k, op_a, op_b, alpha, a,
+          b, beta, c);
+    }
+
+    /// Fixed extent matrix multiplication
+
+    /// Compute <tt>c = alpha * op(a) * op(b) + beta * c</tt> for packed,
+    /// row-major matrices, i.e. the leading dimensions are implied by
+    /// \c m , \c n , and \c k .
+    /// \return \c false if there is no kernel for \c m , \c n , or \c k , or
+    /// if the element types differ or an operation is \c ConjTrans , in
+    /// which case nothing is done
+    template <typename S1, typename T1, typename T2, typename S2, typename T3>
+    inline bool fixed_gemm(const madness::cblas::CBLAS_TRANSPOSE op_a,
+        const madness::cblas::CBLAS_TRANSPOSE op_b, const integer m,
+        const integer n, const integer k, const S1 alpha, const T1* const a,
+        const T2* const b, const S2 beta, T3* const c)
+    {
+      return fixed_gemm(op_a, op_b, m, n, k, alpha, a, b, beta, c,
+          std::integral_constant<bool, std::is_same<T1, T2>::value
+          && std::is_same<T1, T3>::value
+          && TiledArray::detail::is_numeric<T3>::value>());
+    }
+
+  }  // namespace math
+} // namespace TiledArray
+
+#endif // TILEDARRAY_MATH_FIXED_KERNELS_H__INCLUDED
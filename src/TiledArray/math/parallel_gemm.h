@@ -27,143 +27,215 @@
 #define TILEDARRAY_PARALLEL_GEMM_H__INCLUDED
 
 #include <TiledArray/madness.h>
-#include <TiledArray/vector_op.h>
-#include <TiledArray/blas.h>
-
-#define TILEDARRAY_DYNAMIC_BLOCK_SIZE std::numeric_limits<std::size_t>::max();
+#include <TiledArray/math/blas.h>
+#include <TiledArray/utility.h>
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
 
 namespace TiledArray {
   namespace math {
 
-//#ifdef HAVE_INTEL_TBB
-
-
-    template <typename T, integer Size>
-    class MatrixBlockTask : public tbb::task {
-
-      const integer rows_;
-      const integer cols_;
-      T* data_;
-      const integer ld_;
-      std::shared_ptr<T> result_;
-
-      /// Copy a \c Size^2 block from \c data to \c result
-
-      /// \param[out] result A pointer to the first element of the result block
-      /// \param[in] data A pointer to the first element of the block to be copied
-      /// \param[in] ld The leading dimension stride for the \c data block
-      void copy_block(T* result, const T* data, const integer ld) {
-        const T* const block_end = result + (TILEDARRAY_LOOP_UNWIND * Size);
-        for(; result < block_end; result += Size, data += ld)
-          TiledArray::math::copy_block(result, data);
-      }
-
-      /// Copy a rectangular \c m*n block from \c data to \c result
-
-      /// \param[in] m The number of rows to copy
-      /// \param[in] n The number of columns to copy
-      /// \param[out] result A pointer to the first element of the result block
-      /// \param[in] data A pointer to the first element of the block to be copied
-      /// \param[in] ld The leading dimension stride for the \c data block
-      void copy_block(const integer m, const integer n, T* result,
-          const T* data, const integer ld)
-      {
-        const T* const block_end = result + (m * Size);
-        for(; result < block_end; result += Size, data += ld)
-          TiledArray::math::copy_block(n, result, data);
-      }
-
-    public:
-      MatrixBlockTask(const integer rows, const integer cols,
-          const T* const data, const integer ld) :
-        rows_(rows), cols_(cols), data_(data), ld_(ld)
-      { }
-
-      /// Task body
-      virtual tbb::task* execut() {
-
-        // Compute block iteration limit
-        constexpr integer index_mask = ~integer(TILEDARRAY_LOOP_UNWIND - 1ul);
-        const integer mx = rows_ & index_mask; // = rows - rows % TILEDARRAY_LOOP_UNWIND
-        const integer nx = cols_ & index_mask; // = cols - cols % TILEDARRAY_LOOP_UNWIND
-        const integer m_tail = rows_ - mx;
-        const integer n_tail = cols_ - nx;
-
-        // Copy data into block_
-        integer i = 0ul;
-        T* result_i = result_.get();
-        const T* data_i = data_;
-        for(; i < mx; i += TILEDARRAY_LOOP_UNWIND, result_i += Size, data_i += ld_) {
-
-          integer j = 0ul;
-          for(; j < nx; j += TILEDARRAY_LOOP_UNWIND)
-            copy_block(result_i + j, data_i + j);
-
-          if(n_tail)
-            copy_block(TILEDARRAY_LOOP_UNWIND, n_tail, result_i + j, data_i + j);
+    /// Smallest number of rows or columns in a parallel GEMM block
+    constexpr integer parallel_gemm_min_block = 64;
+
+    /// Smallest \c m*n*k for which a GEMM is split among threads
+    constexpr double parallel_gemm_min_volume = 2097152.0; // = 128^3
+
+    namespace detail {
+
+      /// Shared state of a parallel matrix multiplication
+
+      /// The result matrix is partitioned into a grid of blocks, and each
+      /// block is computed by a serial \c math::gemm call on the
+      /// corresponding row panel of \c op(a) and column panel of \c op(b) ,
+      /// which the underlying BLAS or Eigen kernel packs for its
+      /// micro-kernel. Blocks are claimed, in order, by the calling thread and
+      /// by the helper tasks until none remain. Helper tasks that start after
+      /// all blocks have been claimed return without touching the matrices.
+      template <typename S1, typename T1, typename T2, typename S2, typename T3>
+      class ParallelGemm {
+        const madness::cblas::CBLAS_TRANSPOSE op_a_; ///< Operation applied to a
+        const madness::cblas::CBLAS_TRANSPOSE op_b_; ///< Operation applied to b
+        const integer m_, n_, k_; ///< The matrix dimensions
+        const S1 alpha_; ///< Scaling factor of a*b
+        const T1* const a_; ///< Left-hand matrix
+        const integer lda_; ///< Leading dimension of a
+        const T2* const b_; ///< Right-hand matrix
+        const integer ldb_; ///< Leading dimension of b
+        const S2 beta_; ///< Scaling factor of c
+        T3* const c_; ///< Result matrix
+        const integer ldc_; ///< Leading dimension of c
+        integer block_m_; ///< Number of rows in a block
+        integer block_n_; ///< Number of columns in a block
+        integer blocks_n_; ///< Number of block columns
+        integer nblocks_; ///< Total number of blocks
+        madness::AtomicInt next_; ///< The next block to be computed
+        madness::AtomicInt done_; ///< Number of computed blocks
+
+        /// Compute a block of the result matrix
+
+        /// \param block The ordinal index of the block
+        void compute(const integer block) const {
+          const integer i = (block / blocks_n_) * block_m_;
+          const integer j = (block % blocks_n_) * block_n_;
+          const integer m = std::min(block_m_, m_ - i);
+          const integer n = std::min(block_n_, n_ - j);
+
+          const T1* const a = a_ + (op_a_ == madness::cblas::NoTrans ? i * lda_ : i);
+          const T2* const b = b_ + (op_b_ == madness::cblas::NoTrans ? j : j * ldb_);
+          gemm(op_a_, op_b_, m, n, k_, alpha_, a, lda_, b, ldb_, beta_,
+              c_ + (i * ldc_ + j), ldc_);
         }
 
-        if(m_tail) {
-
-          integer j = 0ul;
-          for(; j < nx; j += TILEDARRAY_LOOP_UNWIND)
-            copy_block(m_tail, TILEDARRAY_LOOP_UNWIND, result_i + j, data_i + j);
-
-          if(n_tail)
-            copy_block(m_tail, n_tail, result_i + j, data_i + j);
-
+      public:
+
+        ParallelGemm(const madness::cblas::CBLAS_TRANSPOSE op_a,
+            const madness::cblas::CBLAS_TRANSPOSE op_b, const integer m,
+            const integer n, const integer k, const S1 alpha, const T1* a,
+            const integer lda, const T2* b, const integer ldb, const S2 beta,
+            T3* c, const integer ldc, const integer threads) :
+          op_a_(op_a), op_b_(op_b), m_(m), n_(n), k_(k), alpha_(alpha),
+          a_(a), lda_(lda), b_(b), ldb_(ldb), beta_(beta), c_(c), ldc_(ldc)
+        {
+          // Partition the result into about two blocks per thread, splitting
+          // rows first so that blocks own whole cache lines of c.
+          const integer target = 2 * threads;
+          const integer blocks_m = std::max<integer>(1, std::min<integer>(target,
+              m_ / parallel_gemm_min_block));
+          blocks_n_ = std::max<integer>(1, std::min<integer>(target / blocks_m,
+              n_ / parallel_gemm_min_block));
+          block_m_ = (m_ + blocks_m - 1) / blocks_m;
+          block_n_ = (n_ + blocks_n_ - 1) / blocks_n_;
+          nblocks_ = ((m_ + block_m_ - 1) / block_m_) * blocks_n_;
+          next_ = 0;
+          done_ = 0;
         }
 
-        return nullptr;
-      }
+        /// \return The number of blocks in the result matrix
+        integer nblocks() const { return nblocks_; }
 
-      std::shared_ptr<T> result() {
-        constexpr integer size = Size * Size;
-        constexpr integer bytes = size * sizeof(T);
-
-        T* result_ptr = nullptr;
-        if(! posix_memalign(result_ptr, TILEARRAY_ALIGNMENT, bytes))
-          throw std::bad_alloc();
-
-        result_.reset(result_ptr);
-
-        return result_;
-      }
-
-    }; // class MatrixBlockTask
-
-
-    template <integer Size, typename C, typename A = C, typename B = C, typename Alpha = C, typename Beta = C>
-    class GemmTask : public tbb::task {
-      const madness::cblas::CBLAS_TRANSPOSE op_a_, op_b_;
-      const integer m_, n_, k_;
-      const Alpha alpha_;
-      std::shared_ptr<A> a_;
-      constexpr integer lda_ = Size;
-      std::shared_ptr<B> b_;
-      const Beta beta_;
-      std::shared_ptr<C> c_;
-      const integer ldc_;
-
-    public:
-
-
-      GemmTask(madness::cblas::CBLAS_TRANSPOSE op_a,
-          madness::cblas::CBLAS_TRANSPOSE op_b, const integer m, const integer n,
-          const integer k, const Alpha alpha, const std::shared_ptr<A>& a,
-          const std::shared_ptr<B>& b, const Beta beta,
-          const std::shared_ptr<C>& c, const integer ldc) :
-            op_a_(op_a), op_b_(op_b), m_(m), n_(n), k_(k), alpha_(alpha), a_(a),
-            b_(b), beta_(beta), c_(c), ldc_(c)
-      { }
+        /// Compute blocks until all blocks have been claimed
+        void run() {
+          for(integer block = next_++; block < nblocks_; block = next_++) {
+            compute(block);
+            ++done_;
+          }
+        }
 
-      virtual tbb::task execute() {
-        gemm(op_a_, op_b_, m_, n_, k_, alpha_, a_.get(), Size, b_.get(), Size, c_, ldc_);
+        /// \return \c true when all blocks have been computed
+        bool finished() { return done_ == nblocks_; }
+
+      }; // class ParallelGemm
+
+      /// Thread pool task that helps to compute a parallel GEMM
+      template <typename State>
+      class ParallelGemmTask : public madness::PoolTaskInterface {
+        std::shared_ptr<State> state_;
+
+      public:
+        ParallelGemmTask(const std::shared_ptr<State>& state) :
+          madness::PoolTaskInterface(madness::TaskAttributes::hipri()),
+          state_(state)
+        { }
+
+        virtual ~ParallelGemmTask() { }
+
+        virtual void run(const madness::TaskThreadEnv&) { state_->run(); }
+
+      }; // class ParallelGemmTask
+
+    } // namespace detail
+
+    /// Parallel GEMM control flag
+
+    /// Parallel GEMM can be disabled by setting the environment variable
+    /// \c TA_PARALLEL_GEMM to 0, e.g. when the BLAS library is threaded.
+    /// \return \c true if tile GEMMs may be split among threads
+    inline bool parallel_gemm_enabled() {
+      static const bool result =
+          TiledArray::detail::env_flag("TA_PARALLEL_GEMM", true);
+      return result;
+    }
+
+    /// Select the number of threads for a GEMM
+
+    /// A GEMM is split among threads only when it is large enough and there
+    /// are idle threads in the MADNESS thread pool, i.e. when there are fewer
+    /// queued tasks than pool threads.
+    /// \param m The number of rows of the result
+    /// \param n The number of columns of the result
+    /// \param k The number of inner products per element of the result
+    /// \return The number of threads, including the calling thread, that
+    /// should evaluate the GEMM
+    inline integer parallel_gemm_threads(const integer m, const integer n,
+        const integer k)
+    {
+      if(! parallel_gemm_enabled())
+        return 1;
+      if((double(m) * double(n) * double(k)) < parallel_gemm_min_volume)
+        return 1;
+      if(std::max(m, n) < (2 * parallel_gemm_min_block))
+        return 1;
+
+      const integer idle = integer(madness::ThreadPool::size()) -
+          integer(madness::ThreadPool::queue_size());
+      return 1 + std::max<integer>(idle, 0);
+    }
+
+    /// Multithreaded matrix multiplication
+
+    /// Compute \c c=alpha*op(a)*op(b)+beta*c with \c threads threads. The
+    /// blocks of \c c are computed by the calling thread and \c threads-1
+    /// helper tasks that are submitted to the MADNESS thread pool. The
+    /// arguments and data layout are those of \c math::gemm .
+    /// \param threads The number of threads that compute the product
+    template <typename S1, typename T1, typename T2, typename S2, typename T3>
+    inline void parallel_gemm(const integer threads,
+        madness::cblas::CBLAS_TRANSPOSE op_a,
+        madness::cblas::CBLAS_TRANSPOSE op_b, const integer m, const integer n,
+        const integer k, const S1 alpha, const T1* a, const integer lda,
+        const T2* b, const integer ldb, const S2 beta, T3* c, const integer ldc)
+    {
+      typedef detail::ParallelGemm<S1, T1, T2, S2, T3> state_type;
+
+      if(threads > 1) {
+        auto state = std::make_shared<state_type>(op_a, op_b, m, n, k, alpha,
+            a, lda, b, ldb, beta, c, ldc, threads);
+        const integer helpers = std::min(threads, state->nblocks()) - 1;
+        if(helpers > 0) {
+          for(integer i = 0; i < helpers; ++i)
+            madness::ThreadPool::add(new detail::ParallelGemmTask<state_type>(state));
+
+          // Compute blocks on this thread, then wait for the blocks that
+          // are computed by the helpers.
+          state->run();
+          while(! state->finished())
+            std::this_thread::yield();
+          return;
+        }
       }
 
-    }; // class GemmTask
-
-//#endif // HAVE_INTEL_TBB
+      gemm(op_a, op_b, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+    }
+
+    /// Matrix multiplication with runtime thread selection
+
+    /// Large products are split among the idle threads of the MADNESS thread
+    /// pool (see \c parallel_gemm_threads ); other products are evaluated by
+    /// \c math::gemm on the calling thread. The arguments and data layout are
+    /// those of \c math::gemm .
+    template <typename S1, typename T1, typename T2, typename S2, typename T3>
+    inline void parallel_gemm(madness::cblas::CBLAS_TRANSPOSE op_a,
+        madness::cblas::CBLAS_TRANSPOSE op_b, const integer m, const integer n,
+        const integer k, const S1 alpha, const T1* a, const integer lda,
+        const T2* b, const integer ldb, const S2 beta, T3* c, const integer ldc)
+    {
+      parallel_gemm(parallel_gemm_threads(m, n, k), op_a, op_b, m, n, k, alpha,
+          a, lda, b, ldb, beta, c, ldc);
+    }
 
   }  // namespace math
 } // namespace TiledArray
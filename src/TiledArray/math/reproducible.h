@@ -0,0 +1,153 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TILEDARRAY_MATH_REPRODUCIBLE_H__INCLUDED
+#define TILEDARRAY_MATH_REPRODUCIBLE_H__INCLUDED
+
+#include <TiledArray/madness.h>
+#include <TiledArray/utility.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#ifdef HAVE_INTEL_TBB
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#endif // HAVE_INTEL_TBB
+
+namespace TiledArray {
+  namespace detail {
+
+    inline std::atomic<bool>& reproducible_reduce_flag() {
+      static std::atomic<bool> flag(env_flag("TA_REPRODUCIBLE_REDUCE", false));
+      return flag;
+    }
+
+  } // namespace detail
+
+  namespace math {
+
+    /// The number of elements in a block of a reproducible reduction
+    constexpr std::size_t reproducible_reduce_block_size = 4096ul;
+
+    /// Reproducible reductions (\c TA_REPRODUCIBLE_REDUCE , default off)
+
+    /// By default, parallel reductions combine partial results in the order
+    /// they become ready, so the result of a floating point reduction may
+    /// differ in the last bits from run to run. In reproducible mode,
+    /// reductions use a fixed order that depends only on the data layout:
+    /// \li vectors are split into blocks of
+    /// \c reproducible_reduce_block_size elements and the block results are
+    /// combined with a fixed pairwise tree, independent of the number of
+    /// threads;
+    /// \li the tile results of an expression reduction are combined with a
+    /// pairwise tree in tile ordinal order;
+    /// \li the results of the processes are combined with a pairwise tree
+    /// in rank order.
+    ///
+    /// The results are bitwise identical for runs with the same number of
+    /// processes, tiling, and SIMD instruction set (see \c simd::isa() ).
+    /// Element-wise reductions of large tiles are not slower in
+    /// this mode; expression reductions wait for the tile results in order,
+    /// which limits the overlap of communication and computation (see the
+    /// \c ta_reduce example for a measurement).
+    /// \return \c true if reductions are reproducible
+    inline bool reproducible_reduce() {
+      return TiledArray::detail::reproducible_reduce_flag().load(std::memory_order_relaxed);
+    }
+
+    /// Enable or disable reproducible reductions
+
+    /// \param enable The new value of the reproducible reduction flag
+    /// \return The previous value of the flag
+    /// \sa reproducible_reduce()
+    inline bool set_reproducible_reduce(const bool enable) {
+      return TiledArray::detail::reproducible_reduce_flag().exchange(enable);
+    }
+
+    /// Combine values with a fixed pairwise tree
+
+    /// The shape of the tree only depends on the number of values: in the
+    /// first level, element \c 2i+1 is joined into element \c 2i , in the
+    /// second level element \c 4i+2 into element \c 4i , and so on.
+    /// \tparam T The value type
+    /// \tparam JoinOp The join operation type
+    /// \param join_op The join operation, which is called as
+    /// <tt>join_op(left, right)</tt> and stores the result in \c left
+    /// \param values The values to be combined; the result is stored in the
+    /// first element
+    template <typename T, typename JoinOp>
+    void tree_reduce(JoinOp&& join_op, std::vector<T>& values) {
+      for(std::size_t stride = 1ul; stride < values.size(); stride <<= 1)
+        for(std::size_t i = 0ul; (i + stride) < values.size(); i += (stride << 1))
+          join_op(values[i], values[i + stride]);
+    }
+
+    /// Reproducible block reduction
+
+    /// The range <tt>[0, n)</tt> is split into blocks of
+    /// \c reproducible_reduce_block_size elements, which are reduced in
+    /// parallel when TBB is available, and the block results are combined
+    /// with \c tree_reduce .
+    /// \tparam Result The result type
+    /// \tparam BlockOp The block reduction type
+    /// \tparam JoinOp The join operation type
+    /// \param n The number of elements
+    /// \param identity The identity of the reduction
+    /// \param block_op The block reduction, which is called as
+    /// <tt>block_op(result, first, size)</tt> with \c result initialized to
+    /// \c identity
+    /// \param join_op The join operation, which is called as
+    /// <tt>join_op(left, right)</tt> and stores the result in \c left
+    /// \return The reduced value
+    template <typename Result, typename BlockOp, typename JoinOp>
+    Result reproducible_reduce_blocks(const std::size_t n, const Result& identity,
+        BlockOp&& block_op, JoinOp&& join_op)
+    {
+      const std::size_t block_size = reproducible_reduce_block_size;
+      const std::size_t nblocks = (n + block_size - 1ul) / block_size;
+      if(nblocks == 0ul)
+        return identity;
+
+      std::vector<Result> results(nblocks, identity);
+      auto reduce_block = [&] (const std::size_t b) {
+        const std::size_t first = b * block_size;
+        block_op(results[b], first, std::min(block_size, n - first));
+      };
+
+#ifdef HAVE_INTEL_TBB
+      tbb::parallel_for(tbb::blocked_range<std::size_t>(0ul, nblocks),
+          [&reduce_block] (const tbb::blocked_range<std::size_t>& blocks) {
+            for(std::size_t b = blocks.begin(); b != blocks.end(); ++b)
+              reduce_block(b);
+          });
+#else
+      for(std::size_t b = 0ul; b < nblocks; ++b)
+        reduce_block(b);
+#endif // HAVE_INTEL_TBB
+
+      tree_reduce(join_op, results);
+      return results.front();
+    }
+
+  } // namespace math
+} // namespace TiledArray
+
+#endif // TILEDARRAY_MATH_REPRODUCIBLE_H__INCLUDED
@@ -0,0 +1,741 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TILEDARRAY_MATH_SIMD_H__INCLUDED
+#define TILEDARRAY_MATH_SIMD_H__INCLUDED
+
+#include <TiledArray/math/vector_op.h>
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+
+// Packs are written with the vector extensions of GCC and Clang, which the
+// compiler lowers to the instruction set of the function they are inlined
+// into. Other compilers use scalar packs.
+#if defined(__GNUC__) || defined(__clang__)
+#define TILEDARRAY_SIMD_VECTOR_EXTENSIONS 1
+#endif
+
+// On x86-64 the kernels are also compiled for AVX2 and AVX-512, and the
+// instruction set is selected at run time.
+#if defined(TILEDARRAY_ENABLE_SIMD) && defined(TILEDARRAY_SIMD_VECTOR_EXTENSIONS) \
+    && defined(__x86_64__) && ! defined(__INTEL_COMPILER)
+#define TILEDARRAY_SIMD_DISPATCH 1
+#endif
+
+namespace TiledArray {
+  namespace math {
+    namespace simd {
+
+      /// Instruction sets of the vector kernels
+      enum class Isa {
+        portable = 0, ///< The baseline instruction set of the build
+        avx2 = 1,     ///< AVX2 and FMA
+        avx512 = 2    ///< AVX-512F
+      };
+
+      /// Element types supported by the vector kernels
+
+      /// Real and complex kernels are the same, since a complex array is
+      /// processed as an array of real numbers with twice the size.
+      /// \tparam T The element type
+      template <typename T>
+      struct is_vector_type : public std::false_type { };
+
+      template <>
+      struct is_vector_type<float> : public std::true_type { };
+
+      template <>
+      struct is_vector_type<double> : public std::true_type { };
+
+      template <typename T>
+      struct is_vector_type<std::complex<T> > : public is_vector_type<T> { };
+
+      /// Real element types supported by the vector kernels
+
+      /// Reductions that do not decompose into reductions of the real and
+      /// imaginary parts (e.g. \c abs_max ) are only provided for real types.
+      /// \tparam T The element type
+      template <typename T>
+      struct is_real_vector_type : public std::false_type { };
+
+      template <>
+      struct is_real_vector_type<float> : public std::true_type { };
+
+      template <>
+      struct is_real_vector_type<double> : public std::true_type { };
+
+      /// Select the instruction set of the vector kernels
+
+      /// The widest instruction set that is supported by the CPU is used. It
+      /// may be limited by setting the environment variable \c TA_SIMD to
+      /// \c portable , \c avx2 , or \c avx512 .
+      /// \return The instruction set used by the kernels
+      inline Isa isa() {
+        static const Isa result = [] () {
+          Isa supported = Isa::portable;
+#ifdef TILEDARRAY_SIMD_DISPATCH
+          __builtin_cpu_init();
+          if(__builtin_cpu_supports("avx512f"))
+            supported = Isa::avx512;
+          else if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+            supported = Isa::avx2;
+#endif // TILEDARRAY_SIMD_DISPATCH
+
+          const char* limit = getenv("TA_SIMD");
+          if(limit) {
+            const std::string name(limit);
+            const Isa requested = (name == "portable" ? Isa::portable :
+                (name == "avx2" ? Isa::avx2 : Isa::avx512));
+            if(requested < supported)
+              supported = requested;
+          }
+
+          return supported;
+        }();
+        return result;
+      }
+
+      namespace detail {
+
+        /// Scalar pack
+
+        /// A pack holds the elements processed by one vector instruction.
+        /// This is the fallback for compilers without vector extensions.
+        /// \tparam T The element type
+        /// \tparam Bytes The size of the pack in bytes
+        template <typename T, std::size_t Bytes>
+        struct Pack {
+          typedef T type; ///< The pack type
+          static constexpr std::size_t size = 1ul; ///< Elements per pack
+
+          static TILEDARRAY_FORCE_INLINE T reduce_add(const type& a) { return a; }
+
+          static TILEDARRAY_FORCE_INLINE T reduce_max(const type& a) { return a; }
+
+          static TILEDARRAY_FORCE_INLINE T reduce_min(const type& a) { return a; }
+
+          static TILEDARRAY_FORCE_INLINE void max(type& a, const type& b) {
+            a = (a < b ? b : a);
+          }
+
+          static TILEDARRAY_FORCE_INLINE void min(type& a, const type& b) {
+            a = (b < a ? b : a);
+          }
+
+        }; // struct Pack
+
+#ifdef TILEDARRAY_SIMD_VECTOR_EXTENSIONS
+
+        /// Vector pack
+
+        /// \tparam T The element type
+        /// \tparam Vector The vector type, which holds \c Bytes bytes
+        template <typename T, typename Vector>
+        struct VectorPack {
+          typedef Vector type; ///< The pack type
+          typedef decltype(type() < type()) mask_type; ///< Comparison result type
+          static constexpr std::size_t size = sizeof(type) / sizeof(T); ///< Elements per pack
+
+          static TILEDARRAY_FORCE_INLINE T reduce_add(const type& a) {
+            T result = a[0];
+            for(std::size_t i = 1ul; i < size; ++i)
+              result += a[i];
+            return result;
+          }
+
+          static TILEDARRAY_FORCE_INLINE T reduce_max(const type& a) {
+            T result = a[0];
+            for(std::size_t i = 1ul; i < size; ++i)
+              result = (result < a[i] ? a[i] : result);
+            return result;
+          }
+
+          static TILEDARRAY_FORCE_INLINE T reduce_min(const type& a) {
+            T result = a[0];
+            for(std::size_t i = 1ul; i < size; ++i)
+              result = (a[i] < result ? a[i] : result);
+            return result;
+          }
+
+          static TILEDARRAY_FORCE_INLINE void max(type& a, const type& b) {
+            const mask_type mask = a < b;
+            a = (type)((mask & (mask_type)b) | (~mask & (mask_type)a));
+          }
+
+          static TILEDARRAY_FORCE_INLINE void min(type& a, const type& b) {
+            const mask_type mask = b < a;
+            a = (type)((mask & (mask_type)b) | (~mask & (mask_type)a));
+          }
+
+        }; // struct VectorPack
+
+        typedef float float16_type __attribute__((vector_size(16)));
+        typedef float float32_type __attribute__((vector_size(32)));
+        typedef float float64_type __attribute__((vector_size(64)));
+        typedef double double16_type __attribute__((vector_size(16)));
+        typedef double double32_type __attribute__((vector_size(32)));
+        typedef double double64_type __attribute__((vector_size(64)));
+
+        template <>
+        struct Pack<float, 16ul> : public VectorPack<float, float16_type> { };
+
+        template <>
+        struct Pack<float, 32ul> : public VectorPack<float, float32_type> { };
+
+        template <>
+        struct Pack<float, 64ul> : public VectorPack<float, float64_type> { };
+
+        template <>
+        struct Pack<double, 16ul> : public VectorPack<double, double16_type> { };
+
+        template <>
+        struct Pack<double, 32ul> : public VectorPack<double, double32_type> { };
+
+        template <>
+        struct Pack<double, 64ul> : public VectorPack<double, double64_type> { };
+
+#endif // TILEDARRAY_SIMD_VECTOR_EXTENSIONS
+
+        /// Vector kernels
+
+        /// The kernels are force inlined into the entry point of each
+        /// instruction set, so the packs are compiled for that instruction
+        /// set. Reductions use four independent accumulators to hide the
+        /// latency of the vector instructions.
+        /// \tparam T The real element type
+        /// \tparam Bytes The size of a pack in bytes
+        template <typename T, std::size_t Bytes>
+        struct Kernels {
+          typedef Pack<T, Bytes> pack;
+          typedef typename pack::type pack_type;
+          static constexpr std::size_t size = pack::size;
+
+          static TILEDARRAY_FORCE_INLINE void
+          load(pack_type& MADNESS_RESTRICT a, const T* MADNESS_RESTRICT const x) {
+            std::memcpy(&a, x, sizeof(pack_type));
+          }
+
+          static TILEDARRAY_FORCE_INLINE void
+          store(T* MADNESS_RESTRICT const x, const pack_type& MADNESS_RESTRICT a) {
+            std::memcpy(x, &a, sizeof(pack_type));
+          }
+
+          static TILEDARRAY_FORCE_INLINE void
+          add_to(const std::size_t n, const T* MADNESS_RESTRICT const x,
+              T* MADNESS_RESTRICT const y)
+          {
+            std::size_t i = 0ul;
+            for(; (i + size) <= n; i += size) {
+              pack_type a, b;
+              load(a, x + i);
+              load(b, y + i);
+              b += a;
+              store(y + i, b);
+            }
+            for(; i < n; ++i)
+              y[i] += x[i];
+          }
+
+          static TILEDARRAY_FORCE_INLINE void
+          axpy(const std::size_t n, const T alpha,
+              const T* MADNESS_RESTRICT const x, T* MADNESS_RESTRICT const y)
+          {
+            std::size_t i = 0ul;
+            for(; (i + size) <= n; i += size) {
+              pack_type a, b;
+              load(a, x + i);
+              load(b, y + i);
+              b += a * alpha;
+              store(y + i, b);
+            }
+            for(; i < n; ++i)
+              y[i] += x[i] * alpha;
+          }
+
+          static TILEDARRAY_FORCE_INLINE void
+          scale_to(const std::size_t n, const T alpha, T* MADNESS_RESTRICT const y) {
+            std::size_t i = 0ul;
+            for(; (i + size) <= n; i += size) {
+              pack_type a;
+              load(a, y + i);
+              a *= alpha;
+              store(y + i, a);
+            }
+            for(; i < n; ++i)
+              y[i] *= alpha;
+          }
+
+          /// Reduction kernel
+
+          /// \tparam Op The reduction operation type, which provides
+          /// <tt>Op::reduce(result, args...)</tt> , where \c args point to
+          /// the argument packs, and <tt>Op::join(result, arg)</tt>
+          /// \param n The number of elements
+          /// \param result The pack that holds the reduction
+          /// \param args The argument arrays
+          /// \return The number of elements that were reduced, which is a
+          /// multiple of the pack size
+          template <typename Op, typename... Args>
+          static TILEDARRAY_FORCE_INLINE std::size_t
+          reduce(const std::size_t n, pack_type& MADNESS_RESTRICT result,
+              const Args* MADNESS_RESTRICT const... args)
+          {
+            pack_type r1 = result, r2 = result, r3 = result;
+
+            std::size_t i = 0ul;
+            for(; (i + 4ul * size) <= n; i += 4ul * size) {
+              Op::reduce(result, (args + i)...);
+              Op::reduce(r1, (args + i + size)...);
+              Op::reduce(r2, (args + i + 2ul * size)...);
+              Op::reduce(r3, (args + i + 3ul * size)...);
+            }
+            for(; (i + size) <= n; i += size)
+              Op::reduce(result, (args + i)...);
+
+            Op::join(result, r1);
+            Op::join(r2, r3);
+            Op::join(result, r2);
+
+            return i;
+          }
+
+          struct SumReduce {
+            static TILEDARRAY_FORCE_INLINE void reduce(pack_type& r, const T* const x) {
+              pack_type a;
+              load(a, x);
+              r += a;
+            }
+            static TILEDARRAY_FORCE_INLINE void join(pack_type& r, const pack_type& a) { r += a; }
+          }; // struct SumReduce
+
+          struct DotReduce {
+            static TILEDARRAY_FORCE_INLINE void
+            reduce(pack_type& r, const T* const x, const T* const y) {
+              pack_type a, b;
+              load(a, x);
+              load(b, y);
+              r += a * b;
+            }
+            static TILEDARRAY_FORCE_INLINE void join(pack_type& r, const pack_type& a) { r += a; }
+          }; // struct DotReduce
+
+          struct SquaredNormReduce {
+            static TILEDARRAY_FORCE_INLINE void reduce(pack_type& r, const T* const x) {
+              pack_type a;
+              load(a, x);
+              r += a * a;
+            }
+            static TILEDARRAY_FORCE_INLINE void join(pack_type& r, const pack_type& a) { r += a; }
+          }; // struct SquaredNormReduce
+
+          struct AbsMaxReduce {
+            static TILEDARRAY_FORCE_INLINE void reduce(pack_type& r, const T* const x) {
+              pack_type a;
+              load(a, x);
+              pack::max(a, -a);
+              pack::max(r, a);
+            }
+            static TILEDARRAY_FORCE_INLINE void join(pack_type& r, const pack_type& a) { pack::max(r, a); }
+          }; // struct AbsMaxReduce
+
+          struct AbsMinReduce {
+            static TILEDARRAY_FORCE_INLINE void reduce(pack_type& r, const T* const x) {
+              pack_type a;
+              load(a, x);
+              pack::max(a, -a);
+              pack::min(r, a);
+            }
+            static TILEDARRAY_FORCE_INLINE void join(pack_type& r, const pack_type& a) { pack::min(r, a); }
+          }; // struct AbsMinReduce
+
+          static TILEDARRAY_FORCE_INLINE T
+          sum(const std::size_t n, const T* MADNESS_RESTRICT const x) {
+            pack_type result = pack_type();
+            std::size_t i = reduce<SumReduce>(n, result, x);
+            T s = pack::reduce_add(result);
+            for(; i < n; ++i)
+              s += x[i];
+            return s;
+          }
+
+          static TILEDARRAY_FORCE_INLINE T
+          dot(const std::size_t n, const T* MADNESS_RESTRICT const x,
+              const T* MADNESS_RESTRICT const y)
+          {
+            pack_type result = pack_type();
+            std::size_t i = reduce<DotReduce>(n, result, x, y);
+            T s = pack::reduce_add(result);
+            for(; i < n; ++i)
+              s += x[i] * y[i];
+            return s;
+          }
+
+          static TILEDARRAY_FORCE_INLINE T
+          squared_norm(const std::size_t n, const T* MADNESS_RESTRICT const x) {
+            pack_type result = pack_type();
+            std::size_t i = reduce<SquaredNormReduce>(n, result, x);
+            T s = pack::reduce_add(result);
+            for(; i < n; ++i)
+              s += x[i] * x[i];
+            return s;
+          }
+
+          static TILEDARRAY_FORCE_INLINE T
+          abs_max(const std::size_t n, const T* MADNESS_RESTRICT const x) {
+            pack_type result = pack_type();
+            std::size_t i = reduce<AbsMaxReduce>(n, result, x);
+            T s = pack::reduce_max(result);
+            for(; i < n; ++i)
+              s = std::max(s, std::abs(x[i]));
+            return s;
+          }
+
+          static TILEDARRAY_FORCE_INLINE T
+          abs_min(const std::size_t n, const T* MADNESS_RESTRICT const x) {
+            pack_type result = pack_type() + std::numeric_limits<T>::max();
+            std::size_t i = reduce<AbsMinReduce>(n, result, x);
+            T s = pack::reduce_min(result);
+            for(; i < n; ++i)
+              s = std::min(s, std::abs(x[i]));
+            return s;
+          }
+
+        }; // struct Kernels
+
+        // Kernel operations, which are passed to the instruction set entry
+        // points below
+
+        struct AddToOp {
+          template <std::size_t Bytes, typename T>
+          TILEDARRAY_FORCE_INLINE void
+          apply(const std::size_t n, const T* const x, T* const y) const {
+            Kernels<T, Bytes>::add_to(n, x, y);
+          }
+        }; // struct AddToOp
+
+        struct AxpyOp {
+          template <std::size_t Bytes, typename T>
+          TILEDARRAY_FORCE_INLINE void
+          apply(const std::size_t n, const T alpha, const T* const x, T* const y) const {
+            Kernels<T, Bytes>::axpy(n, alpha, x, y);
+          }
+        }; // struct AxpyOp
+
+        struct ScaleToOp {
+          template <std::size_t Bytes, typename T>
+          TILEDARRAY_FORCE_INLINE void
+          apply(const std::size_t n, const T alpha, T* const y) const {
+            Kernels<T, Bytes>::scale_to(n, alpha, y);
+          }
+        }; // struct ScaleToOp
+
+        struct SumOp {
+          template <std::size_t Bytes, typename T>
+          TILEDARRAY_FORCE_INLINE T apply(const std::size_t n, const T* const x) const {
+            return Kernels<T, Bytes>::sum(n, x);
+          }
+        }; // struct SumOp
+
+        struct DotOp {
+          template <std::size_t Bytes, typename T>
+          TILEDARRAY_FORCE_INLINE T
+          apply(const std::size_t n, const T* const x, const T* const y) const {
+            return Kernels<T, Bytes>::dot(n, x, y);
+          }
+        }; // struct DotOp
+
+        struct SquaredNormOp {
+          template <std::size_t Bytes, typename T>
+          TILEDARRAY_FORCE_INLINE T apply(const std::size_t n, const T* const x) const {
+            return Kernels<T, Bytes>::squared_norm(n, x);
+          }
+        }; // struct SquaredNormOp
+
+        struct AbsMaxOp {
+          template <std::size_t Bytes, typename T>
+          TILEDARRAY_FORCE_INLINE T apply(const std::size_t n, const T* const x) const {
+            return Kernels<T, Bytes>::abs_max(n, x);
+          }
+        }; // struct AbsMaxOp
+
+        struct AbsMinOp {
+          template <std::size_t Bytes, typename T>
+          TILEDARRAY_FORCE_INLINE T apply(const std::size_t n, const T* const x) const {
+            return Kernels<T, Bytes>::abs_min(n, x);
+          }
+        }; // struct AbsMinOp
+
+#ifdef TILEDARRAY_SIMD_DISPATCH
+
+        template <typename Op, typename... Args>
+        __attribute__((target("avx512f"))) decltype(auto)
+        apply_avx512(const Op& op, const Args... args) {
+          return op.template apply<64ul>(args...);
+        }
+
+        template <typename Op, typename... Args>
+        __attribute__((target("avx2,fma"))) decltype(auto)
+        apply_avx2(const Op& op, const Args... args) {
+          return op.template apply<32ul>(args...);
+        }
+
+#endif // TILEDARRAY_SIMD_DISPATCH
+
+        /// Call the kernel of the selected instruction set
+
+        /// \tparam Op The kernel operation type
+        /// \tparam Args The kernel argument types
+        /// \param op The kernel operation
+        /// \param args The kernel arguments
+        /// \return The result of the kernel
+        template <typename Op, typename... Args>
+        decltype(auto) apply(const Op& op, const Args... args) {
+#ifdef TILEDARRAY_SIMD_DISPATCH
+          switch(isa()) {
+            case Isa::avx512:
+              return apply_avx512(op, args...);
+            case Isa::avx2:
+              return apply_avx2(op, args...);
+            default:
+              break;
+          }
+#endif // TILEDARRAY_SIMD_DISPATCH
+          return op.template apply<16ul>(args...);
+        }
+
+        /// Apply an element-wise kernel to blocks of a range
+
+        /// \tparam Op The block operation type
+        /// \param n The number of elements
+        /// \param op The operation, which is called as <tt>op(first, size)</tt>
+        /// for each block
+        template <typename Op>
+        void for_each_block(const std::size_t n, Op&& op) {
+#ifdef HAVE_INTEL_TBB
+          tbb::parallel_for(SizeTRange(0ul, n),
+              [&op] (const SizeTRange& range) { op(range.begin(), range.size()); },
+              tbb::auto_partitioner());
+#else
+          op(0ul, n);
+#endif // HAVE_INTEL_TBB
+        }
+
+        /// Apply a reduction kernel to blocks of a range
+
+        /// The blocks have a fixed size in reproducible mode (see
+        /// \c reproducible_reduce() ).
+        /// \tparam Result The result type
+        /// \tparam Op The block reduction type
+        /// \tparam Join The join operation type
+        /// \param n The number of elements
+        /// \param identity The identity of the reduction
+        /// \param op The reduction, which is called as <tt>op(first, size)</tt>
+        /// for each block
+        /// \param join The operation that joins two block results
+        /// \return The reduced value
+        template <typename Result, typename Op, typename Join>
+        Result reduce_blocks(const std::size_t n, const Result identity,
+            Op&& op, Join&& join)
+        {
+          if(reproducible_reduce())
+            return reproducible_reduce_blocks(n, identity,
+                [&op, &join] (Result& result, const std::size_t first, const std::size_t size)
+                { result = join(result, op(first, size)); },
+                [&join] (Result& left, const Result& right) { left = join(left, right); });
+
+#ifdef HAVE_INTEL_TBB
+          return tbb::parallel_reduce(SizeTRange(0ul, n), identity,
+              [&op, &join] (const SizeTRange& range, const Result value)
+              { return join(value, op(range.begin(), range.size())); },
+              join, tbb::auto_partitioner());
+#else
+          return join(identity, op(0ul, n));
+#endif // HAVE_INTEL_TBB
+        }
+
+        /// The real element type of a (real or complex) vector element type
+        template <typename T>
+        struct real { typedef T type; };
+
+        template <typename T>
+        struct real<std::complex<T> > { typedef T type; };
+
+        template <typename T>
+        using real_t = typename real<T>::type;
+
+        /// \return The number of real elements in \c n elements of type \c T
+        template <typename T>
+        constexpr std::size_t real_size(const std::size_t n) {
+          return n * (sizeof(T) / sizeof(real_t<T>));
+        }
+
+        template <typename T>
+        const real_t<T>* real_data(const T* const x) {
+          return reinterpret_cast<const real_t<T>*>(x);
+        }
+
+        template <typename T>
+        real_t<T>* real_data(T* const x) {
+          return reinterpret_cast<real_t<T>*>(x);
+        }
+
+      } // namespace detail
+
+      /// Add a vector to another vector
+
+      /// Compute <tt>y[i] += x[i]</tt> .
+      /// \tparam T The element type
+      /// \param n The number of elements
+      /// \param x The vector that is added
+      /// \param y The result vector
+      template <typename T,
+          typename std::enable_if<is_vector_type<T>::value>::type* = nullptr>
+      void add_to(const std::size_t n, const T* const x, T* const y) {
+        const auto* const rx = detail::real_data(x);
+        auto* const ry = detail::real_data(y);
+        detail::for_each_block(detail::real_size<T>(n),
+            [=] (const std::size_t first, const std::size_t size)
+            { detail::apply(detail::AddToOp(), size, rx + first, ry + first); });
+      }
+
+      /// Add a scaled vector to another vector
+
+      /// Compute <tt>y[i] += alpha * x[i]</tt> .
+      /// \tparam T The element type
+      /// \param n The number of elements
+      /// \param alpha The real scaling factor
+      /// \param x The vector that is added
+      /// \param y The result vector
+      template <typename T,
+          typename std::enable_if<is_vector_type<T>::value>::type* = nullptr>
+      void axpy(const std::size_t n, const detail::real_t<T> alpha,
+          const T* const x, T* const y)
+      {
+        const auto* const rx = detail::real_data(x);
+        auto* const ry = detail::real_data(y);
+        detail::for_each_block(detail::real_size<T>(n),
+            [=] (const std::size_t first, const std::size_t size)
+            { detail::apply(detail::AxpyOp(), size, alpha, rx + first, ry + first); });
+      }
+
+      /// Scale a vector
+
+      /// Compute <tt>y[i] *= alpha</tt> .
+      /// \tparam T The element type
+      /// \param n The number of elements
+      /// \param alpha The real scaling factor
+      /// \param y The result vector
+      template <typename T,
+          typename std::enable_if<is_vector_type<T>::value>::type* = nullptr>
+      void scale_to(const std::size_t n, const detail::real_t<T> alpha, T* const y) {
+        auto* const ry = detail::real_data(y);
+        detail::for_each_block(detail::real_size<T>(n),
+            [=] (const std::size_t first, const std::size_t size)
+            { detail::apply(detail::ScaleToOp(), size, alpha, ry + first); });
+      }
+
+      /// Square of the vector 2-norm
+
+      /// \tparam T The element type
+      /// \param n The number of elements
+      /// \param x The vector
+      /// \return The sum of <tt>|x[i]|^2</tt>
+      template <typename T,
+          typename std::enable_if<is_vector_type<T>::value>::type* = nullptr>
+      detail::real_t<T> squared_norm(const std::size_t n, const T* const x) {
+        typedef detail::real_t<T> real_type;
+        const real_type* const rx = detail::real_data(x);
+        return detail::reduce_blocks(detail::real_size<T>(n), real_type(0),
+            [=] (const std::size_t first, const std::size_t size)
+            { return detail::apply(detail::SquaredNormOp(), size, rx + first); },
+            [] (const real_type l, const real_type r) { return l + r; });
+      }
+
+      /// Sum of vector elements
+
+      /// \tparam T The element type
+      /// \param n The number of elements
+      /// \param x The vector
+      /// \return The sum of <tt>x[i]</tt>
+      template <typename T,
+          typename std::enable_if<is_real_vector_type<T>::value>::type* = nullptr>
+      T sum(const std::size_t n, const T* const x) {
+        return detail::reduce_blocks(n, T(0),
+            [=] (const std::size_t first, const std::size_t size)
+            { return detail::apply(detail::SumOp(), size, x + first); },
+            [] (const T l, const T r) { return l + r; });
+      }
+
+      /// Vector dot product
+
+      /// \tparam T The element type
+      /// \param n The number of elements
+      /// \param x The left-hand vector
+      /// \param y The right-hand vector
+      /// \return The sum of <tt>x[i] * y[i]</tt>
+      template <typename T,
+          typename std::enable_if<is_real_vector_type<T>::value>::type* = nullptr>
+      T dot(const std::size_t n, const T* const x, const T* const y) {
+        return detail::reduce_blocks(n, T(0),
+            [=] (const std::size_t first, const std::size_t size)
+            { return detail::apply(detail::DotOp(), size, x + first, y + first); },
+            [] (const T l, const T r) { return l + r; });
+      }
+
+      /// Absolute maximum element
+
+      /// \tparam T The element type
+      /// \param n The number of elements
+      /// \param x The vector
+      /// \return The largest <tt>|x[i]|</tt> , or zero if \c n is zero
+      template <typename T,
+          typename std::enable_if<is_real_vector_type<T>::value>::type* = nullptr>
+      T abs_max(const std::size_t n, const T* const x) {
+        return detail::reduce_blocks(n, T(0),
+            [=] (const std::size_t first, const std::size_t size)
+            { return detail::apply(detail::AbsMaxOp(), size, x + first); },
+            [] (const T l, const T r) { return std::max(l, r); });
+      }
+
+      /// Absolute minimum element
+
+      /// \tparam T The element type
+      /// \param n The number of elements
+      /// \param x The vector
+      /// \return The smallest <tt>|x[i]|</tt> , or the largest value of \c T
+      /// if \c n is zero
+      template <typename T,
+          typename std::enable_if<is_real_vector_type<T>::value>::type* = nullptr>
+      T abs_min(const std::size_t n, const T* const x) {
+        return detail::reduce_blocks(n, std::numeric_limits<T>::max(),
+            [=] (const std::size_t first, const std::size_t size)
+            { return detail::apply(detail::AbsMinOp(), size, x + first); },
+            [] (const T l, const T r) { return std::min(l, r); });
+      }
+
+    } // namespace simd
+  } // namespace math
+} // namespace TiledArray
+
+#endif // TILEDARRAY_MATH_SIMD_H__INCLUDED
@@ -29,6 +29,7 @@
 #include <TiledArray/type_traits.h>
 #include <TiledArray/madness.h>
 #include <TiledArray/config.h>
+#include <TiledArray/math/reproducible.h>
 
 #define TILEDARRAY_LOOP_UNWIND ::TiledArray::math::LoopUnwind::value
 
@@ -636,11 +637,54 @@ namespace TiledArray {
     };
 #endif
 
+    /// Block reduction of a reproducible reduction
+
+    /// This object applies a serial reduction to a block of the arguments,
+    /// and is used by \c reproducible_reduce_blocks .
+    template <typename ReduceOp, typename... Args>
+    class ReduceBlockOp {
+    public:
+      ReduceBlockOp(ReduceOp& reduce_op, const Args* const... args) :
+        reduce_op_(reduce_op), args_(args...)
+      { }
+
+      template <typename Result>
+      void operator()(Result& result, const std::size_t first,
+          const std::size_t size) const
+      {
+        helper(result, first, size, std::make_index_sequence<sizeof...(Args)>());
+      }
+
+    private:
+
+      template <typename Result, std::size_t... Is>
+      void helper(Result& result, const std::size_t first, const std::size_t size,
+          const std::index_sequence<Is...>&) const
+      {
+        reduce_op_serial(reduce_op_, size, result, (std::get<Is>(args_) + first)...);
+      }
+
+      ReduceOp& reduce_op_;
+      std::tuple<const Args * const ...> args_;
+
+    }; // class ReduceBlockOp
+
+    /// Reduce vectors
+
+    /// The arguments are reduced in parallel when TBB is available. The
+    /// order of the reduction is undefined, unless reproducible reductions
+    /// are enabled (see \c reproducible_reduce() ).
     template <typename ReduceOp, typename JoinOp, typename Result, typename... Args>
     void reduce_op(ReduceOp&& reduce_op, JoinOp&& join_op, const Result& identity, const std::size_t n, Result& result,
                    const Args* const... args)
     {
-      //TODO implement reduce operation with TBB
+      if(reproducible_reduce()) {
+        join_op(result, reproducible_reduce_blocks(n, identity,
+            ReduceBlockOp<std::remove_reference_t<ReduceOp>, Args...>(reduce_op, args...),
+            join_op));
+        return;
+      }
+
 #ifdef HAVE_INTEL_TBB
         SizeTRange range(0, n);
 
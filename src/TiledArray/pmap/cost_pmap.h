@@ -0,0 +1,252 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TILEDARRAY_PMAP_COST_PMAP_H__INCLUDED
+#define TILEDARRAY_PMAP_COST_PMAP_H__INCLUDED
+
+#include <TiledArray/pmap/pmap.h>
+#include <TiledArray/tiled_range.h>
+#include <TiledArray/utility.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <numeric>
+#include <string>
+
+namespace TiledArray {
+  namespace detail {
+
+    inline std::atomic<bool>& balanced_pmap_flag() {
+      static std::atomic<bool> flag(env_flag("TA_BALANCED_PMAP", false));
+      return flag;
+    }
+
+    /// Cost-balance result process maps (\c TA_BALANCED_PMAP , default off)
+    inline bool balanced_pmap() {
+      return balanced_pmap_flag().load(std::memory_order_relaxed);
+    }
+
+    /// Enable or disable cost-balanced result process maps
+
+    /// \param enable The new value of the cost-balanced process map flag
+    /// \return The previous value of the flag
+    /// \sa balanced_pmap()
+    inline bool set_balanced_pmap(const bool enable) {
+      return balanced_pmap_flag().exchange(enable);
+    }
+
+    /// A cost-balanced process map
+
+    /// Map N tiles with costs \f$ c_i \f$ among P processes in contiguous
+    /// blocks of approximately equal cost, i.e. tile \f$ i \f$ is mapped to
+    /// process \f$ p \f$ when \f$ b_p \le i < b_{p+1} \f$. The block
+    /// boundary \f$ b_p \f$ is the index whose cost prefix sum,
+    /// \f$ \sum_{j<b_p} c_j \f$, is closest to \f$ p C / P \f$, where
+    /// \f$ C \f$ is the total cost. The blocks follow the tile ordinal order,
+    /// so each process holds a compact slab of the tile grid, and the cost of
+    /// a process differs from the average by at most the cost of one tile.
+    /// The boundaries are stored on every process, so \c owner() is an
+    /// \f$ O(\log P) \f$ search. When the total cost is zero, the tiles are
+    /// split as by \c BlockedPmap .
+    class CostPmap : public Pmap {
+    protected:
+
+      // Import Pmap protected variables
+      using Pmap::rank_; ///< The rank of this process
+      using Pmap::procs_; ///< The number of processes
+      using Pmap::size_; ///< The number of tiles mapped among all processes
+      using Pmap::local_; ///< A list of local tiles
+
+    private:
+
+      std::vector<size_type> first_; ///< First tile of each process's block
+      std::vector<double> cost_; ///< Total cost of each process's block
+
+    public:
+      typedef Pmap::size_type size_type; ///< Key type
+
+      /// Construct cost-balanced map
+
+      /// \param world The world where the tiles will be mapped
+      /// \param costs The cost of each tile; it must be the same on all
+      /// processes
+      CostPmap(World& world, const std::vector<double>& costs) :
+        Pmap(world, costs.size()), first_(procs_ + 1ul, 0ul), cost_(procs_, 0.0)
+      {
+        // Compute the cost prefix sums
+        std::vector<double> prefix(size_ + 1ul, 0.0);
+        for(size_type i = 0ul; i < size_; ++i) {
+          TA_ASSERT(costs[i] >= 0.0);
+          prefix[i + 1ul] = prefix[i] + costs[i];
+        }
+        const double total = prefix.back();
+
+        // Place each block boundary at the prefix sum that is closest to an
+        // even share of the total cost
+        first_.back() = size_;
+        for(size_type p = 1ul; p < procs_; ++p) {
+          size_type first = 0ul;
+          if(total > 0.0) {
+            const double target = total * double(p) / double(procs_);
+            first = std::lower_bound(prefix.begin(), prefix.end(), target)
+                - prefix.begin();
+            if((first > 0ul) && ((target - prefix[first - 1ul]) < (prefix[first] - target)))
+              --first;
+          } else {
+            first = p * (size_ / procs_) + std::min(p, size_ % procs_);
+          }
+          first_[p] = std::min(std::max(first, first_[p - 1ul]), size_);
+        }
+
+        for(size_type p = 0ul; p < procs_; ++p)
+          cost_[p] = prefix[first_[p + 1ul]] - prefix[first_[p]];
+
+        // Construct the list of local tiles
+        local_.reserve(first_[rank_ + 1ul] - first_[rank_]);
+        for(size_type tile = first_[rank_]; tile < first_[rank_ + 1ul]; ++tile) {
+          TA_ASSERT(CostPmap::owner(tile) == rank_);
+          local_.push_back(tile);
+        }
+      }
+
+      virtual ~CostPmap() { }
+
+      /// Maps \c tile to the processor that owns it
+
+      /// \param tile The tile to be queried
+      /// \return Processor that logically owns \c tile
+      virtual size_type owner(const size_type tile) const {
+        TA_ASSERT(tile < size_);
+        return std::upper_bound(first_.begin() + 1l, first_.end() - 1l, tile)
+            - (first_.begin() + 1l);
+      }
+
+
+      /// Check that the tile is owned by this process
+
+      /// \param tile The tile to be checked
+      /// \return \c true if \c tile is owned by this process, otherwise \c false .
+      virtual bool is_local(const size_type tile) const {
+        return ((tile >= first_[rank_]) && (tile < first_[rank_ + 1ul]));
+      }
+
+      /// Cost of a process
+
+      /// \param proc The process
+      /// \return The total cost of the tiles mapped to \c proc
+      double cost(const size_type proc) const {
+        TA_ASSERT(proc < procs_);
+        return cost_[proc];
+      }
+
+      /// Cost of this process
+
+      /// \return The total cost of the local tiles
+      double local_cost() const { return cost_[rank_]; }
+
+      /// Load imbalance
+
+      /// \return The ratio of the largest process cost to the average
+      /// process cost, which is 1 for a perfectly balanced map, or 1 when the
+      /// total cost is zero
+      double imbalance() const {
+        const double total = std::accumulate(cost_.begin(), cost_.end(), 0.0);
+        if(total <= 0.0)
+          return 1.0;
+        return *std::max_element(cost_.begin(), cost_.end())
+            * double(procs_) / total;
+      }
+
+    }; // class CostPmap
+
+    /// Load imbalance of a process map
+
+    /// \param pmap The process map
+    /// \param costs The cost of each tile of \c pmap
+    /// \return The ratio of the largest process cost to the average process
+    /// cost, or 1 when the total cost is zero
+    inline double load_imbalance(const Pmap& pmap, const std::vector<double>& costs) {
+      TA_ASSERT(costs.size() == pmap.size());
+      std::vector<double> proc_cost(pmap.procs(), 0.0);
+      for(std::size_t tile = 0ul; tile < costs.size(); ++tile)
+        proc_cost[pmap.owner(tile)] += costs[tile];
+
+      const double total = std::accumulate(proc_cost.begin(), proc_cost.end(), 0.0);
+      if(total <= 0.0)
+        return 1.0;
+      return *std::max_element(proc_cost.begin(), proc_cost.end())
+          * double(pmap.procs()) / total;
+    }
+
+    /// Tile costs of an array
+
+    /// The cost of a tile is its number of elements, or zero when the
+    /// shape marks the tile as zero, so that the costs reflect both the
+    /// sparsity and the tile sizes of a non-uniform tiling.
+    /// \tparam Shape The shape type
+    /// \param trange The tiled range of the array
+    /// \param shape The shape of the array
+    /// \return The cost of each tile
+    template <typename Shape>
+    std::vector<double> tile_costs(const TiledRange& trange, const Shape& shape) {
+      const auto& tiles_range = trange.tiles_range();
+      const unsigned int rank = tiles_range.rank();
+      std::vector<double> costs(tiles_range.volume(), 0.0);
+
+      // Iterate over the tile grid in ordinal order, and compute the tile
+      // volumes from the tile extents of each dimension
+      std::vector<std::size_t> index(tiles_range.lobound_data(),
+          tiles_range.lobound_data() + rank);
+      for(std::size_t ord = 0ul; ord < costs.size(); ++ord) {
+        if(! shape.is_zero(ord)) {
+          double volume = 1.0;
+          for(unsigned int d = 0u; d < rank; ++d)
+            volume *= double(trange.data()[d].tile(index[d]).second -
+                trange.data()[d].tile(index[d]).first);
+          costs[ord] = volume;
+        }
+
+        for(unsigned int d = rank; d > 0u; --d) {
+          if(++index[d - 1u] < std::size_t(tiles_range.upbound_data()[d - 1u]))
+            break;
+          index[d - 1u] = tiles_range.lobound_data()[d - 1u];
+        }
+      }
+
+      return costs;
+    }
+
+    /// Construct a cost-balanced process map for an array
+
+    /// \tparam Shape The shape type
+    /// \param world The world where the tiles will be mapped
+    /// \param trange The tiled range of the array
+    /// \param shape The shape of the array
+    /// \return A \c CostPmap with the costs given by \c tile_costs()
+    template <typename Shape>
+    std::shared_ptr<CostPmap>
+    make_cost_pmap(World& world, const TiledRange& trange, const Shape& shape) {
+      return std::make_shared<CostPmap>(world, tile_costs(trange, shape));
+    }
+
+  }  // namespace detail
+}  // namespace TiledArray
+
+
+#endif // TILEDARRAY_PMAP_COST_PMAP_H__INCLUDED
@@ -0,0 +1,135 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TILEDARRAY_PMAP_HADAMARD_PMAP_H__INCLUDED
+#define TILEDARRAY_PMAP_HADAMARD_PMAP_H__INCLUDED
+
+#include <TiledArray/pmap/pmap.h>
+#include <algorithm>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// Maps the tiles of a tensor with leading Hadamard dimensions onto processes
+
+    /// The tiles are indexed as \f$ (h, m, x) \f$ in row-major order, where
+    /// \f$ h \in [0,H) \f$ is the Hadamard tile and \f$ m \in [0,M) \f$ is the
+    /// row of the tile within its Hadamard slab. The Hadamard slabs are
+    /// distributed cyclically over \f$ P_h = \min(H, P) \f$ processes, and
+    /// the rows of each slab over \f$ S \f$ processes (see \c split() ):
+    /// tile \f$ (h, m, x) \f$ maps to process
+    /// \f$ (h \bmod P_h) + P_h (m \bmod S) \f$. When there are at least as
+    /// many Hadamard tiles as processes, \f$ S = 1 \f$, so every slab is held
+    /// by a single process.
+    ///
+    /// \note This class is used to map <em>tile</em> indices to processes.
+    class HadamardPmap : public Pmap {
+    protected:
+
+      // Import Pmap protected variables
+      using Pmap::rank_; ///< The rank of this process
+      using Pmap::procs_; ///< The number of processes
+      using Pmap::size_; ///< The number of tiles mapped among all processes
+      using Pmap::local_; ///< A list of local tiles
+
+    private:
+
+      const size_type h_; ///< The number of Hadamard tiles
+      const size_type m_; ///< The number of rows in each Hadamard slab
+      const size_type x_; ///< The number of tiles in each row
+      const size_type slab_procs_; ///< The number of processes that hold slabs
+      const size_type split_; ///< The number of processes per slab
+
+    public:
+      typedef Pmap::size_type size_type; ///< Size type
+
+      /// The number of processes that share a Hadamard slab
+
+      /// \param procs The number of processes
+      /// \param h The number of Hadamard tiles
+      /// \param m The number of rows in each Hadamard slab
+      /// \return The number of processes, per slab, that fit in \c procs ,
+      /// bounded by \c m ; 1 when \c h is not less than \c procs
+      static size_type split(const size_type procs, const size_type h,
+          const size_type m)
+      {
+        return (h < procs ? std::max<size_type>(std::min(procs / h, m), 1ul) : 1ul);
+      }
+
+      /// Construct process map
+
+      /// \param world The world where the tiles will be mapped
+      /// \param h The number of Hadamard tiles
+      /// \param m The number of rows in each Hadamard slab
+      /// \param x The number of tiles in each row
+      HadamardPmap(World& world, const size_type h, const size_type m,
+          const size_type x) :
+        Pmap(world, h * m * x), h_(h), m_(m), x_(x),
+        slab_procs_(std::min<size_type>(h, procs_)), split_(split(procs_, h, m))
+      {
+        TA_ASSERT(h_ >= 1ul);
+        TA_ASSERT(m_ >= 1ul);
+        TA_ASSERT(x_ >= 1ul);
+
+        // Initialize local tile list
+        if(rank_ < (slab_procs_ * split_)) {
+          const size_type first_m = rank_ / slab_procs_;
+          for(size_type h = rank_ % slab_procs_; h < h_; h += slab_procs_) {
+            for(size_type m = first_m; m < m_; m += split_) {
+              const size_type first = (h * m_ + m) * x_;
+              for(size_type tile = first; tile < (first + x_); ++tile) {
+                TA_ASSERT(HadamardPmap::owner(tile) == rank_);
+                local_.push_back(tile);
+              }
+            }
+          }
+        }
+      }
+
+      virtual ~HadamardPmap() { }
+
+      /// Access the number of processes that hold Hadamard slabs
+      size_type slab_procs() const { return slab_procs_; }
+      /// Access the number of processes per Hadamard slab
+      size_type split() const { return split_; }
+
+      /// Maps \c tile to the processor that owns it
+
+      /// \param tile The tile to be queried
+      /// \return Processor that logically owns \c tile
+      virtual size_type owner(const size_type tile) const {
+        TA_ASSERT(tile < size_);
+        const size_type row = tile / x_;
+        return ((row / m_) % slab_procs_) + slab_procs_ * ((row % m_) % split_);
+      }
+
+      /// Check that the tile is owned by this process
+
+      /// \param tile The tile to be checked
+      /// \return \c true if \c tile is owned by this process, otherwise \c false .
+      virtual bool is_local(const size_type tile) const {
+        return (HadamardPmap::owner(tile) == rank_);
+      }
+
+    }; // class HadamardPmap
+
+  }  // namespace detail
+}  // namespace TiledArray
+
+#endif // TILEDARRAY_PMAP_HADAMARD_PMAP_H__INCLUDED
@@ -0,0 +1,199 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TILEDARRAY_PMAP_LAYERED_PMAP_H__INCLUDED
+#define TILEDARRAY_PMAP_LAYERED_PMAP_H__INCLUDED
+
+#include <TiledArray/pmap/pmap.h>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// Maps cyclically a matrix of indices onto a stack of 2-d process grids
+
+    /// The processes are organized into \f$ L \f$ layers, each of which is a
+    /// matrix of \f$ P_{\rm row} \times P_{\rm col} \f$ processes; process
+    /// \f$ \{ p_{\rm row}, p_{\rm col} \} \f$ of layer \f$ l \f$ has rank
+    /// \f$ l P_{\rm row} P_{\rm col} + p_{\rm row} P_{\rm col} + p_{\rm col} \f$.
+    /// One dimension of the index matrix, the layer dimension, is split into
+    /// \f$ L \f$ contiguous slabs, and slab \f$ l \f$ is mapped cyclically
+    /// onto layer \f$ l \f$ (see \c CyclicPmap ). Index \f$ x \f$ of the
+    /// layer dimension, which has \f$ N \f$ elements, belongs to layer
+    /// \f$ \lfloor x L / N \rfloor \f$.
+    ///
+    /// \note This class is used to map <em>tile</em> indices to processes.
+    class LayeredPmap : public Pmap {
+    protected:
+
+      // Import Pmap protected variables
+      using Pmap::rank_; ///< The rank of this process
+      using Pmap::procs_; ///< The number of processes
+      using Pmap::size_; ///< The number of tiles mapped among all processes
+      using Pmap::local_; ///< A list of local tiles
+
+    private:
+
+      const size_type rows_; ///< Number of tile rows to be mapped
+      const size_type cols_; ///< Number of tile columns to be mapped
+      const size_type proc_cols_; ///< Number of process columns in a layer
+      const size_type proc_rows_; ///< Number of process rows in a layer
+      const size_type layers_; ///< Number of process layers
+      const bool col_layers_; ///< Layers are selected by the column index
+
+      /// The layer of a tile
+
+      /// \param row The tile row
+      /// \param col The tile column
+      /// \return The layer that holds tile \c (row,col)
+      size_type layer(const size_type row, const size_type col) const {
+        return (col_layers_ ? layer(col, layers_, cols_) :
+            layer(row, layers_, rows_));
+      }
+
+    public:
+      typedef Pmap::size_type size_type; ///< Size type
+
+      /// Construct process map
+
+      /// \param world The world where the tiles will be mapped
+      /// \param rows The number of tile rows to be mapped
+      /// \param cols The number of tile columns to be mapped
+      /// \param proc_rows The number of process rows in each layer
+      /// \param proc_cols The number of process columns in each layer
+      /// \param layers The number of process layers
+      /// \param col_layers If \c true the layer of a tile is selected by its
+      /// column index, otherwise by its row index
+      /// \throw TiledArray::Exception When <tt>proc_rows * proc_cols * layers > world.size()</tt>
+      /// \throw TiledArray::Exception When the layer dimension is smaller than
+      /// \c layers
+      LayeredPmap(World& world, size_type rows, size_type cols,
+          size_type proc_rows, size_type proc_cols, size_type layers,
+          const bool col_layers) :
+        Pmap(world, rows * cols), rows_(rows), cols_(cols),
+        proc_cols_(proc_cols), proc_rows_(proc_rows), layers_(layers),
+        col_layers_(col_layers)
+      {
+        // Check that the size is non-zero
+        TA_ASSERT(rows_ >= 1ul);
+        TA_ASSERT(cols_ >= 1ul);
+
+        // Check limits of process rows, columns, and layers
+        TA_ASSERT(proc_rows_ >= 1ul);
+        TA_ASSERT(proc_cols_ >= 1ul);
+        TA_ASSERT(layers_ >= 1ul);
+        TA_ASSERT((proc_rows_ * proc_cols_ * layers_) <= procs_);
+        TA_ASSERT(layers_ <= (col_layers_ ? cols_ : rows_));
+
+        // Initialize local tile list
+        const size_type layer_size = proc_rows_ * proc_cols_;
+        if(rank_ < (layer_size * layers_)) {
+          // Compute rank coordinates
+          const size_type rank_layer = rank_ / layer_size;
+          const size_type rank_row = (rank_ % layer_size) / proc_cols_;
+          const size_type rank_col = rank_ % proc_cols_;
+
+          // Iterate over the tiles of this process's grid position, and keep
+          // those that belong to this layer
+          for(size_type i = rank_row; i < rows_; i += proc_rows_) {
+            for(size_type j = rank_col; j < cols_; j += proc_cols_) {
+              if(layer(i, j) != rank_layer) continue;
+              TA_ASSERT(LayeredPmap::owner(i * cols_ + j) == rank_);
+              local_.push_back(i * cols_ + j);
+            }
+          }
+        }
+      }
+
+      virtual ~LayeredPmap() { }
+
+      /// Access number of rows in the tile index matrix
+      size_type nrows() const { return rows_; }
+      /// Access number of columns in the tile index matrix
+      size_type ncols() const { return cols_; }
+      /// Access number of rows in the process matrix of a layer
+      size_type nrows_proc() const { return proc_rows_; }
+      /// Access number of columns in the process matrix of a layer
+      size_type ncols_proc() const { return proc_cols_; }
+      /// Access number of process layers
+      size_type nlayers() const { return layers_; }
+
+      /// Layer of an index
+
+      /// \param index The index in the layer dimension
+      /// \param layers The number of layers
+      /// \param extent The size of the layer dimension
+      /// \return The layer that holds \c index
+      static size_type layer(const size_type index, const size_type layers,
+          const size_type extent)
+      {
+        TA_ASSERT(index < extent);
+        return (index * layers) / extent;
+      }
+
+      /// First index of a layer
+
+      /// \param layer The layer
+      /// \param layers The number of layers
+      /// \param extent The size of the layer dimension
+      /// \return The first index of the layer dimension that belongs to
+      /// \c layer; \c layer_begin(layers,layers,extent) is equal to \c extent
+      static size_type layer_begin(const size_type layer, const size_type layers,
+          const size_type extent)
+      {
+        TA_ASSERT(layer <= layers);
+        return (layer * extent + layers - 1ul) / layers;
+      }
+
+      /// Maps \c tile to the processor that owns it
+
+      /// \param tile The tile to be queried
+      /// \return Processor that logically owns \c tile
+      virtual size_type owner(const size_type tile) const {
+        TA_ASSERT(tile < size_);
+        // Compute tile coordinate in tile grid
+        const size_type tile_row = tile / cols_;
+        const size_type tile_col = tile % cols_;
+        // Compute process coordinate of tile in the process grid
+        const size_type proc_row = tile_row % proc_rows_;
+        const size_type proc_col = tile_col % proc_cols_;
+        // Compute the process that owns tile
+        const size_type proc = layer(tile_row, tile_col) * proc_rows_ * proc_cols_
+            + proc_row * proc_cols_ + proc_col;
+
+        TA_ASSERT(proc < procs_);
+
+        return proc;
+      }
+
+
+      /// Check that the tile is owned by this process
+
+      /// \param tile The tile to be checked
+      /// \return \c true if \c tile is owned by this process, otherwise \c false .
+      virtual bool is_local(const size_type tile) const {
+        return (LayeredPmap::owner(tile) == rank_);
+      }
+
+    }; // class LayeredPmap
+
+  }  // namespace detail
+}  // namespace TiledArray
+
+
+#endif // TILEDARRAY_PMAP_LAYERED_PMAP_H__INCLUDED
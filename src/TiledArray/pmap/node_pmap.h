@@ -0,0 +1,411 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TILEDARRAY_PMAP_NODE_PMAP_H__INCLUDED
+#define TILEDARRAY_PMAP_NODE_PMAP_H__INCLUDED
+
+#include <TiledArray/pmap/layered_pmap.h>
+#include <TiledArray/utility.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unistd.h>
+
+namespace TiledArray {
+  namespace detail {
+
+    inline std::atomic<bool>& node_aware_proc_grid_flag() {
+      static std::atomic<bool> flag(env_flag("TA_NODE_AWARE_GRID", false));
+      return flag;
+    }
+
+    /// Node-aware process grids (\c TA_NODE_AWARE_GRID , default off)
+    inline bool node_aware_proc_grid() {
+      return node_aware_proc_grid_flag().load(std::memory_order_relaxed);
+    }
+
+    /// Enable or disable node-aware process grids
+
+    /// \param enable The new value of the node-aware process grid flag
+    /// \return The previous value of the flag
+    /// \sa node_aware_proc_grid()
+    inline bool set_node_aware_proc_grid(const bool enable) {
+      return node_aware_proc_grid_flag().exchange(enable);
+    }
+
+    /// The assignment of processes to shared-memory nodes
+
+    /// Nodes are numbered in the order of their lowest rank, and the
+    /// processes of a node are ordered by rank. The node-major list of
+    /// processes, \c ranks() , places the processes of each node next to
+    /// each other, so that contiguous blocks of a process grid filled in that
+    /// order are likely to sit inside a node.
+    class NodeTopology {
+    public:
+      typedef std::size_t size_type; ///< Size type
+
+    private:
+      std::vector<size_type> node_; ///< The node of each process
+      std::vector<ProcessID> ranks_; ///< Processes in node-major order
+      std::vector<size_type> node_begin_; ///< Offset of each node in ranks_
+
+      /// Compute the node-major process list from the node labels
+
+      /// \param labels The node label of each process
+      void init(const std::vector<std::size_t>& labels) {
+        TA_ASSERT(! labels.empty());
+
+        // Number the nodes in the order of their lowest rank
+        std::map<std::size_t, size_type> numbers;
+        node_.reserve(labels.size());
+        for(std::size_t label : labels)
+          node_.push_back(numbers.emplace(label, numbers.size()).first->second);
+
+        // Count the processes of each node, and place the processes in node
+        // order (a stable counting sort)
+        node_begin_.assign(numbers.size() + 1ul, 0ul);
+        for(size_type node : node_)
+          ++node_begin_[node + 1ul];
+        for(size_type node = 0ul; node < numbers.size(); ++node)
+          node_begin_[node + 1ul] += node_begin_[node];
+
+        std::vector<size_type> next(node_begin_.begin(), node_begin_.end() - 1l);
+        ranks_.resize(node_.size());
+        for(std::size_t p = 0ul; p < node_.size(); ++p)
+          ranks_[next[node_[p]]++] = p;
+      }
+
+    public:
+
+      /// Discover the nodes of a world
+
+      /// Processes that share a host name are assigned to the same node. This
+      /// is a collective operation.
+      /// \param world The world to be queried
+      explicit NodeTopology(World& world) {
+        char name[256];
+        if(gethostname(name, sizeof(name)) != 0)
+          name[0] = '\0';
+        name[sizeof(name) - 1ul] = '\0';
+
+        // Gather the host name hashes of all processes
+        std::vector<std::size_t> labels(world.size(), 0ul);
+        labels[world.rank()] = std::hash<std::string>()(std::string(name));
+        world.gop.sum(labels.data(), labels.size());
+
+        init(labels);
+      }
+
+      /// Construct a topology from an explicit node assignment
+
+      /// \param labels The node label of each process; processes with equal
+      /// labels belong to the same node
+      explicit NodeTopology(const std::vector<std::size_t>& labels) {
+        init(labels);
+      }
+
+      /// Cached topology of a world
+
+      /// The topology of each world is discovered once, so the first call
+      /// for a world is collective.
+      /// \param world The world to be queried
+      /// \return The topology of \c world
+      static std::shared_ptr<const NodeTopology> get(World& world) {
+        static std::mutex mutex;
+        static std::map<unsigned long, std::shared_ptr<const NodeTopology> > cache;
+
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          auto it = cache.find(world.id());
+          if(it != cache.end())
+            return it->second;
+        }
+
+        auto topology = std::make_shared<const NodeTopology>(world);
+        std::lock_guard<std::mutex> lock(mutex);
+        return cache.emplace(world.id(), topology).first->second;
+      }
+
+      /// Number of processes
+      size_type size() const { return node_.size(); }
+
+      /// Number of nodes
+      size_type nodes() const { return node_begin_.size() - 1ul; }
+
+      /// The node of a process
+
+      /// \param rank The process rank
+      /// \return The node of process \c rank
+      size_type node(const ProcessID rank) const {
+        TA_ASSERT(size_type(rank) < node_.size());
+        return node_[rank];
+      }
+
+      /// Number of processes on a node
+
+      /// \param node The node
+      /// \return The number of processes on \c node
+      size_type node_size(const size_type node) const {
+        TA_ASSERT(node < nodes());
+        return node_begin_[node + 1ul] - node_begin_[node];
+      }
+
+      /// Common node size
+
+      /// \return The number of processes per node when all nodes have the
+      /// same number of processes, otherwise 0
+      size_type uniform_node_size() const {
+        const size_type result = node_size(0ul);
+        for(size_type node = 1ul; node < nodes(); ++node)
+          if(node_size(node) != result)
+            return 0ul;
+        return result;
+      }
+
+      /// Processes in node-major order
+      const std::vector<ProcessID>& ranks() const { return ranks_; }
+
+      /// Lay out a process grid on the nodes
+
+      /// The grid slots are filled with the node-major process list (see
+      /// \c ranks() ), layer by layer, and within a layer row by row or
+      /// column by column. Processes at the end of the list are not used when
+      /// the grid is smaller than the world.
+      /// \param proc_rows The number of process rows in a layer
+      /// \param proc_cols The number of process columns in a layer
+      /// \param layers The number of layers
+      /// \param col_major If \c true , the columns of the grid are filled
+      /// with contiguous blocks of the process list, otherwise the rows
+      /// \return The rank of each grid slot, where slot
+      /// \c layer*proc_rows*proc_cols+row*proc_cols+col is process
+      /// \c {row,col} of layer \c layer
+      std::vector<ProcessID> grid_ranks(const size_type proc_rows,
+          const size_type proc_cols, const size_type layers,
+          const bool col_major) const
+      {
+        const size_type layer_size = proc_rows * proc_cols;
+        TA_ASSERT((layer_size * layers) <= size());
+
+        std::vector<ProcessID> result(layer_size * layers);
+        auto it = ranks_.begin();
+        for(size_type l = 0ul; l < layers; ++l) {
+          const size_type offset = l * layer_size;
+          if(col_major) {
+            for(size_type j = 0ul; j < proc_cols; ++j)
+              for(size_type i = 0ul; i < proc_rows; ++i)
+                result[offset + i * proc_cols + j] = *it++;
+          } else {
+            for(size_type i = 0ul; i < layer_size; ++i)
+              result[offset + i] = *it++;
+          }
+        }
+
+        return result;
+      }
+
+      /// Count the intra-node links of a process grid layout
+
+      /// \param grid The rank of each grid slot (see \c grid_ranks() )
+      /// \param proc_rows The number of process rows in a layer
+      /// \param proc_cols The number of process columns in a layer
+      /// \return The number of processes, other than the first, of the row
+      /// and column groups that lie entirely inside a node
+      size_type intra_node_links(const std::vector<ProcessID>& grid,
+          const size_type proc_rows, const size_type proc_cols) const
+      {
+        const size_type layer_size = proc_rows * proc_cols;
+        size_type result = 0ul;
+        for(size_type offset = 0ul; offset < grid.size(); offset += layer_size) {
+          // Row groups
+          for(size_type i = 0ul; i < proc_rows; ++i) {
+            const ProcessID* const row = grid.data() + offset + i * proc_cols;
+            const size_type n = node(row[0]);
+            if(std::all_of(row, row + proc_cols,
+                [=] (const ProcessID p) { return node(p) == n; }))
+              result += proc_cols - 1ul;
+          }
+
+          // Column groups
+          for(size_type j = 0ul; j < proc_cols; ++j) {
+            const size_type n = node(grid[offset + j]);
+            size_type i = 1ul;
+            for(; i < proc_rows; ++i)
+              if(node(grid[offset + i * proc_cols + j]) != n)
+                break;
+            if(i == proc_rows)
+              result += proc_rows - 1ul;
+          }
+        }
+
+        return result;
+      }
+
+    }; // class NodeTopology
+
+    /// Maps cyclically a matrix of indices onto a node-aware process grid
+
+    /// This is the counterpart of \c CyclicPmap and, for more than one layer,
+    /// \c LayeredPmap for a process grid whose slots are assigned to
+    /// processes by an explicit table, usually built with
+    /// \c NodeTopology::grid_ranks() . Index \f$ \{ k_{\rm row}, k_{\rm col} \} \f$
+    /// maps to the same grid slot as in those maps, and the slot maps to the
+    /// process given by the table. When the rows or columns of the grid sit
+    /// inside a node, so do the blocks of tiles that share a row or column
+    /// phase, and the broadcasts of SUMMA stay within a node.
+    ///
+    /// \note This class is used to map <em>tile</em> indices to processes.
+    class NodePmap : public Pmap {
+    protected:
+
+      // Import Pmap protected variables
+      using Pmap::rank_; ///< The rank of this process
+      using Pmap::procs_; ///< The number of processes
+      using Pmap::size_; ///< The number of tiles mapped among all processes
+      using Pmap::local_; ///< A list of local tiles
+
+    private:
+
+      const size_type rows_; ///< Number of tile rows to be mapped
+      const size_type cols_; ///< Number of tile columns to be mapped
+      const size_type proc_cols_; ///< Number of process columns in a layer
+      const size_type proc_rows_; ///< Number of process rows in a layer
+      const size_type layers_; ///< Number of process layers
+      const bool col_layers_; ///< Layers are selected by the column index
+      std::shared_ptr<const std::vector<ProcessID> > ranks_; ///< Rank of each grid slot
+
+      /// The grid slot of a tile
+
+      /// \param row The tile row
+      /// \param col The tile column
+      /// \return The grid slot that holds tile \c (row,col)
+      size_type slot(const size_type row, const size_type col) const {
+        const size_type layer = (layers_ == 1ul ? 0ul : (col_layers_ ?
+            LayeredPmap::layer(col, layers_, cols_) :
+            LayeredPmap::layer(row, layers_, rows_)));
+        return (layer * proc_rows_ + (row % proc_rows_)) * proc_cols_
+            + (col % proc_cols_);
+      }
+
+    public:
+      typedef Pmap::size_type size_type; ///< Size type
+
+      /// Construct process map
+
+      /// \param world The world where the tiles will be mapped
+      /// \param rows The number of tile rows to be mapped
+      /// \param cols The number of tile columns to be mapped
+      /// \param proc_rows The number of process rows in each layer
+      /// \param proc_cols The number of process columns in each layer
+      /// \param layers The number of process layers
+      /// \param col_layers If \c true the layer of a tile is selected by its
+      /// column index, otherwise by its row index
+      /// \param ranks The rank of each grid slot (see
+      /// \c NodeTopology::grid_ranks() )
+      /// \throw TiledArray::Exception When <tt>proc_rows * proc_cols * layers</tt>
+      /// is not equal to the size of \c ranks
+      /// \throw TiledArray::Exception When the layer dimension is smaller than
+      /// \c layers
+      NodePmap(World& world, size_type rows, size_type cols,
+          size_type proc_rows, size_type proc_cols, size_type layers,
+          const bool col_layers,
+          const std::shared_ptr<const std::vector<ProcessID> >& ranks) :
+        Pmap(world, rows * cols), rows_(rows), cols_(cols),
+        proc_cols_(proc_cols), proc_rows_(proc_rows), layers_(layers),
+        col_layers_(col_layers), ranks_(ranks)
+      {
+        // Check that the size is non-zero
+        TA_ASSERT(rows_ >= 1ul);
+        TA_ASSERT(cols_ >= 1ul);
+
+        // Check limits of process rows, columns, and layers
+        TA_ASSERT(proc_rows_ >= 1ul);
+        TA_ASSERT(proc_cols_ >= 1ul);
+        TA_ASSERT(layers_ >= 1ul);
+        TA_ASSERT(ranks_);
+        TA_ASSERT((proc_rows_ * proc_cols_ * layers_) == ranks_->size());
+        TA_ASSERT(ranks_->size() <= procs_);
+        TA_ASSERT(layers_ <= (col_layers_ ? cols_ : rows_));
+
+        // Find the grid slot of this process
+        const auto it = std::find(ranks_->begin(), ranks_->end(), ProcessID(rank_));
+        if(it != ranks_->end()) {
+          const size_type layer_size = proc_rows_ * proc_cols_;
+          const size_type rank_slot = it - ranks_->begin();
+          const size_type rank_row = (rank_slot % layer_size) / proc_cols_;
+          const size_type rank_col = rank_slot % proc_cols_;
+
+          // Iterate over the tiles of this process's grid position, and keep
+          // those that belong to its layer
+          for(size_type i = rank_row; i < rows_; i += proc_rows_) {
+            for(size_type j = rank_col; j < cols_; j += proc_cols_) {
+              if(slot(i, j) != rank_slot) continue;
+              TA_ASSERT(NodePmap::owner(i * cols_ + j) == rank_);
+              local_.push_back(i * cols_ + j);
+            }
+          }
+        }
+      }
+
+      virtual ~NodePmap() { }
+
+      /// Access number of rows in the tile index matrix
+      size_type nrows() const { return rows_; }
+      /// Access number of columns in the tile index matrix
+      size_type ncols() const { return cols_; }
+      /// Access number of rows in the process matrix of a layer
+      size_type nrows_proc() const { return proc_rows_; }
+      /// Access number of columns in the process matrix of a layer
+      size_type ncols_proc() const { return proc_cols_; }
+      /// Access number of process layers
+      size_type nlayers() const { return layers_; }
+
+      /// Maps \c tile to the processor that owns it
+
+      /// \param tile The tile to be queried
+      /// \return Processor that logically owns \c tile
+      virtual size_type owner(const size_type tile) const {
+        TA_ASSERT(tile < size_);
+        const size_type proc = (*ranks_)[slot(tile / cols_, tile % cols_)];
+
+        TA_ASSERT(proc < procs_);
+
+        return proc;
+      }
+
+
+      /// Check that the tile is owned by this process
+
+      /// \param tile The tile to be checked
+      /// \return \c true if \c tile is owned by this process, otherwise \c false .
+      virtual bool is_local(const size_type tile) const {
+        return (NodePmap::owner(tile) == rank_);
+      }
+
+    }; // class NodePmap
+
+  }  // namespace detail
+}  // namespace TiledArray
+
+
+#endif // TILEDARRAY_PMAP_NODE_PMAP_H__INCLUDED
@@ -0,0 +1,444 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TILEDARRAY_POOL_ALLOCATOR_H__INCLUDED
+#define TILEDARRAY_POOL_ALLOCATOR_H__INCLUDED
+
+#include <TiledArray/madness.h>
+#include <TiledArray/error.h>
+#include <TiledArray/utility.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace TiledArray {
+
+  /// Memory pool statistics
+
+  /// The statistics are collected by all \c PoolAllocator objects of this
+  /// process. See \c pool_allocator_statistics() .
+  struct PoolAllocatorStatistics {
+    std::size_t bytes_in_use = 0ul; ///< Bytes held by live allocations
+    std::size_t high_water_mark = 0ul; ///< Largest value of \c bytes_in_use
+    std::size_t bytes_cached = 0ul; ///< Bytes held in the shared free lists
+    std::size_t allocations = 0ul; ///< Number of allocation requests
+    std::size_t pool_hits = 0ul; ///< Allocations served from a free list
+    std::size_t system_allocations = 0ul; ///< Allocations served by the system
+  }; // struct PoolAllocatorStatistics
+
+  namespace detail {
+
+    /// Size-class memory pool
+
+    /// Requests are rounded up to a size class, and freed blocks are kept in
+    /// per-class free lists for reuse. There are four size classes per power
+    /// of two between \c min_block_size and \c max_block_size ; larger
+    /// requests are passed directly to the system. Each thread keeps a small
+    /// cache of free blocks, so that the blocks freed by a thread are reused
+    /// by the same thread without locking. Blocks that do not fit into the
+    /// thread cache are moved to shared free lists, which hold at most
+    /// \c cache_limit() bytes.
+    ///
+    /// When first-touch placement is enabled (see \c first_touch() ), new
+    /// blocks are touched by the allocating thread, so that, on NUMA systems,
+    /// their pages are placed on the memory node of that thread. Together
+    /// with the per-thread caches, this keeps tile data close to the threads
+    /// that use it.
+    class MemoryPool {
+    public:
+      typedef std::size_t size_type; ///< Size type
+
+      static constexpr size_type alignment = TILEDARRAY_CACHELINE_SIZE; ///< Block alignment
+      static constexpr size_type min_block_size = 64ul; ///< Smallest block size
+      static constexpr size_type max_block_size = 1ul << 30; ///< Largest pooled block size
+      static constexpr unsigned int thread_cache_blocks = 4u; ///< Blocks per class in a thread cache
+      static constexpr size_type thread_cache_max_block_size = 1ul << 22; ///< Largest block in a thread cache
+
+    private:
+
+      static constexpr unsigned int min_exp = 6u; ///< log2(min_block_size)
+      static constexpr unsigned int max_exp = 30u; ///< log2(max_block_size)
+      static constexpr unsigned int num_classes = ((max_exp - min_exp) << 2) + 1u; ///< Number of size classes
+
+      /// Free list of a size class
+      struct FreeList {
+        std::vector<void*> blocks_; ///< Free blocks
+        madness::Spinlock lock_; ///< Free list lock
+      }; // struct FreeList
+
+      /// Per-thread free block cache
+      class ThreadCache {
+        std::vector<void*> blocks_[num_classes]; ///< Free blocks of each class
+
+      public:
+        ThreadCache() = default;
+        ThreadCache(const ThreadCache&) = delete;
+        ThreadCache& operator=(const ThreadCache&) = delete;
+
+        /// Return cached blocks to the pool
+        ~ThreadCache() {
+          MemoryPool& pool = MemoryPool::instance();
+          for(unsigned int c = 0u; c < num_classes; ++c)
+            for(void* block : blocks_[c])
+              pool.release(c, block);
+        }
+
+        /// \return The free blocks of class \c c
+        std::vector<void*>& operator[](const unsigned int c) { return blocks_[c]; }
+      }; // class ThreadCache
+
+      FreeList lists_[num_classes]; ///< Shared free lists
+      std::atomic<size_type> bytes_in_use_{0ul};
+      std::atomic<size_type> high_water_mark_{0ul};
+      std::atomic<size_type> bytes_cached_{0ul};
+      std::atomic<size_type> allocations_{0ul};
+      std::atomic<size_type> pool_hits_{0ul};
+      std::atomic<size_type> system_allocations_{0ul};
+
+      MemoryPool() = default;
+
+      /// \return The thread cache of the calling thread
+      static ThreadCache& thread_cache() {
+        static thread_local ThreadCache cache;
+        return cache;
+      }
+
+      /// Allocate memory from the system
+      void* system_allocate(const size_type bytes) {
+        void* block = nullptr;
+        if(posix_memalign(& block, alignment, bytes) != 0)
+          throw std::bad_alloc();
+        ++system_allocations_;
+
+        // Place the pages of the block on the memory node of this thread
+        if(first_touch()) {
+          char* const first = static_cast<char*>(block);
+          for(size_type i = 0ul; i < bytes; i += page_size)
+            first[i] = 0;
+        }
+
+        return block;
+      }
+
+      /// Return a block to the shared free list of class \c c , or to the
+      /// system when the shared free lists are full
+      void release(const unsigned int c, void* block) {
+        const size_type bytes = class_size(c);
+        if((bytes_cached_ += bytes) <= cache_limit()) {
+          madness::ScopedMutex<madness::Spinlock> locker(& lists_[c].lock_);
+          lists_[c].blocks_.push_back(block);
+        } else {
+          bytes_cached_ -= bytes;
+          free(block);
+        }
+      }
+
+      /// Increase the number of bytes in use and update the high-water mark
+      void add_in_use(const size_type bytes) {
+        const size_type in_use = (bytes_in_use_ += bytes);
+        size_type high = high_water_mark_.load();
+        while((in_use > high) && ! high_water_mark_.compare_exchange_weak(high, in_use)) ;
+      }
+
+      static constexpr size_type page_size = 4096ul; ///< Page size used for first touch
+
+    public:
+
+      MemoryPool(const MemoryPool&) = delete;
+      MemoryPool& operator=(const MemoryPool&) = delete;
+
+      /// Return all cached blocks to the system
+      ~MemoryPool() { trim(); }
+
+      /// Singleton accessor
+      static MemoryPool& instance() {
+        static MemoryPool pool;
+        return pool;
+      }
+
+      /// First-touch placement flag
+
+      /// First-touch placement is enabled by setting the environment variable
+      /// \c TA_POOL_FIRST_TOUCH to 1.
+      /// \return \c true if new blocks are touched by the allocating thread
+      static bool first_touch() {
+        static const bool result = env_flag("TA_POOL_FIRST_TOUCH", false);
+        return result;
+      }
+
+      /// Shared free list limit
+
+      /// The limit may be set, in MiB, with the environment variable
+      /// \c TA_POOL_CACHE_LIMIT .
+      /// \return The largest number of bytes held in the shared free lists
+      /// (default = 1 GiB)
+      static size_type cache_limit() {
+        static const size_type result = [] () {
+          const char* limit = getenv("TA_POOL_CACHE_LIMIT");
+          return (limit ? size_type(std::strtoul(limit, nullptr, 10)) << 20 :
+              size_type(1ul << 30));
+        }();
+        return result;
+      }
+
+      /// Size class of a request
+
+      /// \param bytes The number of requested bytes, where
+      /// <tt>0 < bytes <= max_block_size</tt>
+      /// \return The smallest size class that holds \c bytes
+      static unsigned int size_class(const size_type bytes) {
+        TA_ASSERT(bytes <= max_block_size);
+        if(bytes <= min_block_size)
+          return 0u;
+
+        // Find e such that 2^e < bytes <= 2^(e+1)
+        unsigned int e = 0u;
+        for(size_type n = bytes - 1ul; n > 1ul; n >>= 1)
+          ++e;
+
+        // The four classes of (2^e, 2^(e+1)] are 2^e + q * 2^(e-2), q = 1..4
+        const size_type step = size_type(1) << (e - 2u);
+        const size_type q = (bytes - (size_type(1) << e) + step - 1ul) / step;
+        return ((e - min_exp) << 2) + q;
+      }
+
+      /// Block size of a size class
+
+      /// \param c The size class
+      /// \return The number of bytes in the blocks of class \c c
+      static size_type class_size(const unsigned int c) {
+        TA_ASSERT(c < num_classes);
+        if(c == 0u)
+          return min_block_size;
+        const unsigned int e = min_exp + ((c - 1u) >> 2);
+        const size_type q = ((c - 1u) & 3u) + 1u;
+        return (size_type(1) << e) + q * (size_type(1) << (e - 2u));
+      }
+
+      /// Allocate a block
+
+      /// \param bytes The number of bytes to allocate
+      /// \return A pointer to a block of at least \c bytes bytes, aligned to
+      /// \c alignment , or \c nullptr when \c bytes is zero
+      /// \throw std::bad_alloc When memory allocation fails
+      void* allocate(const size_type bytes) {
+        if(bytes == 0ul)
+          return nullptr;
+        ++allocations_;
+
+        if(bytes > max_block_size) {
+          add_in_use(bytes);
+          return system_allocate(bytes);
+        }
+
+        const unsigned int c = size_class(bytes);
+        const size_type block_size = class_size(c);
+        add_in_use(block_size);
+
+        // Search the thread cache
+        std::vector<void*>& cache = thread_cache()[c];
+        if(! cache.empty()) {
+          void* const block = cache.back();
+          cache.pop_back();
+          ++pool_hits_;
+          return block;
+        }
+
+        // Search the shared free list
+        {
+          madness::ScopedMutex<madness::Spinlock> locker(& lists_[c].lock_);
+          if(! lists_[c].blocks_.empty()) {
+            void* const block = lists_[c].blocks_.back();
+            lists_[c].blocks_.pop_back();
+            bytes_cached_ -= block_size;
+            ++pool_hits_;
+            return block;
+          }
+        }
+
+        try {
+          return system_allocate(block_size);
+        } catch(...) {
+          bytes_in_use_ -= block_size;
+          throw;
+        }
+      }
+
+      /// Free a block
+
+      /// \param block The block to be freed
+      /// \param bytes The number of bytes that was requested for \c block
+      void deallocate(void* const block, const size_type bytes) {
+        if(! block)
+          return;
+
+        if(bytes > max_block_size) {
+          bytes_in_use_ -= bytes;
+          free(block);
+          return;
+        }
+
+        const unsigned int c = size_class(bytes);
+        bytes_in_use_ -= class_size(c);
+
+        std::vector<void*>& cache = thread_cache()[c];
+        if((class_size(c) <= thread_cache_max_block_size) &&
+            (cache.size() < thread_cache_blocks))
+          cache.push_back(block);
+        else
+          release(c, block);
+      }
+
+      /// Return the blocks in the shared free lists to the system
+
+      /// \note Blocks held in thread caches are not affected.
+      void trim() {
+        for(unsigned int c = 0u; c < num_classes; ++c) {
+          madness::ScopedMutex<madness::Spinlock> locker(& lists_[c].lock_);
+          for(void* block : lists_[c].blocks_)
+            free(block);
+          bytes_cached_ -= class_size(c) * lists_[c].blocks_.size();
+          lists_[c].blocks_.clear();
+        }
+      }
+
+      /// \return The statistics of this pool
+      PoolAllocatorStatistics statistics() const {
+        PoolAllocatorStatistics stats;
+        stats.bytes_in_use = bytes_in_use_.load();
+        stats.high_water_mark = high_water_mark_.load();
+        stats.bytes_cached = bytes_cached_.load();
+        stats.allocations = allocations_.load();
+        stats.pool_hits = pool_hits_.load();
+        stats.system_allocations = system_allocations_.load();
+        return stats;
+      }
+
+      /// Reset the counters and set the high-water mark to the current number
+      /// of bytes in use
+      void reset_statistics() {
+        high_water_mark_ = bytes_in_use_.load();
+        allocations_ = 0ul;
+        pool_hits_ = 0ul;
+        system_allocations_ = 0ul;
+      }
+
+    }; // class MemoryPool
+
+  } // namespace detail
+
+  /// Pooled allocator
+
+  /// A standard allocator that draws memory from the process-wide
+  /// \c detail::MemoryPool , which recycles blocks of the same size class
+  /// instead of returning them to the system. It is intended for the data of
+  /// tiles, which are allocated and freed repeatedly with the same sizes,
+  /// e.g. <tt>Tensor<double, PoolAllocator<double> ></tt>. The memory is
+  /// aligned to \c TILEDARRAY_CACHELINE_SIZE .
+  /// \tparam T The element type
+  template <typename T>
+  class PoolAllocator {
+  public:
+    typedef T value_type; ///< Element type
+    typedef T* pointer; ///< Element pointer type
+    typedef const T* const_pointer; ///< Element const pointer type
+    typedef T& reference; ///< Element reference type
+    typedef const T& const_reference; ///< Element const reference type
+    typedef std::size_t size_type; ///< Size type
+    typedef std::ptrdiff_t difference_type; ///< Difference type
+
+    template <typename U>
+    struct rebind { typedef PoolAllocator<U> other; };
+
+    PoolAllocator() = default;
+    PoolAllocator(const PoolAllocator&) = default;
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) { }
+
+    /// Allocate memory for \c n elements
+
+    /// \param n The number of elements
+    /// \return A pointer to uninitialized memory for \c n elements
+    /// \throw std::bad_alloc When memory allocation fails
+    pointer allocate(const size_type n, const void* = nullptr) {
+      if(n > max_size())
+        throw std::bad_alloc();
+      return static_cast<pointer>(
+          detail::MemoryPool::instance().allocate(n * sizeof(T)));
+    }
+
+    /// Free memory
+
+    /// \param p The memory to be freed
+    /// \param n The number of elements that was allocated
+    void deallocate(pointer p, const size_type n) {
+      detail::MemoryPool::instance().deallocate(p, n * sizeof(T));
+    }
+
+    /// \return The largest number of elements that can be allocated
+    size_type max_size() const {
+      return std::numeric_limits<size_type>::max() / sizeof(T);
+    }
+
+    template <typename U, typename... Args>
+    void construct(U* p, Args&&... args) {
+      ::new(static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+
+    template <typename U>
+    void destroy(U* p) { p->~U(); }
+
+  }; // class PoolAllocator
+
+  template <typename T, typename U>
+  inline bool operator==(const PoolAllocator<T>&, const PoolAllocator<U>&) {
+    return true;
+  }
+
+  template <typename T, typename U>
+  inline bool operator!=(const PoolAllocator<T>&, const PoolAllocator<U>&) {
+    return false;
+  }
+
+  /// Memory pool statistics accessor
+
+  /// \return The statistics of the memory pool used by \c PoolAllocator
+  inline PoolAllocatorStatistics pool_allocator_statistics() {
+    return detail::MemoryPool::instance().statistics();
+  }
+
+  /// Reset the memory pool statistics of this process
+
+  /// The high-water mark is set to the current number of bytes in use.
+  inline void reset_pool_allocator_statistics() {
+    detail::MemoryPool::instance().reset_statistics();
+  }
+
+  /// Return the memory cached by the memory pool to the system
+  inline void pool_allocator_trim() {
+    detail::MemoryPool::instance().trim();
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_POOL_ALLOCATOR_H__INCLUDED
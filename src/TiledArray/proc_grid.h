@@ -27,6 +27,8 @@
 #define TILEDARRAY_GRID_H__INCLUDED
 
 #include <TiledArray/pmap/cyclic_pmap.h>
+#include <TiledArray/pmap/layered_pmap.h>
+#include <TiledArray/pmap/node_pmap.h>
 #include <TiledArray/math/eigen.h>
 
 namespace TiledArray {
@@ -56,6 +58,20 @@ namespace TiledArray {
     /// \f]
     /// where the positive, real root of \f$P_{\rm{row}}\f$ give the optimal
     /// optimal communication time.
+    ///
+    /// The processes may also be divided into several layers, each of which
+    /// holds an identical 2D grid. This is used by 2.5D SUMMA, where every
+    /// layer evaluates the contractions for a slab of the inner dimension.
+    ///
+    /// By default, process \f$ \{ p_{\rm row}, p_{\rm col} \} \f$ of layer
+    /// \f$ l \f$ has rank
+    /// \f$ l P_{\rm row} P_{\rm col} + p_{\rm row} P_{\rm col} + p_{\rm col} \f$.
+    /// When a \c NodeTopology is given, the grid is instead filled with the
+    /// processes of each node in turn, row by row or column by column,
+    /// so that the row or column groups, and with them the SUMMA broadcasts,
+    /// sit inside a node where possible. The grid shape may then deviate
+    /// slightly from the optimum above, so that the rows or columns divide
+    /// the node size.
     class ProcGrid {
     public:
       typedef uint_fast32_t size_type;
@@ -74,7 +90,10 @@ namespace TiledArray {
       size_type local_rows_; ///< The number of local element rows
       size_type local_cols_; ///< The number of local element columns
       size_type local_size_; ///< Number of local elements
-
+      size_type layers_; ///< Number of process grid layers
+      size_type layer_; ///< This process's layer in the process grid
+      std::shared_ptr<const std::vector<ProcessID> > ranks_; ///< The rank of
+                              ///< each grid slot; empty for the default order
 
       /// Compute the number of process rows that minimizes communication
 
@@ -168,12 +187,15 @@ namespace TiledArray {
         }
       }
 
-      /// Member variable initialization
+      /// Process grid size initialization
 
-      /// This function initializes the member variables with with the optimal
-      /// sizes.
-      void init(const size_type rank, const size_type nprocs,
-          const std::size_t row_size, const std::size_t col_size)
+      /// This function initializes the process grid sizes with the optimal
+      /// values.
+      /// \param nprocs The number of processes in the grid
+      /// \param row_size The number of element rows
+      /// \param col_size The number of element columns
+      void init_grid(const size_type nprocs, const std::size_t row_size,
+          const std::size_t col_size)
       {
         // Check for the simple cases first ...
         if(nprocs == 1u) { // Only one process
@@ -183,15 +205,6 @@ namespace TiledArray {
           proc_cols_ = 1u;
           proc_size_ = 1u;
 
-          // Set this process rank
-          rank_row_ = 0;
-          rank_col_ = 0;
-
-          // Set local counts
-          local_rows_ = rows_;
-          local_cols_ = cols_;
-          local_size_ = size_;
-
         } else if(size_ <= nprocs) { // Max one tile per process
 
           // Set process grid sizes
@@ -199,17 +212,6 @@ namespace TiledArray {
           proc_cols_ = cols_;
           proc_size_ = size_;
 
-          if(rank < proc_size_) {
-            // Set this process rank
-            rank_row_ = rank / proc_cols_;
-            rank_col_ = rank % proc_cols_;
-
-            // Set local counts
-            local_rows_ = 1u;
-            local_cols_ = 1u;
-            local_size_ = 1u;
-          }
-
         } else { // The not so simple case
 
           // Compute the limits for process rows
@@ -232,18 +234,112 @@ namespace TiledArray {
           }
 
           proc_size_ = proc_rows_ * proc_cols_;
+        }
+      }
 
-          if(rank < proc_size_) {
-            // Set this process rank
-            rank_row_ = rank / proc_cols_;
-            rank_col_ = rank % proc_cols_;
-
-            // Set local counts
-            local_rows_ = (rows_ / proc_rows_) + (size_type(rank_row_) < (rows_ % proc_rows_) ? 1u : 0u);
-            local_cols_ = (cols_ / proc_cols_) + (size_type(rank_col_) < (cols_ % proc_cols_) ? 1u : 0u);
-            local_size_ = local_rows_ * local_cols_;
+      /// Node-aware process grid layout
+
+      /// The grid slots are filled with the node-major process list of
+      /// \c topology , row by row or column by column, whichever keeps more
+      /// row and column groups inside a node. When all nodes have the same
+      /// size, and it is not a multiple of the process rows or columns, the
+      /// grid shape is first adjusted, without increasing the number of unused
+      /// processes, such that it is.
+      /// \param topology The node topology of the processes
+      /// \param nprocs The number of processes in a layer
+      void init_nodes(const NodeTopology& topology, const size_type nprocs) {
+        TA_ASSERT(topology.size() >= (proc_size_ * layers_));
+
+        const size_type node_size = topology.uniform_node_size();
+        if((size_ > nprocs) && (node_size > 1u) && ((node_size % proc_rows_) != 0u)
+            && ((node_size % proc_cols_) != 0u))
+        {
+          const size_type min_proc_rows =
+              std::max<size_type>(((nprocs + cols_ - 1ul) / cols_), 1ul);
+          const size_type max_proc_rows = std::min<size_type>(nprocs, rows_);
+          const size_type delta = std::max<size_type>(1ul, std::log2(nprocs));
+          const size_type max_x = std::min(proc_rows_ + delta, max_proc_rows);
+
+          size_type diff = delta + 1u;
+          for(size_type x = std::max<int_fast32_t>(min_proc_rows,
+              int_fast32_t(proc_rows_) - delta); x <= max_x; ++x)
+          {
+            const size_type y = nprocs / x;
+            const size_type test_diff = std::abs(long(proc_rows_) - long(x));
+            if(((x * y) >= proc_size_) && (test_diff < diff) &&
+                (((node_size % x) == 0u) || ((node_size % y) == 0u)))
+            {
+              proc_rows_ = x;
+              proc_cols_ = y;
+              proc_size_ = x * y;
+              diff = test_diff;
+            }
           }
         }
+
+        // Choose the fill order that keeps more groups inside a node
+        std::vector<ProcessID> row_major =
+            topology.grid_ranks(proc_rows_, proc_cols_, layers_, false);
+        std::vector<ProcessID> col_major =
+            topology.grid_ranks(proc_rows_, proc_cols_, layers_, true);
+        if(topology.intra_node_links(col_major, proc_rows_, proc_cols_) >
+            topology.intra_node_links(row_major, proc_rows_, proc_cols_))
+          row_major.swap(col_major);
+        ranks_ = std::make_shared<const std::vector<ProcessID> >(std::move(row_major));
+      }
+
+      /// The grid slot of a process
+
+      /// \param rank The process rank
+      /// \return The grid slot of \c rank , which is not less than
+      /// <tt>proc_size() * layers()</tt> when the process is not part of the
+      /// grid
+      size_type rank_slot(const ProcessID rank) const {
+        if(! ranks_)
+          return rank;
+        return std::find(ranks_->begin(), ranks_->end(), rank) - ranks_->begin();
+      }
+
+      /// The process of a grid slot
+
+      /// \param slot The grid slot
+      /// \return The rank of the process at \c slot
+      ProcessID slot_rank(const size_type slot) const {
+        TA_ASSERT(slot < (proc_size_ * layers_));
+        return (ranks_ ? (*ranks_)[slot] : ProcessID(slot));
+      }
+
+      /// Process rank initialization
+
+      /// This function initializes the coordinates and local counts of this
+      /// process. Processes that are not included in the grid have no local
+      /// elements.
+      /// \param rank The rank of this process in the grid
+      void init_rank(const size_type rank) {
+        if(rank < proc_size_) {
+          // Set this process rank
+          rank_row_ = rank / proc_cols_;
+          rank_col_ = rank % proc_cols_;
+
+          // Set local counts
+          local_rows_ = (rows_ / proc_rows_) + (size_type(rank_row_) < (rows_ % proc_rows_) ? 1u : 0u);
+          local_cols_ = (cols_ / proc_cols_) + (size_type(rank_col_) < (cols_ % proc_cols_) ? 1u : 0u);
+          local_size_ = local_rows_ * local_cols_;
+        }
+      }
+
+      /// Member variable initialization
+
+      /// This function initializes the member variables with with the optimal
+      /// sizes.
+      void init(const size_type rank, const size_type nprocs,
+          const std::size_t row_size, const std::size_t col_size,
+          const NodeTopology* topology)
+      {
+        init_grid(nprocs, row_size, col_size);
+        if(topology)
+          init_nodes(*topology, nprocs);
+        init_rank(rank_slot(rank));
       }
 
     public:
@@ -253,7 +349,8 @@ namespace TiledArray {
       ProcGrid() :
         world_(NULL), rows_(0u), cols_(0u), size_(0u), proc_rows_(0u),
         proc_cols_(0u), proc_size_(0u), rank_row_(0), rank_col_(0),
-        local_rows_(0u), local_cols_(0u), local_size_(0u)
+        local_rows_(0u), local_cols_(0u), local_size_(0u), layers_(1u),
+        layer_(0u), ranks_()
       { }
 
       /// Construct a process grid
@@ -261,25 +358,56 @@ namespace TiledArray {
       // This constructor makes a rough estimate of the optimal process
       // dimensions. The goal is for the ratios of proc_rows/proc_cols and
       // rows/cols to be approximately equal.
+      /// When \c layers is greater than one, the processes of \c world are
+      /// divided into \c layers identical 2D process grids, which are stacked
+      /// on top of each other. The grid of each layer is optimized for
+      /// <tt>world.size() / layers</tt> processes; layer \c l contains the
+      /// processes with ranks in the range
+      /// <tt>[l * proc_size(), (l + 1) * proc_size())</tt>. The row and
+      /// column functions of this object refer to the layer of this process.
+      /// When \c topology is given, the processes are assigned to the grid
+      /// slots node by node instead (see \c init_nodes() ).
       /// \param world The world where the process grid will live
       /// \param rows The number of tile rows
       /// \param cols The number of tile columns
       /// \param row_size The number of element rows
       /// \param col_size The number of element columns
+      /// \param layers The number of process grid layers [ default = 1 ]
+      /// \param topology The node topology of \c world , or \c nullptr for
+      /// the default rank order [ default = nullptr ]
+      /// \throw TiledArray::Exception When \c layers is zero or larger than
+      /// the number of processes in \c world.
       ProcGrid(World& world, const size_type rows, const size_type cols,
-          const std::size_t row_size, const std::size_t col_size) :
+          const std::size_t row_size, const std::size_t col_size,
+          const size_type layers = 1u, const NodeTopology* topology = nullptr) :
         world_(&world), rows_(rows), cols_(cols), size_(rows_ * cols_),
         proc_rows_(0ul), proc_cols_(0ul), proc_size_(0ul),
         rank_row_(-1), rank_col_(-1),
-        local_rows_(0ul), local_cols_(0ul), local_size_(0ul)
+        local_rows_(0ul), local_cols_(0ul), local_size_(0ul), layers_(layers),
+        layer_(0ul), ranks_()
       {
         // Check for non-zero sizes
         TA_ASSERT(rows_ >= 1u);
         TA_ASSERT(cols_ >= 1u);
         TA_ASSERT(row_size >= 1ul);
         TA_ASSERT(col_size >= 1ul);
+        TA_ASSERT(layers_ >= 1u);
+        TA_ASSERT(layers_ <= size_type(world_->size()));
+
+        init_grid(world_->size() / layers_, row_size, col_size);
+        if(topology) {
+          TA_ASSERT(topology->size() == size_type(world_->size()));
+          init_nodes(*topology, world_->size() / layers_);
+        }
 
-        init(world_->rank(), world_->size(), row_size, col_size);
+        // Processes that are not included in any layer have no local elements
+        const size_type slot = rank_slot(world_->rank());
+        if(slot < (proc_size_ * layers_)) {
+          layer_ = slot / proc_size_;
+          init_rank(slot % proc_size_);
+        } else {
+          layer_ = layers_;
+        }
       }
 
 #ifdef TILEDARRAY_ENABLE_TEST_PROC_GRID
@@ -300,12 +428,16 @@ namespace TiledArray {
       /// \param cols The number of tile columns
       /// \param row_size The number of element rows
       /// \param col_size The number of element columns
+      /// \param topology The node topology of the \c test_nprocs processes,
+      /// or \c nullptr for the default rank order [ default = nullptr ]
       ProcGrid(World& world, const size_type test_rank, size_type test_nprocs,
           const size_type rows, const size_type cols,
-          const std::size_t row_size, const std::size_t col_size) :
+          const std::size_t row_size, const std::size_t col_size,
+          const NodeTopology* topology = nullptr) :
         world_(&world), rows_(rows), cols_(cols), size_(rows_ * cols_),
         proc_rows_(0u), proc_cols_(0u), proc_size_(0u), rank_row_(-1),
-        rank_col_(-1), local_rows_(0u), local_cols_(0u), local_size_(0u)
+        rank_col_(-1), local_rows_(0u), local_cols_(0u), local_size_(0u),
+        layers_(1u), layer_(0u), ranks_()
       {
         // Check for non-zero sizes
         TA_ASSERT(rows >= 1u);
@@ -313,8 +445,11 @@ namespace TiledArray {
         TA_ASSERT(row_size >= 1u);
         TA_ASSERT(col_size >= 1u);
         TA_ASSERT(test_rank < test_nprocs);
+        TA_ASSERT(! topology || (topology->size() == test_nprocs));
 
-        init(test_rank, test_nprocs, row_size, col_size);
+        init(test_rank, test_nprocs, row_size, col_size, topology);
+        if(rank_slot(test_rank) >= proc_size_)
+          layer_ = layers_;
       }
 #endif // TILEDARRAY_ENABLE_TEST_PROC_GRID
 
@@ -330,7 +465,8 @@ namespace TiledArray {
         proc_cols_(other.proc_cols_), proc_size_(other.proc_size_),
         rank_row_(other.rank_row_), rank_col_(other.rank_col_),
         local_rows_(other.local_rows_), local_cols_(other.local_cols_),
-        local_size_(other.local_size_)
+        local_size_(other.local_size_), layers_(other.layers_),
+        layer_(other.layer_), ranks_(other.ranks_)
       { }
 
       /// Copy assignment operator
@@ -349,6 +485,9 @@ namespace TiledArray {
         local_rows_ = other.local_rows_;
         local_cols_ = other.local_cols_;
         local_size_ = other.local_size_;
+        layers_ = other.layers_;
+        layer_ = other.layer_;
+        ranks_ = other.ranks_;
 
         return *this;
       }
@@ -409,6 +548,33 @@ namespace TiledArray {
       /// less than the number of process in world).
       size_type proc_size() const { return proc_size_; }
 
+      /// Layer count accessor
+
+      /// \return The number of process grid layers
+      size_type layers() const { return layers_; }
+
+      /// Layer accessor
+
+      /// \return The layer of this process, or \c layers() if this process
+      /// is not included in the process grid
+      size_type layer() const { return layer_; }
+
+      /// The range of the layer dimension assigned to this process's layer
+
+      /// The layer dimension, e.g. the inner dimension of a contraction, is
+      /// split into \c layers() contiguous slabs, where slab \c l is assigned
+      /// to layer \c l . This partition matches that of the process maps
+      /// constructed by \c make_row_phase_pmap() and
+      /// \c make_col_phase_pmap() .
+      /// \param extent The size of the layer dimension
+      /// \return The first and past-the-end index of the slab of this layer
+      std::pair<size_type, size_type> layer_range(const size_type extent) const {
+        TA_ASSERT(layer_ < layers_);
+        return std::pair<size_type, size_type>(
+            LayeredPmap::layer_begin(layer_, layers_, extent),
+            LayeredPmap::layer_begin(layer_ + 1u, layers_, extent));
+      }
+
 
       /// Construct a row group
 
@@ -425,10 +591,10 @@ namespace TiledArray {
           proc_list.reserve(proc_cols_);
 
           // Populate the row process list
-          size_type p = rank_row_ * proc_cols_;
+          size_type p = layer_ * proc_size_ + rank_row_ * proc_cols_;
           const size_type row_end = p + proc_cols_;
           for(; p < row_end; ++p)
-            proc_list.push_back(p);
+            proc_list.push_back(slot_rank(p));
 
           // Construct the group
           group = madness::Group(*world_, proc_list, did);
@@ -452,8 +618,9 @@ namespace TiledArray {
           proc_list.reserve(proc_rows_);
 
           // Populate the column process list
+          const size_type offset = layer_ * proc_size_;
           for(size_type p = rank_col_; p < proc_size_; p += proc_cols_)
-            proc_list.push_back(p);
+            proc_list.push_back(slot_rank(offset + p));
 
           // Construct the group
           if(proc_list.size() != 0)
@@ -463,13 +630,20 @@ namespace TiledArray {
         return group;
       }
 
+      /// Rank table query
+
+      /// \return \c true if the processes are placed on the grid with a
+      /// rank table (e.g. a node-aware grid), so the grid slots are not in
+      /// rank order
+      bool has_rank_table() const { return static_cast<bool>(ranks_); }
+
       /// Map a row to the process in this process's column
 
       /// \param row The row to be mapped
       /// \return The process the corresponds to the process coordinate \c (row,rank_col)
       ProcessID map_row(const size_type row) const {
         TA_ASSERT(row < proc_rows_);
-        return rank_col_ + row * proc_cols_;
+        return slot_rank(layer_ * proc_size_ + rank_col_ + row * proc_cols_);
       }
 
       /// Map a column to the process in this process's row
@@ -478,16 +652,36 @@ namespace TiledArray {
       /// \return The process the corresponds to the process coordinate \c (rank_row,col)
       ProcessID map_col(const size_type col) const {
         TA_ASSERT(col < proc_cols_);
-        return rank_row_ * proc_cols_ + col;
+        return slot_rank(layer_ * proc_size_ + rank_row_ * proc_cols_ + col);
+      }
+
+      /// Map a layer to the process at this process's grid coordinate
+
+      /// \param layer The layer to be mapped
+      /// \return The process the corresponds to the process coordinate
+      /// \c (rank_row,rank_col) in \c layer
+      ProcessID map_layer(const size_type layer) const {
+        TA_ASSERT(layer < layers_);
+        return slot_rank(layer * proc_size_ + rank_row_ * proc_cols_ + rank_col_);
       }
 
       /// Construct a cyclic process
 
       /// Construct a cyclic process map with the same phase as the process grid.
+      /// For a layered process grid, the tiles are mapped onto the first layer.
+      /// For a node-aware process grid, this is a \c NodePmap .
       /// \return Cyclic process map
       std::shared_ptr<Pmap> make_pmap() const {
         TA_ASSERT(world_);
 
+        if(ranks_) {
+          const auto first_layer = (layers_ == 1u ? ranks_ :
+              std::make_shared<const std::vector<ProcessID> >(ranks_->begin(),
+                  ranks_->begin() + proc_size_));
+          return std::make_shared<NodePmap>(*world_, rows_, cols_, proc_rows_,
+              proc_cols_, 1ul, false, first_layer);
+        }
+
         return std::make_shared<CyclicPmap>(*world_, rows_, cols_, proc_rows_, proc_cols_);
       }
 
@@ -495,11 +689,24 @@ namespace TiledArray {
 
       /// Construct a cyclic process map where the column phase of the process
       /// matches that of this process grid.
+      /// For a layered process grid, the rows of the process map are split
+      /// among the layers (see \c layer_range() ).
+      /// For a node-aware process grid, this is a \c NodePmap , so the tiles
+      /// broadcast along a process column are held by processes of as few
+      /// nodes as possible.
       /// \param rows The number of rows in the process map
       /// \return Cyclic process map with matching column phase
       std::shared_ptr<Pmap> make_col_phase_pmap(const size_type rows) const {
         TA_ASSERT(world_);
 
+        if(ranks_)
+          return std::make_shared<NodePmap>(*world_, rows, cols_, proc_rows_,
+              proc_cols_, layers_, false, ranks_);
+
+        if(layers_ > 1u)
+          return std::make_shared<LayeredPmap>(*world_, rows, cols_, proc_rows_,
+              proc_cols_, layers_, false);
+
         return std::make_shared<CyclicPmap>(*world_, rows, cols_, proc_rows_, proc_cols_);
       }
 
@@ -507,11 +714,24 @@ namespace TiledArray {
 
       /// Construct a cyclic process map where the column phase of the process
       /// matches that of this process grid.
+      /// For a layered process grid, the columns of the process map are split
+      /// among the layers (see \c layer_range() ).
+      /// For a node-aware process grid, this is a \c NodePmap , so the tiles
+      /// broadcast along a process row are held by processes of as few nodes
+      /// as possible.
       /// \param cols The number of columns in the process map
       /// \return Cyclic process map with matching column phase
       std::shared_ptr<Pmap> make_row_phase_pmap(const size_type cols) const {
         TA_ASSERT(world_);
 
+        if(ranks_)
+          return std::make_shared<NodePmap>(*world_, rows_, cols, proc_rows_,
+              proc_cols_, layers_, true, ranks_);
+
+        if(layers_ > 1u)
+          return std::make_shared<LayeredPmap>(*world_, rows_, cols, proc_rows_,
+              proc_cols_, layers_, true);
+
         return std::make_shared<CyclicPmap>(*world_, rows_, cols, proc_rows_, proc_cols_);
       }
     }; // class Grid
@@ -24,6 +24,10 @@
 #include <TiledArray/permutation.h>
 #include <TiledArray/size_array.h>
 
+#ifndef TILEDARRAY_RANGE_INLINE_RANK
+#define TILEDARRAY_RANGE_INLINE_RANK 6
+#endif // TILEDARRAY_RANGE_INLINE_RANK
+
 namespace TiledArray {
 
   /// \brief A (hyperrectangular) interval on \f$ Z^n \f$, space of integer n-indices
@@ -35,6 +39,9 @@ namespace TiledArray {
   /// test if an element is included in the range with a coordinate index or
   /// ordinal offset. Finally, it can be used to convert coordinate indices to
   /// ordinal offsets and vice versa.
+  /// The dimension data of ranges with rank less than or equal to
+  /// \c TILEDARRAY_RANGE_INLINE_RANK is stored in the range object, so
+  /// constructing, copying, or moving such ranges does not allocate memory.
   /// TODO add Range support for negative indices
   class Range {
   public:
@@ -48,6 +55,9 @@ namespace TiledArray {
     typedef detail::RangeIterator<size_type, Range_> const_iterator; ///< Coordinate iterator
     friend class detail::RangeIterator<size_type, Range_>;
 
+    /// The largest rank of a range that does not allocate memory
+    static constexpr unsigned int max_inline_rank = TILEDARRAY_RANGE_INLINE_RANK;
+
   protected:
 
     size_type* data_ = nullptr;
@@ -62,6 +72,68 @@ namespace TiledArray {
     size_type offset_ = 0ul; ///< Ordinal index offset correction
     size_type volume_ = 0ul; ///< Total number of elements
     unsigned int rank_ = 0u; ///< The rank (or number of dimensions) in the range
+    size_type inline_data_[max_inline_rank << 2]; ///< Storage for the dimension
+                      ///< information of ranges with rank <= \c max_inline_rank
+
+    /// Allocate the dimension data array
+
+    /// \param rank The rank of the range
+    /// \pre \c data_ does not hold memory, i.e. it is \c nullptr or the
+    /// memory was released with \c dealloc()
+    /// \post \c data_ holds \c 4*rank elements, and \c rank_ is \c rank
+    /// \throw std::bad_alloc When memory allocation fails.
+    void alloc(const unsigned int rank) {
+      data_ = (rank == 0u ? nullptr :
+          (rank <= max_inline_rank ? inline_data_ : new size_type[rank << 2]));
+      rank_ = rank;
+    }
+
+    /// Release the dimension data array
+
+    /// \post \c data_ is \c nullptr and \c rank_ is zero
+    void dealloc() {
+      if(data_ != inline_data_)
+        delete [] data_;
+      data_ = nullptr;
+      rank_ = 0u;
+    }
+
+    /// Reallocate the dimension data array
+
+    /// The array is reused if its rank is equal to \c rank ; the content of
+    /// the array is not preserved otherwise.
+    /// \param rank The new rank of the range
+    /// \throw std::bad_alloc When memory allocation fails.
+    void realloc(const unsigned int rank) {
+      if(rank_ != rank) {
+        dealloc();
+        alloc(rank);
+      }
+    }
+
+    /// Take the data of another range
+
+    /// Heap memory is transferred to this object, while the dimension data of
+    /// ranges that fit into the inline storage is copied.
+    /// \param other The range to be moved
+    /// \pre \c data_ does not hold memory
+    /// \post \c other is an empty range
+    void move_data(Range_& other) {
+      if(other.data_ == other.inline_data_) {
+        data_ = inline_data_;
+        memcpy(data_, other.data_, (sizeof(size_type) << 2) * other.rank_);
+      } else {
+        data_ = other.data_;
+      }
+      offset_ = other.offset_;
+      volume_ = other.volume_;
+      rank_ = other.rank_;
+
+      other.data_ = nullptr;
+      other.offset_ = 0ul;
+      other.volume_ = 0ul;
+      other.rank_ = 0u;
+    }
 
   private:
 
@@ -309,8 +381,7 @@ namespace TiledArray {
       TA_ASSERT(n == detail::size(upper_bound));
       if(n) {
         // Initialize array memory
-        data_ = new size_type[n << 2];
-        rank_ = n;
+        alloc(n);
         init_range_data(lower_bound, upper_bound);
       }
     }
@@ -333,8 +404,7 @@ namespace TiledArray {
       TA_ASSERT(n == detail::size(upper_bound));
       if(n) {
         // Initialize array memory
-        data_ = new size_type[n << 2];
-        rank_ = n;
+        alloc(n);
         init_range_data(lower_bound, upper_bound);
       }
     }
@@ -353,8 +423,7 @@ namespace TiledArray {
       const size_type n = detail::size(extent);
       if(n) {
         // Initialize array memory
-        data_ = new size_type[n << 2];
-        rank_ = n;
+        alloc(n);
         init_range_data(extent);
       }
     }
@@ -371,8 +440,7 @@ namespace TiledArray {
       const size_type n = detail::size(extent);
       if(n) {
         // Initialize array memory
-        data_ = new size_type[n << 2];
-        rank_ = n;
+        alloc(n);
         init_range_data(extent);
       }
     }
@@ -393,8 +461,7 @@ namespace TiledArray {
       const size_type n = detail::size(bounds);
       if(n) {
         // Initialize array memory
-        data_ = new size_type[n << 2];
-        rank_ = n;
+        alloc(n);
         init_range_data(bounds);
       }
     }
@@ -413,8 +480,7 @@ namespace TiledArray {
       const size_type n = detail::size(bounds);
       if(n) {
         // Initialize array memory
-        data_ = new size_type[n << 2];
-        rank_ = n;
+        alloc(n);
         init_range_data(bounds);
       }
     }
@@ -450,27 +516,18 @@ namespace TiledArray {
     /// \throw std::bad_alloc When memory allocation fails.
     Range(const Range_& other) {
       if(other.rank_ > 0ul) {
-        data_ = new size_type[other.rank_ << 2];
+        alloc(other.rank_);
         offset_ = other.offset_;
         volume_ = other.volume_;
-        rank_ = other.rank_;
         memcpy(data_, other.data_, (sizeof(size_type) << 2) * other.rank_);
       }
     }
 
-    /// Copy Constructor
+    /// Move Constructor
 
-    /// \param other The range to be copied
-    /// \throw std::bad_alloc When memory allocation fails.
-    Range(Range_&& other) :
-      data_(other.data_), offset_(other.offset_), volume_(other.volume_),
-      rank_(other.rank_)
-    {
-      other.data_ = nullptr;
-      other.offset_ = 0ul;
-      other.volume_ = 0ul;
-      other.rank_ = 0u;
-    }
+    /// \param other The range to be moved
+    /// \throw nothing
+    Range(Range_&& other) noexcept { move_data(other); }
 
     /// Permuting copy constructor
 
@@ -481,8 +538,7 @@ namespace TiledArray {
       TA_ASSERT(perm.dim() == other.rank_);
 
       if(other.rank_ > 0ul) {
-        data_ = new size_type[other.rank_ << 2];
-        rank_ = other.rank_;
+        alloc(other.rank_);
 
         if(perm) {
           init_range_data(perm, other.data_, other.data_ + rank_);
@@ -496,7 +552,7 @@ namespace TiledArray {
     }
 
     /// Destructor
-    ~Range() { delete [] data_; }
+    ~Range() { dealloc(); }
 
     /// Copy assignment operator
 
@@ -504,11 +560,7 @@ namespace TiledArray {
     /// \return A reference to this object
     /// \throw std::bad_alloc When memory allocation fails.
     Range_& operator=(const Range_& other) {
-      if(rank_ != other.rank_) {
-        delete [] data_;
-        data_ = (other.rank_ > 0ul ? new size_type[other.rank_ << 2] : nullptr);
-        rank_ = other.rank_;
-      }
+      realloc(other.rank_);
       memcpy(data_, other.data_, (sizeof(size_type) << 2) * rank_);
       offset_ = other.offset_;
       volume_ = other.volume_;
@@ -521,16 +573,11 @@ namespace TiledArray {
     /// \param other The range to be copied
     /// \return A reference to this object
     /// \throw nothing
-    Range_& operator=(Range_&& other) {
-      data_ = other.data_;
-      offset_ = other.offset_;
-      volume_ = other.volume_;
-      rank_ = other.rank_;
-
-      other.data_ = nullptr;
-      other.offset_ = 0ul;
-      other.volume_ = 0ul;
-      other.rank_ = 0u;
+    Range_& operator=(Range_&& other) noexcept {
+      if(this != &other) {
+        dealloc();
+        move_data(other);
+      }
 
       return *this;
     }
@@ -761,11 +808,7 @@ namespace TiledArray {
       TA_ASSERT(n == detail::size(upper_bound));
 
       // Reallocate memory for range arrays
-      if(rank_ != n) {
-        delete [] data_;
-        data_ = (n > 0ul ? new size_type[n << 2] : nullptr);
-        rank_ = n;
-      }
+      realloc(n);
       if(n > 0ul)
         init_range_data(lower_bound, upper_bound);
       else
@@ -931,11 +974,7 @@ namespace TiledArray {
 
       // Reallocate the array
       const unsigned int four_x_rank = rank << 2;
-      if(rank_ != rank) {
-        delete [] data_;
-        data_ = (rank > 0u ? new size_type[four_x_rank] : nullptr);
-        rank_ = rank;
-      }
+      realloc(rank);
 
       // Get range data
       ar & madness::archive::wrap(data_, four_x_rank) & offset_ & volume_;
@@ -948,11 +987,11 @@ namespace TiledArray {
     }
 
     void swap(Range_& other) {
-      // Get temp data
-      std::swap(data_, other.data_);
-      std::swap(offset_, other.offset_);
-      std::swap(volume_, other.volume_);
-      std::swap(rank_, other.rank_);
+      // Inline data cannot be exchanged by swapping pointers, so swap with
+      // moves, which do not allocate memory.
+      Range_ temp(std::move(other));
+      other = std::move(*this);
+      *this = std::move(temp);
     }
 
   private:
@@ -1039,14 +1078,17 @@ namespace TiledArray {
     TA_ASSERT(perm.dim() == rank_);
     if(rank_ > 1ul) {
       // Copy the lower and upper bound data into a temporary array
-      size_type* MADNESS_RESTRICT const temp_lower = new size_type[rank_ << 1];
+      size_type temp_buffer[max_inline_rank << 1];
+      size_type* MADNESS_RESTRICT const temp_lower =
+          (rank_ <= max_inline_rank ? temp_buffer : new size_type[rank_ << 1]);
       const size_type* MADNESS_RESTRICT const temp_upper = temp_lower + rank_;
       std::memcpy(temp_lower, data_, (sizeof(size_type) << 1) * rank_);
 
       init_range_data(perm, temp_lower, temp_upper);
 
       // Cleanup old memory.
-      delete[] temp_lower;
+      if(temp_lower != temp_buffer)
+        delete[] temp_lower;
     }
     return *this;
   }
@@ -23,6 +23,8 @@
 #include <TiledArray/config.h>
 #include <TiledArray/error.h>
 #include <TiledArray/madness.h>
+#include <TiledArray/math/reproducible.h>
+#include <vector>
 
 namespace TiledArray {
   namespace detail {
@@ -63,6 +65,39 @@ namespace TiledArray {
     private:
       opT op_; ///< The pairwise reduction operation
 
+      /// Query the batch flag of the pairwise operation
+
+      /// \return The result of <tt>op.batch(first, second)</tt>
+      template <typename Op>
+      static auto batch(const Op& op, const first_argument_type& first,
+          const second_argument_type& second, int) ->
+          decltype(op.batch(first, second))
+      { return op.batch(first, second); }
+
+      /// Pairwise operations without a batch interface are never batched
+      template <typename Op>
+      static bool batch(const Op&, const first_argument_type&,
+          const second_argument_type&, long)
+      { return false; }
+
+      /// Reduce a batch of argument pairs with the batched pairwise operation
+      template <typename Op>
+      static auto reduce_batch(const Op& op, result_type& result,
+          const std::vector<const first_argument_type*>& first,
+          const std::vector<const second_argument_type*>& second, int) ->
+          decltype(op(result, first, second))
+      { return op(result, first, second); }
+
+      /// Reduce a batch of argument pairs one pair at a time
+      template <typename Op>
+      static void reduce_batch(const Op& op, result_type& result,
+          const std::vector<const first_argument_type*>& first,
+          const std::vector<const second_argument_type*>& second, long)
+      {
+        for(std::size_t i = 0ul; i < first.size(); ++i)
+          op(result, *first[i], *second[i]);
+      }
+
     public:
       /// Default constructor
       ReducePairOpWrapper() : op_() { }
@@ -112,6 +147,34 @@ namespace TiledArray {
         op_(result, arg.first, arg.second);
       }
 
+      /// Batch reduction flag
+
+      /// \param[in] arg The argument pair to be reduced
+      /// \return \c true if \c arg may be reduced together with other
+      /// argument pairs that are ready, i.e. when the pairwise operation
+      /// provides <tt>batch(first, second)</tt> and it returns \c true
+      bool batch(const argument_type& arg) const {
+        return batch(op_, arg.first.get(), arg.second.get(), 0);
+      }
+
+      /// Reduce a batch of argument pairs
+
+      /// \param[out] result The object that will hold the result of this reduction
+      /// \param[in] args The argument pairs to be reduced
+      void operator()(result_type& result,
+          const std::vector<const argument_type*>& args) const
+      {
+        std::vector<const first_argument_type*> first;
+        std::vector<const second_argument_type*> second;
+        first.reserve(args.size());
+        second.reserve(args.size());
+        for(const argument_type* arg : args) {
+          first.push_back(& arg->first.get());
+          second.push_back(& arg->second.get());
+        }
+        reduce_batch(op_, result, first, second, 0);
+      }
+
     }; // class ReducePairOpWrapper
 
 
@@ -157,6 +220,19 @@ namespace TiledArray {
     /// }; // struct ReductionOp
     /// \endcode
     ///
+    /// Optionally, the reduction operation may reduce several arguments at
+    /// once. Arguments for which <tt>batch(arg)</tt> returns \c true are
+    /// not paired with each other; instead they are queued while the result
+    /// object is busy, and the task that holds the result object reduces all
+    /// queued arguments with a single call:
+    /// \code
+    ///     // Check that an argument may be reduced in a batch
+    ///     bool batch(const argument_type&) const;
+    ///
+    ///     // Reduce a batch of arguments
+    ///     void operator()(result_type&, const std::vector<const argument_type*>&) const;
+    /// \endcode
+    ///
     /// For example, a vector sum function might look like:
     ///
     /// \code
@@ -302,6 +378,50 @@ namespace TiledArray {
           return PoolTaskInterface::make_id(id, *this);
         }
 
+        /// Query the batch flag of the reduction operation
+
+        /// \return The result of <tt>op.batch(arg)</tt>
+        template <typename Op>
+        static auto batch(const Op& op, const argument_type& arg, int) ->
+            decltype(op.batch(arg))
+        { return op.batch(arg); }
+
+        /// Operations without a batch interface are never batched
+        template <typename Op>
+        static bool batch(const Op&, const argument_type&, long) { return false; }
+
+        /// Reduce a batch of arguments with the batched reduction operation
+        template <typename Op>
+        static auto reduce_batch(const Op& op, result_type& result,
+            const std::vector<const argument_type*>& args, int) ->
+            decltype(op(result, args))
+        { return op(result, args); }
+
+        /// Reduce a batch of arguments one at a time
+        template <typename Op>
+        static void reduce_batch(const Op& op, result_type& result,
+            const std::vector<const argument_type*>& args, long)
+        {
+          for(const argument_type* arg : args)
+            op(result, *arg);
+        }
+
+        /// Reduce all batched arguments
+
+        /// \param result The target of the reduction
+        /// \param objects The batched reduction arguments
+        void reduce(result_type& result, const std::vector<ReduceObject*>& objects) {
+          if(objects.size() == 1ul) {
+            op_(result, objects.front()->arg());
+          } else {
+            std::vector<const argument_type*> args;
+            args.reserve(objects.size());
+            for(const ReduceObject* object : objects)
+              args.push_back(& object->arg());
+            reduce_batch(op_, result, args, 0);
+          }
+        }
+
         /// Check for ready reduce arguments and reduce them
 
         /// This function will check for and reduce data that is ready until
@@ -313,7 +433,21 @@ namespace TiledArray {
         void reduce(std::shared_ptr<result_type>& result) {
           while(result) {
             lock_.lock(); // <<< Begin critical section
-            if(ready_object_) {
+            if(! batch_objects_.empty()) {
+              // Get the batched arguments
+              std::vector<ReduceObject*> objects;
+              objects.swap(batch_objects_);
+              lock_.unlock(); // <<< End critical section
+
+              // Reduce the arguments that were held by batch_objects_
+              reduce(*result, objects);
+
+              // cleanup the arguments
+              for(ReduceObject* object : objects) {
+                ReduceObject::destroy(object);
+                this->dec();
+              }
+            } else if(ready_object_) {
               // Get the ready argument
               ReduceObject* ready_object = const_cast<ReduceObject*>(ready_object_);
               ready_object_ = nullptr;
@@ -390,6 +524,7 @@ namespace TiledArray {
         opT op_; ///< The reduction operation
         std::shared_ptr<result_type> ready_result_; ///< Result object that is ready to be reduced
         volatile ReduceObject* ready_object_; ///< Reduction argument that is ready to be reduced
+        std::vector<ReduceObject*> batch_objects_; ///< Ready reduction arguments that will be reduced in a batch
         Future<result_type> result_; ///< The result of the reduction task
         madness::Spinlock lock_; ///< Task lock
         madness::CallbackInterface* callback_; ///< The completion callback
@@ -405,7 +540,8 @@ namespace TiledArray {
         ReduceTaskImpl(World& world, opT op, madness::CallbackInterface* callback) :
           madness::TaskInterface(1, TaskAttributes::hipri()),
           world_(world), op_(op), ready_result_(std::make_shared<result_type>(op())),
-          ready_object_(nullptr), result_(), lock_(), callback_(callback)
+          ready_object_(nullptr), batch_objects_(), result_(), lock_(),
+          callback_(callback)
         { }
 
         virtual ~ReduceTaskImpl() { }
@@ -422,10 +558,12 @@ namespace TiledArray {
 
         /// This function will place \c object in the ready state. If
         /// another object is already in the ready state, then both objects
-        /// are used to spawn a task
+        /// are used to spawn a task. Objects that may be reduced in a batch
+        /// are queued until the task that holds the result reduces them.
         /// \param object The reduction object that is ready to be reduced
         void ready(ReduceObject* object) {
           TA_ASSERT(object);
+          const bool batch_object = batch(op_, object->arg(), 0);
           lock_.lock(); // <<< Begin critical section
           if(ready_result_) {
             std::shared_ptr<result_type> ready_result = ready_result_;
@@ -434,6 +572,9 @@ namespace TiledArray {
             TA_ASSERT(ready_result);
             world_.taskq.add(this, & ReduceTaskImpl::reduce_result_object,
                 ready_result, object, TaskAttributes::hipri());
+          } else if(batch_object) {
+            batch_objects_.push_back(object);
+            lock_.unlock(); // <<< End critical section
           } else if(ready_object_) {
             ReduceObject* ready_object = const_cast<ReduceObject*>(ready_object_);
             ready_object_ = nullptr;
@@ -709,6 +850,299 @@ namespace TiledArray {
 
     }; // class ReducePairTask
 
+
+    /// Ordered reduce task
+
+    /// This task reduces an arbitrary number of arguments, like
+    /// \c ReduceTask , but the order of the reduction only depends on the
+    /// order in which the arguments were added: each argument is reduced by
+    /// a separate task, and the argument results are combined with a
+    /// pairwise tree (see \c math::tree_reduce ). Floating point results are
+    /// therefore reproducible, at the cost of waiting for specific pairs of
+    /// results. The reduction operation has the same form as for
+    /// \c ReduceTask , though batch reductions are not used.
+    /// \tparam opT The reduction operation type
+    template <typename opT>
+    class OrderedReduceTask {
+    protected:
+      typedef typename opT::result_type result_type;
+
+    private:
+      World* world_; ///< The world that owns the reduction tasks
+      opT op_; ///< The reduction operation
+      std::vector<Future<result_type> > results_; ///< Argument results, in order
+
+      template <typename Op, typename... Args>
+      static result_type reduce_arg(const Op& op, const Args&... args) {
+        result_type result = op();
+        op(result, args...);
+        return result;
+      }
+
+      static result_type join(opT op, result_type left, const result_type& right) {
+        op(left, right);
+        return left;
+      }
+
+      static result_type finalize(opT op, result_type result) {
+        return op(result);
+      }
+
+    protected:
+
+      /// Add an argument result to the reduction
+
+      /// \tparam Op The argument reduction operation type
+      /// \tparam Args The reduction argument types
+      /// \param op The operation that reduces the arguments
+      /// \param args The reduction arguments; these may be futures
+      template <typename Op, typename... Args>
+      void add_result(const Op& op, const Args&... args) {
+        TA_ASSERT(world_);
+        results_.push_back(world_->taskq.add(& OrderedReduceTask::template
+            reduce_arg<Op, typename madness::remove_future<Args>::type...>,
+            op, args..., madness::TaskAttributes::hipri()));
+      }
+
+      const opT& op() const { return op_; }
+
+    public:
+
+      /// Default constructor
+      OrderedReduceTask() : world_(nullptr), op_(), results_() { }
+
+      /// Constructor
+
+      /// \param world The world that owns this task
+      /// \param op The reduction operation [ default = opT() ]
+      OrderedReduceTask(World& world, const opT& op = opT()) :
+        world_(& world), op_(op), results_()
+      { }
+
+      OrderedReduceTask(OrderedReduceTask<opT>&&) = default;
+      OrderedReduceTask<opT>& operator=(OrderedReduceTask<opT>&&) = default;
+
+      // Non-copyable
+      OrderedReduceTask(const OrderedReduceTask<opT>&) = delete;
+      OrderedReduceTask<opT>& operator=(const OrderedReduceTask<opT>&) = delete;
+
+      /// Add an argument to the reduction task
+
+      /// \c arg may be of the argument type of \c opT, a \c Future to the
+      /// argument type, or \c RemoteReference<FutureImpl> to the argument
+      /// type.
+      /// \tparam Arg The argument type
+      /// \param arg The argument that will be reduced
+      /// \return The number of arguments
+      template <typename Arg>
+      int add(const Arg& arg) {
+        typedef typename std::remove_const<typename std::remove_reference<
+            typename opT::argument_type>::type>::type argument_type;
+        add_result(op_, Future<argument_type>(arg));
+        return results_.size();
+      }
+
+      /// Argument count
+
+      /// \return The total number of arguments added to this task
+      int count() const { return results_.size(); }
+
+      /// Submit the reduction
+
+      /// \return The result of the reduction
+      /// \note Arguments can no longer be added to the reduction after
+      /// calling \c submit().
+      Future<result_type> submit() {
+        TA_ASSERT(world_);
+        if(results_.empty())
+          results_.emplace_back(op_());
+
+        // Combine the argument results with a pairwise tree
+        for(std::size_t stride = 1ul; stride < results_.size(); stride <<= 1)
+          for(std::size_t i = 0ul; (i + stride) < results_.size(); i += (stride << 1))
+            results_[i] = world_->taskq.add(& OrderedReduceTask::join, op_,
+                results_[i], results_[i + stride], madness::TaskAttributes::hipri());
+
+        Future<result_type> result = world_->taskq.add(& OrderedReduceTask::finalize,
+            op_, results_.front(), madness::TaskAttributes::hipri());
+        results_.clear();
+        world_ = nullptr;
+        return result;
+      }
+
+      /// Type conversion operator
+
+      /// \return \c true if the task object is initialized.
+      operator bool() const { return world_ != nullptr; }
+
+    }; // class OrderedReduceTask
+
+
+    /// Ordered reduce pair task
+
+    /// This task reduces an arbitrary number of argument pairs, like
+    /// \c ReducePairTask , in the order in which they were added (see
+    /// \c OrderedReduceTask ).
+    /// \tparam opT The pair reduction operation type
+    template <typename opT>
+    class OrderedReducePairTask : public OrderedReduceTask<opT> {
+    private:
+      typedef OrderedReduceTask<opT> OrderedReduceTask_; ///< The base class
+
+    public:
+
+      /// Default constructor
+      OrderedReducePairTask() : OrderedReduceTask_() { }
+
+      /// Constructor
+
+      /// \param world The world that owns this task
+      /// \param op The pair reduction operation [ default = opT() ]
+      OrderedReducePairTask(World& world, const opT& op = opT()) :
+        OrderedReduceTask_(world, op)
+      { }
+
+      /// Add a pair of arguments to the reduction task
+
+      /// \c left and \c right may be of the argument types of \c opT, a
+      /// \c Future to the argument types,
+      /// \c RemoteReference<FutureImpl> to the argument
+      /// types, or any combination of the above.
+      /// \tparam L The left-hand object type
+      /// \tparam R The right-hand object type
+      /// \param left The left-hand argument that will be reduced
+      /// \param right The right-hand argument that will be reduced
+      template <typename L, typename R>
+      void add(const L& left, const R& right) {
+        typedef typename std::remove_const<typename std::remove_reference<
+            typename opT::first_argument_type>::type>::type first_argument_type;
+        typedef typename std::remove_const<typename std::remove_reference<
+            typename opT::second_argument_type>::type>::type second_argument_type;
+        OrderedReduceTask_::add_result(OrderedReduceTask_::op(),
+            Future<first_argument_type>(left), Future<second_argument_type>(right));
+      }
+
+    }; // class OrderedReducePairTask
+
+
+    /// Partial results of the processes of a reproducible all-reduce
+
+    /// \tparam T The result type
+    template <typename T>
+    struct RankResults {
+      std::vector<T> values; ///< The result of each process
+      std::vector<unsigned char> flags; ///< Non-zero for processes with a result
+
+      /// Merge operation, which fills the results of other processes
+
+      /// Merging is exact, so the all-reduce tree of the runtime does not
+      /// affect the result.
+      struct MergeOp {
+        typedef RankResults<T> result_type;
+
+        result_type operator()() const { return result_type(); }
+
+        const result_type& operator()(const result_type& result) const { return result; }
+
+        void operator()(result_type& result, const result_type& arg) const {
+          if(result.values.empty()) {
+            result = arg;
+            return;
+          }
+          for(std::size_t i = 0ul; i < arg.flags.size(); ++i) {
+            if(arg.flags[i]) {
+              result.values[i] = arg.values[i];
+              result.flags[i] = 1;
+            }
+          }
+        }
+      }; // struct MergeOp
+
+      template <typename Archive>
+      void serialize(Archive& ar) { ar & values & flags; }
+
+    }; // struct RankResults
+
+    template <typename T>
+    RankResults<T> make_rank_results(const std::size_t size,
+        const std::size_t rank, const T& value)
+    {
+      RankResults<T> result;
+      result.values.resize(size);
+      result.flags.resize(size, 0);
+      result.values[rank] = value;
+      result.flags[rank] = 1;
+      return result;
+    }
+
+    template <typename Op>
+    typename Op::result_type
+    reduce_rank_results(const Op& op, RankResults<typename Op::result_type> results) {
+      math::tree_reduce([&op] (typename Op::result_type& left,
+          const typename Op::result_type& right) { op(left, right); },
+          results.values);
+      return results.values.front();
+    }
+
+    /// Reproducible all-reduce
+
+    /// The results of all processes are gathered on every process and
+    /// combined with a pairwise tree in rank order, so all processes get the
+    /// same, reproducible result. The amount of data grows with the number of
+    /// processes, so this should only be used for small result types.
+    /// \tparam Key The key type
+    /// \tparam Op The reduction operation type
+    /// \param world The world of the reduction
+    /// \param key The key of the all-reduce
+    /// \param value The result of this process
+    /// \param op The reduction operation, which is called as
+    /// <tt>op(result, value)</tt> to combine the results of two processes
+    /// \return The reduced result
+    template <typename Key, typename Op>
+    Future<typename Op::result_type>
+    reproducible_all_reduce(World& world, const Key& key,
+        const Future<typename Op::result_type>& value, const Op& op)
+    {
+      typedef typename Op::result_type result_type;
+      Future<RankResults<result_type> > local = world.taskq.add(
+          & make_rank_results<result_type>, std::size_t(world.size()),
+          std::size_t(world.rank()), value);
+      Future<RankResults<result_type> > all = world.gop.all_reduce(key, local,
+          typename RankResults<result_type>::MergeOp());
+      return world.taskq.add(& reduce_rank_results<Op>, op, all);
+    }
+
+    /// All-reduce of local arguments
+
+    /// The local arguments are reduced with a \c ReduceTask and combined with
+    /// the results of the other processes with an all-reduce. When
+    /// reproducible reductions are enabled (see
+    /// \c math::reproducible_reduce() ), an \c OrderedReduceTask and
+    /// \c reproducible_all_reduce() are used instead.
+    /// \tparam Key The key type
+    /// \tparam Op The reduction operation type
+    /// \tparam AddArgs The argument generator type
+    /// \param world The world of the reduction
+    /// \param key The key of the all-reduce
+    /// \param op The reduction operation
+    /// \param add_args The argument generator, which is called as
+    /// <tt>add_args(reduce_task)</tt> and adds the local arguments with
+    /// <tt>reduce_task.add(arg)</tt>
+    /// \return The reduced result
+    template <typename Key, typename Op, typename AddArgs>
+    Future<typename Op::result_type>
+    all_reduce_args(World& world, const Key& key, const Op& op, AddArgs&& add_args) {
+      if(math::reproducible_reduce()) {
+        OrderedReduceTask<Op> reduce_task(world, op);
+        add_args(reduce_task);
+        return reproducible_all_reduce(world, key, reduce_task.submit(), op);
+      }
+
+      ReduceTask<Op> reduce_task(world, op);
+      add_args(reduce_task);
+      return world.gop.all_reduce(key, reduce_task.submit(), op);
+    }
+
   } // namespace detail
 } // namespace TiledArray
 
@@ -21,6 +21,8 @@
 #define TILEDARRAY_REPLICATOR_H__INCLUDED
 
 #include <TiledArray/madness.h>
+#include <algorithm>
+#include <cmath>
 
 namespace TiledArray {
   namespace detail {
@@ -28,7 +30,14 @@ namespace TiledArray {
     /// Replicate a \c Array object
 
     /// This object will create a replicated \c Array from a distributed
-    /// \c Array.
+    /// \c Array. Each tile is broadcast from its owner with a tree, where the
+    /// tree of a tile owned by rank \c r is the tree of rank 0 with ranks
+    /// shifted by \c r , so the forwarding work is spread over all nodes.
+    /// Tiles are sent in separate messages, as soon as they are ready, and
+    /// each replicated tile can be used as soon as it arrives. The fan-out of
+    /// the tree is \f$ \lceil \sqrt{P - 1} \rceil \f$ for \f$ P \f$ nodes,
+    /// so a tile reaches all nodes after at most two forwarding steps, and no
+    /// node sends more than \f$ 2 \sqrt{P} \f$ messages per tile.
     /// \tparam A The array type
     /// Homeworld = M7R-227
     template <typename A>
@@ -37,14 +46,15 @@ namespace TiledArray {
       typedef Replicator<A> Replicator_; ///< This object type
       typedef madness::WorldObject<Replicator_> wobj_type; ///< The base object type
       typedef std::stack<madness::CallbackInterface*, std::vector<madness::CallbackInterface*> > callback_type; ///< Callback interface
+      typedef typename A::size_type size_type; ///< The tile index type
+      typedef typename A::value_type value_type; ///< The tile type
 
       A destination_; ///< The replicated array
-      std::vector<typename A::size_type> indices_; ///< List of local tile indices
-      std::vector<Future<typename A::value_type> > data_; ///< List of local tiles
-      madness::AtomicInt sent_; ///< The number of nodes the data has been sent to
       World& world_;
+      ProcessID fan_out_; ///< The number of children of a node in the tree
+      size_type expected_; ///< The number of non-zero tiles
+      madness::AtomicInt received_; ///< The number of tiles that have been received and forwarded
       volatile callback_type callbacks_; ///< A callback stack
-      volatile mutable bool probe_; ///< Cache for local data probe
 
       /// \note Assume object is already locked
       void do_callbacks() {
@@ -55,133 +65,69 @@ namespace TiledArray {
         }
       }
 
-      /// Task that will call send when all local tiles are ready to be sent
-      class DelaySend : public madness::TaskInterface {
-      private:
-        Replicator_& parent_; ///< The parent replicator operation
-
-      public:
-
-        /// Constructor
-        DelaySend(Replicator_& parent) :
-          madness::TaskInterface(madness::TaskAttributes::hipri()),
-          parent_(parent)
-        {
-          typename std::vector<Future<typename A::value_type> >::iterator it =
-              parent_.data_.begin();
-          typename std::vector<Future<typename A::value_type> >::iterator end =
-              parent_.data_.end();
-          for(; it != end; ++it) {
-            if(! it->probe()) {
-              madness::DependencyInterface::inc();
-              it->register_callback(this);
-            }
-          }
-        }
-
-        /// Virtual destructor
-        virtual ~DelaySend() { }
-
-        /// Task send task function
-        virtual void run(const madness::TaskThreadEnv&) { parent_.send(); }
-
-      }; // class DelaySend
-
-      /// Probe all local data has been set
-
-      /// \return \c true when all local tiles have been set
-      bool probe() const {
-        madness::ScopedMutex<madness::Spinlock> locker(this);
-
-        if(! probe_) {
-          typename std::vector<Future<typename A::value_type> >::const_iterator it =
-              data_.begin();
-          typename std::vector<Future<typename A::value_type> >::const_iterator end =
-              data_.end();
-          for(; it != end; ++it)
-            if(! it->probe())
-              break;
-
-          probe_ = (it == end);
-        }
-
-        return probe_;
-      }
-
-      /// Send data to the next node when it is ready
-      void delay_send() {
-        if(probe()) {
-          // The data is ready so send it now.
-          send(); // Replication is done
-        } else {
-          // The local data is not ready to be sent, so create a task that will
-          // send it when it is ready.
-          DelaySend* delay_send_task = new DelaySend(*this);
-          world_.taskq.add(delay_send_task);
+      /// Forward a tile to the children of this node in the tree of \c root
+
+      /// \param root The owner of the tile
+      /// \param index The tile index
+      /// \param tile The tile
+      void forward(const ProcessID root, const size_type index, const value_type& tile) {
+        const ProcessID size = world_.size();
+        const ProcessID rank = (world_.rank() + size - root) % size;
+        const ProcessID first = rank * fan_out_ + 1;
+        const ProcessID last = std::min<ProcessID>(first + fan_out_, size);
+        for(ProcessID child = first; child < last; ++child)
+          wobj_type::task((child + root) % size, & Replicator_::receive_handler,
+              root, index, tile, madness::TaskAttributes::hipri());
+
+        // Notify the callbacks when all tiles have been replicated
+        if((size_type(++received_) == expected_)) {
+          madness::ScopedMutex<madness::Spinlock> locker(this);
+          do_callbacks();
         }
       }
 
-      /// Send all local data to the next node
-      void send() {
-        const long sent = ++sent_;
-        const ProcessID dest = (world_.rank() + sent) % world_.size();
-
-        if(dest != world_.rank()) {
-          wobj_type::task(dest, &  Replicator_::send_handler, indices_, data_,
-              madness::TaskAttributes::hipri());
-        } else
-          do_callbacks(); // Replication is done
-      }
+      /// Store a tile and forward it in the tree of \c root
 
-      void send_handler(const std::vector<typename A::size_type>& indices,
-          const std::vector<Future<typename A::value_type> >& data)
+      /// \param root The owner of the tile
+      /// \param index The tile index
+      /// \param tile The tile
+      void receive_handler(const ProcessID root, const size_type index,
+          const value_type& tile)
       {
-        typename std::vector<typename A::size_type>::const_iterator index_it =
-            indices.begin();
-        typename std::vector<Future<typename A::value_type> >::const_iterator data_it =
-            data.begin();
-        typename std::vector<Future<typename A::value_type> >::const_iterator data_end =
-            data.end();
-
-        for(; data_it != data_end; ++data_it, ++index_it)
-          destination_.set(*index_it, data_it->get());
-
-        delay_send();
+        destination_.set(index, tile);
+        forward(root, index, tile);
       }
 
     public:
 
       Replicator(const A& source, const A destination) :
         wobj_type(source.world()), madness::Spinlock(),
-        destination_(destination), indices_(), data_(), sent_(),
-        world_(source.world()), callbacks_(), probe_(false)
+        destination_(destination), world_(source.world()),
+        fan_out_(std::max<ProcessID>(1, std::ceil(std::sqrt(double(world_.size() - 1))))),
+        expected_(0ul), received_(), callbacks_()
       {
-        sent_ = 0;
+        received_ = 0;
 
-        // Generate a list of local tiles from other.
-        typename A::pmap_interface::const_iterator end = source.pmap()->end();
-        typename A::pmap_interface::const_iterator it = source.pmap()->begin();
-        indices_.reserve(source.pmap()->local_size());
-        data_.reserve(source.pmap()->local_size());
+        // Count the tiles that will be received
         if(source.is_dense()) {
-          // When dense, all tiles are present
-          for(; it != end; ++it) {
-            indices_.push_back(*it);
-            data_.push_back(source.find(*it));
-            destination_.set(*it, data_.back());
-          }
+          expected_ = source.size();
         } else {
-          // When sparse, we need to generate a list
-          for(; it != end; ++it)
-            if(! source.is_zero(*it)) {
-              indices_.push_back(*it);
-              data_.push_back(source.find(*it));
-              destination_.set(*it, data_.back());
-            }
+          for(size_type index = 0ul; index < source.size(); ++index)
+            if(! source.is_zero(index))
+              ++expected_;
         }
 
-        /// Send the data to the first node
-        delay_send();
+        // Store the local tiles and start the broadcast of each tile when it
+        // is ready
+        for(const size_type index : * source.pmap()) {
+          if(source.is_zero(index))
+            continue;
+
+          Future<value_type> tile = source.find(index);
+          destination_.set(index, tile);
+          wobj_type::task(world_.rank(), & Replicator_::forward, world_.rank(),
+              index, tile, madness::TaskAttributes::hipri());
+        }
 
         // Process any pending messages
         wobj_type::process_pending();
@@ -189,22 +135,23 @@ namespace TiledArray {
 
       /// Check that the replication is complete
 
-      /// \return \c true when all data has been transfered.
+      /// \return \c true when all tiles have been received and forwarded by
+      /// this node.
       bool done() {
         madness::ScopedMutex<madness::Spinlock> locker(this);
-        return sent_ == world_.size();
+        return size_type(received_) == expected_;
       }
 
 
       /// Add a callback
 
-      /// The callback is called when the local data has been sent to all
-      /// nodes. If the data has already been sent to all nodes, the callback
+      /// The callback is called when all tiles have been received and
+      /// forwarded by this node. If this has already happened, the callback
       /// is notified immediately.
       /// \param callback The callback object
       void register_callback(madness::CallbackInterface* callback) {
           madness::ScopedMutex<madness::Spinlock> locker(this);
-          if(sent_ == world_.size())
+          if(size_type(received_) == expected_)
             callback->notify();
           else
             const_cast<callback_type&>(callbacks_).push(callback);
@@ -275,11 +275,84 @@ namespace TiledArray {
       }
     }
 
+  private:
+
+    /// Norm tensors with at most this many tiles are summed directly
+    static constexpr size_type reduce_norms_direct_size = 4096ul;
+
+    /// Sum tile norms across all processes
+
+    /// Norm tensors with more than \c reduce_norms_direct_size tiles are
+    /// split into blocks of at most 8 tiles in each dimension. The processes
+    /// agree on the blocks that hold non-zero norms on at least one process
+    /// with an all reduce of the block max-norms, then only the norms of
+    /// those blocks are packed into a contiguous buffer and summed. Smaller
+    /// norm tensors are summed directly. The choice depends only on the tile
+    /// range, so all processes call the same collectives.
+    /// \param world The world where the norms are reduced
+    /// \param tile_norms The tile norms of this process; on output, the sum
+    /// of the tile norms of all processes
+    static void reduce_norms(World& world, Tensor<value_type>& tile_norms) {
+      if(world.size() == 1)
+        return;
+
+      if(tile_norms.size() <= reduce_norms_direct_size) {
+        world.gop.sum(tile_norms.data(), tile_norms.size());
+        return;
+      }
+
+      // Compute the number of blocks in each dimension
+      const Range& range = tile_norms.range();
+      const unsigned int rank = range.rank();
+      const auto* MADNESS_RESTRICT const lower = range.lobound_data();
+      std::vector<size_type> block_extent(rank);
+      size_type blocks = 1ul;
+      for(unsigned int d = 0u; d < rank; ++d) {
+        block_extent[d] = (range.extent(d) + 7ul) >> 3;
+        blocks *= block_extent[d];
+      }
+      auto block_ordinal = [&] (const auto& index) {
+        size_type block = 0ul;
+        for(unsigned int d = 0u; d < rank; ++d)
+          block = block * block_extent[d] + ((index[d] - lower[d]) >> 3);
+        return block;
+      };
+
+      // Find the blocks that are non-zero on any process
+      std::vector<value_type> block_norms(blocks, value_type(0));
+      size_type i = 0ul;
+      for(auto it = range.begin(); it != range.end(); ++it, ++i) {
+        value_type& block_norm = block_norms[block_ordinal(*it)];
+        block_norm = std::max(block_norm, tile_norms[i]);
+      }
+      world.gop.max(block_norms.data(), block_norms.size());
+
+      // Pack, reduce, and unpack the norms of the non-zero blocks
+      std::vector<value_type> buffer;
+      buffer.reserve(tile_norms.size());
+      i = 0ul;
+      for(auto it = range.begin(); it != range.end(); ++it, ++i)
+        if(block_norms[block_ordinal(*it)] > value_type(0))
+          buffer.push_back(tile_norms[i]);
+
+      if(buffer.empty())
+        return;
+      world.gop.sum(buffer.data(), buffer.size());
+
+      auto buffer_it = buffer.cbegin();
+      i = 0ul;
+      for(auto it = range.begin(); it != range.end(); ++it, ++i)
+        if(block_norms[block_ordinal(*it)] > value_type(0))
+          tile_norms[i] = *buffer_it++;
+    }
+
+  public:
+
     /// Collective "dense" constructor
 
     /// This constructor uses tile norms given as a dense tensor.
-    /// The tile norms data are summed across all processes (via
-    /// an all reduce).
+    /// The tile norms data are summed across all processes (see
+    /// \c reduce_norms ).
     /// Next, the norms are converted to per-element norms by dividing each
     /// norm by the number of elements in the corresponding tile.
     /// \param world The world where the shape will live
@@ -294,7 +367,7 @@ namespace TiledArray {
       TA_ASSERT(tile_norms_.range() == trange.tiles_range());
 
       // reduce norm data from all processors
-      world.gop.sum(tile_norms_.data(), tile_norms_.size());
+      reduce_norms(world, tile_norms_);
 
       normalize();
     }
@@ -316,7 +389,7 @@ namespace TiledArray {
                 const SparseNormSequence& tile_norms,
                 const TiledRange& trange) : SparseShape(tile_norms, trange)
     {
-      world.gop.sum(tile_norms_.data(), tile_norms_.size());
+      reduce_norms(world, tile_norms_);
     }
 
     /// Copy constructor
@@ -364,6 +437,11 @@ namespace TiledArray {
     /// \return true
     static constexpr bool is_dense() { return false; }
 
+    /// The fraction of non-zero norm products above which \c gemm()
+    /// uses BLAS, which computes about ten products in the time the indexed
+    /// kernel takes for one
+    static constexpr double gemm_norms_dense_fraction = 0.1;
+
     /// Sparsity of the shape
 
     /// \return The fraction of tiles that are zero.
@@ -990,6 +1068,142 @@ namespace TiledArray {
       return zero_tile_count;
     }
 
+    /// Sparse product of norm matrices
+
+    /// Compute the row-major \c M*N matrix of norms
+    /// \f[
+    /// {(\rm{result})}_{mn} = |(\rm{factor})| \sum_k (\rm{left})_{mk} N_k (\rm{right})_{kn}
+    /// \f]
+    /// where \f$ N_k \f$ is the size of inner tile \f$ k \f$ , and hard zero
+    /// the norms that are below the threshold. When the fraction of
+    /// products of non-zero norms is above \c gemm_norms_dense_fraction ,
+    /// the left-hand norms are scaled by the inner tile sizes and the result
+    /// is computed with \c math::gemm . Otherwise, the arguments are not
+    /// scaled or copied. Instead, the non-zero norms of each row of \c right
+    /// are indexed, as in a compressed-row matrix, and only the products of
+    /// non-zero norms of \c left and \c right are accumulated. Rows of
+    /// \c right with more non-zero than zero norms are accumulated densely.
+    /// When Intel TBB is available, the rows of large sparse products are
+    /// computed in parallel.
+    /// \param M The number of rows of \c left and \c result
+    /// \param N The number of columns of \c right and \c result
+    /// \param K The number of columns of \c left and rows of \c right
+    /// \param factor The absolute value of the scaling factor
+    /// \param left The \c M*K matrix of left-hand norms
+    /// \param right The \c K*N matrix of right-hand norms
+    /// \param k_sizes The sizes of the \c K inner tiles
+    /// \param[out] result The \c M*N result matrix, which must be zero
+    /// initialized
+    /// \param[in,out] zero_tile_count The number of zero result norms is added
+    /// to this counter
+    static void gemm_norms(const integer M, const integer N, const integer K,
+        const value_type factor, const value_type* const left,
+        const value_type* const right, const value_type* const k_sizes,
+        value_type* const result, madness::AtomicInt& zero_tile_count)
+    {
+      const value_type threshold = threshold_;
+
+      // Count the non-zero norms of the arguments
+      const integer MK = M * K, KN = K * N;
+      const integer left_nonzero = std::count_if(left, left + MK,
+          [] (const value_type norm) { return norm != value_type(0); });
+      const integer right_nonzero = std::count_if(right, right + KN,
+          [] (const value_type norm) { return norm != value_type(0); });
+
+      if((double(left_nonzero) * double(right_nonzero)) >
+          (gemm_norms_dense_fraction * double(MK) * double(KN)))
+      {
+        // Scale the columns of left by the inner tile sizes, and contract
+        // with BLAS.
+        std::unique_ptr<value_type[]> scaled_left(new value_type[MK]);
+        auto left_op = [] (const value_type left, const value_type right)
+            { return left * right; };
+        for(integer i = 0; i < MK; i += K)
+          math::vector_op(left_op, K, scaled_left.get() + i, left + i, k_sizes);
+
+        math::gemm(madness::cblas::NoTrans, madness::cblas::NoTrans, M, N, K,
+            factor, scaled_left.get(), K, right, N, value_type(0), result, N);
+
+        // Hard zero tiles that are below the zero threshold.
+        int zero_count = 0;
+        for(integer i = 0; i < M * N; ++i) {
+          if(result[i] < threshold) {
+            result[i] = value_type(0);
+            ++zero_count;
+          }
+        }
+        zero_tile_count += zero_count;
+        return;
+      }
+
+      // Index the non-zero norms of each row of right
+      std::vector<integer> right_row_ptr(K + 1, 0);
+      std::vector<integer> right_cols;
+      right_cols.reserve(right_nonzero);
+      for(integer k = 0; k < K; ++k) {
+        const value_type* MADNESS_RESTRICT const right_k = right + k * N;
+        for(integer n = 0; n < N; ++n)
+          if(right_k[n] != value_type(0))
+            right_cols.push_back(n);
+        right_row_ptr[k + 1] = right_cols.size();
+      }
+
+      auto gemm_rows = [=,&right_row_ptr,&right_cols,&zero_tile_count]
+          (const integer first, const integer last)
+      {
+        int zero_count = 0;
+        for(integer m = first; m < last; ++m) {
+          const value_type* MADNESS_RESTRICT const left_m = left + m * K;
+          value_type* MADNESS_RESTRICT const result_m = result + m * N;
+
+          for(integer k = 0; k < K; ++k) {
+            const integer first_n = right_row_ptr[k];
+            const integer last_n = right_row_ptr[k + 1];
+            if((left_m[k] == value_type(0)) || (first_n == last_n))
+              continue;
+
+            const value_type left_mk = left_m[k] * k_sizes[k];
+            const value_type* MADNESS_RESTRICT const right_k = right + k * N;
+            if(((last_n - first_n) << 1) > N) {
+              for(integer n = 0; n < N; ++n)
+                result_m[n] += left_mk * right_k[n];
+            } else {
+              for(integer j = first_n; j < last_n; ++j) {
+                const integer n = right_cols[j];
+                result_m[n] += left_mk * right_k[n];
+              }
+            }
+          }
+
+          // Scale the row and hard zero tiles that are below the threshold.
+          for(integer n = 0; n < N; ++n) {
+            value_type& norm = result_m[n];
+            norm *= factor;
+            if(norm < threshold) {
+              norm = value_type(0);
+              ++zero_count;
+            }
+          }
+        }
+
+        zero_tile_count += zero_count;
+      };
+
+#ifdef HAVE_INTEL_TBB
+      // Only distribute products that are large enough to amortize the
+      // scheduling overhead.
+      if((std::size_t(M) * std::size_t(N) * std::size_t(K)) >= (1ul << 20)) {
+        tbb::parallel_for(math::SizeTRange(0ul, M),
+            [&gemm_rows] (const math::SizeTRange& range) {
+              gemm_rows(range.begin(), range.end());
+            }, tbb::auto_partitioner());
+        return;
+      }
+#endif // HAVE_INTEL_TBB
+
+      gemm_rows(0, M);
+    }
+
   public:
 
     SparseShape_ mult(const SparseShape_& other) const {
@@ -1093,34 +1307,9 @@ namespace TiledArray {
                 k_rank, [] (const vector_type& size_vector) -> const vector_type&
                 { return size_vector; });
 
-        // TODO: Make this faster. It can be done without using temporaries
-        // for the arguments, but requires a custom matrix multiply.
-
-        Tensor<value_type> left(tile_norms_.range());
-        const size_type mk = M * K;
-        auto left_op = [] (const value_type left, const value_type right)
-            { return left * right; };
-        for(size_type i = 0ul; i < mk; i += K)
-          math::vector_op(left_op, K, left.data() + i,
-              tile_norms_.data() + i, k_sizes.data());
-
-        Tensor<value_type> right(other.tile_norms_.range());
-        for(integer i = 0ul, k = 0; k < K; i += N, ++k) {
-          const value_type factor = k_sizes[k];
-          auto right_op = [=] (const value_type arg) { return arg * factor; };
-          math::vector_op(right_op, N, right.data() + i, other.tile_norms_.data() + i);
-        }
-
-        result_norms = left.gemm(right, abs_factor, gemm_helper);
-
-        // Hard zero tiles that are below the zero threshold.
-        result_norms.inplace_unary(
-            [threshold, &zero_tile_count] (value_type& value) {
-              if(value < threshold) {
-                value = value_type(0);
-                ++zero_tile_count;
-              }
-            });
+        gemm_norms(M, N, K, abs_factor, tile_norms_.data(),
+            other.tile_norms_.data(), k_sizes.data(), result_norms.data(),
+            zero_tile_count);
 
       } else {
 
@@ -1150,6 +1339,124 @@ namespace TiledArray {
       return gemm(other, factor, gemm_helper).perm(perm);
     }
 
+    /// Contraction with Hadamard dimensions
+
+    /// Compute the shape of a contraction that shares the leading
+    /// \c hadamard_rank dimensions of this shape and \c other with the
+    /// result, i.e. \f$ C_{hij} = \sum_k A_{hik} B_{hkj} \f$ . The norms of
+    /// each element of the Hadamard dimensions are contracted separately, and
+    /// the inner tile sizes are scaled by the size of the Hadamard tile.
+    /// \tparam Factor The scaling factor type
+    /// \param other The right-hand argument shape
+    /// \param factor The scaling factor
+    /// \param gemm_helper The gemm helper of the contraction, without the
+    /// Hadamard dimensions; the arguments must not be transposed
+    /// \param hadamard_rank The number of Hadamard dimensions
+    /// \return The result shape
+    /// \note expression abs(Factor) must be well defined (by default, std::abs will be used)
+    template <typename Factor>
+    SparseShape_ hadamard_gemm(const SparseShape_& other, const Factor factor,
+        const math::GemmHelper& gemm_helper, const unsigned int hadamard_rank) const
+    {
+      TA_ASSERT(! tile_norms_.empty());
+      TA_ASSERT(hadamard_rank > 0u);
+      TA_ASSERT(gemm_helper.left_op() == madness::cblas::NoTrans);
+      TA_ASSERT(gemm_helper.right_op() == madness::cblas::NoTrans);
+
+      const unsigned int left_outer_end = hadamard_rank + gemm_helper.left_outer_end();
+      const unsigned int left_rank = hadamard_rank + gemm_helper.left_rank();
+      const unsigned int right_outer_begin = hadamard_rank + gemm_helper.right_outer_begin();
+      const unsigned int right_rank = hadamard_rank + gemm_helper.right_rank();
+      const unsigned int result_rank = hadamard_rank + gemm_helper.result_rank();
+      TA_ASSERT(tile_norms_.range().rank() == left_rank);
+      TA_ASSERT(other.tile_norms_.range().rank() == right_rank);
+
+      const value_type abs_factor = to_abs_factor(factor);
+      madness::AtomicInt zero_tile_count;
+      zero_tile_count = 0;
+
+      // Compute the number of Hadamard tiles, and the matrix sizes of the
+      // contraction of each Hadamard tile
+      const size_type* MADNESS_RESTRICT const left_extent =
+          tile_norms_.range().extent_data();
+      const size_type* MADNESS_RESTRICT const right_extent =
+          other.tile_norms_.range().extent_data();
+      integer H = 1, M = 1, N = 1, K = 1;
+      unsigned int i = 0u;
+      for(; i < hadamard_rank; ++i) {
+        TA_ASSERT(left_extent[i] == right_extent[i]);
+        H *= left_extent[i];
+      }
+      for(; i < left_outer_end; ++i)
+        M *= left_extent[i];
+      for(; i < left_rank; ++i)
+        K *= left_extent[i];
+      for(i = right_outer_begin; i < right_rank; ++i)
+        N *= right_extent[i];
+
+      // Initialize the result size vectors and tile range
+      std::shared_ptr<vector_type> result_size_vectors(new vector_type[result_rank],
+          std::default_delete<vector_type[]>());
+      std::vector<size_type> lobound, upbound;
+      lobound.reserve(result_rank);
+      upbound.reserve(result_rank);
+      unsigned int x = 0u;
+      for(i = 0u; i < left_outer_end; ++i, ++x) {
+        result_size_vectors.get()[x] = size_vectors_.get()[i];
+        lobound.push_back(tile_norms_.range().lobound_data()[i]);
+        upbound.push_back(tile_norms_.range().upbound_data()[i]);
+      }
+      for(i = right_outer_begin; i < right_rank; ++i, ++x) {
+        result_size_vectors.get()[x] = other.size_vectors_.get()[i];
+        lobound.push_back(other.tile_norms_.range().lobound_data()[i]);
+        upbound.push_back(other.tile_norms_.range().upbound_data()[i]);
+      }
+
+      Tensor<value_type> result_norms(
+          typename Tensor<value_type>::range_type(lobound, upbound), 0);
+
+      // Compute the sizes of the Hadamard and inner tiles
+      auto noop = [] (const vector_type& size_vector) -> const vector_type&
+          { return size_vector; };
+      const vector_type h_sizes =
+          recursive_outer_product(size_vectors_.get(), hadamard_rank, noop);
+      const unsigned int k_rank = left_rank - left_outer_end;
+      const vector_type k_sizes = (k_rank > 0u ?
+          recursive_outer_product(size_vectors_.get() + left_outer_end, k_rank, noop) :
+          vector_type(1ul, value_type(1)));
+
+      for(integer h = 0; h < H; ++h) {
+        const value_type h_size = h_sizes[h];
+        const vector_type h_k_sizes(k_sizes,
+            [h_size] (const value_type k_size) { return k_size * h_size; });
+
+        gemm_norms(M, N, K, abs_factor, tile_norms_.data() + h * M * K,
+            other.tile_norms_.data() + h * K * N, h_k_sizes.data(),
+            result_norms.data() + h * M * N, zero_tile_count);
+      }
+
+      return SparseShape_(result_norms, result_size_vectors, zero_tile_count);
+    }
+
+    /// Contraction with Hadamard dimensions
+
+    /// \tparam Factor The scaling factor type
+    /// \param other The right-hand argument shape
+    /// \param factor The scaling factor
+    /// \param gemm_helper The gemm helper of the contraction, without the
+    /// Hadamard dimensions; the arguments must not be transposed
+    /// \param hadamard_rank The number of Hadamard dimensions
+    /// \param perm The permutation to be applied to the result
+    /// \return The permuted result shape
+    /// \note expression abs(Factor) must be well defined (by default, std::abs will be used)
+    template <typename Factor>
+    SparseShape_ hadamard_gemm(const SparseShape_& other, const Factor factor,
+        const math::GemmHelper& gemm_helper, const unsigned int hadamard_rank,
+        const Permutation& perm) const
+    {
+      return hadamard_gemm(other, factor, gemm_helper, hadamard_rank).perm(perm);
+    }
+
   private:
     template <typename Factor>
     static value_type to_abs_factor(const Factor factor) {
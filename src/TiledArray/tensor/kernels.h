@@ -28,6 +28,7 @@
 
 #include <TiledArray/tensor/utility.h>
 #include <TiledArray/tensor/permute.h>
+#include <TiledArray/math/fixed_kernels.h>
 #include <TiledArray/math/eigen.h>
 
 namespace TiledArray {
@@ -166,6 +167,10 @@ namespace TiledArray {
 
       const auto volume = result.range().volume();
 
+      if(math::fixed_inplace_vector_op(op, math::fixed_inner_extent(result.range()),
+          volume, result.data(), tensors.data()...))
+        return;
+
       math::inplace_vector_op(op, volume, result.data(),
           tensors.data()...);
     }
@@ -373,6 +378,10 @@ namespace TiledArray {
               typename Ts::const_reference MADNESS_RESTRICT... ts)
           { new(result) typename TR::value_type(op(ts...)); };
 
+      if(math::fixed_vector_ptr_op(wrapper_op, math::fixed_inner_extent(result.range()),
+          volume, result.data(), tensors.data()...))
+        return;
+
       math::vector_ptr_op(wrapper_op, volume, result.data(), tensors.data()...);
     }
 
@@ -563,6 +572,8 @@ namespace TiledArray {
     /// \c i in the index range of \c tensor1 . \c result is initialized to \c identity .
     /// If HAVE_INTEL_TBB is defined, the reduction will be executed in an undefined order,
     /// otherwise will execute in the order of increasing \c i .
+    /// The order is fixed when reproducible reductions are enabled (see
+    /// \c math::reproducible_reduce() ).
     /// \tparam ReduceOp The element-wise reduction operation type
     /// \tparam JoinOp The result operation type
     /// \tparam Scalar A scalar type
@@ -584,6 +595,10 @@ namespace TiledArray {
 
       const auto volume = tensor1.range().volume();
 
+      if(math::fixed_reduce_op(reduce_op, math::fixed_inner_extent(tensor1.range()),
+          volume, identity, tensor1.data(), tensors.data()...))
+        return identity;
+
       math::reduce_op(reduce_op, join_op, identity, volume, identity,
           tensor1.data(), tensors.data()...);
 
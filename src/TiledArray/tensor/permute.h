@@ -28,6 +28,7 @@
 
 #include <TiledArray/perm_index.h>
 #include <TiledArray/math/transpose.h>
+#include <TiledArray/math/fixed_kernels.h>
 
 namespace TiledArray {
   namespace detail {
@@ -96,6 +97,41 @@ namespace TiledArray {
       }
     }
 
+    /// Minimum tensor volume for a threaded permutation
+    constexpr std::size_t permute_parallel_volume = 1ul << 17;
+
+    /// Minimum number of elements that are permuted by one thread
+    constexpr std::size_t permute_grain_size = 1ul << 14;
+
+    /// Apply a permutation kernel to a set of independent work items
+
+    /// When Intel TBB is available and \c volume is large, the items are
+    /// distributed among the worker threads; otherwise they are evaluated in
+    /// order by the calling thread.
+    /// \tparam Op The work item operation type
+    /// \param n The number of work items
+    /// \param volume The number of elements that are permuted by all items
+    /// \param op The work item operation, with signature
+    /// <tt>void op(std::size_t)</tt>
+    template <typename Op>
+    inline void permute_for_each(const std::size_t n, const std::size_t volume,
+        Op&& op)
+    {
+#ifdef HAVE_INTEL_TBB
+      if((n > 1ul) && (volume >= permute_parallel_volume)) {
+        tbb::parallel_for(math::SizeTRange(0ul, n),
+            [&op] (const math::SizeTRange& range) {
+              for(std::size_t i = range.begin(); i < range.end(); ++i)
+                op(i);
+            }, tbb::auto_partitioner());
+        return;
+      }
+#endif // HAVE_INTEL_TBB
+
+      for(std::size_t i = 0ul; i < n; ++i)
+        op(i);
+    }
+
     /// Construct a permuted tensor copy
 
     /// The expected signature of the input operations is:
@@ -117,6 +153,11 @@ namespace TiledArray {
     /// result tensor given the element pointer and the result value
     /// \param args The data pointers of the tensors to be permuted
     /// \param perm The permutation that will be applied to the copy
+    /// \note Large permutations are split into independent row blocks of the
+    /// fused matrix transposes, which are evaluated in parallel (see
+    /// \c permute_for_each ). Row blocks are a multiple of
+    /// \c TILEDARRAY_LOOP_UNWIND elements (one cache line of \c double ), so
+    /// threads rarely write to the same cache line of the result.
     template <typename InputOp, typename OutputOp, typename Result,
         typename Arg0, typename... Args>
     inline void permute(InputOp&& input_op, OutputOp&& output_op, Result& result,
@@ -132,6 +173,9 @@ namespace TiledArray {
       // Get pointer to arg extent
       const auto* MADNESS_RESTRICT const arg0_extent = arg0.range().extent_data();
 
+      // The stride-one extent, if the tensor extents have specialized kernels
+      const std::size_t fixed_inner = math::fixed_inner_extent(arg0.range());
+
       if(perm[ndim1] == ndim1) {
         // This is the simple case where the last dimension is not permuted.
         // Therefore, it can be shuffled in chunks.
@@ -151,13 +195,18 @@ namespace TiledArray {
         { output_op(result, input_op(a0, as...)); };
 
         // Permute the data
-        for(typename Result::size_type index = 0ul; index < volume; index += block_size) {
-          const typename Result::size_type perm_index = perm_index_op(index);
-
-          // Copy the block
-          math::vector_ptr_op(op, block_size, result.data() + perm_index,
-              arg0.data() + index, (args.data() + index)...);
-        }
+        permute_for_each(volume / block_size, volume,
+            [&] (const std::size_t block) {
+              const typename Result::size_type index = block * block_size;
+              const typename Result::size_type perm_index = perm_index_op(index);
+
+              // Copy the block
+              if(! math::fixed_vector_ptr_op(op, fixed_inner, block_size,
+                  result.data() + perm_index, arg0.data() + index,
+                  (args.data() + index)...))
+                math::vector_ptr_op(op, block_size, result.data() + perm_index,
+                    arg0.data() + index, (args.data() + index)...);
+            });
 
       } else {
         // This is the more complicated case. Here we permute in terms of matrix
@@ -186,20 +235,45 @@ namespace TiledArray {
         for(unsigned int i = perm[ndim1] + 1u; i < ndim; ++i)
           result_outer_stride *= result_extent[i];
 
+        // Split the rows of each matrix into blocks that are large enough to
+        // amortize the cost of scheduling.
+        constexpr std::size_t row_mask = ~std::size_t(TILEDARRAY_LOOP_UNWIND - 1ul);
+        const std::size_t rows = other_fused_size[1];
+        const std::size_t row_block = std::max<std::size_t>(
+            (permute_grain_size / other_fused_size[3] + TILEDARRAY_LOOP_UNWIND - 1ul) & row_mask,
+            TILEDARRAY_LOOP_UNWIND);
+        const std::size_t row_blocks = (rows + row_block - 1ul) / row_block;
+
         // Copy data from the input to the output matrix via a series of matrix
         // transposes.
-        for(typename Result::size_type i = 0ul; i < other_fused_size[0]; ++i) {
-          typename Result::size_type index = i * other_fused_weight[0];
-          for(typename Result::size_type j = 0ul; j < other_fused_size[2]; ++j, index += other_fused_weight[2]) {
-            // Compute the ordinal index of the input and output matrices.
-            typename Result::size_type perm_index = perm_index_op(index);
-
-            math::transpose(input_op, output_op,
-                other_fused_size[1], other_fused_size[3],
-                result_outer_stride, result.data() + perm_index,
-                other_fused_weight[1], arg0.data() + index, (args.data() + index)...);
-          }
-        }
+        permute_for_each(other_fused_size[0] * other_fused_size[2] * row_blocks,
+            volume, [&] (const std::size_t item)
+        {
+          const std::size_t matrix = item / row_blocks;
+          const std::size_t first_row = (item % row_blocks) * row_block;
+          const std::size_t last_row = std::min(first_row + row_block, rows);
+
+          // Compute the ordinal index of the input and output matrices.
+          const typename Result::size_type index =
+              (matrix / other_fused_size[2]) * other_fused_weight[0] +
+              (matrix % other_fused_size[2]) * other_fused_weight[2];
+          const typename Result::size_type perm_index = perm_index_op(index);
+
+          // Row i of the argument matrix is column i of the result matrix.
+          const typename Result::size_type offset = first_row * other_fused_weight[1];
+          if(fixed_inner && math::fixed_transpose(input_op, output_op,
+              last_row - first_row, other_fused_size[3],
+              result_outer_stride, result.data() + perm_index + first_row,
+              other_fused_weight[1], arg0.data() + index + offset,
+              (args.data() + index + offset)...))
+            return;
+
+          math::transpose(input_op, output_op,
+              last_row - first_row, other_fused_size[3],
+              result_outer_stride, result.data() + perm_index + first_row,
+              other_fused_weight[1], arg0.data() + index + offset,
+              (args.data() + index + offset)...);
+        });
       }
     }
 
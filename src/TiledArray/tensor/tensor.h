@@ -22,6 +22,10 @@
 
 #include <TiledArray/math/gemm_helper.h>
 #include <TiledArray/math/blas.h>
+#include <TiledArray/math/fixed_kernels.h>
+#include <TiledArray/math/parallel_gemm.h>
+#include <TiledArray/math/simd.h>
+#include <TiledArray/pool_allocator.h>
 #include <TiledArray/tensor/kernels.h>
 #include <TiledArray/tensor/complex.h>
 
@@ -90,14 +94,27 @@ namespace TiledArray {
         data_ = allocator_type::allocate(range.volume());
       }
 
+      /// Construct a view of the data of another tensor
+
+      /// \param range The N-dimensional range for this tensor
+      /// \param base The tensor that owns the data
+      Impl(const range_type& range, const std::shared_ptr<Impl>& base) :
+        allocator_type(), range_(range), data_(base->data_), base_(base)
+      {
+        TA_ASSERT(range.volume() == base->range_.volume());
+      }
+
       ~Impl() {
-        math::destroy_vector(range_.volume(), data_);
-        allocator_type::deallocate(data_, range_.volume());
+        if(! base_) {
+          math::destroy_vector(range_.volume(), data_);
+          allocator_type::deallocate(data_, range_.volume());
+        }
         data_ = NULL;
       }
 
       range_type range_; ///< Tensor size info
       pointer data_; ///< Tensor data
+      std::shared_ptr<Impl> base_; ///< The tensor that owns the data of a view
     }; // class Impl
 
     template <typename... Ts>
@@ -114,6 +131,38 @@ namespace TiledArray {
       math::uninitialized_fill_vector(n, U(), u);
     }
 
+    /// Tensors that are supported by the vector kernels of math/simd.h,
+    /// i.e. tensors with the (real or complex floating point) element type of
+    /// this tensor
+    template <typename Right>
+    struct is_vector_tensor : public std::false_type { };
+
+    template <typename A>
+    struct is_vector_tensor<Tensor<value_type, A> > :
+        public math::simd::is_vector_type<value_type> { };
+
+    /// Apply a vector kernel to tensors
+
+    /// \tparam Enable \c true if the kernel supports the tensors
+    /// \tparam Op The kernel operation type
+    /// \tparam Ts The tensor types
+    /// \param op The kernel operation, which is called as <tt>op(tensors...)</tt>
+    /// \param tensors The tensors
+    /// \return \c true if \c op was called, otherwise the caller should use
+    /// the generic element-wise operation
+    template <bool Enable, typename Op, typename... Ts,
+        typename std::enable_if<Enable>::type* = nullptr>
+    static bool vector_kernel(Op&& op, Ts&... tensors) {
+      TA_ASSERT(! detail::empty(tensors...));
+      TA_ASSERT(detail::is_range_set_congruent(tensors...));
+      op(tensors...);
+      return true;
+    }
+
+    template <bool Enable, typename Op, typename... Ts,
+        typename std::enable_if<! Enable>::type* = nullptr>
+    static bool vector_kernel(Op&&, Ts&...) { return false; }
+
     std::shared_ptr<Impl> pimpl_; ///< Shared pointer to implementation object
     static const range_type empty_range_; ///< Empty range
 
@@ -596,6 +645,22 @@ namespace TiledArray {
       return result;
     }
 
+    /// Shift the lower and upper bound of this tensor without copying its data
+
+    /// \tparam Index The shift array type
+    /// \param bound_shift The shift to be applied to the tensor range
+    /// \return A tensor with a shifted range that shares the data of this
+    /// tensor, i.e. modifying the elements of one modifies the other.
+    template <typename Index>
+    Tensor_ shift_view(const Index& bound_shift) const {
+      TA_ASSERT(pimpl_);
+      Tensor_ result;
+      result.pimpl_ = std::make_shared<Impl>(pimpl_->range_,
+          (pimpl_->base_ ? pimpl_->base_ : pimpl_));
+      result.shift_to(bound_shift);
+      return result;
+    }
+
     // Generic vector operations
 
     /// Use a binary, element wise operation to construct a new tensor
@@ -721,6 +786,10 @@ namespace TiledArray {
     template <typename Scalar,
         typename std::enable_if<detail::is_numeric_v<Scalar>>::type* = nullptr>
     Tensor_& scale_to(const Scalar factor) {
+      if(vector_kernel<math::simd::is_vector_type<value_type>::value &&
+          std::is_arithmetic<Scalar>::value>([factor] (auto& result)
+          { math::simd::scale_to(result.size(), factor, result.data()); }, *this))
+        return *this;
       return inplace_unary([factor] (numeric_type& MADNESS_RESTRICT res) { res *= factor; });
     }
 
@@ -821,6 +890,9 @@ namespace TiledArray {
     template <typename Right,
         typename std::enable_if<is_tensor<Right>::value>::type* = nullptr>
     Tensor_& add_to(const Right& right) {
+      if(vector_kernel<is_vector_tensor<Right>::value>([] (auto& result, const auto& arg)
+          { math::simd::add_to(result.size(), arg.data(), result.data()); }, *this, right))
+        return *this;
       return inplace_binary(right, [] (numeric_type& MADNESS_RESTRICT l,
           const numeric_t<Right> r) { l += r; });
     }
@@ -943,6 +1015,9 @@ namespace TiledArray {
     template <typename Right,
         typename std::enable_if<is_tensor<Right>::value>::type* = nullptr>
     Tensor_& subt_to(const Right& right) {
+      if(vector_kernel<is_vector_tensor<Right>::value>([] (auto& result, const auto& arg)
+          { math::simd::axpy(result.size(), -1, arg.data(), result.data()); }, *this, right))
+        return *this;
       return inplace_binary(right, [] (numeric_type& MADNESS_RESTRICT l,
           const numeric_t<Right> r)
           { l -= r; });
@@ -1202,8 +1277,10 @@ namespace TiledArray {
       const integer lda = (gemm_helper.left_op() == madness::cblas::NoTrans ? k : m);
       const integer ldb = (gemm_helper.right_op() == madness::cblas::NoTrans ? n : k);
 
-      math::gemm(gemm_helper.left_op(), gemm_helper.right_op(), m, n, k, factor,
-          pimpl_->data_, lda, other.data(), ldb, numeric_type(0), result.data(), n);
+      if(! math::fixed_gemm(gemm_helper.left_op(), gemm_helper.right_op(), m, n,
+          k, factor, pimpl_->data_, other.data(), numeric_type(0), result.data()))
+        math::parallel_gemm(gemm_helper.left_op(), gemm_helper.right_op(), m, n, k, factor,
+            pimpl_->data_, lda, other.data(), ldb, numeric_type(0), result.data(), n);
 
       return result;
     }
@@ -1299,12 +1376,262 @@ namespace TiledArray {
       const integer ldb =
           (gemm_helper.right_op() == madness::cblas::NoTrans ? n : k);
 
-      math::gemm(gemm_helper.left_op(), gemm_helper.right_op(), m, n, k, factor,
-          left.data(), lda, right.data(), ldb, numeric_type(1), pimpl_->data_, n);
+      if(! math::fixed_gemm(gemm_helper.left_op(), gemm_helper.right_op(), m, n,
+          k, factor, left.data(), right.data(), numeric_type(1), pimpl_->data_))
+        math::parallel_gemm(gemm_helper.left_op(), gemm_helper.right_op(), m, n, k, factor,
+            left.data(), lda, right.data(), ldb, numeric_type(1), pimpl_->data_, n);
 
       return *this;
     }
 
+    /// Default inner contraction of a tensor-of-tensor contraction
+
+    /// The last index of the left-hand inner tensors is contracted with the
+    /// first index of the right-hand inner tensors, i.e. the inner tensors
+    /// of rank 2 are multiplied as matrices, and a contraction of tensors of
+    /// matrices is a block matrix product.
+    /// \param left_rank The rank of the left-hand inner tensors
+    /// \param right_rank The rank of the right-hand inner tensors
+    /// \return The *GEMM operation meta data of the inner contraction
+    static math::GemmHelper
+    default_inner_gemm_helper(const unsigned int left_rank, const unsigned int right_rank) {
+      TA_ASSERT(left_rank > 0u);
+      TA_ASSERT(right_rank > 0u);
+      TA_ASSERT((left_rank + right_rank) > 2u);
+      return math::GemmHelper(madness::cblas::NoTrans, madness::cblas::NoTrans,
+          left_rank + right_rank - 2u, left_rank, right_rank);
+    }
+
+    /// Contract this tensor of tensors with \c other
+
+    /// The outer indices are contracted as described by \c gemm_helper ,
+    /// and each product of a pair of inner tensors is a contraction described
+    /// by \c inner_gemm_helper . Empty inner tensors are treated as zero.
+    /// \tparam U The other tensor element type
+    /// \tparam AU The other tensor allocator type
+    /// \tparam V The type of \c factor scalar
+    /// \param other The tensor that will be contracted with this tensor
+    /// \param factor Multiply the result by this constant
+    /// \param gemm_helper The *GEMM operation meta data of the outer indices
+    /// \param inner_gemm_helper The *GEMM operation meta data of the inner
+    /// tensors
+    /// \return A new tensor which is the result of contracting this tensor with
+    /// \c other and scaled by \c factor
+    template <typename U, typename AU, typename V,
+              typename std::enable_if<detail::is_tensor_of_tensor<
+                  Tensor_, Tensor<U, AU>>::value>::type* = nullptr>
+    Tensor_ gemm(const Tensor<U, AU>& other, const V factor,
+                 const math::GemmHelper& gemm_helper,
+                 const math::GemmHelper& inner_gemm_helper) const {
+      TA_ASSERT(pimpl_);
+      TA_ASSERT(pimpl_->range_.rank() == gemm_helper.left_rank());
+      TA_ASSERT(!other.empty());
+      TA_ASSERT(other.range().rank() == gemm_helper.right_rank());
+
+      Tensor_ result(gemm_helper.make_result_range<range_type>(pimpl_->range_, other.range()));
+      result.gemm(*this, other, factor, gemm_helper, inner_gemm_helper);
+
+      return result;
+    }
+
+    /// Contract this tensor of tensors with \c other
+
+    /// The inner tensors are contracted with \c default_inner_gemm_helper() .
+    /// \tparam U The other tensor element type
+    /// \tparam AU The other tensor allocator type
+    /// \tparam V The type of \c factor scalar
+    /// \param other The tensor that will be contracted with this tensor
+    /// \param factor Multiply the result by this constant
+    /// \param gemm_helper The *GEMM operation meta data of the outer indices
+    /// \return A new tensor which is the result of contracting this tensor with
+    /// \c other and scaled by \c factor
+    template <typename U, typename AU, typename V,
+              typename std::enable_if<detail::is_tensor_of_tensor<
+                  Tensor_, Tensor<U, AU>>::value>::type* = nullptr>
+    Tensor_ gemm(const Tensor<U, AU>& other, const V factor,
+                 const math::GemmHelper& gemm_helper) const {
+      TA_ASSERT(pimpl_);
+      TA_ASSERT(pimpl_->range_.rank() == gemm_helper.left_rank());
+      TA_ASSERT(!other.empty());
+      TA_ASSERT(other.range().rank() == gemm_helper.right_rank());
+
+      Tensor_ result(gemm_helper.make_result_range<range_type>(pimpl_->range_, other.range()));
+      result.gemm(*this, other, factor, gemm_helper);
+
+      return result;
+    }
+
+    /// Contract two tensors of tensors and accumulate the scaled result to this tensor
+
+    /// The outer indices must fit one of the patterns of the contraction of
+    /// tensors (see above), and the inner tensors must fit one of these
+    /// patterns for \c inner_gemm_helper . Result element \c C[m,n] is
+    /// accumulated with the inner contractions <tt>A[m,k] * B[k,n]</tt>, in
+    /// order of \c k . Each result element is computed by a batch of small
+    /// GEMM calls, where consecutive products of inner tensors with the same
+    /// dimensions share the same matrix sizes. With TBB, the rows of the
+    /// result are computed in parallel.
+    /// \tparam U The left-hand tensor element type
+    /// \tparam AU The left-hand tensor allocator type
+    /// \tparam V The right-hand tensor element type
+    /// \tparam AV The right-hand tensor allocator type
+    /// \tparam W The type of the scaling factor
+    /// \param left The left-hand tensor that will be contracted
+    /// \param right The right-hand tensor that will be contracted
+    /// \param factor The contraction result will be scaling by this value, then accumulated into \c this
+    /// \param gemm_helper The *GEMM operation meta data of the outer indices
+    /// \param inner_gemm_helper The *GEMM operation meta data of the inner
+    /// tensors
+    /// \return A reference to \c this
+    template <
+        typename U, typename AU, typename V, typename AV, typename W,
+        typename std::enable_if<detail::is_tensor_of_tensor<
+            Tensor_, Tensor<U, AU>, Tensor<V, AV>>::value>::type* = nullptr>
+    Tensor_& gemm(const Tensor<U, AU>& left, const Tensor<V, AV>& right,
+                  const W factor, const math::GemmHelper& gemm_helper,
+                  const math::GemmHelper& inner_gemm_helper) {
+      typedef typename value_type::numeric_type inner_numeric_type;
+
+      // Check that this tensor is not empty and has the correct rank
+      TA_ASSERT(pimpl_);
+      TA_ASSERT(pimpl_->range_.rank() == gemm_helper.result_rank());
+
+      // Check that the arguments are not empty and have the correct ranks
+      TA_ASSERT(!left.empty());
+      TA_ASSERT(left.range().rank() == gemm_helper.left_rank());
+      TA_ASSERT(!right.empty());
+      TA_ASSERT(right.range().rank() == gemm_helper.right_rank());
+
+      // Check that the outer dimensions of left and right match the result,
+      // and that the inner dimensions of left and right match
+      TA_ASSERT(gemm_helper.left_result_congruent(left.range().extent_data(),
+          pimpl_->range_.extent_data()));
+      TA_ASSERT(gemm_helper.right_result_congruent(right.range().extent_data(),
+          pimpl_->range_.extent_data()));
+      TA_ASSERT(gemm_helper.left_right_congruent(left.range().extent_data(),
+          right.range().extent_data()));
+
+      // Tensor of tensor contractions do not conjugate the inner tensors
+      TA_ASSERT(gemm_helper.left_op() != madness::cblas::ConjTrans);
+      TA_ASSERT(gemm_helper.right_op() != madness::cblas::ConjTrans);
+
+      // Compute gemm dimensions
+      integer m, n, k;
+      gemm_helper.compute_matrix_sizes(m, n, k, left.range(), right.range());
+
+      // Strides of the outer matrices
+      const bool left_trans = (gemm_helper.left_op() != madness::cblas::NoTrans);
+      const bool right_trans = (gemm_helper.right_op() != madness::cblas::NoTrans);
+      const integer left_i = (left_trans ? 1 : k), left_l = (left_trans ? m : 1);
+      const integer right_j = (right_trans ? k : 1), right_l = (right_trans ? 1 : n);
+
+      const auto* MADNESS_RESTRICT const left_data = left.data();
+      const auto* MADNESS_RESTRICT const right_data = right.data();
+      pointer MADNESS_RESTRICT const result_data = pimpl_->data_;
+      const inner_numeric_type alpha = factor;
+
+      // Compute the rows [first, last) of the result
+      auto contract_rows = [=,&inner_gemm_helper] (const integer first, const integer last) {
+        integer inner_m = 0, inner_n = 0, inner_k = 0;
+        const typename value_type::range_type::size_type* a_extent = nullptr;
+        const typename value_type::range_type::size_type* b_extent = nullptr;
+
+        for(integer i = first; i < last; ++i) {
+          for(integer j = 0; j < n; ++j) {
+            value_type& c = result_data[i * n + j];
+
+            // Accumulate the batch of inner contractions for element (i,j)
+            for(integer l = 0; l < k; ++l) {
+              const auto& a = left_data[i * left_i + l * left_l];
+              const auto& b = right_data[j * right_j + l * right_l];
+              if(a.empty() || b.empty())
+                continue;
+
+              TA_ASSERT(a.range().rank() == inner_gemm_helper.left_rank());
+              TA_ASSERT(b.range().rank() == inner_gemm_helper.right_rank());
+              TA_ASSERT(inner_gemm_helper.left_right_congruent(
+                  a.range().extent_data(), b.range().extent_data()));
+
+              // Reuse the matrix sizes of the previous product when the
+              // inner tensors have the same dimensions
+              if(! (a_extent && b_extent &&
+                  std::equal(a_extent, a_extent + a.range().rank(), a.range().extent_data()) &&
+                  std::equal(b_extent, b_extent + b.range().rank(), b.range().extent_data())))
+              {
+                inner_gemm_helper.compute_matrix_sizes(inner_m, inner_n, inner_k,
+                    a.range(), b.range());
+              }
+              a_extent = a.range().extent_data();
+              b_extent = b.range().extent_data();
+
+              inner_numeric_type beta = 1;
+              if(c.empty()) {
+                c = value_type(inner_gemm_helper.make_result_range<
+                    typename value_type::range_type>(a.range(), b.range()));
+                beta = 0;
+              }
+              TA_ASSERT(c.range().volume() == std::size_t(inner_m * inner_n));
+
+              const integer lda = (inner_gemm_helper.left_op() ==
+                  madness::cblas::NoTrans ? inner_k : inner_m);
+              const integer ldb = (inner_gemm_helper.right_op() ==
+                  madness::cblas::NoTrans ? inner_n : inner_k);
+              math::gemm(inner_gemm_helper.left_op(), inner_gemm_helper.right_op(),
+                  inner_m, inner_n, inner_k, alpha, a.data(), lda, b.data(), ldb,
+                  beta, c.data(), inner_n);
+            }
+          }
+        }
+      };
+
+#ifdef HAVE_INTEL_TBB
+      tbb::parallel_for(math::SizeTRange(0ul, m),
+          [&contract_rows] (const math::SizeTRange& range) {
+            contract_rows(range.begin(), range.end());
+          }, tbb::auto_partitioner());
+#else
+      contract_rows(0, m);
+#endif // HAVE_INTEL_TBB
+
+      return *this;
+    }
+
+    /// Contract two tensors of tensors and accumulate the scaled result to this tensor
+
+    /// The inner tensors are contracted with \c default_inner_gemm_helper() , where
+    /// the inner ranks are those of the first non-empty inner tensors of
+    /// \c left and \c right .
+    /// \tparam U The left-hand tensor element type
+    /// \tparam AU The left-hand tensor allocator type
+    /// \tparam V The right-hand tensor element type
+    /// \tparam AV The right-hand tensor allocator type
+    /// \tparam W The type of the scaling factor
+    /// \param left The left-hand tensor that will be contracted
+    /// \param right The right-hand tensor that will be contracted
+    /// \param factor The contraction result will be scaling by this value, then accumulated into \c this
+    /// \param gemm_helper The *GEMM operation meta data of the outer indices
+    /// \return A reference to \c this
+    template <
+        typename U, typename AU, typename V, typename AV, typename W,
+        typename std::enable_if<detail::is_tensor_of_tensor<
+            Tensor_, Tensor<U, AU>, Tensor<V, AV>>::value>::type* = nullptr>
+    Tensor_& gemm(const Tensor<U, AU>& left, const Tensor<V, AV>& right,
+                  const W factor, const math::GemmHelper& gemm_helper) {
+      TA_ASSERT(!left.empty());
+      TA_ASSERT(!right.empty());
+
+      // Find the ranks of the inner tensors
+      auto is_not_empty = [] (const typename Tensor<U, AU>::value_type& t) { return ! t.empty(); };
+      auto is_not_empty_right = [] (const typename Tensor<V, AV>::value_type& t) { return ! t.empty(); };
+      const auto a = std::find_if(left.begin(), left.end(), is_not_empty);
+      const auto b = std::find_if(right.begin(), right.end(), is_not_empty_right);
+      if((a == left.end()) || (b == right.end()))
+        return *this;
+
+      return gemm(left, right, factor, gemm_helper,
+          default_inner_gemm_helper(a->range().rank(), b->range().rank()));
+    }
+
     // Reduction operations
 
     /// Generalized tensor trace
@@ -1363,6 +1690,8 @@ namespace TiledArray {
     /// \c i in the index range of \c this . \c result is initialized to \c identity .
     /// If HAVE_INTEL_TBB is defined, and this is a contiguous tensor, the reduction will
     /// be executed in an undefined order, otherwise will execute in the order of increasing \c i .
+    /// The order is fixed for contiguous tensors when reproducible reductions
+    /// are enabled (see \c math::reproducible_reduce() ).
     /// \tparam ReduceOp The reduction operation type
     /// \tparam JoinOp The join operation type
     /// \param reduce_op The element-wise reduction operation
@@ -1383,6 +1712,8 @@ namespace TiledArray {
     /// \c i in the index range of \c this . \c result is initialized to \c identity .
     /// If HAVE_INTEL_TBB is defined, and this is a contiguous tensor, the reduction will
     /// be executed in an undefined order, otherwise will execute in the order of increasing \c i .
+    /// The order is fixed for contiguous tensors when reproducible reductions
+    /// are enabled (see \c math::reproducible_reduce() ).
     /// \tparam Right The right-hand argument tensor type
     /// \tparam ReduceOp The reduction operation type
     /// \tparam JoinOp The join operation type
@@ -1403,6 +1734,11 @@ namespace TiledArray {
 
     /// \return The sum of all elements of this tensor
     numeric_type sum() const {
+      numeric_type result;
+      if(vector_kernel<math::simd::is_real_vector_type<value_type>::value>(
+          [&result] (const auto& arg) { result = math::simd::sum(arg.size(), arg.data()); },
+          *this))
+        return result;
       auto sum_op = [] (numeric_type& MADNESS_RESTRICT res, const numeric_type arg)
               { res += arg; };
       return reduce(sum_op, sum_op, numeric_type(0));
@@ -1421,6 +1757,11 @@ namespace TiledArray {
 
     /// \return The vector norm of this tensor
     scalar_type squared_norm() const {
+      scalar_type result;
+      if(vector_kernel<math::simd::is_vector_type<value_type>::value>(
+          [&result] (const auto& arg) { result = math::simd::squared_norm(arg.size(), arg.data()); },
+          *this))
+        return result;
       auto square_op = [] (scalar_type& MADNESS_RESTRICT res, const numeric_type arg)
               { res += TiledArray::detail::norm(arg); };
       auto sum_op = [] (scalar_type& MADNESS_RESTRICT res, const scalar_type arg)
@@ -1465,6 +1806,11 @@ namespace TiledArray {
 
     /// \return The minimum elements of this tensor
     scalar_type abs_min() const {
+      scalar_type result;
+      if(vector_kernel<math::simd::is_real_vector_type<value_type>::value>(
+          [&result] (const auto& arg) { result = math::simd::abs_min(arg.size(), arg.data()); },
+          *this))
+        return result;
       auto abs_min_op = [] (scalar_type& MADNESS_RESTRICT res, const numeric_type arg)
               { res = std::min(res, std::abs(arg)); };
       auto min_op = [] (scalar_type& MADNESS_RESTRICT res, const scalar_type arg)
@@ -1476,6 +1822,11 @@ namespace TiledArray {
 
     /// \return The maximum elements of this tensor
     scalar_type abs_max() const {
+      scalar_type result;
+      if(vector_kernel<math::simd::is_real_vector_type<value_type>::value>(
+          [&result] (const auto& arg) { result = math::simd::abs_max(arg.size(), arg.data()); },
+          *this))
+        return result;
       auto abs_max_op = [] (scalar_type& MADNESS_RESTRICT res, const numeric_type arg)
               { res = std::max(res, std::abs(arg)); };
       auto max_op = [] (scalar_type& MADNESS_RESTRICT res, const scalar_type arg)
@@ -1493,6 +1844,13 @@ namespace TiledArray {
     template <typename Right,
         typename std::enable_if<is_tensor<Right>::value>::type* = nullptr>
     numeric_type dot(const Right& other) const {
+      numeric_type result;
+      if(vector_kernel<is_vector_tensor<Right>::value &&
+          math::simd::is_real_vector_type<value_type>::value>([&result]
+          (const auto& left, const auto& right)
+          { result = math::simd::dot(left.size(), left.data(), right.data()); },
+          *this, other))
+        return result;
       auto mult_add_op = [] (numeric_type& res, const numeric_type l,
                 const numeric_t<Right> r)
                 { res += l * r; };
@@ -1573,6 +1931,10 @@ namespace TiledArray {
 //  class Tensor<std::complex<double>, Eigen::aligned_allocator<std::complex<double> > >;
 //  extern template
 //  class Tensor<std::complex<float>, Eigen::aligned_allocator<std::complex<float> > >;
+  extern template
+  class Tensor<double, PoolAllocator<double> >;
+  extern template
+  class Tensor<float, PoolAllocator<float> >;
 
 #endif // TILEDARRAY_HEADER_ONLY
 
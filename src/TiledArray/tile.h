@@ -467,6 +467,17 @@ namespace TiledArray {
   inline decltype(auto) shift(const Tile<Arg>& arg, const Index& range_shift)
   { return detail::make_tile(shift(arg.tensor(), range_shift)); }
 
+  /// Shift the range of \c arg without copying its data
+
+  /// \tparam Arg The tensor argument type
+  /// \tparam Index An array type
+  /// \param arg The tile argument to be shifted
+  /// \param range_shift The offset to be applied to the argument range
+  /// \return A tile with a new range that shares the data of \c arg
+  template <typename Arg, typename Index>
+  inline decltype(auto) shift_view(const Tile<Arg>& arg, const Index& range_shift)
+  { return detail::make_tile(shift_view(arg.tensor(), range_shift)); }
+
   /// Shift the range of \c arg in place
 
   /// \tparam Arg The tensor argument type
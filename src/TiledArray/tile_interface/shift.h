@@ -55,10 +55,43 @@ namespace TiledArray {
   { return arg.shift_to(range_shift); }
 
 
+  namespace detail {
+    GENERATE_HAS_MEMBER_FUNCTION_ANYRETURN(shift_view)
+  } // namespace detail
+
+  /// Shift the range of \c arg without copying its data
+
+  /// \tparam Arg The tile argument type
+  /// \tparam Index An array type
+  /// \param arg The tile argument to be shifted
+  /// \param range_shift The offset to be applied to the argument range
+  /// \return A tile with a new range that shares the data of \c arg
+  template <typename Arg, typename Index,
+      typename std::enable_if<detail::has_member_function_shift_view_anyreturn<
+          const Arg, const Index&>::value>::type* = nullptr>
+  inline auto shift_view(const Arg& arg, const Index& range_shift)
+  { return arg.shift_view(range_shift); }
+
+  /// Shift the range of \c arg
+
+  /// This overload is used for tiles that cannot share their data.
+  /// \tparam Arg The tile argument type
+  /// \tparam Index An array type
+  /// \param arg The tile argument to be shifted
+  /// \param range_shift The offset to be applied to the argument range
+  /// \return A copy of the tile with a new range
+  template <typename Arg, typename Index,
+      typename std::enable_if<! detail::has_member_function_shift_view_anyreturn<
+          const Arg, const Index&>::value>::type* = nullptr>
+  inline auto shift_view(const Arg& arg, const Index& range_shift)
+  { return shift(arg, range_shift); }
+
+
   namespace tile_interface {
 
     using TiledArray::shift;
     using TiledArray::shift_to;
+    using TiledArray::shift_view;
 
     template <typename T>
     using result_of_shift_t = typename std::decay<
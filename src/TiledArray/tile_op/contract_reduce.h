@@ -28,14 +28,53 @@
 
 #include <TiledArray/permutation.h>
 #include <TiledArray/math/gemm_helper.h>
+#include <TiledArray/math/blas.h>
+#include <TiledArray/tensor/type_traits.h>
 #include <TiledArray/tile_op/tile_interface.h>
 #include "../tile_interface/add.h"
 #include "../tile_interface/permute.h"
 #include <TiledArray/tensor/complex.h>
+#include <TiledArray/utility.h>
+#include <atomic>
+#include <vector>
+
+#ifndef TILEDARRAY_CONTRACT_BATCH_MAX_VOLUME
+/// The largest tile volume that is contracted in a batch (see \c ContractReduce::batch() )
+#define TILEDARRAY_CONTRACT_BATCH_MAX_VOLUME 4096
+#endif // TILEDARRAY_CONTRACT_BATCH_MAX_VOLUME
 
 namespace TiledArray {
   namespace detail {
 
+    inline std::atomic<bool>& contract_batch_flag() {
+      static std::atomic<bool> flag(env_flag("TA_CONTRACT_BATCH", false));
+      return flag;
+    }
+
+    /// Batch small tile contractions (\c TA_CONTRACT_BATCH , default off)
+    inline bool contract_batch() {
+      return contract_batch_flag().load(std::memory_order_relaxed);
+    }
+
+    /// Enable or disable batched contraction of small tiles
+
+    /// \param enable The new value of the batch contraction flag
+    /// \return The previous value of the flag
+    /// \sa contract_batch()
+    inline bool set_contract_batch(const bool enable) {
+      return contract_batch_flag().exchange(enable);
+    }
+
+    /// Check that tiles of type \c T can be contracted in a batch
+
+    /// Batched contraction requires contiguous tensors of numeric elements.
+    /// \tparam T The tile type
+    template <typename T>
+    struct is_batch_contract_tile : public std::false_type { };
+
+    template <typename T, typename A>
+    struct is_batch_contract_tile<Tensor<T, A> > : public is_numeric<T> { };
+
     /// Contract and (sum) reduce base
 
     /// This implementation class is used to provide shallow copy semantics for ContractReduce.
@@ -61,18 +100,71 @@ namespace TiledArray {
             const madness::cblas::CBLAS_TRANSPOSE right_op,
             const scalar_type alpha, const unsigned int result_rank,
             const unsigned int left_rank, const unsigned int right_rank,
-            const Permutation& perm = Permutation()) :
+            const Permutation& perm, const bool swappable) :
           gemm_helper_(left_op, right_op, result_rank, left_rank, right_rank),
-          alpha_(alpha), perm_(perm)
+          swap_gemm_helper_(transpose_op(right_op), transpose_op(left_op),
+              result_rank, right_rank, left_rank),
+          alpha_(alpha), perm_(perm),
+          swap_(swappable && is_swap_perm(gemm_helper_, perm))
         { }
 
         math::GemmHelper gemm_helper_; ///< Gemm helper object
+        math::GemmHelper swap_gemm_helper_; ///< Gemm helper object for the
+            ///< contraction of the right- and left-hand arguments
         scalar_type alpha_; ///< Scaling factor applied to the contraction of
             ///< the left- and right-hand arguments
         Permutation perm_; ///< Permutation that is applied to the final result
             ///< tensor
+        bool swap_; ///< The permuted result is computed directly by
+            ///< contracting the arguments in reverse order
       };
 
+      /// Transpose a BLAS matrix operation
+
+      /// \param op The operation to be transposed
+      /// \return \c Trans if \c op is \c NoTrans , otherwise \c NoTrans
+      static madness::cblas::CBLAS_TRANSPOSE
+      transpose_op(const madness::cblas::CBLAS_TRANSPOSE op) {
+        return (op == madness::cblas::NoTrans ? madness::cblas::Trans :
+            madness::cblas::NoTrans);
+      }
+
+      /// Check for a permutation that swaps the outer dimensions
+
+      /// \f$ (A B)^T = B^T A^T \f$ , so a result permutation that moves the
+      /// (ordered) outer dimensions of the right-hand argument in front of
+      /// the (ordered) outer dimensions of the left-hand argument can be
+      /// applied by contracting the arguments in reverse order.
+      /// \param gemm_helper The gemm helper of the contraction
+      /// \param perm The permutation that is applied to the result
+      /// \return \c true if \c perm swaps the left and right outer dimensions
+      static bool is_swap_perm(const math::GemmHelper& gemm_helper,
+          const Permutation& perm)
+      {
+        if(! perm)
+          return false;
+        if((gemm_helper.left_op() == madness::cblas::ConjTrans) ||
+            (gemm_helper.right_op() == madness::cblas::ConjTrans))
+          return false;
+
+        const unsigned int left_outer =
+            gemm_helper.left_outer_end() - gemm_helper.left_outer_begin();
+        const unsigned int right_outer =
+            gemm_helper.right_outer_end() - gemm_helper.right_outer_begin();
+        if((left_outer == 0u) || (right_outer == 0u) ||
+            (perm.dim() != (left_outer + right_outer)))
+          return false;
+
+        for(unsigned int i = 0u; i < left_outer; ++i)
+          if(perm[i] != (i + right_outer))
+            return false;
+        for(unsigned int i = left_outer; i < perm.dim(); ++i)
+          if(perm[i] != (i - left_outer))
+            return false;
+
+        return true;
+      }
+
       std::shared_ptr<Impl> pimpl_;
 
     public:
@@ -96,13 +188,15 @@ namespace TiledArray {
       /// \param right_rank The rank of the right-hand tensor
       /// \param perm The permutation to be applied to the result tensor
       /// (default = no permute)
+      /// \param swappable If \c true , the derived class can contract the
+      /// arguments in reverse order (see \c swap_arguments() )
       ContractReduceBase(const madness::cblas::CBLAS_TRANSPOSE left_op,
           const madness::cblas::CBLAS_TRANSPOSE right_op,
           const scalar_type alpha, const unsigned int result_rank,
           const unsigned int left_rank, const unsigned int right_rank,
-          const Permutation& perm = Permutation()) :
+          const Permutation& perm = Permutation(), const bool swappable = false) :
         pimpl_(std::make_shared<Impl>(left_op, right_op, alpha, result_rank, left_rank,
-            right_rank, perm))
+            right_rank, perm, swappable))
       { }
 
 
@@ -114,6 +208,26 @@ namespace TiledArray {
         return pimpl_->gemm_helper_;
       }
 
+      /// Gemm meta data accessor for the reverse-order contraction
+
+      /// \return A const reference to the gemm helper object that contracts
+      /// the right- and left-hand arguments, in that order
+      const math::GemmHelper& swap_gemm_helper() const {
+        TA_ASSERT(pimpl_);
+        return pimpl_->swap_gemm_helper_;
+      }
+
+      /// Reverse-order contraction flag
+
+      /// \return \c true if the permutation is applied by contracting the
+      /// right- and left-hand arguments, in that order, with
+      /// \c swap_gemm_helper() ; in that case the contraction yields the
+      /// permuted result, and the post-processing step does not permute it.
+      bool swap_arguments() const {
+        TA_ASSERT(pimpl_);
+        return pimpl_->swap_;
+      }
+
       /// Permutation accessor
 
       /// \return A const reference to the permutation for this operation
@@ -215,7 +329,7 @@ namespace TiledArray {
           const unsigned int left_rank, const unsigned int right_rank,
           const Permutation& perm = Permutation()) :
         ContractReduceBase_(left_op, right_op, alpha, result_rank, left_rank,
-            right_rank, perm)
+            right_rank, perm, std::is_same<Left, Right>::value)
       { }
 
 
@@ -231,7 +345,7 @@ namespace TiledArray {
         using TiledArray::empty;
         TA_ASSERT(! empty(temp));
 
-        if(! ContractReduceBase_::perm())
+        if(! ContractReduceBase_::perm() || ContractReduceBase_::swap_arguments())
           return temp;
 
         TiledArray::Permute<result_type, result_type> permute;
@@ -258,6 +372,184 @@ namespace TiledArray {
       /// \param[in] right The right-hand tile to be contracted
       void operator()(result_type& result, first_argument_type left,
           second_argument_type right) const
+      {
+        contract(result, left, right, std::is_same<Left, Right>());
+      }
+
+      /// The largest tile volume that is contracted in a batch
+      static constexpr std::size_t batch_max_volume =
+          TILEDARRAY_CONTRACT_BATCH_MAX_VOLUME;
+
+      /// Batch contraction flag
+
+      /// The contraction of small tiles is dominated by the overhead of the
+      /// GEMM call and of the reduction task, so the pairs of small tiles
+      /// that are ready to be reduced into a result tile are contracted
+      /// together (see \c ReduceTask ). Batching is disabled by default (see
+      /// \c detail::contract_batch() ).
+      /// \param[in] left The left-hand tile to be contracted
+      /// \param[in] right The right-hand tile to be contracted
+      /// \return \c true if \c left and \c right may be contracted in a
+      /// batch with other tile pairs
+      bool batch(first_argument_type left, second_argument_type right) const {
+        return batch(left, right, is_batch_contraction());
+      }
+
+      /// Contract a batch of tile pairs and add to a target tile
+
+      /// The sum of the contractions of all pairs is computed with a single
+      /// GEMM, where the inner dimensions of the pairs are concatenated:
+      /// \f$ \sum_p A_p B_p = [A_1 \cdots A_n] [B_1 \cdots B_n]^T \f$ .
+      /// \param[in,out] result The result object that will be the reduction
+      /// target
+      /// \param[in] left The left-hand tiles to be contracted
+      /// \param[in] right The right-hand tiles to be contracted
+      void operator()(result_type& result, const std::vector<const Left*>& left,
+          const std::vector<const Right*>& right) const
+      {
+        TA_ASSERT(left.size() == right.size());
+        TA_ASSERT(! left.empty());
+        contract(result, left, right, is_batch_contraction());
+      }
+
+    private:
+
+      typedef std::integral_constant<bool,
+          is_batch_contract_tile<Result>::value
+          && is_batch_contract_tile<Left>::value
+          && is_batch_contract_tile<Right>::value> is_batch_contraction;
+          ///< Batch contraction is supported for the tile types
+
+      /// Tiles that do not support batch contraction are never batched
+      bool batch(first_argument_type, second_argument_type, std::false_type) const {
+        return false;
+      }
+
+      /// Small tiles are batched, when batching is enabled
+      bool batch(first_argument_type left, second_argument_type right,
+          std::true_type) const
+      {
+        return contract_batch() && (left.size() <= batch_max_volume) &&
+            (right.size() <= batch_max_volume);
+      }
+
+      /// Contract a batch of tile pairs one pair at a time
+      void contract(result_type& result, const std::vector<const Left*>& left,
+          const std::vector<const Right*>& right, std::false_type) const
+      {
+        for(std::size_t p = 0ul; p < left.size(); ++p)
+          contract(result, *left[p], *right[p], std::is_same<Left, Right>());
+      }
+
+      /// Contract a batch of tile pairs with a single GEMM
+      void contract(result_type& result, const std::vector<const Left*>& left,
+          const std::vector<const Right*>& right, std::true_type) const
+      {
+        // The reverse-order contraction is only used when Left and Right
+        // are the same type (see the constructor)
+        if(ContractReduceBase_::swap_arguments())
+          batch_gemm(result, right, left, ContractReduceBase_::swap_gemm_helper());
+        else
+          batch_gemm(result, left, right, ContractReduceBase_::gemm_helper());
+      }
+
+      /// Contract the concatenated tiles of a batch and add to a target tile
+
+      /// \tparam L The left-hand tile type
+      /// \tparam R The right-hand tile type
+      /// \param[in,out] result The result object that will be the reduction
+      /// target
+      /// \param[in] left The left-hand tiles to be contracted
+      /// \param[in] right The right-hand tiles to be contracted
+      /// \param[in] gemm_helper The *GEMM operation meta data
+      template <typename L, typename R>
+      void batch_gemm(result_type& result, const std::vector<const L*>& left,
+          const std::vector<const R*>& right,
+          const math::GemmHelper& gemm_helper) const
+      {
+        // The outer dimensions are the same for all pairs of the batch
+        integer m = 1, n = 1, k = 1;
+        gemm_helper.compute_matrix_sizes(m, n, k, left.front()->range(),
+            right.front()->range());
+
+        // Compute the inner size of the concatenated matrices
+        integer K = 0;
+        for(std::size_t p = 0ul; p < left.size(); ++p) {
+          TA_ASSERT((left[p]->range().volume() % m) == 0ul);
+          TA_ASSERT(right[p]->range().volume() ==
+              ((left[p]->range().volume() / m) * n));
+          K += left[p]->range().volume() / m;
+        }
+
+        // Concatenate the tiles along the inner dimension. The left-hand
+        // matrix is m x K (or K x m when transposed), and the right-hand
+        // matrix is K x n (or n x K when transposed).
+        const bool left_notrans = (gemm_helper.left_op() == madness::cblas::NoTrans);
+        const bool right_notrans = (gemm_helper.right_op() == madness::cblas::NoTrans);
+        std::vector<typename L::value_type> a(m * K);
+        std::vector<typename R::value_type> b(K * n);
+        integer offset = 0;
+        for(std::size_t p = 0ul; p < left.size(); ++p) {
+          const integer k_p = left[p]->range().volume() / m;
+
+          if(left_notrans) {
+            for(integer i = 0; i < m; ++i)
+              std::copy_n(left[p]->data() + i * k_p, k_p, a.data() + i * K + offset);
+          } else {
+            std::copy_n(left[p]->data(), k_p * m, a.data() + offset * m);
+          }
+
+          if(right_notrans) {
+            std::copy_n(right[p]->data(), k_p * n, b.data() + offset * n);
+          } else {
+            for(integer j = 0; j < n; ++j)
+              std::copy_n(right[p]->data() + j * k_p, k_p, b.data() + j * K + offset);
+          }
+
+          offset += k_p;
+        }
+
+        // Get the leading dimension for left and right matrices.
+        const integer lda = (left_notrans ? K : m);
+        const integer ldb = (right_notrans ? n : K);
+
+        using TiledArray::empty;
+        typedef typename result_type::numeric_type numeric_type;
+        if(empty(result)) {
+          result = result_type(gemm_helper.make_result_range<typename
+              result_type::range_type>(left.front()->range(), right.front()->range()));
+          math::gemm(gemm_helper.left_op(), gemm_helper.right_op(), m, n, K,
+              ContractReduceBase_::factor(), a.data(), lda, b.data(), ldb,
+              numeric_type(0), result.data(), n);
+        } else {
+          TA_ASSERT(result.range().volume() == std::size_t(m * n));
+          math::gemm(gemm_helper.left_op(), gemm_helper.right_op(), m, n, K,
+              ContractReduceBase_::factor(), a.data(), lda, b.data(), ldb,
+              numeric_type(1), result.data(), n);
+        }
+      }
+
+      /// Contract a pair of tiles in reverse order when it yields the permuted result
+      void contract(result_type& result, first_argument_type left,
+          second_argument_type right, std::true_type) const
+      {
+        if(ContractReduceBase_::swap_arguments()) {
+          using TiledArray::empty;
+          using TiledArray::gemm;
+          if(empty(result))
+            result = gemm(right, left, ContractReduceBase_::factor(),
+                ContractReduceBase_::swap_gemm_helper());
+          else
+            gemm(result, right, left, ContractReduceBase_::factor(),
+                ContractReduceBase_::swap_gemm_helper());
+        } else {
+          contract(result, left, right, std::false_type());
+        }
+      }
+
+      /// Contract a pair of tiles in order
+      void contract(result_type& result, first_argument_type left,
+          second_argument_type right, std::false_type) const
       {
         using TiledArray::empty;
         using TiledArray::gemm;
@@ -493,6 +785,246 @@ namespace TiledArray {
 
     }; // class ContractReduce
 
+
+    /// Check that tiles of type \c T support contractions with Hadamard dimensions
+
+    /// \tparam T The tile type
+    template <typename T>
+    struct is_hadamard_contract_tile : public is_batch_contract_tile<T> { };
+
+    template <typename T>
+    struct is_hadamard_contract_tile<Tile<T> > : public is_batch_contract_tile<T> { };
+
+
+    /// Contract and (sum) reduce operation with Hadamard dimensions
+
+    /// This encodes a binary tensor contraction that shares the leading
+    /// (Hadamard, or batch) dimensions of the arguments with the result, e.g.
+    /// \f$ C_{hij} = \sum_k A_{hik} B_{hkj} \f$, as one GEMM per element of
+    /// the Hadamard dimensions, as well as the sum reduction and
+    /// post-processing. The arguments must be ordered as \f$ (h, i, k) \f$
+    /// and \f$ (h, k, j) \f$, so that each GEMM operates on contiguous,
+    /// untransposed matrices. Tiles that are not contiguous tensors of
+    /// numeric elements, and non-numeric scaling factors, are not supported.
+    /// \tparam Result The result tile type
+    /// \tparam Left The left-hand tile type
+    /// \tparam Right The right-hand tile type
+    /// \tparam Scalar The scaling factor type
+    template <typename Result, typename Left, typename Right, typename Scalar>
+    class HadamardContractReduce {
+    public:
+      typedef HadamardContractReduce<Result, Left, Right, Scalar>
+          HadamardContractReduce_; ///< This class type
+      typedef const Left& first_argument_type; ///< The left tile type
+      typedef const Right& second_argument_type; ///< The right tile type
+      typedef Result result_type; ///< The result type
+      typedef Scalar scalar_type; ///< The scaling factor type
+
+      /// Supported operation flag
+      static constexpr bool supported =
+          is_hadamard_contract_tile<Result>::value &&
+          is_hadamard_contract_tile<Left>::value &&
+          is_hadamard_contract_tile<Right>::value &&
+          is_numeric<Scalar>::value;
+
+    private:
+
+      struct Impl {
+        Impl(const scalar_type alpha, const unsigned int hadamard_rank,
+            const unsigned int result_rank, const unsigned int left_rank,
+            const unsigned int right_rank, const Permutation& perm) :
+          gemm_helper_(madness::cblas::NoTrans, madness::cblas::NoTrans,
+              result_rank - hadamard_rank, left_rank - hadamard_rank,
+              right_rank - hadamard_rank),
+          alpha_(alpha), hadamard_rank_(hadamard_rank), perm_(perm)
+        { }
+
+        math::GemmHelper gemm_helper_; ///< Gemm helper object for the
+            ///< contraction of one element of the Hadamard dimensions
+        scalar_type alpha_; ///< Scaling factor applied to the contraction of
+            ///< the left- and right-hand arguments
+        unsigned int hadamard_rank_; ///< The number of Hadamard dimensions
+        Permutation perm_; ///< Permutation that is applied to the final result
+            ///< tensor
+      };
+
+      std::shared_ptr<Impl> pimpl_;
+
+      /// Contract a pair of tiles and add to a target tile
+      void contract(result_type& result, first_argument_type left,
+          second_argument_type right, std::true_type) const
+      {
+        const math::GemmHelper& gemm_helper = pimpl_->gemm_helper_;
+        const unsigned int hadamard_rank = pimpl_->hadamard_rank_;
+        const unsigned int left_outer_end =
+            hadamard_rank + gemm_helper.left_outer_end();
+        const unsigned int left_rank = hadamard_rank + gemm_helper.left_rank();
+        const unsigned int right_outer_begin =
+            hadamard_rank + gemm_helper.right_outer_begin();
+        const unsigned int right_rank = hadamard_rank + gemm_helper.right_rank();
+
+        // Compute the number of GEMMs and the matrix sizes of each GEMM
+        const auto* MADNESS_RESTRICT const left_extent = left.range().extent_data();
+        const auto* MADNESS_RESTRICT const right_extent = right.range().extent_data();
+        integer h = 1, m = 1, n = 1, k = 1;
+        unsigned int i = 0u;
+        for(; i < hadamard_rank; ++i) {
+          TA_ASSERT(left_extent[i] == right_extent[i]);
+          h *= left_extent[i];
+        }
+        for(; i < left_outer_end; ++i)
+          m *= left_extent[i];
+        for(; i < left_rank; ++i)
+          k *= left_extent[i];
+        for(i = right_outer_begin; i < right_rank; ++i)
+          n *= right_extent[i];
+
+        using TiledArray::empty;
+        typedef typename result_type::numeric_type numeric_type;
+        numeric_type beta(1);
+        if(empty(result)) {
+          // The result range is the Hadamard and outer dimensions of left,
+          // followed by the outer dimensions of right
+          std::vector<std::size_t> lobound, upbound;
+          lobound.reserve(gemm_helper.result_rank() + hadamard_rank);
+          upbound.reserve(gemm_helper.result_rank() + hadamard_rank);
+          for(i = 0u; i < left_outer_end; ++i) {
+            lobound.push_back(left.range().lobound_data()[i]);
+            upbound.push_back(left.range().upbound_data()[i]);
+          }
+          for(i = right_outer_begin; i < right_rank; ++i) {
+            lobound.push_back(right.range().lobound_data()[i]);
+            upbound.push_back(right.range().upbound_data()[i]);
+          }
+
+          result = result_type(typename result_type::range_type(lobound, upbound));
+          beta = numeric_type(0);
+        } else {
+          TA_ASSERT(result.range().volume() == std::size_t(h * m * n));
+        }
+
+        for(integer x = 0; x < h; ++x)
+          math::gemm(madness::cblas::NoTrans, madness::cblas::NoTrans, m, n, k,
+              pimpl_->alpha_, left.data() + x * m * k, k,
+              right.data() + x * k * n, n, beta, result.data() + x * m * n, n);
+      }
+
+      /// Unsupported tile or scaling factor types
+      void contract(result_type&, first_argument_type, second_argument_type,
+          std::false_type) const
+      {
+        TA_EXCEPTION("Contractions with Hadamard dimensions are not supported "
+            "for this tile type");
+      }
+
+    public:
+      // Compiler generated defaults are fine. N.B. this is shallow-copy.
+      HadamardContractReduce() = default;
+      HadamardContractReduce(const HadamardContractReduce_&) = default;
+      HadamardContractReduce(HadamardContractReduce_&&) = default;
+      ~HadamardContractReduce() = default;
+      HadamardContractReduce_& operator=(const HadamardContractReduce_&) = default;
+      HadamardContractReduce_& operator=(HadamardContractReduce_&&) = default;
+
+      /// Construct contract/reduce functor
+
+      /// \param alpha The scaling factor applied to the contracted tiles
+      /// \param hadamard_rank The number of leading dimensions that are
+      /// shared by the arguments and the result
+      /// \param result_rank The rank of the result tensor
+      /// \param left_rank The rank of the left-hand tensor
+      /// \param right_rank The rank of the right-hand tensor
+      /// \param perm The permutation to be applied to the result tensor
+      /// (default = no permute)
+      HadamardContractReduce(const scalar_type alpha,
+          const unsigned int hadamard_rank, const unsigned int result_rank,
+          const unsigned int left_rank, const unsigned int right_rank,
+          const Permutation& perm = Permutation()) :
+        pimpl_(std::make_shared<Impl>(alpha, hadamard_rank, result_rank,
+            left_rank, right_rank, perm))
+      { }
+
+      /// Gemm meta data accessor
+
+      /// \return A const reference to the gemm helper object of the
+      /// contraction of one element of the Hadamard dimensions
+      const math::GemmHelper& gemm_helper() const {
+        TA_ASSERT(pimpl_);
+        return pimpl_->gemm_helper_;
+      }
+
+      /// Hadamard rank accessor
+
+      /// \return The number of leading dimensions that are shared by the
+      /// arguments and the result
+      unsigned int hadamard_rank() const {
+        TA_ASSERT(pimpl_);
+        return pimpl_->hadamard_rank_;
+      }
+
+      /// Permutation accessor
+
+      /// \return A const reference to the permutation for this operation
+      const Permutation& perm() const {
+        TA_ASSERT(pimpl_);
+        return pimpl_->perm_;
+      }
+
+      /// Scaling factor accessor
+
+      /// \return The scaling factor for this operation
+      scalar_type factor() const {
+        TA_ASSERT(pimpl_);
+        return pimpl_->alpha_;
+      }
+
+      /// Create a result type object
+
+      /// Initialize a result object for subsequent reductions
+      result_type operator()() const {
+        return result_type();
+      }
+
+      /// Post processing step
+      result_type operator()(const result_type& temp) const {
+        using TiledArray::empty;
+        TA_ASSERT(! empty(temp));
+
+        if(! perm())
+          return temp;
+
+        TiledArray::Permute<result_type, result_type> permute;
+        return permute(temp, perm());
+      }
+
+      /// Reduce two result objects
+
+      /// Add \c arg to \c result .
+      /// \param[in,out] result The result object that will be the reduction
+      /// target
+      /// \param[in] arg The argument that will be added to \c result
+      void operator()(result_type& result, const result_type& arg) const {
+        using TiledArray::add_to;
+        add_to(result, arg);
+      }
+
+      /// Contract a pair of tiles and add to a target tile
+
+      /// Contract \c left and \c right and add the result to \c result.
+      /// \param[in,out] result The result object that will be the reduction
+      /// target
+      /// \param[in] left The left-hand tile to be contracted
+      /// \param[in] right The right-hand tile to be contracted
+      void operator()(result_type& result, first_argument_type left,
+          second_argument_type right) const
+      {
+        TA_ASSERT(pimpl_);
+        contract(result, left, right,
+            std::integral_constant<bool, supported>());
+      }
+
+    }; // class HadamardContractReduce
+
   } // namespace detail
 } // namespace TiledArray
 
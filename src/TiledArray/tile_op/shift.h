@@ -55,7 +55,8 @@ namespace TiledArray {
 
     private:
 
-      std::vector<long> range_shift_;
+      std::vector<long> range_shift_; ///< Range shift array
+      bool view_; ///< If \c true , non-consumable tiles are not copied
 
       // Permuting tile evaluation function
       // These operations cannot consume the argument tile since this operation
@@ -75,7 +76,9 @@ namespace TiledArray {
       // consumability of the arguments.
 
       template <bool C, typename = void>
-      auto eval(const argument_type& arg) const {
+      result_type eval(const argument_type& arg) const {
+        if(view_)
+          return view(arg, std::is_same<result_type, argument_type>());
         TiledArray::Shift<result_type, argument_type> shift;
         return shift(arg, range_shift_);
       }
@@ -94,6 +97,19 @@ namespace TiledArray {
         return arg;
       }
 
+      // Shift without copying the argument data, which is only possible when
+      // the argument and result types match.
+
+      result_type view(const argument_type& arg, std::true_type) const {
+        using TiledArray::shift_view;
+        return shift_view(arg, range_shift_);
+      }
+
+      result_type view(const argument_type& arg, std::false_type) const {
+        TiledArray::Shift<result_type, argument_type> shift;
+        return shift(arg, range_shift_);
+      }
+
     public:
 
       // Compiler generated functions
@@ -108,8 +124,13 @@ namespace TiledArray {
       /// Default constructor
 
       /// Construct a no operation that does not permute the result tile
-      Shift(const std::vector<long>& range_shift) :
-        range_shift_(range_shift)
+      /// \param range_shift The offset applied to the tile range
+      /// \param view If \c true , tiles that are not consumed or permuted
+      /// share the data of the argument tile instead of copying it. This is
+      /// only safe when the result tiles are not modified, e.g. when they are
+      /// the argument of another tile operation.
+      Shift(const std::vector<long>& range_shift, const bool view = false) :
+        range_shift_(range_shift), view_(view)
       { }
 
       /// Shift and permute operator
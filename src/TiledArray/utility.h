@@ -29,7 +29,9 @@
 #include <TiledArray/madness.h>
 #include <TiledArray/error.h>
 #include <TiledArray/type_traits.h>
+#include <cstdlib>
 #include <iosfwd>
+#include <string>
 #include <vector>
 #include <array>
 #include <initializer_list>
@@ -170,6 +172,20 @@ namespace TiledArray {
       print_array(out, a, size(a));
     }
 
+    /// Initial value of a process-wide mode flag
+
+    /// Mode flags (e.g. \c bulk_fetch() ) are initialized from an environment
+    /// variable and may be changed at runtime with their \c set_ function.
+    /// They must be set consistently on all processes.
+    /// \param name The name of the environment variable
+    /// \param default_value The value of the flag when \c name is not set
+    /// \return \c false if \c name is set to 0, \c true if it is set to
+    /// another value, and \c default_value if it is not set
+    inline bool env_flag(const char* name, const bool default_value) {
+      const char* value = getenv(name);
+      return (value ? std::string(value) != "0" : default_value);
+    }
+
   } // namespace detail
 } // namespace TiledArray
 
@@ -41,6 +41,10 @@ namespace TiledArray {
   template<typename, typename>
   class Tensor;
 
+  // Pooled tile allocator
+  template <typename>
+  class PoolAllocator;
+
   typedef Tensor<double, Eigen::aligned_allocator<double> > TensorD;
   typedef Tensor<int, Eigen::aligned_allocator<int> > TensorI;
   typedef Tensor<float, Eigen::aligned_allocator<float> > TensorF;
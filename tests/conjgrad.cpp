@@ -0,0 +1,96 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TiledArray/algebra/conjgrad.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct ConjGradFixture {
+
+  // Symmetric, diagonally dominant matrix
+  struct Matrix {
+    Matrix(World& world, const TiledRange1& tr1) : a(world, TiledRange({tr1, tr1})) {
+      const std::size_t n = tr1.extent();
+      a.init_elements([n] (const auto& i) {
+        return (i[0] == i[1] ? double(n) : 1.0 / double(1 + i[0] + i[1]));
+      });
+    }
+
+    void operator()(const TArrayD& x, TArrayD& result) const {
+      result("i") = a("i,j") * x("j");
+    }
+
+    TArrayD a;
+  }; // struct Matrix
+
+  ConjGradFixture() :
+    world(*GlobalFixture::world), tr1{0, 5, 10, 15, 20, 23},
+    a(world, tr1), b(world, TiledRange({tr1})),
+    preconditioner(world, TiledRange({tr1}))
+  {
+    b.init_elements([] (const auto& i) { return 1.0 + 0.25 * double(i[0] % 7); });
+    preconditioner.init_elements([this] (const auto&) {
+      return 1.0 / double(tr1.extent());
+    });
+  }
+
+  ~ConjGradFixture() { GlobalFixture::world->gop.fence(); }
+
+  // The residual norm of x
+  double residual(const TArrayD& x) {
+    TArrayD r;
+    a(x, r);
+    r("i") = r("i") - b("i");
+    return r("i").norm().get();
+  }
+
+  World& world;
+  TiledRange1 tr1;
+  Matrix a;
+  TArrayD b;
+  TArrayD preconditioner;
+
+}; // ConjGradFixture
+
+BOOST_FIXTURE_TEST_SUITE( conjgrad_suite, ConjGradFixture )
+
+BOOST_AUTO_TEST_CASE( solve )
+{
+  TArrayD x(world, b.trange());
+  ConjugateGradientSolver<TArrayD, Matrix> solver;
+  BOOST_REQUIRE_NO_THROW(solver(a, b, x, preconditioner, 1.0e-12));
+  BOOST_CHECK_SMALL(residual(x), 1.0e-9);
+}
+
+BOOST_AUTO_TEST_CASE( solve_pipelined )
+{
+  TArrayD x(world, b.trange());
+  PipelinedConjugateGradientSolver<TArrayD, Matrix> solver;
+  BOOST_REQUIRE_NO_THROW(solver(a, b, x, preconditioner, 1.0e-12));
+  BOOST_CHECK_SMALL(residual(x), 1.0e-9);
+
+  // Check that b is not modified by the in-place updates
+  auto b_tile = b.find(0).get();
+  for(std::size_t i = 0ul; i < b_tile.size(); ++i)
+    BOOST_CHECK_EQUAL(b_tile[i], 1.0 + 0.25 * double(i % 7));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,186 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TiledArray/pmap/cost_pmap.h"
+#include "TiledArray/pmap/blocked_pmap.h"
+#include "TiledArray/dense_shape.h"
+#include "sparse_shape_fixture.h"
+#include "unit_test_config.h"
+#include "global_fixture.h"
+
+using namespace TiledArray;
+
+struct CostPmapFixture : public TiledRangeFixture {
+
+  CostPmapFixture() { }
+
+  /// Tile costs that grow quadratically with the tile index
+  static std::vector<double> skewed_costs(const std::size_t size) {
+    std::vector<double> costs(size);
+    for(std::size_t i = 0ul; i < size; ++i)
+      costs[i] = double(i * i);
+    return costs;
+  }
+
+};
+
+
+// =============================================================================
+// CostPmap Test Suite
+
+
+BOOST_FIXTURE_TEST_SUITE( cost_pmap_suite, CostPmapFixture )
+
+BOOST_AUTO_TEST_CASE( owner )
+{
+  const std::size_t rank = GlobalFixture::world->rank();
+  const std::size_t size = GlobalFixture::world->size();
+
+  ProcessID* p_owner = new ProcessID[size];
+
+  // Check various pmap sizes
+  for(std::size_t tiles = 1ul; tiles < 100ul; ++tiles) {
+    detail::CostPmap pmap(* GlobalFixture::world, skewed_costs(tiles));
+
+    for(std::size_t tile = 0; tile < tiles; ++tile) {
+      std::fill_n(p_owner, size, 0);
+      p_owner[rank] = pmap.owner(tile);
+      // check that the value is in range
+      BOOST_CHECK_LT(p_owner[rank], size);
+      GlobalFixture::world->gop.sum(p_owner, size);
+
+      // Make sure everyone agrees on who owns what.
+      for(std::size_t p = 0ul; p < size; ++p)
+        BOOST_CHECK_EQUAL(p_owner[p], p_owner[rank]);
+
+      // Check that the blocks are contiguous
+      if(tile > 0ul)
+        BOOST_CHECK_LE(pmap.owner(tile - 1ul), pmap.owner(tile));
+    }
+  }
+
+  delete [] p_owner;
+}
+
+BOOST_AUTO_TEST_CASE( local_group )
+{
+  ProcessID tile_owners[100];
+
+  for(std::size_t tiles = 1ul; tiles < 100ul; ++tiles) {
+    detail::CostPmap pmap(* GlobalFixture::world, skewed_costs(tiles));
+
+    // Check that the total number of local tiles is equal to the number of
+    // tiles in the map
+    std::size_t total_size = pmap.local_size();
+    GlobalFixture::world->gop.sum(total_size);
+    BOOST_CHECK_EQUAL(total_size, tiles);
+    BOOST_CHECK(pmap.empty() == (pmap.local_size() == 0ul));
+
+    // Check that all local elements map to this rank
+    for(detail::CostPmap::const_iterator it = pmap.begin(); it != pmap.end(); ++it) {
+      BOOST_CHECK_EQUAL(pmap.owner(*it), GlobalFixture::world->rank());
+      BOOST_CHECK(pmap.is_local(*it));
+    }
+
+    std::fill_n(tile_owners, tiles, 0);
+    for(detail::CostPmap::const_iterator it = pmap.begin(); it != pmap.end(); ++it) {
+      tile_owners[*it] += GlobalFixture::world->rank();
+    }
+
+    GlobalFixture::world->gop.sum(tile_owners, tiles);
+    for(std::size_t tile = 0; tile < tiles; ++tile) {
+      BOOST_CHECK_EQUAL(tile_owners[tile], pmap.owner(tile));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( balance )
+{
+  const std::size_t size = GlobalFixture::world->size();
+  const std::vector<double> costs = skewed_costs(1000ul);
+  const double max_cost = *std::max_element(costs.begin(), costs.end());
+  const double mean = std::accumulate(costs.begin(), costs.end(), 0.0)
+      / double(size);
+
+  detail::CostPmap pmap(* GlobalFixture::world, costs);
+
+  // Check that the cost of each process is within one tile of the average
+  double total = 0.0;
+  for(std::size_t p = 0ul; p < size; ++p) {
+    BOOST_CHECK_LE(std::abs(pmap.cost(p) - mean), max_cost);
+    total += pmap.cost(p);
+  }
+  BOOST_CHECK_CLOSE(total, mean * double(size), 1.0e-10);
+  BOOST_CHECK_EQUAL(pmap.local_cost(), pmap.cost(GlobalFixture::world->rank()));
+
+  // Check the load imbalance metric
+  BOOST_CHECK_GE(pmap.imbalance(), 1.0);
+  BOOST_CHECK_LE(pmap.imbalance(), 1.0 + max_cost / mean);
+  BOOST_CHECK_CLOSE(detail::load_imbalance(pmap, costs), pmap.imbalance(), 1.0e-10);
+
+  // Check that the growing costs are balanced better than by tile count
+  detail::BlockedPmap skewed_blocked_pmap(* GlobalFixture::world, costs.size());
+  BOOST_CHECK_LE(pmap.imbalance(),
+      detail::load_imbalance(skewed_blocked_pmap, costs));
+
+  // Check that the costs are balanced at least as well as by tile count
+  // when the costs are concentrated at the end
+  std::vector<double> tail_costs(1000ul, 0.0);
+  std::fill(tail_costs.begin() + 900l, tail_costs.end(), 1.0);
+  detail::CostPmap tail_pmap(* GlobalFixture::world, tail_costs);
+  detail::BlockedPmap blocked_pmap(* GlobalFixture::world, tail_costs.size());
+  BOOST_CHECK_LE(tail_pmap.imbalance(),
+      detail::load_imbalance(blocked_pmap, tail_costs));
+}
+
+BOOST_AUTO_TEST_CASE( zero_cost )
+{
+  // Check that tiles without cost are split evenly
+  detail::CostPmap pmap(* GlobalFixture::world, std::vector<double>(50ul, 0.0));
+  detail::BlockedPmap blocked_pmap(* GlobalFixture::world, 50ul);
+  BOOST_CHECK_EQUAL(pmap.local_size(), blocked_pmap.local_size());
+  BOOST_CHECK_EQUAL(pmap.imbalance(), 1.0);
+}
+
+BOOST_AUTO_TEST_CASE( shape_costs )
+{
+  const TiledRange& trange = tr;
+  const SparseShape<float> shape = SparseShapeFixture::make_shape(trange, 0.3, 17);
+
+  // Check that the cost of a tile is its volume, or zero for zero tiles
+  const std::vector<double> costs = detail::tile_costs(trange, shape);
+  BOOST_REQUIRE_EQUAL(costs.size(), trange.tiles_range().volume());
+  for(std::size_t i = 0ul; i < costs.size(); ++i) {
+    if(shape.is_zero(i))
+      BOOST_CHECK_EQUAL(costs[i], 0.0);
+    else
+      BOOST_CHECK_EQUAL(costs[i], double(trange.make_tile_range(i).volume()));
+  }
+
+  // Check that dense shapes give the tile volumes
+  const std::vector<double> dense_costs = detail::tile_costs(trange, DenseShape());
+  for(std::size_t i = 0ul; i < dense_costs.size(); ++i)
+    BOOST_CHECK_EQUAL(dense_costs[i], double(trange.make_tile_range(i).volume()));
+
+  auto pmap = detail::make_cost_pmap(* GlobalFixture::world, trange, shape);
+  BOOST_CHECK_EQUAL(pmap->size(), costs.size());
+  BOOST_CHECK_CLOSE(pmap->imbalance(), detail::load_imbalance(*pmap, costs), 1.0e-10);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
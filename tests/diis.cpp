@@ -0,0 +1,138 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TiledArray/algebra/diis.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct DIISFixture {
+
+  DIISFixture() : world(*GlobalFixture::world), tr({{0, 3, 7, 12}, {0, 4, 9}}) {
+    for(int k = 0; k < 4; ++k) {
+      x.emplace_back(world, tr);
+      x.back().init_elements([k] (const auto& i) {
+        return double(1 + k) * (0.5 + double(i[0])) - 0.25 * double(i[1]);
+      });
+    }
+  }
+
+  ~DIISFixture() { GlobalFixture::world->gop.fence(); }
+
+  std::vector<const TArrayD*> pointers() const {
+    std::vector<const TArrayD*> result;
+    for(const TArrayD& x_k : x)
+      result.push_back(&x_k);
+    return result;
+  }
+
+  World& world;
+  TiledRange tr;
+  std::vector<TArrayD> x;
+
+}; // DIISFixture
+
+BOOST_FIXTURE_TEST_SUITE( diis_suite, DIISFixture )
+
+BOOST_AUTO_TEST_CASE( dot_products )
+{
+  // Check the batched dot products against separate reductions
+  const std::vector<double> dots = TiledArray::dot_products(pointers(), x[2]);
+  BOOST_REQUIRE_EQUAL(dots.size(), x.size());
+  for(std::size_t k = 0ul; k < x.size(); ++k)
+    BOOST_CHECK_CLOSE(dots[k], dot_product(x[k], x[2]), 1.0e-12);
+}
+
+BOOST_AUTO_TEST_CASE( axpy_combination )
+{
+  // Check the fused linear combination against separate axpy calls
+  const std::vector<double> a = {0.5, -1.0, 2.0, 0.25};
+
+  TArrayD y = clone(x[0]);
+  axpy(y, a, pointers());
+
+  TArrayD ref = clone(x[0]);
+  for(std::size_t k = 0ul; k < x.size(); ++k)
+    axpy(ref, a[k], x[k]);
+
+  ref("i,j") = ref("i,j") - y("i,j");
+  BOOST_CHECK_SMALL(ref("i,j").norm().get(), 1.0e-10);
+}
+
+BOOST_AUTO_TEST_CASE( axpy_tile_types )
+{
+  // Only tensors of numbers with contiguous data are combined element-wise
+  BOOST_CHECK(detail::is_axpy_tile<TensorD>::value);
+  BOOST_CHECK(detail::is_axpy_tile<Tile<TensorD> >::value);
+  BOOST_CHECK(! detail::is_axpy_tile<Tensor<TensorD> >::value);
+  BOOST_CHECK(! detail::is_axpy_tile<Tile<Tensor<TensorD> > >::value);
+}
+
+BOOST_AUTO_TEST_CASE( axpy_combination_sparse )
+{
+  // Check the linear combination of sparse arrays, which uses separate axpy
+  // calls, against separate axpy calls
+  std::vector<TSpArrayD> sx;
+  std::vector<const TSpArrayD*> sx_ptrs;
+  for(int k = 0; k < 4; ++k) {
+    sx.emplace_back(world, tr);
+    sx.back().init_elements([k] (const auto& i) {
+      return double(1 + k) * (0.5 + double(i[0])) - 0.25 * double(i[1]);
+    });
+  }
+  for(const TSpArrayD& sx_k : sx)
+    sx_ptrs.push_back(&sx_k);
+
+  const std::vector<double> a = {0.5, -1.0, 2.0, 0.25};
+  TSpArrayD y = clone(sx[0]);
+  axpy(y, a, sx_ptrs);
+
+  TSpArrayD ref = clone(sx[0]);
+  for(std::size_t k = 0ul; k < sx.size(); ++k)
+    axpy(ref, a[k], sx[k]);
+
+  ref("i,j") = ref("i,j") - y("i,j");
+  BOOST_CHECK_SMALL(ref("i,j").norm().get(), 1.0e-10);
+}
+
+BOOST_AUTO_TEST_CASE( extrapolate )
+{
+  // Solve w * v = x[1] element-wise with the fixed point iteration
+  // v -= w * v - x[1], where w has two distinct values, so DIIS converges
+  // after three iterations
+  TArrayD w(world, tr);
+  w.init_elements([] (const auto& i) {
+    return ((i[0] + i[1]) % 2 == 0 ? 0.75 : 0.5);
+  });
+
+  DIIS<TArrayD> diis(1, 5);
+  TArrayD v = clone(x[0]);
+  TArrayD error;
+  for(int i = 0; i < 5; ++i) {
+    error("i,j") = w("i,j") * v("i,j") - x[1]("i,j");
+    diis.extrapolate(v, error);
+    error("i,j") = w("i,j") * v("i,j") - x[1]("i,j");
+    v("i,j") = v("i,j") - error("i,j");
+  }
+  error("i,j") = w("i,j") * v("i,j") - x[1]("i,j");
+  BOOST_CHECK_SMALL(error("i,j").norm().get(), 1.0e-8);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -280,6 +280,33 @@ BOOST_AUTO_TEST_CASE( make_replicated )
   }
 }
 
+BOOST_AUTO_TEST_CASE( make_replicated_sparse )
+{
+  // Construct a sparse array where every third tile is zero, and fill each
+  // tile with its ordinal index
+  SpArrayN as(world, tr, TiledArray::SparseShape<float>(shape_tensor, tr));
+  for(std::size_t i = 0ul; i < as.size(); ++i)
+    if(as.is_local(i) && ! as.is_zero(i))
+      as.set(i, int(i + 1ul));
+
+  // Replicate the array; with more than two processes, tiles are forwarded
+  // by the intermediate nodes of the broadcast tree.
+  BOOST_REQUIRE_NO_THROW(as.make_replicated());
+
+  // Check that every process has all non-zero tiles
+  for(std::size_t i = 0ul; i < as.size(); ++i) {
+    BOOST_CHECK_EQUAL(as.is_zero(i), shape_tensor[i] == 0.0f);
+    if(as.is_zero(i))
+      continue;
+
+    BOOST_CHECK(as.is_local(i));
+    const SpArrayN::value_type tile = as.find(i).get();
+    BOOST_CHECK_EQUAL(tile.range(), as.trange().make_tile_range(i));
+    for(SpArrayN::value_type::const_iterator it = tile.begin(); it != tile.end(); ++it)
+      BOOST_CHECK_EQUAL(*it, int(i + 1ul));
+  }
+}
+
 BOOST_AUTO_TEST_CASE( serialization )
 {
   decltype(a) acopy(a.world(), a.trange(), a.shape());
@@ -180,4 +180,112 @@ BOOST_AUTO_TEST_CASE( eval_permute )
 
 }
 
+BOOST_AUTO_TEST_CASE( eval_redistribute )
+{
+  // Evaluate the array with a different process map, so the remote tiles
+  // are fetched in bulk
+  auto pmap = std::make_shared<TiledArray::detail::HashPmap>(
+      * GlobalFixture::world, tr.tiles_range().volume());
+  auto dist_eval = make_array_eval(array, array.world(),
+      DenseShape(), pmap, Permutation(), make_scal(3));
+  using dist_eval_type = decltype(dist_eval);
+
+  // Request the tiles in reverse order
+  std::vector<std::size_t> order(pmap->begin(), pmap->end());
+  std::reverse(order.begin(), order.end());
+  dist_eval.set_tile_order(order);
+
+  BOOST_REQUIRE_NO_THROW(dist_eval.eval());
+
+  // Check that each tile has been fetched and properly scaled.
+  for(auto index : order) {
+    TArrayI::value_type array_tile = array.find(index);
+
+    Future<dist_eval_type::value_type> impl_tile;
+    BOOST_REQUIRE_NO_THROW(impl_tile = dist_eval.get(index));
+
+    dist_eval_type::eval_type eval_tile;
+    BOOST_REQUIRE_NO_THROW(eval_tile = static_cast<dist_eval_type::eval_type>(impl_tile.get()));
+
+    BOOST_CHECK_EQUAL(eval_tile.range(), array_tile.range());
+    for(std::size_t i = 0ul; i < eval_tile.size(); ++i) {
+      BOOST_CHECK_EQUAL(eval_tile[i], 3 * array_tile[i]);
+    }
+  }
+
+  dist_eval.wait();
+  GlobalFixture::world->gop.fence();
+}
+
+BOOST_AUTO_TEST_CASE( eval_redistribute_window )
+{
+  // Fetch at most two remote tiles ahead of the tiles that have been taken,
+  // and discard every third tile
+  auto pmap = std::make_shared<TiledArray::detail::HashPmap>(
+      * GlobalFixture::world, tr.tiles_range().volume());
+  auto dist_eval = make_array_eval(array, array.world(),
+      DenseShape(), pmap, Permutation(), make_scal(3));
+  using dist_eval_type = decltype(dist_eval);
+
+  std::vector<std::size_t> order(pmap->begin(), pmap->end());
+  dist_eval.set_tile_order(order, 2ul);
+
+  BOOST_REQUIRE_NO_THROW(dist_eval.eval());
+
+  for(std::size_t i = 0ul; i < order.size(); ++i) {
+    const std::size_t index = order[i];
+    if((i % 3ul) == 2ul) {
+      BOOST_REQUIRE_NO_THROW(dist_eval.discard(index));
+      continue;
+    }
+
+    TArrayI::value_type array_tile = array.find(index);
+
+    Future<dist_eval_type::value_type> impl_tile;
+    BOOST_REQUIRE_NO_THROW(impl_tile = dist_eval.get(index));
+
+    dist_eval_type::eval_type eval_tile;
+    BOOST_REQUIRE_NO_THROW(eval_tile = static_cast<dist_eval_type::eval_type>(impl_tile.get()));
+
+    BOOST_CHECK_EQUAL(eval_tile.range(), array_tile.range());
+    for(std::size_t j = 0ul; j < eval_tile.size(); ++j) {
+      BOOST_CHECK_EQUAL(eval_tile[j], 3 * array_tile[j]);
+    }
+  }
+
+  dist_eval.wait();
+  GlobalFixture::world->gop.fence();
+}
+
+BOOST_AUTO_TEST_CASE( bulk_fetch )
+{
+  // Send one tile per reply batch
+  typedef TiledArray::detail::BulkFetch<TArrayI> fetch_type;
+  std::unique_ptr<fetch_type> fetch(new fetch_type(array, 1ul));
+  BOOST_CHECK_EQUAL(fetch->batch_bytes(), 1ul);
+
+  // Fetch every remote tile
+  std::vector<std::size_t> indices;
+  for(std::size_t index = 0ul; index < array.size(); ++index)
+    if(! array.is_local(index))
+      indices.push_back(index);
+  fetch->fetch(indices);
+
+  for(auto index : indices) {
+    TArrayI::value_type array_tile = array.find(index);
+    TArrayI::value_type tile = fetch->get(index);
+    BOOST_CHECK_EQUAL(tile.range(), array_tile.range());
+    for(std::size_t i = 0ul; i < tile.size(); ++i)
+      BOOST_CHECK_EQUAL(tile[i], array_tile[i]);
+  }
+
+  // Check that tiles that were not requested are fetched from the array
+  for(auto index : * array.pmap())
+    BOOST_CHECK_EQUAL(fetch->get(index).get().range(),
+        array.trange().make_tile_range(index));
+
+  // Wait for the other processes to receive their tiles
+  GlobalFixture::world->gop.fence();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -168,6 +168,7 @@ struct ContractionEvalFixture : public SparseShapeFixture {
   /// \param pmap The process map for the evaluated tensor
   /// \param perm The permutation applied to the tensor
   /// \param op The contraction/reduction tile operation
+  /// \param layers The number of process grid layers
   template <typename LeftTile, typename RightTile, typename Policy, typename Op>
   TiledArray::detail::DistEval<typename Op::result_type, Policy>
   make_contract_eval(
@@ -177,7 +178,8 @@ struct ContractionEvalFixture : public SparseShapeFixture {
       const typename TiledArray::detail::DistEval<typename Op::result_type, Policy>::shape_type& shape,
       const std::shared_ptr<typename TiledArray::detail::DistEval<typename Op::result_type, Policy>::pmap_interface>& pmap,
       const Permutation& perm,
-      const Op& op)
+      const Op& op, const std::size_t layers = 1ul,
+      const TiledArray::detail::NodeTopology* topology = nullptr)
   {
     TA_ASSERT(left.range().rank() == op.left_rank());
     TA_ASSERT(right.range().rank() == op.right_rank());
@@ -221,7 +223,7 @@ struct ContractionEvalFixture : public SparseShapeFixture {
     typename impl_type::trange_type trange(ranges.begin(), ranges.end());
 
     // Construct the process grid
-    TiledArray::detail::ProcGrid proc_grid(world, M, N, m, n);
+    TiledArray::detail::ProcGrid proc_grid(world, M, N, m, n, layers, topology);
 
     return TiledArray::detail::DistEval<typename Op::result_type, Policy>(
         std::shared_ptr<impl_type>( new impl_type(left, right, world, trange,
@@ -449,4 +451,258 @@ BOOST_AUTO_TEST_CASE( sparse_eval )
   do_sparse_eval(true);
 }
 
+BOOST_AUTO_TEST_CASE( sparse_eval_grow )
+{
+  // Force the depth controller to grow the pipeline up to the number of
+  // steps, so that growth is requested when the last step has been reached.
+  const std::size_t min_depth =
+      set_summa_min_depth(std::numeric_limits<std::size_t>::max());
+
+  TSpArrayI left(*GlobalFixture::world, tr, make_shape(tr, 0.4, 23));
+  TSpArrayI right(*GlobalFixture::world, tr, make_shape(tr, 0.4, 42));
+  rand_fill_array(left);
+  left.truncate();
+  rand_fill_array(right);
+  right.truncate();
+
+  auto left_arg = make_array_eval(left, left.world(), left.shape(),
+      proc_grid.make_row_phase_pmap(tr.tiles_range().volume() / tr.tiles_range().extent(0)),
+      Permutation(), make_array_noop());
+  auto right_arg = make_array_eval(right, right.world(), right.shape(),
+      proc_grid.make_col_phase_pmap(tr.tiles_range().volume() / tr.tiles_range().extent(tr.tiles_range().rank() - 1)),
+      Permutation(), make_array_noop());
+  auto op = make_contract(2u, left_arg.trange().tiles_range().rank(),
+      right_arg.trange().tiles_range().rank());
+  SparseShape<float> result_shape =
+      left_arg.shape().gemm(right_arg.shape(), 1, op.gemm_helper());
+
+  auto contract = make_contract_eval(left_arg, right_arg,
+      left_arg.world(), result_shape, pmap, Permutation(), op);
+  using dist_eval_type = decltype(contract);
+
+  BOOST_REQUIRE_NO_THROW(contract.eval());
+  BOOST_REQUIRE_NO_THROW(contract.wait());
+  set_summa_min_depth(min_depth);
+
+  // Compute the reference contraction
+  const matrix_type l = copy_to_matrix(left, 1),
+                    r = copy_to_matrix(right, GlobalFixture::dim - 1);
+  const matrix_type reference = l * r;
+
+  for(auto index : *contract.pmap()) {
+    dist_eval_type::range_type range = contract.trange().make_tile_range(index);
+    if(contract.is_zero(index)) {
+      BOOST_CHECK((reference.block(range.lobound(0), range.lobound(1),
+          range.extent(0), range.extent(1)).array() == 0).all());
+    } else {
+      dist_eval_type::eval_type eval_tile;
+      BOOST_REQUIRE_NO_THROW(eval_tile = contract.get(index).get());
+      BOOST_CHECK_EQUAL(eval_tile.range(), range);
+      BOOST_CHECK(eigen_map(eval_tile) == reference.block(range.lobound(0),
+          range.lobound(1), range.extent(0), range.extent(1)));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( layered_eval )
+{
+  const std::size_t M = tr.tiles_range().extent(0);
+  const std::size_t N = tr.tiles_range().extent(tr.tiles_range().rank() - 1u);
+  const std::size_t K = tr.tiles_range().volume() / M;
+  const std::size_t layers =
+      std::min<std::size_t>(GlobalFixture::world->size(), K);
+
+  // Distribute the arguments among the layers of the process grid
+  detail::ProcGrid layered_grid(*GlobalFixture::world, M, N,
+      tr.elements_range().extent(0),
+      tr.elements_range().extent(tr.elements_range().rank() - 1u), layers);
+  array_eval_type layered_left(make_array_eval(left, left.world(), DenseShape(),
+      layered_grid.make_row_phase_pmap(K), Permutation(), make_array_noop()));
+  array_eval_type layered_right(make_array_eval(right, right.world(), DenseShape(),
+      layered_grid.make_col_phase_pmap(tr.tiles_range().volume() / N),
+      Permutation(), make_array_noop()));
+
+  auto contract = make_contract_eval(layered_left, layered_right,
+      layered_left.world(), DenseShape(), pmap, Permutation(), make_contract(2u,
+      layered_left.trange().tiles_range().rank(),
+      layered_right.trange().tiles_range().rank()), layers);
+  using dist_eval_type = decltype(contract);
+
+  // Check evaluation
+  BOOST_REQUIRE_NO_THROW(contract.eval());
+  BOOST_REQUIRE_NO_THROW(contract.wait());
+
+  // Compute the reference contraction
+  const matrix_type l = copy_to_matrix(left, 1),
+                    r = copy_to_matrix(right, GlobalFixture::dim - 1);
+  const matrix_type reference = l * r;
+
+  // Check that the partial results of all layers are summed
+  for(auto index : *contract.pmap()) {
+    dist_eval_type::eval_type eval_tile;
+    BOOST_REQUIRE_NO_THROW(eval_tile = contract.get(index).get());
+    BOOST_CHECK(! eval_tile.empty());
+
+    if(!eval_tile.empty()) {
+      BOOST_CHECK_EQUAL(eval_tile.range(), contract.trange().make_tile_range(index));
+      BOOST_CHECK(eigen_map(eval_tile) == reference.block(eval_tile.range().lobound(0),
+          eval_tile.range().lobound(1), eval_tile.range().extent(0), eval_tile.range().extent(1)));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( node_aware_eval )
+{
+  const std::size_t M = tr.tiles_range().extent(0);
+  const std::size_t N = tr.tiles_range().extent(tr.tiles_range().rank() - 1u);
+  const std::size_t K = tr.tiles_range().volume() / M;
+
+  // Place the processes round-robin on the nodes, so that the process grid
+  // is not in rank order (e.g. with 6 processes on 3 nodes, the rank table
+  // is {0,3,1,4,2,5})
+  const std::size_t nprocs = GlobalFixture::world->size();
+  const std::size_t nodes = std::max<std::size_t>(nprocs / 2ul, 1ul);
+  std::vector<std::size_t> labels(nprocs);
+  for(std::size_t p = 0ul; p < nprocs; ++p)
+    labels[p] = p % nodes;
+  const detail::NodeTopology topology(labels);
+
+  detail::ProcGrid node_grid(*GlobalFixture::world, M, N,
+      tr.elements_range().extent(0),
+      tr.elements_range().extent(tr.elements_range().rank() - 1u), 1ul,
+      &topology);
+  BOOST_CHECK(node_grid.has_rank_table());
+  array_eval_type node_left(make_array_eval(left, left.world(), DenseShape(),
+      node_grid.make_row_phase_pmap(K), Permutation(), make_array_noop()));
+  array_eval_type node_right(make_array_eval(right, right.world(), DenseShape(),
+      node_grid.make_col_phase_pmap(tr.tiles_range().volume() / N),
+      Permutation(), make_array_noop()));
+
+  auto contract = make_contract_eval(node_left, node_right,
+      node_left.world(), DenseShape(), pmap, Permutation(), make_contract(2u,
+      node_left.trange().tiles_range().rank(),
+      node_right.trange().tiles_range().rank()), 1ul, &topology);
+  using dist_eval_type = decltype(contract);
+
+  // Check evaluation; the broadcast roots must be translated to the row and
+  // column group ranks
+  BOOST_REQUIRE_NO_THROW(contract.eval());
+  BOOST_REQUIRE_NO_THROW(contract.wait());
+
+  // Compute the reference contraction
+  const matrix_type l = copy_to_matrix(left, 1),
+                    r = copy_to_matrix(right, GlobalFixture::dim - 1);
+  const matrix_type reference = l * r;
+
+  for(auto index : *contract.pmap()) {
+    dist_eval_type::eval_type eval_tile;
+    BOOST_REQUIRE_NO_THROW(eval_tile = contract.get(index).get());
+    BOOST_CHECK(! eval_tile.empty());
+
+    if(!eval_tile.empty()) {
+      BOOST_CHECK_EQUAL(eval_tile.range(), contract.trange().make_tile_range(index));
+      BOOST_CHECK(eigen_map(eval_tile) == reference.block(eval_tile.range().lobound(0),
+          eval_tile.range().lobound(1), eval_tile.range().extent(0), eval_tile.range().extent(1)));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( depth_statistics )
+{
+  const bool logging = set_summa_depth_logging(true);
+  reset_summa_depth_statistics();
+
+  auto contract = make_contract_eval(left_arg, right_arg,
+      left_arg.world(), DenseShape(), pmap, Permutation(), make_contract(2u,
+      left_arg.trange().tiles_range().rank(), right_arg.trange().tiles_range().rank()));
+
+  BOOST_REQUIRE_NO_THROW(contract.eval());
+  BOOST_REQUIRE_NO_THROW(contract.wait());
+  GlobalFixture::world->gop.fence();
+  set_summa_depth_logging(logging);
+
+  // Check that the depth statistics are exported by the processes of the
+  // process grid, and that they are consistent
+  const std::size_t k =
+      tr.tiles_range().volume() / tr.tiles_range().extent(0);
+  const std::vector<SummaDepthStatistics> stats = summa_depth_statistics();
+  if(proc_grid.local_size()) {
+    BOOST_REQUIRE_EQUAL(stats.size(), 1ul);
+    const SummaDepthStatistics& s = stats.front();
+    BOOST_CHECK_GE(s.initial_depth, 1ul);
+    BOOST_CHECK_LE(s.initial_depth, k);
+    BOOST_CHECK_LE(s.min_depth, s.initial_depth);
+    BOOST_CHECK_GE(s.max_depth, s.initial_depth);
+    BOOST_CHECK_LE(s.min_depth, s.final_depth);
+    BOOST_CHECK_GE(s.max_depth, s.final_depth);
+    BOOST_CHECK_EQUAL(s.steps, k);
+    BOOST_CHECK_GE(s.mean_bcast_latency, 0.0);
+    BOOST_CHECK_GE(s.mean_gemm_time, 0.0);
+  } else {
+    BOOST_CHECK(stats.empty());
+  }
+
+  // The statistics are removed from the log when they are exported
+  BOOST_CHECK(summa_depth_statistics().empty());
+}
+
+BOOST_AUTO_TEST_CASE( depth_controller )
+{
+  detail::SummaDepthController controller;
+  controller.initialize(2ul, 8ul, 0ul, true);
+  BOOST_CHECK_EQUAL(controller.depth(), 2ul);
+
+  // Depth is not changed before enough samples are collected
+  BOOST_CHECK_EQUAL(controller.adjust(), 0);
+
+  // Broadcast latency larger than the contraction time increases the depth
+  for(int i = 0; i < 2; ++i) {
+    controller.step_started(100ul);
+    controller.step_finished(100ul, 1.0, 0.1);
+  }
+  // ... unless the pipeline has reached the end of the inner dimension
+  BOOST_CHECK_EQUAL(controller.adjust(false), 0);
+  BOOST_CHECK_EQUAL(controller.depth(), 2ul);
+  BOOST_CHECK_EQUAL(controller.adjust(), 1);
+  BOOST_CHECK_EQUAL(controller.depth(), 3ul);
+
+  // Contraction time larger than the broadcast latency decreases the depth
+  for(int i = 0; i < 8; ++i) {
+    controller.step_started(100ul);
+    controller.step_finished(100ul, 0.0, 10.0);
+  }
+  BOOST_CHECK_EQUAL(controller.adjust(), -1);
+  BOOST_CHECK_EQUAL(controller.depth(), 2ul);
+
+  // Resident memory above the limit decreases the depth
+  controller.initialize(4ul, 8ul, 1000ul, true);
+  controller.step_started(2000ul);
+  BOOST_CHECK_EQUAL(controller.adjust(), -1);
+  BOOST_CHECK_EQUAL(controller.depth(), 3ul);
+  controller.step_finished(2000ul, 1.0, 1.0);
+
+  // ... even below the minimum depth
+  const std::size_t min_depth = set_summa_min_depth(4ul);
+  controller.initialize(4ul, 8ul, 1000ul, true);
+  controller.step_started(2000ul);
+  BOOST_CHECK_EQUAL(controller.adjust(), -1);
+  BOOST_CHECK_EQUAL(controller.depth(), 3ul);
+  controller.step_finished(2000ul, 1.0, 1.0);
+  set_summa_min_depth(min_depth);
+
+  // The depth is fixed when the controller is disabled
+  controller.initialize(2ul, 8ul, 0ul, false);
+  for(int i = 0; i < 4; ++i) {
+    controller.step_started(100ul);
+    controller.step_finished(100ul, 1.0, 0.1);
+  }
+  BOOST_CHECK_EQUAL(controller.adjust(), 0);
+  BOOST_CHECK_EQUAL(controller.depth(), 2ul);
+
+  const SummaDepthStatistics stats = controller.statistics();
+  BOOST_CHECK_EQUAL(stats.initial_depth, 2ul);
+  BOOST_CHECK_EQUAL(stats.steps, 4ul);
+  BOOST_CHECK_EQUAL(stats.peak_resident_bytes, 100ul);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -364,6 +364,69 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE(scal_block, F, Fixtures, F) {
   }
 }
 
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(block_add, F, Fixtures, F) {
+  auto& a = F::a;
+  auto& b = F::b;
+  auto& c = F::c;
+
+  // Keep deep copies of the arguments, since the block tiles share the data
+  // of the argument tiles
+  const auto a_ref = TiledArray::clone(a);
+  const auto b_ref = TiledArray::clone(b);
+
+  BOOST_REQUIRE_NO_THROW(c("a,b,c") = a("a,b,c").block({3, 3, 3}, {5, 5, 5}) +
+                                      b("a,b,c").block({3, 3, 3}, {5, 5, 5}));
+
+  // Check that the data of the arguments is not modified
+  for (std::size_t i = 0ul; i < a.size(); ++i) {
+    BOOST_CHECK_EQUAL(a.is_zero(i), a_ref.is_zero(i));
+    if (!a.is_zero(i)) {
+      auto tile = a.find(i).get();
+      auto ref_tile = a_ref.find(i).get();
+      BOOST_CHECK_EQUAL(tile.range(), ref_tile.range());
+      for (std::size_t j = 0ul; j < tile.size(); ++j)
+        BOOST_CHECK_EQUAL(tile[j], ref_tile[j]);
+    }
+    BOOST_CHECK_EQUAL(b.is_zero(i), b_ref.is_zero(i));
+    if (!b.is_zero(i)) {
+      auto tile = b.find(i).get();
+      auto ref_tile = b_ref.find(i).get();
+      BOOST_CHECK_EQUAL(tile.range(), ref_tile.range());
+      for (std::size_t j = 0ul; j < tile.size(); ++j)
+        BOOST_CHECK_EQUAL(tile[j], ref_tile[j]);
+    }
+  }
+
+  BlockRange block_range(a.trange().tiles_range(), {3, 3, 3}, {5, 5, 5});
+
+  for (std::size_t index = 0ul; index < block_range.volume(); ++index) {
+    const std::size_t arg_index = block_range.ordinal(index);
+    if (!a_ref.is_zero(arg_index) || !b_ref.is_zero(arg_index)) {
+      auto result_tile = c.find(index).get();
+      const auto arg_range = a.trange().make_tile_range(arg_index);
+
+      for (unsigned int r = 0u; r < arg_range.rank(); ++r) {
+        BOOST_CHECK_EQUAL(
+            result_tile.range().lobound(r),
+            arg_range.lobound(r) - a.trange().data()[r].tile(3).first);
+
+        BOOST_CHECK_EQUAL(
+            result_tile.range().upbound(r),
+            arg_range.upbound(r) - a.trange().data()[r].tile(3).first);
+      }
+
+      auto a_tile = a_ref.is_zero(arg_index) ? F::make_zero_tile(arg_range)
+                                             : a_ref.find(arg_index).get();
+      auto b_tile = b_ref.is_zero(arg_index) ? F::make_zero_tile(arg_range)
+                                             : b_ref.find(arg_index).get();
+      for (std::size_t j = 0ul; j < result_tile.range().volume(); ++j)
+        BOOST_CHECK_EQUAL(result_tile[j], a_tile[j] + b_tile[j]);
+    } else {
+      BOOST_CHECK(c.is_zero(index));
+    }
+  }
+}
+
 BOOST_FIXTURE_TEST_CASE_TEMPLATE(assign_sub_blockscal_block, F, Fixtures, F) {
   auto& a = F::a;
   auto& c = F::c;
@@ -1764,6 +1827,112 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE(cont_non_uniform2, F, Fixtures, F) {
   }
 }
 
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(cont_max_memory, F, Fixtures, F) {
+  // Construct the tiled range
+  std::array<std::size_t, 6> tiling1 = {{0, 1, 2, 3, 4, 5}};
+  std::array<std::size_t, 2> tiling2 = {{0, 40}};
+  TiledRange1 tr1_1(tiling1.begin(), tiling1.end());
+  TiledRange1 tr1_2(tiling2.begin(), tiling2.end());
+  std::array<TiledRange1, 4> tiling4 = {{tr1_1, tr1_2, tr1_1, tr1_1}};
+  TiledRange trange(tiling4.begin(), tiling4.end());
+
+  const std::size_t m = 5;
+  const std::size_t k = 40 * 5 * 5;
+  const std::size_t n = 5;
+
+  // Construct the test arguments
+  auto left = F::make_array(trange);
+  auto right = F::make_array(trange);
+
+  // Construct the reference matrices
+  typename F::Matrix left_ref(m, k);
+  typename F::Matrix right_ref(n, k);
+
+  // Initialize input
+  F::rand_fill_matrix_and_array(left_ref, left, 23);
+  F::rand_fill_matrix_and_array(right_ref, right, 42);
+
+  // Compute the reference result
+  typename F::Matrix result_ref = 5 * left_ref * right_ref.transpose();
+
+  // The memory budget holds the tiles of one SUMMA iteration, which is below
+  // the footprint of the default depth (at least 2). Each iteration holds one
+  // tile column of left and one tile row of right, i.e. 2 * m * 40 elements.
+  typedef typename TiledArray::detail::numeric_type<
+      typename F::TArray::value_type>::type numeric_type;
+  const std::size_t budget = 2ul * m * 40ul * sizeof(numeric_type);
+
+  // Compute the result to be tested with the memory budget
+  const bool logging = set_summa_depth_logging(true);
+  reset_summa_depth_statistics();
+  typename F::TArray result;
+  BOOST_REQUIRE_NO_THROW(result("x,y") =
+      (5 * left("x,i,j,k") * right("y,i,j,k")).set_max_memory(budget));
+  result.world().gop.fence();
+  set_summa_depth_logging(logging);
+
+  // Check that the depth was capped by the budget
+  const std::vector<SummaDepthStatistics> stats = summa_depth_statistics();
+  BOOST_CHECK_LE(stats.size(), 1ul);
+  const bool all_local_dense =
+      (result.world().size() == 1) && left.is_dense() && right.is_dense();
+  if(all_local_dense)
+    BOOST_CHECK_EQUAL(stats.size(), 1ul);
+  for(const SummaDepthStatistics& s : stats) {
+    BOOST_CHECK_LE(s.peak_resident_bytes, budget);
+    if(all_local_dense) {
+      // Every iteration holds a full tile column and row, so only one
+      // iteration fits in the budget
+      BOOST_CHECK_EQUAL(s.initial_depth, 1ul);
+      BOOST_CHECK_EQUAL(s.max_depth, 1ul);
+    }
+  }
+
+  // Check the result
+  for (auto it = result.begin(); it != result.end(); ++it) {
+    typename F::TArray::value_type tile = *it;
+    for (Range::const_iterator rit = tile.range().begin();
+         rit != tile.range().end(); ++rit) {
+      const std::size_t elem_index = result.elements_range().ordinal(*rit);
+      BOOST_CHECK_EQUAL(result_ref.array()(elem_index), tile[*rit]);
+    }
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(cont_chain, F, Fixtures, F) {
+  auto& a = F::a;
+  auto& b = F::b;
+  auto& c = F::c;
+
+  // a * (b * c) is cheaper than (a * b) * c for this chain, so it may be
+  // reordered
+  decltype(F::c) r, expected, expected_reordered;
+  BOOST_REQUIRE_NO_THROW(r("i,j,l") = a("i,j,k") * b("k,p,q") * c("p,q,l"));
+  BOOST_REQUIRE_NO_THROW(expected_reordered("i,j,l") =
+                             a("i,j,k") * (b("k,p,q") * c("p,q,l")));
+
+  // Evaluate the chain from left to right
+  const bool reorder = TiledArray::detail::set_reorder_contractions(false);
+  BOOST_REQUIRE_NO_THROW(expected("i,j,l") =
+                             a("i,j,k") * b("k,p,q") * c("p,q,l"));
+  TiledArray::detail::set_reorder_contractions(reorder);
+
+  for (std::size_t i = 0ul; i < r.size(); ++i) {
+    const auto range = r.trange().make_tile_range(i);
+    auto r_tile = r.is_zero(i) ? F::make_zero_tile(range) : r.find(i).get();
+    auto expected_tile = expected.is_zero(i) ? F::make_zero_tile(range)
+                                             : expected.find(i).get();
+    auto expected_reordered_tile =
+        expected_reordered.is_zero(i) ? F::make_zero_tile(range)
+                                      : expected_reordered.find(i).get();
+
+    for (std::size_t j = 0ul; j < r_tile.size(); ++j) {
+      BOOST_CHECK_EQUAL(r_tile[j], expected_tile[j]);
+      BOOST_CHECK_EQUAL(r_tile[j], expected_reordered_tile[j]);
+    }
+  }
+}
+
 BOOST_FIXTURE_TEST_CASE_TEMPLATE(cont_plus_reduce, F, Fixtures, F) {
   // Construct the tiled range
   std::array<std::size_t, 6> tiling1 = {{0, 1, 2, 3, 4, 5}};
@@ -1901,6 +2070,67 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE(outer_product, F, Fixtures, F) {
   BOOST_CHECK_EQUAL(ew, ew_test);
 }
 
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(hadamard_contract, F, Fixtures, F) {
+  auto& a = F::a;
+  auto& b = F::b;
+  decltype(F::c) c, d;
+
+  if (!TiledArray::detail::is_hadamard_contract_tile<
+          typename F::TArray::value_type>::value) {
+    BOOST_CHECK_THROW(c("i,j,l") = a("i,l,k") * b("j,l,k"),
+                      TiledArray::Exception);
+    return;
+  }
+
+  // Gather the elements of an array on all processes
+  auto gather = [](const typename F::TArray& array) {
+    const auto& elements = array.trange().elements_range();
+    std::vector<typename F::element_type> result(elements.volume(), 0);
+    for (auto it = array.begin(); it != array.end(); ++it) {
+      const typename F::TArray::value_type tile = *it;
+      for (auto&& i : tile.range()) result[elements.ordinal(i)] = tile[i];
+    }
+    GlobalFixture::world->gop.sum(result.data(), result.size());
+    return result;
+  };
+
+  BOOST_REQUIRE_NO_THROW(c("i,j,l") = a("i,l,k") * b("j,l,k"));
+  BOOST_REQUIRE_NO_THROW(d("l,i,j") = 2 * (a("i,l,k") * b("j,l,k")));
+
+  const std::vector<typename F::element_type> ea = gather(a);
+  const std::vector<typename F::element_type> eb = gather(b);
+  const auto& a_range = a.trange().elements_range();
+  const auto& b_range = b.trange().elements_range();
+  const std::size_t nk = a_range.extent(2);
+
+  // c(i,j,l) = sum_k a(i,l,k) b(j,l,k)
+  auto expected = [&](const std::size_t i, const std::size_t j,
+                      const std::size_t l) {
+    typename F::element_type result = 0;
+    for (std::size_t k = 0ul; k < nk; ++k)
+      result += ea[a_range.ordinal(i, l, k)] * eb[b_range.ordinal(j, l, k)];
+    return result;
+  };
+
+  for (auto it = c.begin(); it != c.end(); ++it) {
+    const typename F::TArray::value_type tile = *it;
+    for (auto&& i : tile.range())
+      BOOST_CHECK_EQUAL(tile[i], expected(i[0], i[1], i[2]));
+  }
+  for (std::size_t t = 0ul; t < c.size(); ++t) {
+    if (c.is_zero(t) && c.is_local(t)) {
+      for (auto&& i : c.trange().make_tile_range(t))
+        BOOST_CHECK_EQUAL(expected(i[0], i[1], i[2]), 0);
+    }
+  }
+
+  for (auto it = d.begin(); it != d.end(); ++it) {
+    const typename F::TArray::value_type tile = *it;
+    for (auto&& i : tile.range())
+      BOOST_CHECK_EQUAL(tile[i], 2 * expected(i[1], i[2], i[0]));
+  }
+}
+
 BOOST_FIXTURE_TEST_CASE_TEMPLATE(dot, F, Fixtures, F) {
   auto& a = F::a;
   auto& b = F::b;
@@ -1984,6 +2214,154 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE(dot_expr, F, Fixtures, F) {
   BOOST_CHECK_EQUAL(result, expected);
 }
 
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(dot_reproducible, F, Fixtures, F) {
+  auto& a = F::a;
+  auto& b = F::b;
+  const bool reproducible = math::set_reproducible_reduce(true);
+
+  // Check that repeated reductions give bitwise identical results
+  const typename F::element_type dot = a("a,b,c").dot(b("a,b,c")).get();
+  const auto norm = a("a,b,c").norm().get();
+  for (int i = 0; i != 10; ++i) {
+    BOOST_CHECK_EQUAL(a("a,b,c").dot(b("a,b,c")).get(), dot);
+    BOOST_CHECK_EQUAL(a("a,b,c").norm().get(), norm);
+  }
+
+  math::set_reproducible_reduce(reproducible);
+
+  // Check that the result agrees with the default reduction
+  BOOST_CHECK(std::abs(a("a,b,c").dot(b("a,b,c")).get() - dot) <=
+              1.0e-10 * std::abs(dot));
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(balanced_pmap, F, Fixtures, F) {
+  auto& a = F::a;
+  auto& b = F::b;
+  const bool balanced = TiledArray::detail::set_balanced_pmap(true);
+
+  // Check that a new result array is distributed by tile cost
+  decltype(F::c) c;
+  BOOST_REQUIRE_NO_THROW(c("a,b,c") = a("a,b,c") + b("a,b,c"));
+  BOOST_CHECK(std::dynamic_pointer_cast<TiledArray::detail::CostPmap>(c.pmap()));
+
+  TiledArray::detail::set_balanced_pmap(balanced);
+
+  for (std::size_t i = 0ul; i < c.size(); ++i) {
+    if (!c.is_zero(i)) {
+      auto c_tile = c.find(i).get();
+      auto a_tile =
+          a.is_zero(i) ? F::make_zero_tile(c_tile.range()) : a.find(i).get();
+      auto b_tile =
+          b.is_zero(i) ? F::make_zero_tile(c_tile.range()) : b.find(i).get();
+
+      for (std::size_t j = 0ul; j < c_tile.size(); ++j)
+        BOOST_CHECK_EQUAL(c_tile[j], a_tile[j] + b_tile[j]);
+    } else {
+      BOOST_CHECK(a.is_zero(i) && b.is_zero(i));
+    }
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(eval_block, F, Fixtures, F) {
+  auto& a = F::a;
+  auto& b = F::b;
+
+  decltype(F::c) t, r, u;
+  {
+    TiledArray::expressions::EvalBlock block;
+    t("a,b,c") = a("a,b,c") + b("a,b,c");
+    r("a,b,c") = 2 * t("a,b,c");
+    u("a,b,c") = a("c,b,a") - b("c,b,a");
+    block.temporary(t);
+
+    // Check that the assignments are evaluated by the block
+    BOOST_CHECK_EQUAL(block.size(), 3ul);
+    BOOST_CHECK(!r.is_initialized());
+    BOOST_CHECK(!u.is_initialized());
+  }
+
+  // Check that the intermediate has been released
+  BOOST_CHECK(!t.is_initialized());
+
+  for (std::size_t i = 0ul; i < r.size(); ++i) {
+    if (!r.is_zero(i)) {
+      auto r_tile = r.find(i).get();
+      auto a_tile =
+          a.is_zero(i) ? F::make_zero_tile(r_tile.range()) : a.find(i).get();
+      auto b_tile =
+          b.is_zero(i) ? F::make_zero_tile(r_tile.range()) : b.find(i).get();
+
+      for (std::size_t j = 0ul; j < r_tile.size(); ++j)
+        BOOST_CHECK_EQUAL(r_tile[j], 2 * (a_tile[j] + b_tile[j]));
+    } else {
+      BOOST_CHECK(a.is_zero(i) && b.is_zero(i));
+    }
+  }
+
+  decltype(F::c) v;
+  BOOST_REQUIRE_NO_THROW(v("a,b,c") = a("c,b,a") - b("c,b,a"));
+  for (std::size_t i = 0ul; i < u.size(); ++i) {
+    BOOST_CHECK_EQUAL(u.is_zero(i), v.is_zero(i));
+    if (!u.is_zero(i)) {
+      auto u_tile = u.find(i).get();
+      auto v_tile = v.find(i).get();
+      for (std::size_t j = 0ul; j < u_tile.size(); ++j)
+        BOOST_CHECK_EQUAL(u_tile[j], v_tile[j]);
+    }
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(eval_block_exception, F, Fixtures, F) {
+#ifndef NDEBUG
+  auto& a = F::a;
+  auto& b = F::b;
+
+  decltype(F::c) t, r;
+  TiledArray::expressions::EvalBlock block;
+  t("a,b,c") = a("a,b,c") + b("a,b,c");
+  r("a,b,c") = a("a,b,d");  // invalid target variable list
+  BOOST_CHECK_EQUAL(block.size(), 2ul);
+
+  // Check that the exception of the invalid assignment is thrown by wait(),
+  // and that the block is recording again
+  BOOST_CHECK_THROW(block.wait(), TiledArray::Exception);
+  BOOST_CHECK(block.collecting());
+  BOOST_CHECK_EQUAL(block.size(), 0ul);
+  BOOST_CHECK(!r.is_initialized());
+
+  // Check that the assignment that was started before the exception has
+  // been completed
+  BOOST_REQUIRE(t.is_initialized());
+  for (std::size_t i = 0ul; i < t.size(); ++i) {
+    if (!t.is_zero(i)) {
+      if (t.is_local(i)) BOOST_CHECK(t.find(i).probe());
+      auto t_tile = t.find(i).get();
+      auto a_tile =
+          a.is_zero(i) ? F::make_zero_tile(t_tile.range()) : a.find(i).get();
+      auto b_tile =
+          b.is_zero(i) ? F::make_zero_tile(t_tile.range()) : b.find(i).get();
+      for (std::size_t j = 0ul; j < t_tile.size(); ++j)
+        BOOST_CHECK_EQUAL(t_tile[j], a_tile[j] + b_tile[j]);
+    }
+  }
+
+  // Check that the block can be reused
+  r("a,b,c") = 2 * a("a,b,c");
+  BOOST_CHECK_EQUAL(block.size(), 1ul);
+  block.wait();
+  BOOST_CHECK(block.collecting());
+  for (std::size_t i = 0ul; i < r.size(); ++i) {
+    BOOST_CHECK_EQUAL(r.is_zero(i), a.is_zero(i));
+    if (!r.is_zero(i)) {
+      auto r_tile = r.find(i).get();
+      auto a_tile = a.find(i).get();
+      for (std::size_t j = 0ul; j < r_tile.size(); ++j)
+        BOOST_CHECK_EQUAL(r_tile[j], 2 * a_tile[j]);
+    }
+  }
+#endif  // NDEBUG
+}
+
 BOOST_FIXTURE_TEST_CASE_TEMPLATE(dot_contr, F, Fixtures, F) {
   auto& a = F::a;
   auto& b = F::b;
@@ -0,0 +1,104 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TiledArray/pmap/hadamard_pmap.h"
+#include "unit_test_config.h"
+#include "global_fixture.h"
+
+using namespace TiledArray;
+
+struct HadamardPmapFixture {
+
+  HadamardPmapFixture() { }
+
+};
+
+
+// =============================================================================
+// HadamardPmap Test Suite
+
+
+BOOST_FIXTURE_TEST_SUITE( hadamard_pmap_suite, HadamardPmapFixture )
+
+BOOST_AUTO_TEST_CASE( split )
+{
+  // Slabs are split only when there are fewer slabs than processes
+  BOOST_CHECK_EQUAL(detail::HadamardPmap::split(4ul, 8ul, 10ul), 1ul);
+  BOOST_CHECK_EQUAL(detail::HadamardPmap::split(4ul, 4ul, 10ul), 1ul);
+  BOOST_CHECK_EQUAL(detail::HadamardPmap::split(8ul, 3ul, 10ul), 2ul);
+  BOOST_CHECK_EQUAL(detail::HadamardPmap::split(8ul, 1ul, 10ul), 8ul);
+
+  // The split is bounded by the number of rows
+  BOOST_CHECK_EQUAL(detail::HadamardPmap::split(8ul, 1ul, 3ul), 3ul);
+  BOOST_CHECK_EQUAL(detail::HadamardPmap::split(8ul, 2ul, 1ul), 1ul);
+}
+
+BOOST_AUTO_TEST_CASE( owner )
+{
+  const std::size_t rank = GlobalFixture::world->rank();
+  const std::size_t size = GlobalFixture::world->size();
+
+  std::vector<ProcessID> p_owner(size);
+
+  // Check various pmap sizes
+  for(std::size_t h = 1ul; h < 6ul; ++h) {
+    for(std::size_t m = 1ul; m < 4ul; ++m) {
+      detail::HadamardPmap pmap(* GlobalFixture::world, h, m, 3ul);
+      BOOST_CHECK_EQUAL(pmap.size(), h * m * 3ul);
+      BOOST_CHECK_EQUAL(pmap.slab_procs(), std::min(h, size));
+      BOOST_CHECK_EQUAL(pmap.split(), detail::HadamardPmap::split(size, h, m));
+
+      for(std::size_t tile = 0; tile < pmap.size(); ++tile) {
+        // Check that the rows of a slab are split among its processes
+        const std::size_t row = tile / 3ul;
+        BOOST_CHECK_EQUAL(pmap.owner(tile), ((row / m) % pmap.slab_procs()) +
+            pmap.slab_procs() * ((row % m) % pmap.split()));
+
+        std::fill(p_owner.begin(), p_owner.end(), 0);
+        p_owner[rank] = pmap.owner(tile);
+        BOOST_CHECK_LT(p_owner[rank], size);
+        GlobalFixture::world->gop.sum(p_owner.data(), size);
+
+        // Make sure everyone agrees on who owns what.
+        for(std::size_t p = 0ul; p < size; ++p)
+          BOOST_CHECK_EQUAL(p_owner[p], p_owner[rank]);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( local_group )
+{
+  for(std::size_t h = 1ul; h < 6ul; ++h) {
+    for(std::size_t m = 1ul; m < 4ul; ++m) {
+      detail::HadamardPmap pmap(* GlobalFixture::world, h, m, 3ul);
+
+      // Check that all local elements map to this rank
+      for(detail::HadamardPmap::const_iterator it = pmap.begin(); it != pmap.end(); ++it)
+        BOOST_CHECK_EQUAL(pmap.owner(*it), GlobalFixture::world->rank());
+
+      // Check that every tile is local to exactly one process
+      std::size_t total_size = pmap.local_size();
+      GlobalFixture::world->gop.sum(total_size);
+      BOOST_CHECK_EQUAL(total_size, pmap.size());
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
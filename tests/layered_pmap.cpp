@@ -0,0 +1,144 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TiledArray/pmap/layered_pmap.h"
+#include "unit_test_config.h"
+#include "global_fixture.h"
+
+using namespace TiledArray;
+
+struct LayeredPmapFixture {
+
+  LayeredPmapFixture() { }
+
+  /// Compute the number of process rows and columns of a layer
+  static std::pair<std::size_t, std::size_t>
+  proc_dims(const std::size_t x, const std::size_t y, const std::size_t layers) {
+    const std::size_t procs = GlobalFixture::world->size() / layers;
+    const std::size_t p_rows = std::max<std::size_t>(1ul,
+        std::min<std::size_t>(std::sqrt(procs), x));
+    return std::make_pair(p_rows, std::max<std::size_t>(1ul, procs / p_rows));
+  }
+
+};
+
+
+// =============================================================================
+// LayeredPmap Test Suite
+
+
+BOOST_FIXTURE_TEST_SUITE( layered_pmap_suite, LayeredPmapFixture )
+
+BOOST_AUTO_TEST_CASE( layer_partition )
+{
+  for(std::size_t extent = 1ul; extent < 20ul; ++extent) {
+    for(std::size_t layers = 1ul; layers <= extent; ++layers) {
+      // Check that the layers are contiguous and cover the layer dimension
+      BOOST_CHECK_EQUAL(detail::LayeredPmap::layer_begin(0ul, layers, extent), 0ul);
+      BOOST_CHECK_EQUAL(detail::LayeredPmap::layer_begin(layers, layers, extent), extent);
+      for(std::size_t layer = 0ul; layer < layers; ++layer) {
+        const std::size_t begin = detail::LayeredPmap::layer_begin(layer, layers, extent);
+        const std::size_t end = detail::LayeredPmap::layer_begin(layer + 1ul, layers, extent);
+        BOOST_CHECK_LT(begin, end);
+        for(std::size_t i = begin; i < end; ++i)
+          BOOST_CHECK_EQUAL(detail::LayeredPmap::layer(i, layers, extent), layer);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( owner )
+{
+  const std::size_t rank = GlobalFixture::world->rank();
+  const std::size_t size = GlobalFixture::world->size();
+
+  ProcessID* p_owner = new ProcessID[size];
+
+  // Check various pmap sizes
+  for(std::size_t x = 1ul; x < 10ul; ++x) {
+    for(std::size_t y = 1ul; y < 10ul; ++y) {
+      const std::size_t layers = std::min<std::size_t>(size, y);
+      const std::pair<std::size_t, std::size_t> dims = proc_dims(x, y, layers);
+
+      const std::size_t tiles = x * y;
+      detail::LayeredPmap pmap(* GlobalFixture::world, x, y, dims.first,
+          dims.second, layers, true);
+
+      for(std::size_t tile = 0; tile < tiles; ++tile) {
+        std::fill_n(p_owner, size, 0);
+        p_owner[rank] = pmap.owner(tile);
+        // check that the value is in range
+        BOOST_CHECK_LT(p_owner[rank], size);
+        GlobalFixture::world->gop.sum(p_owner, size);
+
+        // Make sure everyone agrees on who owns what.
+        for(std::size_t p = 0ul; p < size; ++p)
+          BOOST_CHECK_EQUAL(p_owner[p], p_owner[rank]);
+
+        // Check that the tile belongs to the layer of its column
+        const std::size_t layer =
+            detail::LayeredPmap::layer(tile % y, layers, y);
+        BOOST_CHECK_EQUAL(pmap.owner(tile) / (dims.first * dims.second), layer);
+      }
+    }
+  }
+
+  delete [] p_owner;
+}
+
+BOOST_AUTO_TEST_CASE( local_group )
+{
+  ProcessID tile_owners[100];
+
+  for(std::size_t x = 1ul; x < 10ul; ++x) {
+    for(std::size_t y = 1ul; y < 10ul; ++y) {
+      const std::size_t layers =
+          std::min<std::size_t>(GlobalFixture::world->size(), x);
+      const std::pair<std::size_t, std::size_t> dims = proc_dims(x, y, layers);
+
+      const std::size_t tiles = x * y;
+      detail::LayeredPmap pmap(* GlobalFixture::world, x, y, dims.first,
+          dims.second, layers, false);
+
+      // Check that the total number of local tiles is equal to the number of
+      // tiles in the map
+      std::size_t total_size = pmap.local_size();
+      GlobalFixture::world->gop.sum(total_size);
+      BOOST_CHECK_EQUAL(total_size, tiles);
+      BOOST_CHECK(pmap.empty() == (pmap.local_size() == 0ul));
+
+      // Check that all local elements map to this rank
+      for(detail::LayeredPmap::const_iterator it = pmap.begin(); it != pmap.end(); ++it) {
+        BOOST_CHECK_EQUAL(pmap.owner(*it), GlobalFixture::world->rank());
+      }
+
+      std::fill_n(tile_owners, tiles, 0);
+      for(detail::LayeredPmap::const_iterator it = pmap.begin(); it != pmap.end(); ++it) {
+        tile_owners[*it] += GlobalFixture::world->rank();
+      }
+
+      GlobalFixture::world->gop.sum(tile_owners, tiles);
+      for(std::size_t tile = 0; tile < tiles; ++tile) {
+        BOOST_CHECK_EQUAL(tile_owners[tile], pmap.owner(tile));
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,151 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TiledArray/math/fixed_kernels.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct FixedKernelsFixture {
+
+  // The kernels are tested with an explicit extent list, so the tests do
+  // not depend on the configured registry.
+  typedef math::FixedExtentDispatch<math::FixedExtents<2, 3, 4> > dispatch_type;
+
+  FixedKernelsFixture() { }
+
+  ~FixedKernelsFixture() { }
+
+  template <std::size_t N>
+  using extent = std::integral_constant<std::size_t, N>;
+
+}; // FixedKernelsFixture
+
+BOOST_FIXTURE_TEST_SUITE( fixed_kernels_suite, FixedKernelsFixture )
+
+BOOST_AUTO_TEST_CASE( dispatch )
+{
+  BOOST_CHECK(dispatch_type::contains(3ul));
+  BOOST_CHECK(! dispatch_type::contains(5ul));
+
+  int a[12], b[12];
+  for(int i = 0; i < 12; ++i) {
+    a[i] = i;
+    b[i] = 2 * i;
+  }
+  auto op = [] (int& r, const int arg) { r += arg; };
+
+  // Check that the kernel is called for a listed extent
+  BOOST_CHECK(dispatch_type::call(4ul, math::FixedInplaceVectorOp(), op,
+      std::size_t(12), a, b));
+  for(int i = 0; i < 12; ++i)
+    BOOST_CHECK_EQUAL(a[i], 3 * i);
+
+  // Check that nothing is done for other extents
+  BOOST_CHECK(! dispatch_type::call(6ul, math::FixedInplaceVectorOp(), op,
+      std::size_t(12), a, b));
+  for(int i = 0; i < 12; ++i)
+    BOOST_CHECK_EQUAL(a[i], 3 * i);
+}
+
+BOOST_AUTO_TEST_CASE( reduce )
+{
+  int a[12];
+  for(int i = 0; i < 12; ++i)
+    a[i] = i;
+
+  int sum = 1;
+  auto op = [] (int& r, const int arg) { r += arg; };
+  math::FixedReduceOp()(extent<3>(), op, std::size_t(12), sum, a);
+  BOOST_CHECK_EQUAL(sum, 67);
+}
+
+BOOST_AUTO_TEST_CASE( transpose )
+{
+  int a[12], b[12];
+  for(int i = 0; i < 12; ++i)
+    a[i] = i;
+
+  const auto no_op = [] (const int& a) -> const int& { return a; };
+  const auto copy_op = [] (int* b, const int a) { *b = a; };
+
+  // Transpose a 3x4 matrix
+  math::FixedTranspose()(extent<4>(), extent<3>(), no_op, copy_op,
+      std::size_t(3), b, std::size_t(4), a);
+  for(std::size_t i = 0ul; i < 3ul; ++i)
+    for(std::size_t j = 0ul; j < 4ul; ++j)
+      BOOST_CHECK_EQUAL(b[j * 3 + i], a[i * 4 + j]);
+}
+
+BOOST_AUTO_TEST_CASE( gemm )
+{
+  const integer m = 3, n = 2, k = 4;
+  double a[m * k], b[k * n], c[m * n], ref[m * n];
+  for(integer i = 0; i < m * k; ++i)
+    a[i] = GlobalFixture::world->rand() % 11;
+  for(integer i = 0; i < k * n; ++i)
+    b[i] = GlobalFixture::world->rand() % 11;
+
+  const madness::cblas::CBLAS_TRANSPOSE ops[2] =
+      { madness::cblas::NoTrans, madness::cblas::Trans };
+
+  for(madness::cblas::CBLAS_TRANSPOSE op_a : ops) {
+    for(madness::cblas::CBLAS_TRANSPOSE op_b : ops) {
+      for(const double beta : { 0.0, 1.0, 2.0 }) {
+        for(integer i = 0; i < m * n; ++i)
+          c[i] = ref[i] = double(i);
+
+        math::FixedGemm()(extent<k>(), extent<n>(), extent<m>(), op_a, op_b,
+            3.0, a, b, beta, c);
+        math::gemm(op_a, op_b, m, n, k, 3.0, a,
+            (op_a == madness::cblas::NoTrans ? k : m), b,
+            (op_b == madness::cblas::NoTrans ? n : k), beta, ref, n);
+
+        for(integer i = 0; i < m * n; ++i)
+          BOOST_CHECK_CLOSE(c[i], ref[i], 1.0e-12);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( tensor )
+{
+  // Check that tensor operations give the same result with or without
+  // specialized kernels for the extents of the tensor
+  TensorD t(Range(std::vector<std::size_t>{4, 4}));
+  TensorD s(t.range());
+  for(std::size_t i = 0ul; i < t.size(); ++i) {
+    t[i] = double(i);
+    s[i] = 2.0 * double(i);
+  }
+
+  TensorD r = t.add(s);
+  for(std::size_t i = 0ul; i < r.size(); ++i)
+    BOOST_CHECK_EQUAL(r[i], 3.0 * double(i));
+
+  BOOST_CHECK_EQUAL(t.sum(), 120.0);
+
+  TensorD p = t.permute(Permutation({1,0}));
+  for(std::size_t i = 0ul; i < 4ul; ++i)
+    for(std::size_t j = 0ul; j < 4ul; ++j)
+      BOOST_CHECK_EQUAL(p[j * 4ul + i], t[i * 4ul + j]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,110 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TiledArray/math/parallel_gemm.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+struct ParallelGemmFixture {
+
+  ParallelGemmFixture() :
+    m(197), n(263), k(131)
+  { }
+
+  ~ParallelGemmFixture() { }
+
+  template <typename T>
+  static std::vector<T> make_matrix(const std::size_t size, const int seed) {
+    GlobalFixture::world->srand(seed);
+    std::vector<T> result(size);
+    for(auto& x : result)
+      x = GlobalFixture::world->rand() % 11;
+    return result;
+  }
+
+  /// Test a parallel GEMM against a reference product
+
+  /// \param op_a The operation applied to the left-hand matrix
+  /// \param op_b The operation applied to the right-hand matrix
+  /// \param threads The number of threads, or 0 to select it at runtime
+  template <typename T>
+  void test(const madness::cblas::CBLAS_TRANSPOSE op_a,
+      const madness::cblas::CBLAS_TRANSPOSE op_b, const integer threads) const
+  {
+    // Use leading dimensions that are larger than the matrices
+    const integer lda = (op_a == madness::cblas::NoTrans ? k : m) + 3;
+    const integer ldb = (op_b == madness::cblas::NoTrans ? n : k) + 5;
+    const integer ldc = n + 7;
+    const std::vector<T> a = make_matrix<T>(lda * (op_a == madness::cblas::NoTrans ? m : k), 17);
+    const std::vector<T> b = make_matrix<T>(ldb * (op_b == madness::cblas::NoTrans ? k : n), 31);
+    std::vector<T> c = make_matrix<T>(ldc * m, 43);
+    const std::vector<T> c0 = c;
+
+    if(threads)
+      TiledArray::math::parallel_gemm(threads, op_a, op_b, m, n, k, T(3),
+          a.data(), lda, b.data(), ldb, T(2), c.data(), ldc);
+    else
+      TiledArray::math::parallel_gemm(op_a, op_b, m, n, k, T(3),
+          a.data(), lda, b.data(), ldb, T(2), c.data(), ldc);
+
+    std::size_t mismatches = 0ul;
+    for(integer i = 0; i < m; ++i) {
+      for(integer j = 0; j < n; ++j) {
+        T expected = T(0);
+        for(integer x = 0; x < k; ++x)
+          expected += (op_a == madness::cblas::NoTrans ? a[i * lda + x] : a[x * lda + i]) *
+              (op_b == madness::cblas::NoTrans ? b[x * ldb + j] : b[j * ldb + x]);
+        expected = T(3) * expected + T(2) * c0[i * ldc + j];
+        if(std::abs(double(c[i * ldc + j]) - double(expected)) > 1.0e-8 * std::abs(double(expected)))
+          ++mismatches;
+      }
+    }
+    BOOST_CHECK_EQUAL(mismatches, 0ul);
+  }
+
+  integer m, n, k;
+
+}; // ParallelGemmFixture
+
+BOOST_FIXTURE_TEST_SUITE( parallel_gemm_suite, ParallelGemmFixture )
+
+// int is evaluated with Eigen, double with BLAS
+typedef boost::mpl::list<int, double> gemm_types;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( threaded_gemm, T, gemm_types )
+{
+  for(integer threads : {1, 2, 4, 7}) {
+    test<T>(madness::cblas::NoTrans, madness::cblas::NoTrans, threads);
+    test<T>(madness::cblas::NoTrans, madness::cblas::Trans, threads);
+    test<T>(madness::cblas::Trans, madness::cblas::NoTrans, threads);
+    test<T>(madness::cblas::Trans, madness::cblas::Trans, threads);
+  }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( runtime_threads, T, gemm_types )
+{
+  const integer threads = TiledArray::math::parallel_gemm_threads(m, n, k);
+  BOOST_CHECK_GE(threads, 1);
+  BOOST_CHECK_LE(threads, integer(madness::ThreadPool::size()) + 1);
+  BOOST_CHECK_EQUAL(TiledArray::math::parallel_gemm_threads(8, 8, 8), 1);
+
+  test<T>(madness::cblas::NoTrans, madness::cblas::NoTrans, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,164 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TiledArray/math/simd.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct SimdFixture {
+
+  SimdFixture() { }
+
+  ~SimdFixture() { }
+
+  // Sizes that cover empty vectors, partial packs, and the unwound loops
+  // of all instruction sets
+  static const std::array<std::size_t, 10> sizes;
+
+  template <typename T>
+  static std::vector<T> random_vector(const std::size_t n) {
+    std::vector<T> result(n);
+    for(std::size_t i = 0ul; i < n; ++i)
+      result[i] = T(GlobalFixture::world->rand() % 101 - 50) / T(8);
+    return result;
+  }
+
+  template <typename T>
+  void check_kernels() {
+    for(const std::size_t n : sizes) {
+      const std::vector<T> x = random_vector<T>(n);
+      const std::vector<T> y = random_vector<T>(n);
+
+      T sum = 0, dot = 0, squared_norm = 0, abs_max = 0;
+      T abs_min = std::numeric_limits<T>::max();
+      for(std::size_t i = 0ul; i < n; ++i) {
+        sum += x[i];
+        dot += x[i] * y[i];
+        squared_norm += x[i] * x[i];
+        abs_max = std::max(abs_max, std::abs(x[i]));
+        abs_min = std::min(abs_min, std::abs(x[i]));
+      }
+
+      // The elements are multiples of 1/8, so the reductions are exact
+      BOOST_CHECK_EQUAL(math::simd::sum(n, x.data()), sum);
+      BOOST_CHECK_EQUAL(math::simd::dot(n, x.data(), y.data()), dot);
+      BOOST_CHECK_EQUAL(math::simd::squared_norm(n, x.data()), squared_norm);
+      BOOST_CHECK_EQUAL(math::simd::abs_max(n, x.data()), abs_max);
+      BOOST_CHECK_EQUAL(math::simd::abs_min(n, x.data()), abs_min);
+
+      std::vector<T> z = y;
+      math::simd::add_to(n, x.data(), z.data());
+      for(std::size_t i = 0ul; i < n; ++i)
+        BOOST_CHECK_EQUAL(z[i], y[i] + x[i]);
+
+      z = y;
+      math::simd::axpy(n, T(-2), x.data(), z.data());
+      for(std::size_t i = 0ul; i < n; ++i)
+        BOOST_CHECK_EQUAL(z[i], y[i] - T(2) * x[i]);
+
+      z = y;
+      math::simd::scale_to(n, T(4), z.data());
+      for(std::size_t i = 0ul; i < n; ++i)
+        BOOST_CHECK_EQUAL(z[i], y[i] * T(4));
+    }
+  }
+
+}; // SimdFixture
+
+const std::array<std::size_t, 10> SimdFixture::sizes =
+    {{ 0ul, 1ul, 3ul, 8ul, 15ul, 16ul, 63ul, 64ul, 65ul, 1001ul }};
+
+BOOST_FIXTURE_TEST_SUITE( simd_suite, SimdFixture )
+
+BOOST_AUTO_TEST_CASE( kernels_double )
+{
+  check_kernels<double>();
+}
+
+BOOST_AUTO_TEST_CASE( kernels_float )
+{
+  check_kernels<float>();
+}
+
+BOOST_AUTO_TEST_CASE( kernels_complex )
+{
+  const std::size_t n = 37ul;
+  std::vector<std::complex<double> > x(n), y(n);
+  double squared_norm = 0.0;
+  for(std::size_t i = 0ul; i < n; ++i) {
+    x[i] = std::complex<double>(double(i), -0.5 * double(i));
+    y[i] = std::complex<double>(1.0, double(i));
+    squared_norm += std::norm(x[i]);
+  }
+
+  BOOST_CHECK_EQUAL(math::simd::squared_norm(n, x.data()), squared_norm);
+
+  // Check the real factors are applied to both parts
+  std::vector<std::complex<double> > z = y;
+  math::simd::axpy(n, 2.0, x.data(), z.data());
+  math::simd::scale_to(n, 0.5, z.data());
+  for(std::size_t i = 0ul; i < n; ++i)
+    BOOST_CHECK_EQUAL(z[i], (y[i] + 2.0 * x[i]) * 0.5);
+}
+
+BOOST_AUTO_TEST_CASE( tensor )
+{
+  // Check that the tensor operations that use the vector kernels give the
+  // same result as the element-wise definition
+  TensorD t(Range(std::vector<std::size_t>{7, 11}));
+  TensorD s(t.range());
+  for(std::size_t i = 0ul; i < t.size(); ++i) {
+    t[i] = double(i) - 20.0;
+    s[i] = 0.5 * double(i);
+  }
+
+  TensorD r = t.clone();
+  r.add_to(s);
+  for(std::size_t i = 0ul; i < r.size(); ++i)
+    BOOST_CHECK_EQUAL(r[i], t[i] + s[i]);
+
+  r.subt_to(s);
+  for(std::size_t i = 0ul; i < r.size(); ++i)
+    BOOST_CHECK_EQUAL(r[i], t[i]);
+
+  r.scale_to(3);
+  for(std::size_t i = 0ul; i < r.size(); ++i)
+    BOOST_CHECK_EQUAL(r[i], 3.0 * t[i]);
+
+  double sum = 0.0, dot = 0.0, squared_norm = 0.0;
+  for(std::size_t i = 0ul; i < t.size(); ++i) {
+    sum += t[i];
+    dot += t[i] * s[i];
+    squared_norm += t[i] * t[i];
+  }
+  BOOST_CHECK_EQUAL(t.sum(), sum);
+  BOOST_CHECK_EQUAL(t.dot(s), dot);
+  BOOST_CHECK_EQUAL(t.squared_norm(), squared_norm);
+  BOOST_CHECK_EQUAL(t.abs_max(), 56.0);
+  BOOST_CHECK_EQUAL(t.abs_min(), 0.0);
+
+  TensorZ z(t.range());
+  for(std::size_t i = 0ul; i < z.size(); ++i)
+    z[i] = std::complex<double>(t[i], s[i]);
+  BOOST_CHECK_EQUAL(z.squared_norm(), squared_norm + s.squared_norm());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,188 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TiledArray/pmap/node_pmap.h"
+#include "unit_test_config.h"
+#include "global_fixture.h"
+
+using namespace TiledArray;
+
+struct NodePmapFixture {
+
+  NodePmapFixture() { }
+
+  /// A grid slot table that reverses the rank order
+  static std::shared_ptr<const std::vector<ProcessID> >
+  reversed_ranks(const std::size_t slots) {
+    auto result = std::make_shared<std::vector<ProcessID> >(slots);
+    for(std::size_t slot = 0ul; slot < slots; ++slot)
+      (*result)[slot] = slots - slot - 1ul;
+    return result;
+  }
+
+};
+
+
+// =============================================================================
+// NodePmap Test Suite
+
+
+BOOST_FIXTURE_TEST_SUITE( node_pmap_suite, NodePmapFixture )
+
+BOOST_AUTO_TEST_CASE( topology )
+{
+  // Ten processes placed round-robin on three nodes
+  std::vector<std::size_t> labels(10);
+  for(std::size_t p = 0ul; p < labels.size(); ++p)
+    labels[p] = 7ul * (p % 3ul);
+  const detail::NodeTopology topology(labels);
+
+  BOOST_CHECK_EQUAL(topology.size(), 10ul);
+  BOOST_CHECK_EQUAL(topology.nodes(), 3ul);
+  BOOST_CHECK_EQUAL(topology.node_size(0ul), 4ul);
+  BOOST_CHECK_EQUAL(topology.node_size(1ul), 3ul);
+  BOOST_CHECK_EQUAL(topology.node_size(2ul), 3ul);
+  BOOST_CHECK_EQUAL(topology.uniform_node_size(), 0ul);
+  for(ProcessID p = 0; p < 10; ++p)
+    BOOST_CHECK_EQUAL(topology.node(p), std::size_t(p % 3));
+
+  const std::vector<ProcessID> ranks = {0, 3, 6, 9, 1, 4, 7, 2, 5, 8};
+  BOOST_CHECK_EQUAL_COLLECTIONS(topology.ranks().begin(),
+      topology.ranks().end(), ranks.begin(), ranks.end());
+
+  // A 3x3 grid filled by rows or by columns
+  const std::vector<ProcessID> row_major = topology.grid_ranks(3, 3, 1, false);
+  const std::vector<ProcessID> col_major = topology.grid_ranks(3, 3, 1, true);
+  BOOST_CHECK_EQUAL_COLLECTIONS(row_major.begin(), row_major.end(),
+      ranks.begin(), ranks.begin() + 9);
+  const std::vector<ProcessID> col_ranks = {0, 9, 7, 3, 1, 2, 6, 4, 5};
+  BOOST_CHECK_EQUAL_COLLECTIONS(col_major.begin(), col_major.end(),
+      col_ranks.begin(), col_ranks.end());
+
+  // Only the first row {0,3,6} is inside a node for the row-major layout,
+  // and the first column {0,3,6} for the column-major layout
+  BOOST_CHECK_EQUAL(topology.intra_node_links(row_major, 3, 3), 2ul);
+  BOOST_CHECK_EQUAL(topology.intra_node_links(col_major, 3, 3), 2ul);
+}
+
+BOOST_AUTO_TEST_CASE( discover )
+{
+  const detail::NodeTopology topology(* GlobalFixture::world);
+  const std::size_t size = GlobalFixture::world->size();
+
+  BOOST_CHECK_EQUAL(topology.size(), size);
+  BOOST_CHECK_GE(topology.nodes(), 1ul);
+  BOOST_CHECK_LE(topology.nodes(), size);
+
+  // Check that the node-major process list contains every process once
+  std::vector<ProcessID> ranks = topology.ranks();
+  std::sort(ranks.begin(), ranks.end());
+  for(std::size_t p = 0ul; p < size; ++p)
+    BOOST_CHECK_EQUAL(ranks[p], ProcessID(p));
+
+  // Check that the cached topology matches
+  BOOST_CHECK_EQUAL(detail::NodeTopology::get(* GlobalFixture::world)->nodes(),
+      topology.nodes());
+}
+
+BOOST_AUTO_TEST_CASE( owner )
+{
+  const std::size_t rank = GlobalFixture::world->rank();
+  const std::size_t size = GlobalFixture::world->size();
+
+  ProcessID* p_owner = new ProcessID[size];
+
+  // Check various pmap sizes
+  for(std::size_t x = 1ul; x < 10ul; ++x) {
+    for(std::size_t y = 1ul; y < 10ul; ++y) {
+      const std::size_t layers = std::min<std::size_t>(size, y);
+      const std::size_t p_rows = std::max<std::size_t>(1ul,
+          std::min<std::size_t>(std::sqrt(size / layers), x));
+      const std::size_t p_cols = std::max<std::size_t>(1ul, size / layers / p_rows);
+      const auto ranks = reversed_ranks(p_rows * p_cols * layers);
+
+      const std::size_t tiles = x * y;
+      detail::NodePmap pmap(* GlobalFixture::world, x, y, p_rows, p_cols,
+          layers, true, ranks);
+
+      for(std::size_t tile = 0; tile < tiles; ++tile) {
+        std::fill_n(p_owner, size, 0);
+        p_owner[rank] = pmap.owner(tile);
+        // check that the value is in range
+        BOOST_CHECK_LT(p_owner[rank], size);
+        GlobalFixture::world->gop.sum(p_owner, size);
+
+        // Make sure everyone agrees on who owns what.
+        for(std::size_t p = 0ul; p < size; ++p)
+          BOOST_CHECK_EQUAL(p_owner[p], p_owner[rank]);
+
+        // Check that the tile belongs to the grid slot of its layer
+        const std::size_t row = tile / y, col = tile % y;
+        const std::size_t slot = (detail::LayeredPmap::layer(col, layers, y)
+            * p_rows + row % p_rows) * p_cols + col % p_cols;
+        BOOST_CHECK_EQUAL(pmap.owner(tile), std::size_t((*ranks)[slot]));
+      }
+    }
+  }
+
+  delete [] p_owner;
+}
+
+BOOST_AUTO_TEST_CASE( local_group )
+{
+  ProcessID tile_owners[100];
+
+  for(std::size_t x = 1ul; x < 10ul; ++x) {
+    for(std::size_t y = 1ul; y < 10ul; ++y) {
+      const std::size_t size = GlobalFixture::world->size();
+      const std::size_t layers = std::min<std::size_t>(size, x);
+      const std::size_t p_rows = std::max<std::size_t>(1ul,
+          std::min<std::size_t>(std::sqrt(size / layers), x));
+      const std::size_t p_cols = std::max<std::size_t>(1ul, size / layers / p_rows);
+
+      const std::size_t tiles = x * y;
+      detail::NodePmap pmap(* GlobalFixture::world, x, y, p_rows, p_cols,
+          layers, false, reversed_ranks(p_rows * p_cols * layers));
+
+      // Check that the total number of local tiles is equal to the number of
+      // tiles in the map
+      std::size_t total_size = pmap.local_size();
+      GlobalFixture::world->gop.sum(total_size);
+      BOOST_CHECK_EQUAL(total_size, tiles);
+      BOOST_CHECK(pmap.empty() == (pmap.local_size() == 0ul));
+
+      // Check that all local elements map to this rank
+      for(detail::NodePmap::const_iterator it = pmap.begin(); it != pmap.end(); ++it) {
+        BOOST_CHECK_EQUAL(pmap.owner(*it), GlobalFixture::world->rank());
+      }
+
+      std::fill_n(tile_owners, tiles, 0);
+      for(detail::NodePmap::const_iterator it = pmap.begin(); it != pmap.end(); ++it) {
+        tile_owners[*it] += GlobalFixture::world->rank();
+      }
+
+      GlobalFixture::world->gop.sum(tile_owners, tiles);
+      for(std::size_t tile = 0; tile < tiles; ++tile) {
+        BOOST_CHECK_EQUAL(tile_owners[tile], pmap.owner(tile));
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,142 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TiledArray/pool_allocator.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+using TiledArray::detail::MemoryPool;
+
+struct PoolAllocatorFixture {
+
+  PoolAllocatorFixture() { }
+
+  ~PoolAllocatorFixture() { }
+
+}; // PoolAllocatorFixture
+
+BOOST_FIXTURE_TEST_SUITE( pool_allocator_suite, PoolAllocatorFixture )
+
+BOOST_AUTO_TEST_CASE( size_class )
+{
+  // Check that each request fits into the smallest class that holds it
+  for(std::size_t bytes = 1ul; bytes <= (1ul << 16); ++bytes) {
+    const unsigned int c = MemoryPool::size_class(bytes);
+    BOOST_CHECK_GE(MemoryPool::class_size(c), bytes);
+    if(c > 0u)
+      BOOST_CHECK_LT(MemoryPool::class_size(c - 1u), bytes);
+  }
+
+  BOOST_CHECK_EQUAL(MemoryPool::class_size(MemoryPool::size_class(
+      MemoryPool::max_block_size)), MemoryPool::max_block_size);
+}
+
+BOOST_AUTO_TEST_CASE( allocate )
+{
+  PoolAllocator<double> alloc;
+  const PoolAllocatorStatistics initial = pool_allocator_statistics();
+
+  // Check alignment
+  double* p = alloc.allocate(1000ul);
+  BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(p) % MemoryPool::alignment, 0ul);
+
+  // Check the memory accounting
+  const std::size_t block_size =
+      MemoryPool::class_size(MemoryPool::size_class(1000ul * sizeof(double)));
+  PoolAllocatorStatistics stats = pool_allocator_statistics();
+  BOOST_CHECK_EQUAL(stats.bytes_in_use, initial.bytes_in_use + block_size);
+  BOOST_CHECK_GE(stats.high_water_mark, stats.bytes_in_use);
+  BOOST_CHECK_EQUAL(stats.allocations, initial.allocations + 1ul);
+
+  std::fill_n(p, 1000ul, 1.0);
+  alloc.deallocate(p, 1000ul);
+  BOOST_CHECK_EQUAL(pool_allocator_statistics().bytes_in_use, initial.bytes_in_use);
+
+  // Check that a block of the same size class is reused
+  double* q = alloc.allocate(990ul);
+  BOOST_CHECK_EQUAL(q, p);
+  stats = pool_allocator_statistics();
+  BOOST_CHECK_EQUAL(stats.pool_hits, initial.pool_hits + 1ul);
+  alloc.deallocate(q, 990ul);
+
+  // Check zero size allocation
+  BOOST_CHECK(alloc.allocate(0ul) == nullptr);
+  BOOST_CHECK_NO_THROW(alloc.deallocate(nullptr, 0ul));
+}
+
+BOOST_AUTO_TEST_CASE( high_water_mark )
+{
+  PoolAllocator<float> alloc;
+  reset_pool_allocator_statistics();
+  const std::size_t in_use = pool_allocator_statistics().bytes_in_use;
+
+  std::vector<float*> blocks;
+  std::size_t bytes = 0ul;
+  for(std::size_t n = 1ul; n < 4096ul; n <<= 1) {
+    blocks.push_back(alloc.allocate(n));
+    bytes += MemoryPool::class_size(MemoryPool::size_class(n * sizeof(float)));
+  }
+  std::size_t n = 1ul;
+  for(float* block : blocks) {
+    alloc.deallocate(block, n);
+    n <<= 1;
+  }
+
+  const PoolAllocatorStatistics stats = pool_allocator_statistics();
+  BOOST_CHECK_EQUAL(stats.bytes_in_use, in_use);
+  BOOST_CHECK_GE(stats.high_water_mark, in_use + bytes);
+}
+
+BOOST_AUTO_TEST_CASE( tensor )
+{
+  typedef Tensor<double, PoolAllocator<double> > tensor_type;
+
+  tensor_type t(Range(std::vector<std::size_t>{7, 11, 13}), 2.0);
+  tensor_type s(t.range());
+  for(std::size_t i = 0ul; i < s.size(); ++i)
+    s[i] = double(i);
+
+  // Check tensor operations on pooled tensors
+  tensor_type r = t.add(s);
+  for(std::size_t i = 0ul; i < r.size(); ++i)
+    BOOST_CHECK_EQUAL(r[i], 2.0 + double(i));
+
+  tensor_type p = s.permute(Permutation({2,1,0}));
+  BOOST_CHECK_EQUAL(p.range().extent(0), 13ul);
+  BOOST_CHECK_EQUAL(p[0], s[0]);
+
+  // Check serialization
+  std::array<unsigned char, 16384> buf;
+  madness::archive::BufferOutputArchive oar(buf.data(), buf.size());
+  oar & s;
+  const std::size_t nbyte = oar.size();
+  oar.close();
+
+  tensor_type ts;
+  madness::archive::BufferInputArchive iar(buf.data(), nbyte);
+  iar & ts;
+  iar.close();
+
+  BOOST_CHECK_EQUAL(ts.range(), s.range());
+  for(std::size_t i = 0ul; i < s.size(); ++i)
+    BOOST_CHECK_EQUAL(ts[i], s[i]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
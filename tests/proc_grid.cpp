@@ -193,6 +193,98 @@ BOOST_AUTO_TEST_CASE( make_groups )
   }
 }
 
+BOOST_AUTO_TEST_CASE( layers )
+{
+  const std::size_t K = 7ul;
+  const std::size_t layers =
+      std::min<std::size_t>(GlobalFixture::world->size(), K);
+
+  // Construct the layered process grid
+  TiledArray::detail::ProcGrid proc_grid(*GlobalFixture::world, 42, 84,
+      2048, 1024, layers);
+  BOOST_CHECK_EQUAL(proc_grid.layers(), layers);
+  BOOST_CHECK_LE(proc_grid.proc_size() * layers,
+      std::size_t(GlobalFixture::world->size()));
+
+  std::size_t slab_size = 0ul;
+  if(proc_grid.local_size() != 0ul) {
+    // Check the layer coordinate of this process
+    BOOST_CHECK_EQUAL(proc_grid.layer(),
+        GlobalFixture::world->rank() / proc_grid.proc_size());
+    BOOST_CHECK_EQUAL(proc_grid.map_layer(proc_grid.layer()),
+        GlobalFixture::world->rank());
+    BOOST_CHECK_EQUAL(proc_grid.map_row(proc_grid.rank_row()),
+        GlobalFixture::world->rank());
+    BOOST_CHECK_EQUAL(proc_grid.map_col(proc_grid.rank_col()),
+        GlobalFixture::world->rank());
+
+    // Count the inner dimension slab once per layer
+    const std::pair<std::size_t, std::size_t> range = proc_grid.layer_range(K);
+    BOOST_CHECK_LT(range.first, range.second);
+    if((GlobalFixture::world->rank() % proc_grid.proc_size()) == 0)
+      slab_size = range.second - range.first;
+
+    // Check that the groups only contain processes from this layer
+    madness::DistributedID did_row(madness::uniqueidT(), 0);
+    madness::DistributedID did_col(madness::uniqueidT(), 1);
+    madness::Group row_group = proc_grid.make_row_group(did_row);
+    madness::Group col_group = proc_grid.make_col_group(did_col);
+    BOOST_CHECK_EQUAL(row_group.size(), proc_grid.proc_cols());
+    BOOST_CHECK_EQUAL(col_group.size(), proc_grid.proc_rows());
+    for(ProcessID p = 0; p < row_group.size(); ++p)
+      BOOST_CHECK_EQUAL(row_group.world_rank(p) / proc_grid.proc_size(),
+          proc_grid.layer());
+    for(ProcessID p = 0; p < col_group.size(); ++p)
+      BOOST_CHECK_EQUAL(col_group.world_rank(p) / proc_grid.proc_size(),
+          proc_grid.layer());
+  } else {
+    BOOST_CHECK_EQUAL(proc_grid.layer(), layers);
+  }
+
+  // Check that the inner dimension slabs of all layers cover [0, K)
+  GlobalFixture::world->gop.sum(slab_size);
+  BOOST_CHECK_EQUAL(slab_size, K);
+}
+
+BOOST_AUTO_TEST_CASE( node_aware )
+{
+  // Processes placed round-robin on 4 nodes
+  const std::size_t nprocs = 64ul;
+  std::vector<std::size_t> labels(nprocs);
+  for(std::size_t p = 0ul; p < nprocs; ++p)
+    labels[p] = p % 4ul;
+  const TiledArray::detail::NodeTopology topology(labels);
+
+  std::vector<std::size_t> slots(nprocs, 0ul);
+  std::size_t local_size = 0ul;
+  for(std::size_t rank = 0ul; rank < nprocs; ++rank) {
+    TiledArray::detail::ProcGrid proc_grid(*GlobalFixture::world, rank, nprocs,
+        64, 64, 4096, 4096, &topology);
+    BOOST_CHECK_EQUAL(proc_grid.proc_size(), nprocs);
+    local_size += proc_grid.local_size();
+
+    // Check that the grid coordinates map back to this process
+    BOOST_CHECK_EQUAL(proc_grid.map_row(proc_grid.rank_row()), ProcessID(rank));
+    BOOST_CHECK_EQUAL(proc_grid.map_col(proc_grid.rank_col()), ProcessID(rank));
+    ++slots[proc_grid.rank_row() * proc_grid.proc_cols() + proc_grid.rank_col()];
+
+    // Check that the row or column group of this process is inside its node
+    bool row_node = true, col_node = true;
+    for(std::size_t col = 0ul; col < proc_grid.proc_cols(); ++col)
+      row_node = row_node &&
+          (topology.node(proc_grid.map_col(col)) == topology.node(rank));
+    for(std::size_t row = 0ul; row < proc_grid.proc_rows(); ++row)
+      col_node = col_node &&
+          (topology.node(proc_grid.map_row(row)) == topology.node(rank));
+    BOOST_CHECK(row_node || col_node);
+  }
+
+  // Check that every grid slot is used by exactly one process
+  for(std::size_t slot = 0ul; slot < nprocs; ++slot)
+    BOOST_CHECK_EQUAL(slots[slot], 1ul);
+  BOOST_CHECK_EQUAL(local_size, 64ul * 64ul);
+}
+
 #if 0
 // This test case us used to evaluate distribute statistics. This unit test
 // should only be enabled when changes are made to the ProcGrid algorithm, and
@@ -391,4 +391,58 @@ BOOST_AUTO_TEST_CASE( swap )
   BOOST_CHECK_EQUAL(r.volume(), volume);
 }
 
+BOOST_AUTO_TEST_CASE( inline_storage )
+{
+  // Check ranges that fit into the inline storage and ranges that do not
+  const unsigned int max_rank = Range::max_inline_rank + 2u;
+  for(unsigned int rank = 1u; rank <= max_rank; ++rank) {
+    std::vector<std::size_t> lower(rank), upper(rank);
+    for(unsigned int i = 0u; i < rank; ++i) {
+      lower[i] = i;
+      upper[i] = i + 2u + (i % 2u);
+    }
+    const Range reference(lower, upper);
+
+    // Check copy and move construction
+    Range r1(reference);
+    BOOST_CHECK_EQUAL(r1, reference);
+    Range r2(std::move(r1));
+    BOOST_CHECK_EQUAL(r2, reference);
+    BOOST_CHECK_EQUAL(r1.rank(), 0u);
+    BOOST_CHECK(r1.lobound_data() == nullptr);
+    BOOST_CHECK_EQUAL(r1.volume(), 0ul);
+
+    // Check copy and move assignment between ranges of different rank
+    Range other(std::vector<std::size_t>(max_rank + 1u - rank, 3ul));
+    Range r3(other);
+    r3 = reference;
+    BOOST_CHECK_EQUAL(r3, reference);
+    r3 = std::move(other);
+    BOOST_CHECK_EQUAL(r3.rank(), max_rank + 1u - rank);
+    BOOST_CHECK_EQUAL(r3.volume(), calc_volume(std::vector<std::size_t>(r3.rank(), 3ul)));
+    r3 = std::move(r2);
+    BOOST_CHECK_EQUAL(r3, reference);
+
+    // Check swap between ranges of different rank
+    Range r4(std::vector<std::size_t>(max_rank + 1u - rank, 3ul));
+    Range r5(r4);
+    r3.swap(r4);
+    BOOST_CHECK_EQUAL(r3, r5);
+    BOOST_CHECK_EQUAL(r4, reference);
+
+    // Check permutation
+    std::vector<unsigned int> p(rank);
+    std::iota(p.rbegin(), p.rend(), 0u);
+    const Permutation perm(p);
+    Range r6(reference);
+    r6 *= perm;
+    BOOST_CHECK_EQUAL(r6, Range(perm, reference));
+    for(unsigned int i = 0u; i < rank; ++i) {
+      BOOST_CHECK_EQUAL(r6.lobound(perm[i]), reference.lobound(i));
+      BOOST_CHECK_EQUAL(r6.upbound(perm[i]), reference.upbound(i));
+    }
+    BOOST_CHECK_EQUAL(r6.volume(), reference.volume());
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -79,6 +79,22 @@ struct ReduceOp {
   }
 }; // struct ReduceOp
 
+struct BatchReduceOp : public ReduceOp {
+  using ReduceOp::operator();
+
+  bool batch(const first_argument_type& first, const second_argument_type&) const {
+    return (first % 2) == 0;
+  }
+
+  void operator()(result_type& result,
+      const std::vector<const first_argument_type*>& first,
+      const std::vector<const second_argument_type*>& second) const
+  {
+    for(std::size_t i = 0ul; i < first.size(); ++i)
+      result += *first[i] * *second[i];
+  }
+}; // struct BatchReduceOp
+
 struct ReducePairTaskFixture {
 
   ReducePairTaskFixture() : world(*GlobalFixture::world), rt(world) {
@@ -228,4 +244,157 @@ BOOST_AUTO_TEST_CASE( reduce_zero )
   BOOST_CHECK_EQUAL(result.get(), 0);
 }
 
+BOOST_AUTO_TEST_CASE( reduce_batch )
+{
+  // Even arguments are reduced in batches, odd arguments in pairs
+  ReducePairTask<BatchReduceOp> batch_rt(world, BatchReduceOp());
+  std::vector<Future<int> > fut1_vec;
+  std::vector<Future<int> > fut2_vec;
+
+  for(int i = 0; i < 100; ++i) {
+    Future<int> f1;
+    Future<int> f2;
+    fut1_vec.push_back(f1);
+    fut2_vec.push_back(f2);
+    batch_rt.add(f1, f2);
+  }
+
+  Future<int> result = batch_rt.submit();
+
+  int sum = 0;
+  for(int i = 0; i < 100; ++i) {
+    sum += i * i;
+    fut1_vec[i].set(i);
+    fut2_vec[i].set(i);
+  }
+
+  BOOST_CHECK_EQUAL(result.get(), sum);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+
+// Non-commutative reduction, which records the order of the arguments
+struct ConcatOp {
+  typedef std::vector<int> result_type;
+  typedef int argument_type;
+  typedef int first_argument_type;
+  typedef int second_argument_type;
+
+  result_type operator()() const { return result_type(); }
+
+  const result_type& operator()(const result_type& result) const { return result; }
+
+  void operator()(result_type& result, const result_type& arg) const {
+    result.insert(result.end(), arg.begin(), arg.end());
+  }
+
+  void operator()(result_type& result, const argument_type& arg) const {
+    result.push_back(arg);
+  }
+
+  void operator()(result_type& result, const first_argument_type& first,
+      const second_argument_type& second) const
+  {
+    result.push_back(first * second);
+  }
+}; // struct ConcatOp
+
+struct OrderedReduceTaskFixture {
+
+  OrderedReduceTaskFixture() : world(*GlobalFixture::world) { }
+
+  TiledArray::World& world;
+
+}; // struct OrderedReduceTaskFixture
+
+BOOST_FIXTURE_TEST_SUITE( ordered_reduce_task_suite, OrderedReduceTaskFixture )
+
+BOOST_AUTO_TEST_CASE( reduce_future )
+{
+  OrderedReduceTask<ConcatOp> rt(world);
+  std::vector<Future<int> > fut_vec;
+
+  for(int i = 0; i < 100; ++i) {
+    Future<int> f;
+    fut_vec.push_back(f);
+    BOOST_CHECK_EQUAL(rt.add(f), i + 1);
+  }
+
+  Future<std::vector<int> > result = rt.submit();
+
+  // Set the arguments in reverse order
+  for(int i = 99; i >= 0; --i) {
+    BOOST_CHECK(!(result.probe()));
+    fut_vec[i].set(i);
+  }
+
+  // Check that the arguments are reduced in the order they were added
+  const std::vector<int>& values = result.get();
+  BOOST_REQUIRE_EQUAL(values.size(), 100ul);
+  for(int i = 0; i < 100; ++i)
+    BOOST_CHECK_EQUAL(values[i], i);
+}
+
+BOOST_AUTO_TEST_CASE( reduce_pair_future )
+{
+  OrderedReducePairTask<ConcatOp> rt(world);
+  std::vector<Future<int> > fut_vec;
+
+  for(int i = 0; i < 37; ++i) {
+    Future<int> f;
+    fut_vec.push_back(f);
+    rt.add(f, 2);
+  }
+  BOOST_CHECK_EQUAL(rt.count(), 37);
+
+  Future<std::vector<int> > result = rt.submit();
+
+  for(int i = 36; i >= 0; --i)
+    fut_vec[i].set(i);
+
+  const std::vector<int>& values = result.get();
+  BOOST_REQUIRE_EQUAL(values.size(), 37ul);
+  for(int i = 0; i < 37; ++i)
+    BOOST_CHECK_EQUAL(values[i], 2 * i);
+}
+
+BOOST_AUTO_TEST_CASE( reduce_zero )
+{
+  OrderedReduceTask<ConcatOp> rt(world);
+  BOOST_CHECK(rt.submit().get().empty());
+}
+
+BOOST_AUTO_TEST_CASE( reproducible_blocks )
+{
+  // Sum values with very different magnitudes, where the result depends on
+  // the order of the additions
+  const std::size_t n = 10 * math::reproducible_reduce_block_size + 17ul;
+  std::vector<double> x(n);
+  for(std::size_t i = 0ul; i < n; ++i)
+    x[i] = (i % 3 == 0 ? 1.0e16 : 1.0) * (i % 2 == 0 ? 1.0 : -1.0) + double(i);
+
+  auto block_op = [&x] (double& result, const std::size_t first,
+      const std::size_t size) {
+    for(std::size_t i = first; i < (first + size); ++i)
+      result += x[i];
+  };
+  auto join_op = [] (double& left, const double right) { left += right; };
+
+  // Compute the reference with the same tree serially
+  std::vector<double> blocks;
+  for(std::size_t first = 0ul; first < n; first += math::reproducible_reduce_block_size) {
+    blocks.push_back(0.0);
+    block_op(blocks.back(), first,
+        std::min(math::reproducible_reduce_block_size, n - first));
+  }
+  math::tree_reduce(join_op, blocks);
+
+  for(int r = 0; r < 10; ++r)
+    BOOST_CHECK_EQUAL(math::reproducible_reduce_blocks(n, 0.0, block_op, join_op),
+        blocks.front());
+
+  BOOST_CHECK_EQUAL(math::reproducible_reduce_blocks(0ul, 1.0, block_op, join_op), 1.0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
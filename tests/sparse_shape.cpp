@@ -207,6 +207,37 @@ BOOST_AUTO_TEST_CASE( comm_constructor )
 }
 
 
+BOOST_AUTO_TEST_CASE( comm_constructor_block_sparse )
+{
+  // Construct test tile norms where only the leading corner of the tile grid
+  // is non-zero, so that only some blocks of the grid are reduced.
+  Tensor<float> tile_norms = make_norm_tensor(tr, 1, 62);
+  for(Tensor<float>::size_type i = 0ul; i < tile_norms.size(); ++i) {
+    const auto idx = tr.tiles_range().idx(i);
+    if(std::any_of(idx.begin(), idx.end(), [] (const std::size_t x) { return x > 1ul; }))
+      tile_norms[i] = 0.0f;
+  }
+  Tensor<float> tile_norms_ref = tile_norms.clone();
+
+  // Zero non-local tiles
+  TiledArray::detail::BlockedPmap pmap(*GlobalFixture::world, tr.tiles_range().volume());
+  for(Tensor<float>::size_type i = 0ul; i < tile_norms.size(); ++i)
+    if(! pmap.is_local(i))
+      tile_norms[i] = 0.0f;
+
+  SparseShape<float> x(*GlobalFixture::world, tile_norms, tr);
+
+  for(Tensor<float>::size_type i = 0ul; i < tile_norms.size(); ++i) {
+    const TiledRange::range_type range = tr.make_tile_range(i);
+    float expected = tile_norms_ref[i] / float(range.volume());
+    if(expected < SparseShape<float>::threshold())
+      expected = 0.0f;
+
+    BOOST_CHECK_CLOSE(x[i], expected, tolerance);
+  }
+}
+
+
 BOOST_AUTO_TEST_CASE( copy_constructor )
 {
   // Construct the shape
@@ -1181,6 +1212,54 @@ BOOST_AUTO_TEST_CASE( gemm )
   BOOST_CHECK_CLOSE(result.sparsity(), float(zero_tile_count) / float(result_norms.size()), tolerance);
 }
 
+BOOST_AUTO_TEST_CASE( gemm_very_sparse )
+{
+  // Contract shapes where most norms are zero, so that the product is
+  // computed with the indexed kernel instead of BLAS
+  auto make_very_sparse_shape = [this] (const int seed) {
+    Tensor<float> norms = make_norm_tensor(tr, 1.0, seed);
+    for(std::size_t i = 0ul; i < norms.size(); ++i)
+      if((i % 7ul) != 0ul)
+        norms[i] = SparseShape<float>::threshold() * 0.1;
+    return SparseShape<float>(norms, tr);
+  };
+  const SparseShape<float> sparse_left = make_very_sparse_shape(7);
+  const SparseShape<float> sparse_right = make_very_sparse_shape(9);
+  BOOST_REQUIRE_LT(double(1.0 - sparse_left.sparsity()) *
+      double(1.0 - sparse_right.sparsity()),
+      double(SparseShape<float>::gemm_norms_dense_fraction));
+
+  math::GemmHelper gemm_helper(madness::cblas::NoTrans, madness::cblas::NoTrans,
+      2u, sparse_left.data().range().rank(), sparse_right.data().range().rank());
+  SparseShape<float> result;
+  BOOST_REQUIRE_NO_THROW(result = sparse_left.gemm(sparse_right, 3.0, gemm_helper));
+
+  // Compute the expected norms with a dense matrix multiplication
+  Tensor<float> volumes(tr.tiles_range(), 0.0f);
+  for(std::size_t i = 0ul; i < tr.tiles_range().volume(); ++i)
+    volumes[i] = tr.make_tile_range(i).volume();
+  Tensor<float> result_norms = sparse_left.data().mult(volumes).gemm(
+      sparse_right.data().mult(volumes), 3.0, gemm_helper);
+
+  size_type zero_tile_count = 0ul;
+  for(std::size_t i = 0ul; i < result_norms.size(); ++i) {
+    const auto index = result_norms.range().idx(i);
+    const TiledRange1::range_type r_0 = tr.data()[0].tile(index[0]);
+    const TiledRange1::range_type r_1 = tr.data()[2].tile(index[1]);
+
+    float expected = result_norms[i] /
+        float((r_0.second - r_0.first) * (r_1.second - r_1.first));
+    if(expected < SparseShape<float>::threshold()) {
+      expected = 0.0f;
+      ++zero_tile_count;
+    }
+
+    BOOST_CHECK_CLOSE(result[i], expected, tolerance);
+  }
+
+  BOOST_CHECK_CLOSE(result.sparsity(), float(zero_tile_count) / float(result_norms.size()), tolerance);
+}
+
 BOOST_AUTO_TEST_CASE( gemm_perm )
 {
   const Permutation perm({1,0});
@@ -1240,4 +1319,60 @@ BOOST_AUTO_TEST_CASE( gemm_perm )
   BOOST_CHECK_CLOSE(result.sparsity(), float(zero_tile_count) / float(result_norms.size()), tolerance);
 }
 
+BOOST_AUTO_TEST_CASE( hadamard_gemm )
+{
+  // Contract the last dimension of left with the second dimension of right,
+  // with the first dimension as the Hadamard dimension
+  math::GemmHelper gemm_helper(madness::cblas::NoTrans, madness::cblas::NoTrans,
+      2u, 2u, 2u);
+  SparseShape<float> result;
+  BOOST_REQUIRE_NO_THROW(result = left.hadamard_gemm(right, -7.2, gemm_helper, 1u));
+  BOOST_CHECK_EQUAL(result.data().range().rank(), 3u);
+
+  const std::size_t nh = left.data().range().extent(0);
+  const std::size_t nm = left.data().range().extent(1);
+  const std::size_t nk = left.data().range().extent(2);
+  const std::size_t nn = right.data().range().extent(2);
+
+  // Check that each Hadamard tile is contracted separately, with the inner
+  // tile sizes scaled by the size of the Hadamard tile
+  size_type zero_tile_count = 0ul;
+  std::array<std::size_t, 3> i = {{ 0, 0, 0 }};
+  for(i[0] = 0ul; i[0] < nh; ++i[0]) {
+    const TiledRange1::range_type r_h = tr.data()[0].tile(i[0]);
+    const float size_h = r_h.second - r_h.first;
+
+    for(i[1] = 0ul; i[1] < nm; ++i[1]) {
+      for(i[2] = 0ul; i[2] < nn; ++i[2]) {
+        float expected = 0.0f;
+        for(std::size_t k = 0ul; k < nk; ++k) {
+          const TiledRange1::range_type r_k = tr.data()[2].tile(k);
+          const float size_k = r_k.second - r_k.first;
+          expected += left[std::array<std::size_t, 3>{{ i[0], i[1], k }}] *
+              right[std::array<std::size_t, 3>{{ i[0], k, i[2] }}] *
+              size_k * size_h;
+        }
+        expected *= 7.2f;
+        if(expected < SparseShape<float>::threshold()) {
+          expected = 0.0f;
+          ++zero_tile_count;
+          BOOST_CHECK(result.is_zero(i));
+        }
+
+        BOOST_CHECK_CLOSE(result[i], expected, tolerance);
+      }
+    }
+  }
+
+  BOOST_CHECK_CLOSE(result.sparsity(), float(zero_tile_count) / float(nh * nm * nn), tolerance);
+
+  // Check the permuted result
+  const Permutation perm({1,2,0});
+  SparseShape<float> perm_result;
+  BOOST_REQUIRE_NO_THROW(perm_result = left.hadamard_gemm(right, -7.2, gemm_helper, 1u, perm));
+  const SparseShape<float> expected_perm_result = result.perm(perm);
+  for(std::size_t t = 0ul; t < nh * nm * nn; ++t)
+    BOOST_CHECK_EQUAL(perm_result[t], expected_perm_result[t]);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
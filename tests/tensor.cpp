@@ -169,6 +169,32 @@ BOOST_AUTO_TEST_CASE( permute_constructor_tensor ) {
   }
 }
 
+BOOST_AUTO_TEST_CASE( permute_constructor_tensor_uneven ) {
+  // Extents that are not a multiple of the transpose block size, with a
+  // volume that is large enough for a threaded permutation
+  const std::array<std::size_t, 4> start = {{0ul, 0ul, 0ul, 0ul}};
+  const std::array<std::size_t, 4> finish = {{13ul, 57ul, 7ul, 29ul}};
+  TensorN x(range_type(start, finish));
+  rand_fill(2207, x.size(), x.data());
+
+  std::array<unsigned int, 4> p = {{0,1,2,3}};
+
+  while(std::next_permutation(p.begin(), p.end())) {
+    Permutation perm(p.begin(), p.end());
+
+    TensorN px;
+    BOOST_REQUIRE_NO_THROW(px = TensorN(x, perm));
+
+    std::size_t mismatches = 0ul;
+    for(std::size_t i = 0ul; i < x.size(); ++i) {
+      std::size_t pi = px.range().ordinal(perm * x.range().idx(i));
+      if(px[pi] != x[i])
+        ++mismatches;
+    }
+    BOOST_CHECK_EQUAL(mismatches, 0ul);
+  }
+}
+
 BOOST_AUTO_TEST_CASE( unary_constructor ) {
   // check constructor
   BOOST_REQUIRE_NO_THROW(TensorN x(t, [] (const int arg) { return arg * 83; }));
@@ -269,6 +295,32 @@ BOOST_AUTO_TEST_CASE( clone ) {
   BOOST_CHECK_EQUAL_COLLECTIONS(tc.begin(), tc.end(), t.begin(), t.end());
 }
 
+BOOST_AUTO_TEST_CASE( shift_view ) {
+  const std::vector<long> range_shift(t.range().rank(), -1l);
+
+  TensorN ts;
+  BOOST_REQUIRE_NO_THROW(ts = t.shift_view(range_shift));
+
+  // Check that the range is shifted and the data is shared
+  BOOST_CHECK_EQUAL(ts.range(), r.shift(range_shift));
+  BOOST_CHECK_EQUAL(ts.data(), t.data());
+  BOOST_CHECK_EQUAL(ts.size(), t.size());
+
+  // Check that the range of the original tensor is unchanged
+  BOOST_CHECK_EQUAL(t.range(), r);
+
+  // Check that a view of a view shares the data of the original tensor
+  TensorN tss = ts.shift_view(range_shift);
+  BOOST_CHECK_EQUAL(tss.data(), t.data());
+  BOOST_CHECK_EQUAL(ts.range(), r.shift(range_shift));
+
+  // Check that the data outlives the original tensor
+  TensorN tc = t.clone();
+  ts = tc.shift_view(range_shift);
+  tc = TensorN();
+  BOOST_CHECK_EQUAL_COLLECTIONS(ts.begin(), ts.end(), t.begin(), t.end());
+}
+
 BOOST_AUTO_TEST_CASE( range_accessor )
 {
   BOOST_CHECK_EQUAL_COLLECTIONS(t.range().lobound_data(), t.range().lobound_data() + t.range().rank(),
@@ -1133,4 +1133,59 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( serialization, ITensor, itensor_types )
   BOOST_CHECK_EQUAL_COLLECTIONS(cbegin(a), cend(a), cbegin(a_roundtrip), cend(a_roundtrip));
 }
 
+BOOST_AUTO_TEST_CASE( gemm )
+{
+  // Construct matrices of matrices with inner dimensions that depend on the
+  // outer indices: A[i,l] is (2+i)x(3+l), B[l,j] is (3+l)x(1+j); one element
+  // of each argument is empty (zero).
+  const std::size_t m = 3ul, n = 2ul, k = 4ul;
+  Tensor<Tensor<int> > left(Range(std::array<std::size_t, 2>{{m, k}}));
+  Tensor<Tensor<int> > right(Range(std::array<std::size_t, 2>{{k, n}}));
+  Tensor<Tensor<int> > leftT(Range(std::array<std::size_t, 2>{{k, m}}));
+  for(std::size_t i = 0ul; i < m; ++i)
+    for(std::size_t l = 0ul; l < k; ++l)
+      if(i != 1ul || l != 2ul)
+        leftT(l,i) = left(i,l) = make_rand_tensor(Range(std::array<std::size_t, 2>{{2 + i, 3 + l}}));
+  for(std::size_t l = 0ul; l < k; ++l)
+    for(std::size_t j = 0ul; j < n; ++j)
+      if(l != 0ul || j != 1ul)
+        right(l,j) = make_rand_tensor(Range(std::array<std::size_t, 2>{{3 + l, 1 + j}}));
+
+  const math::GemmHelper gemm_helper(madness::cblas::NoTrans,
+      madness::cblas::NoTrans, 2u, 2u, 2u);
+  const math::GemmHelper gemm_helperT(madness::cblas::Trans,
+      madness::cblas::NoTrans, 2u, 2u, 2u);
+  const math::GemmHelper inner_helper(madness::cblas::NoTrans,
+      madness::cblas::NoTrans, 2u, 2u, 2u);
+
+  Tensor<Tensor<int> > result;
+  BOOST_REQUIRE_NO_THROW(result = left.gemm(right, 2, gemm_helper));
+  BOOST_CHECK_EQUAL(result.range().extent(0), m);
+  BOOST_CHECK_EQUAL(result.range().extent(1), n);
+
+  // Accumulate the transposed contraction
+  BOOST_REQUIRE_NO_THROW(result.gemm(leftT, right, 1, gemm_helperT));
+
+  for(std::size_t i = 0ul; i < m; ++i) {
+    for(std::size_t j = 0ul; j < n; ++j) {
+      // Compute the reference value of element (i,j) with inner gemm
+      Tensor<int> reference;
+      for(std::size_t l = 0ul; l < k; ++l) {
+        if(left(i,l).empty() || right(l,j).empty())
+          continue;
+        if(reference.empty())
+          reference = left(i,l).gemm(right(l,j), 3, inner_helper);
+        else
+          reference.gemm(left(i,l), right(l,j), 3, inner_helper);
+      }
+
+      const Tensor<int>& tile = result(i,j);
+      BOOST_REQUIRE(! tile.empty());
+      BOOST_CHECK_EQUAL(tile.range(), reference.range());
+      for(std::size_t x = 0ul; x < reference.size(); ++x)
+        BOOST_CHECK_EQUAL(tile[x], reference[x]);
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -105,8 +105,6 @@ BOOST_AUTO_TEST_CASE( permute_empty )
 }
 #endif // TA_EXCEPTION_ERROR
 
-// TODO: Test non-empty permutation
-
 BOOST_AUTO_TEST_CASE( matrix_multiply )
 {
   // Set dimension constants
@@ -472,4 +470,140 @@ BOOST_AUTO_TEST_CASE( tensor_contract2 )
 }
 
 
+BOOST_AUTO_TEST_CASE( permuted_tensor_contract )
+{
+  // Set dimension constants
+  const std::size_t
+      left_outer1_start = 2, left_outer1_finish = 12,
+      left_outer2_start = 3, left_outer2_finish = 13,
+      inner_start = 3, inner_finish = 17,
+      right_outer1_start = 5, right_outer1_finish = 15,
+      right_outer2_start = 4, right_outer2_finish = 11;
+
+  // Construct tensors
+  TensorI left = make_tensor(left_outer1_start, left_outer2_start, inner_start, left_outer1_finish, left_outer2_finish, inner_finish);
+  TensorI right = make_tensor(inner_start, right_outer1_start, right_outer2_start, inner_finish, right_outer1_finish, right_outer2_finish);
+  TensorI leftT = make_tensor(inner_start, left_outer1_start, left_outer2_start, inner_finish, left_outer1_finish, left_outer2_finish);
+  TensorI rightT = make_tensor(right_outer1_start, right_outer2_start, inner_start, right_outer1_finish, right_outer2_finish, inner_finish);
+
+  // The first permutation swaps the left and right outer dimensions, which is
+  // fused with the contraction; the others are applied to the result.
+  const Permutation perms[3] = { Permutation({2,3,0,1}),
+      Permutation({1,0,2,3}), Permutation({3,2,1,0}) };
+
+  const madness::cblas::CBLAS_TRANSPOSE ops[2] =
+      { madness::cblas::NoTrans, madness::cblas::Trans };
+
+  for(const Permutation& perm : perms) {
+    for(madness::cblas::CBLAS_TRANSPOSE left_op : ops) {
+      for(madness::cblas::CBLAS_TRANSPOSE right_op : ops) {
+        const TensorI& l = (left_op == madness::cblas::NoTrans ? left : leftT);
+        const TensorI& r = (right_op == madness::cblas::NoTrans ? right : rightT);
+
+        ContractReduce<TensorI, TensorI, TensorI, int>
+        ref_op(left_op, right_op, 3, 4u, 3u, 3u);
+        ContractReduce<TensorI, TensorI, TensorI, int>
+        op(left_op, right_op, 3, 4u, 3u, 3u, perm);
+
+        // Compute the reference with two contractions and an explicit
+        // permutation.
+        TensorI reference = ref_op();
+        ref_op(reference, l, r);
+        ref_op(reference, l, r);
+        reference = reference.permute(perm);
+
+        TensorI result = op();
+        BOOST_REQUIRE_NO_THROW(op(result, l, r));
+        BOOST_REQUIRE_NO_THROW(op(result, l, r));
+        BOOST_REQUIRE_NO_THROW(result = op(result));
+
+        BOOST_CHECK_EQUAL(result.range(), reference.range());
+        for(std::size_t i = 0ul; i < reference.size(); ++i)
+          BOOST_CHECK_EQUAL(result[i], reference[i]);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( batch_contract )
+{
+  const bool enabled = TiledArray::detail::set_contract_batch(true);
+
+  // Set dimension constants; the inner dimension is split among the pairs
+  const std::size_t
+      left_outer1_start = 2, left_outer1_finish = 7,
+      left_outer2_start = 3, left_outer2_finish = 6,
+      right_outer1_start = 5, right_outer1_finish = 9,
+      right_outer2_start = 4, right_outer2_finish = 6;
+  const std::size_t inner_bounds[4] = { 3, 5, 9, 10 };
+
+  // Construct tensors
+  std::vector<TensorI> left, right, leftT, rightT;
+  for(std::size_t p = 0ul; p < 3ul; ++p) {
+    left.push_back(make_tensor(left_outer1_start, left_outer2_start, inner_bounds[p],
+        left_outer1_finish, left_outer2_finish, inner_bounds[p + 1]));
+    right.push_back(make_tensor(inner_bounds[p], right_outer1_start, right_outer2_start,
+        inner_bounds[p + 1], right_outer1_finish, right_outer2_finish));
+    leftT.push_back(make_tensor(inner_bounds[p], left_outer1_start, left_outer2_start,
+        inner_bounds[p + 1], left_outer1_finish, left_outer2_finish));
+    rightT.push_back(make_tensor(right_outer1_start, right_outer2_start, inner_bounds[p],
+        right_outer1_finish, right_outer2_finish, inner_bounds[p + 1]));
+  }
+
+  // The second permutation is fused with the contraction
+  const Permutation perms[2] = { Permutation(), Permutation({2,3,0,1}) };
+
+  const madness::cblas::CBLAS_TRANSPOSE ops[2] =
+      { madness::cblas::NoTrans, madness::cblas::Trans };
+
+  for(const Permutation& perm : perms) {
+    for(madness::cblas::CBLAS_TRANSPOSE left_op : ops) {
+      for(madness::cblas::CBLAS_TRANSPOSE right_op : ops) {
+        const std::vector<TensorI>& l = (left_op == madness::cblas::NoTrans ? left : leftT);
+        const std::vector<TensorI>& r = (right_op == madness::cblas::NoTrans ? right : rightT);
+
+        ContractReduce<TensorI, TensorI, TensorI, int>
+        op(left_op, right_op, 3, 4u, 3u, 3u, perm);
+
+        // Compute the reference one pair at a time
+        TensorI reference = op();
+        for(std::size_t p = 0ul; p < 3ul; ++p) {
+          BOOST_CHECK(op.batch(l[p], r[p]));
+          op(reference, l[p], r[p]);
+        }
+        reference = op(reference);
+
+        // Contract the first two pairs into an empty result, then accumulate
+        // the last pair.
+        std::vector<const TensorI*> l_batch = { &l[0], &l[1] };
+        std::vector<const TensorI*> r_batch = { &r[0], &r[1] };
+        TensorI result = op();
+        BOOST_REQUIRE_NO_THROW(op(result, l_batch, r_batch));
+        l_batch = { &l[2] };
+        r_batch = { &r[2] };
+        BOOST_REQUIRE_NO_THROW(op(result, l_batch, r_batch));
+        BOOST_REQUIRE_NO_THROW(result = op(result));
+
+        BOOST_CHECK_EQUAL(result.range(), reference.range());
+        for(std::size_t i = 0ul; i < reference.size(); ++i)
+          BOOST_CHECK_EQUAL(result[i], reference[i]);
+      }
+    }
+  }
+
+  // Check that large tiles are not batched
+  ContractReduce<TensorI, TensorI, TensorI, int>
+  op(madness::cblas::NoTrans, madness::cblas::NoTrans, 3, 2u, 2u, 2u);
+  TensorI large = make_tensor(0, 0, 100, 100);
+  BOOST_CHECK(! op.batch(large, large));
+
+  // Check that small tiles are not batched when batching is disabled
+  TensorI small = make_tensor(0, 0, 4, 4);
+  BOOST_CHECK(op.batch(small, small));
+  TiledArray::detail::set_contract_batch(false);
+  BOOST_CHECK(! op.batch(small, small));
+
+  TiledArray::detail::set_contract_batch(enabled);
+}
+
 BOOST_AUTO_TEST_SUITE_END()